@@ -0,0 +1,193 @@
+#include "bitrate_controller.h"
+
+#include "net/network_probe.h"
+
+#include <algorithm>
+#include <vector>
+
+// 码率低于档位默认码率的一半时画质明显下降，换用更低的档位
+static const double TIER_MIN_BITRATE_RATIO = 0.5;
+
+static bool same_settings(const BitrateController::Settings &a, const BitrateController::Settings &b) {
+    return a.bitrate_kbps == b.bitrate_kbps && a.width == b.width && a.height == b.height && a.fps == b.fps;
+}
+
+void BitrateController::start_session(const Settings &p_current, const Settings &p_ceiling, uint64_t now_ms) {
+    reset();
+    if (upgrade_after_ms == 0 || !same_settings(backoff_ceiling, p_ceiling)) {
+        upgrade_after_ms = config.upgrade_after_ms;
+        last_upgrade_ms = 0;
+    }
+    current = p_current;
+    ceiling = p_ceiling;
+    backoff_ceiling = p_ceiling;
+    active = true;
+
+    window_start_ms = now_ms;
+    // 重连后先观察一段时间
+    last_change_ms = now_ms;
+    stable_since_ms = now_ms;
+}
+
+void BitrateController::reset() {
+    active = false;
+    current = Settings();
+    ceiling = Settings();
+
+    window_frames = 0;
+    window_lost = 0;
+    window_max_latency_us = 0;
+    window_poor = false;
+    poor = false;
+    window_start_ms = 0;
+    bad_windows = 0;
+    last_change_ms = 0;
+    stable_since_ms = 0;
+}
+
+void BitrateController::on_frame(int lost_frames, double queue_latency_ms) {
+    window_frames.fetch_add(1, std::memory_order_relaxed);
+    if (lost_frames > 0) {
+        window_lost.fetch_add((uint32_t)lost_frames, std::memory_order_relaxed);
+    }
+    uint32_t latency_us = (uint32_t)std::max(0.0, queue_latency_ms * 1000.0);
+    uint32_t previous = window_max_latency_us.load(std::memory_order_relaxed);
+    while (latency_us > previous && !window_max_latency_us.compare_exchange_weak(previous, latency_us, std::memory_order_relaxed)) {
+    }
+}
+
+void BitrateController::on_connection_status(bool p_poor) {
+    poor.store(p_poor, std::memory_order_relaxed);
+    if (p_poor) {
+        window_poor.store(true, std::memory_order_relaxed);
+    }
+}
+
+bool BitrateController::update(uint64_t now_ms, Decision *r_decision) {
+    if (!active || now_ms - window_start_ms < config.window_ms) {
+        return false;
+    }
+    window_start_ms = now_ms;
+
+    uint32_t frames = window_frames.exchange(0, std::memory_order_relaxed);
+    uint32_t lost = window_lost.exchange(0, std::memory_order_relaxed);
+    double max_latency_ms = window_max_latency_us.exchange(0, std::memory_order_relaxed) / 1000.0;
+    // 状态仍为 POOR 时下一个窗口继续计为异常
+    bool was_poor = window_poor.exchange(poor.load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+    // 没有收到任何帧 (例如主机端画面静止) 时不做判断
+    if (frames + lost == 0 && !was_poor) {
+        return false;
+    }
+
+    double loss = frames + lost > 0 ? (double)lost / (frames + lost) : 0.0;
+    double frame_interval_ms = 1000.0 / (current.fps > 0 ? current.fps : 60);
+    Reason reason = REASON_NONE;
+    if (was_poor) {
+        reason = REASON_CONNECTION_POOR;
+    } else if (loss >= config.loss_threshold) {
+        reason = REASON_PACKET_LOSS;
+    } else if (max_latency_ms > config.latency_threshold_frames * frame_interval_ms) {
+        reason = REASON_DECODE_LATENCY;
+    }
+
+    if (reason != REASON_NONE) {
+        bad_windows++;
+        stable_since_ms = now_ms;
+        bool severe = was_poor || loss >= config.severe_loss_threshold;
+        if ((!severe && bad_windows < config.degrade_windows) || now_ms - last_change_ms < config.cooldown_ms) {
+            return false;
+        }
+        bad_windows = 0;
+
+        // 升档后很快又出现问题：链路容量就在两档之间，延长下次升档前的等待
+        if (last_upgrade_ms != 0 && now_ms - last_upgrade_ms < config.failed_upgrade_window_ms) {
+            upgrade_after_ms = std::min(upgrade_after_ms * 2, config.max_upgrade_after_ms);
+        }
+
+        double factor = severe ? config.severe_step_down : config.step_down;
+        int bitrate = std::max(config.min_bitrate_kbps, (int)(current.bitrate_kbps * factor));
+        Settings next = _settings_for_bitrate(bitrate, reason == REASON_DECODE_LATENCY);
+        if (same_settings(next, current)) {
+            return false;
+        }
+        current = next;
+        last_change_ms = now_ms;
+        r_decision->reason = reason;
+        r_decision->settings = current;
+        return true;
+    }
+
+    bad_windows = 0;
+    if (same_settings(current, ceiling)) {
+        // 在上限稳定运行足够久后恢复初始的升档等待时间
+        if (now_ms - stable_since_ms >= config.max_upgrade_after_ms) {
+            upgrade_after_ms = config.upgrade_after_ms;
+        }
+        return false;
+    }
+    if (now_ms - stable_since_ms < upgrade_after_ms || now_ms - last_change_ms < config.cooldown_ms) {
+        return false;
+    }
+
+    int bitrate = std::min(ceiling.bitrate_kbps, (int)(current.bitrate_kbps * config.step_up));
+    Settings next = _settings_for_bitrate(bitrate, false);
+    if (same_settings(next, current)) {
+        return false;
+    }
+    current = next;
+    last_change_ms = now_ms;
+    last_upgrade_ms = now_ms;
+    stable_since_ms = now_ms;
+    r_decision->reason = REASON_RECOVERED;
+    r_decision->settings = current;
+    return true;
+}
+
+BitrateController::Settings BitrateController::_settings_for_bitrate(int bitrate_kbps, bool lower_resolution) const {
+    // 候选档位：上限本身，以及保持上限宽高比的 1440p / 1080p / 720p 与 60 / 30 帧
+    std::vector<int> heights = { ceiling.height };
+    for (int height : { 1440, 1080, 720 }) {
+        if (height < ceiling.height) {
+            heights.push_back(height);
+        }
+    }
+    std::vector<int> rates = { ceiling.fps };
+    for (int fps : { 60, 30 }) {
+        if (fps < ceiling.fps) {
+            rates.push_back(fps);
+        }
+    }
+
+    std::vector<Settings> tiers;
+    for (int height : heights) {
+        for (int fps : rates) {
+            Settings tier;
+            tier.height = height;
+            tier.width = height == ceiling.height ? ceiling.width : (int)((int64_t)ceiling.width * height / ceiling.height) & ~1;
+            tier.fps = fps;
+            tiers.push_back(tier);
+        }
+    }
+    // 按默认码率从高到低，相同时优先帧率
+    std::stable_sort(tiers.begin(), tiers.end(), [](const Settings &a, const Settings &b) {
+        int bitrate_a = NetworkProbe::get_default_bitrate_kbps(a.width, a.height, a.fps);
+        int bitrate_b = NetworkProbe::get_default_bitrate_kbps(b.width, b.height, b.fps);
+        return bitrate_a != bitrate_b ? bitrate_a > bitrate_b : a.fps > b.fps;
+    });
+
+    int64_t current_pixel_rate = (int64_t)current.width * current.height * current.fps;
+    Settings result = tiers.back();
+    for (const Settings &tier : tiers) {
+        // 解码跟不上时至少降低一档像素速率
+        if (lower_resolution && (int64_t)tier.width * tier.height * tier.fps >= current_pixel_rate) {
+            continue;
+        }
+        if (NetworkProbe::get_default_bitrate_kbps(tier.width, tier.height, tier.fps) * TIER_MIN_BITRATE_RATIO <= bitrate_kbps) {
+            result = tier;
+            break;
+        }
+    }
+    result.bitrate_kbps = bitrate_kbps;
+    return result;
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// 自适应码率控制器
+// 综合 Limelight 的连接状态 (CONN_STATUS_POOR)、按 frameNumber 检测到的丢帧数与解码队列延迟，
+// 按固定窗口评估链路状况，给出新的码率与分辨率/帧率档位。
+// 防止振荡：
+//   - 连续多个窗口异常才降档 (连接状态 POOR 或严重丢帧立即降档)
+//   - 降档后需要持续稳定一段时间才升档，每次升档后很快又降档时，下次升档前的等待时间翻倍
+//   - 任何调整之后有冷却时间，且只有变化足够大时才给出建议
+// 码率的调整需要重新连接 (moonlight-common-c 不支持串流中修改码率)，因此控制器只给出建议。
+// on_frame / on_connection_status 可在 Limelight 线程中调用，update 在主线程中调用。
+class BitrateController {
+public:
+    enum Reason {
+        REASON_NONE = 0,
+        REASON_PACKET_LOSS = 1,       // 丢帧率超过阈值
+        REASON_CONNECTION_POOR = 2,   // Limelight 报告 CONN_STATUS_POOR
+        REASON_DECODE_LATENCY = 3,    // 解码队列延迟过高 (客户端解码跟不上)
+        REASON_RECOVERED = 4,         // 链路稳定，恢复码率
+    };
+
+    struct Settings {
+        int bitrate_kbps = 20000;
+        int width = 1920;
+        int height = 1080;
+        int fps = 60;
+    };
+
+    struct Config {
+        uint64_t window_ms = 1000;
+        double loss_threshold = 0.02;        // 窗口内丢帧率超过此值视为异常
+        double severe_loss_threshold = 0.10; // 超过此值立即降档
+        double latency_threshold_frames = 3; // 解码队列延迟超过此帧数视为异常
+        int degrade_windows = 2;             // 连续异常窗口数
+        double step_down = 0.75;
+        double severe_step_down = 0.5;
+        double step_up = 1.25;
+        uint64_t cooldown_ms = 5000;         // 两次调整的最小间隔
+        uint64_t upgrade_after_ms = 15000;   // 持续稳定多久后升档
+        uint64_t max_upgrade_after_ms = 120000;
+        uint64_t failed_upgrade_window_ms = 30000; // 升档后多久内降档视为升档失败
+        int min_bitrate_kbps = 2000;
+    };
+
+    struct Decision {
+        Reason reason = REASON_NONE;
+        Settings settings;
+    };
+
+    void set_config(const Config &p_config) { config = p_config; }
+
+    // 开始新的串流会话。ceiling 为用户选择的上限；上限与上一个会话相同时 (例如按建议重连) 保留升档退避状态
+    void start_session(const Settings &current, const Settings &ceiling, uint64_t now_ms);
+    // 结束会话：停止评估并清除窗口、当前设置与上限，只保留升档退避状态。在连接开始与结束时调用
+    void reset();
+
+    // 每个解码单元调用一次：lost_frames 为本帧之前检测到的丢失帧数，queue_latency_ms 为解码队列延迟
+    void on_frame(int lost_frames, double queue_latency_ms);
+    void on_connection_status(bool poor);
+
+    // 返回 true 时 r_decision 为新的建议
+    bool update(uint64_t now_ms, Decision *r_decision);
+
+    Settings get_current() const { return current; }
+
+private:
+    Config config;
+    Settings current;
+    Settings ceiling;
+    bool active = false;
+    // 升档退避状态所属的上限 (reset 后保留)
+    Settings backoff_ceiling;
+
+    // Limelight 线程写入，主线程在窗口结束时取出
+    std::atomic<uint32_t> window_frames{ 0 };
+    std::atomic<uint32_t> window_lost{ 0 };
+    std::atomic<uint32_t> window_max_latency_us{ 0 };
+    std::atomic<bool> window_poor{ false };
+    std::atomic<bool> poor{ false };
+
+    uint64_t window_start_ms = 0;
+    int bad_windows = 0;
+    uint64_t last_change_ms = 0;
+    uint64_t stable_since_ms = 0;
+    uint64_t last_upgrade_ms = 0;
+    uint64_t upgrade_after_ms = 0;
+
+    Settings _settings_for_bitrate(int bitrate_kbps, bool lower_resolution) const;
+};
@@ -0,0 +1,134 @@
+#include "gamepad_sampler.h"
+
+#include <godot_cpp/classes/input.hpp>
+
+#include <algorithm>
+#include <chrono>
+
+using namespace godot;
+
+// Godot JoyButton -> Limelight 按钮标志 (按 JoyButton 的值索引)
+static const int JOY_BUTTON_FLAGS[] = {
+    A_FLAG,        // JOY_BUTTON_A
+    B_FLAG,        // JOY_BUTTON_B
+    X_FLAG,        // JOY_BUTTON_X
+    Y_FLAG,        // JOY_BUTTON_Y
+    BACK_FLAG,     // JOY_BUTTON_BACK
+    SPECIAL_FLAG,  // JOY_BUTTON_GUIDE
+    PLAY_FLAG,     // JOY_BUTTON_START
+    LS_CLK_FLAG,   // JOY_BUTTON_LEFT_STICK
+    RS_CLK_FLAG,   // JOY_BUTTON_RIGHT_STICK
+    LB_FLAG,       // JOY_BUTTON_LEFT_SHOULDER
+    RB_FLAG,       // JOY_BUTTON_RIGHT_SHOULDER
+    UP_FLAG,       // JOY_BUTTON_DPAD_UP
+    DOWN_FLAG,     // JOY_BUTTON_DPAD_DOWN
+    LEFT_FLAG,     // JOY_BUTTON_DPAD_LEFT
+    RIGHT_FLAG,    // JOY_BUTTON_DPAD_RIGHT
+    MISC_FLAG,     // JOY_BUTTON_MISC1
+    PADDLE1_FLAG,  // JOY_BUTTON_PADDLE1
+    PADDLE2_FLAG,  // JOY_BUTTON_PADDLE2
+    PADDLE3_FLAG,  // JOY_BUTTON_PADDLE3
+    PADDLE4_FLAG,  // JOY_BUTTON_PADDLE4
+    TOUCHPAD_FLAG, // JOY_BUTTON_TOUCHPAD
+};
+static const int JOY_BUTTON_FLAG_COUNT = sizeof(JOY_BUTTON_FLAGS) / sizeof(JOY_BUTTON_FLAGS[0]);
+
+GamepadSampler::GamepadSampler() {
+    for (int &device : devices) {
+        device = -1;
+    }
+}
+
+GamepadSampler::~GamepadSampler() {
+    stop();
+}
+
+void GamepadSampler::start(InputSender *p_sender, int rate_hz) {
+    stop();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop_requested = false;
+        sender = p_sender;
+        interval_us = 1000000 / std::max(1, rate_hz);
+    }
+    sample_count = 0;
+    running = true;
+    worker = std::thread(&GamepadSampler::_run, this);
+}
+
+void GamepadSampler::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop_requested = true;
+    }
+    condition.notify_all();
+    if (worker.joinable()) {
+        worker.join();
+    }
+    running = false;
+}
+
+void GamepadSampler::set_controller_device(int controller, int device) {
+    if (controller < 0 || controller >= InputSender::MAX_CONTROLLERS) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    devices[controller] = device;
+}
+
+void GamepadSampler::_run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    auto next = std::chrono::steady_clock::now();
+    while (!stop_requested) {
+        // 采样期间持有锁：set_controller_device 返回后不会再发送该手柄的旧状态
+        for (int i = 0; i < InputSender::MAX_CONTROLLERS; i++) {
+            if (devices[i] >= 0) {
+                // 状态未变化时由 InputSender 丢弃
+                sender->set_controller_state(i, sample_device(devices[i]));
+                sample_count.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        // 按绝对时间推进，采样周期不随处理耗时漂移
+        next += std::chrono::microseconds(interval_us);
+        auto now = std::chrono::steady_clock::now();
+        if (next < now) {
+            next = now;
+        }
+        condition.wait_until(lock, next, [this]() { return stop_requested; });
+    }
+}
+
+InputSender::ControllerState GamepadSampler::sample_device(int device) {
+    Input *input = Input::get_singleton();
+    InputSender::ControllerState state;
+    for (int i = 0; i < JOY_BUTTON_FLAG_COUNT; i++) {
+        if (input->is_joy_button_pressed(device, (JoyButton)i)) {
+            state.button_flags |= JOY_BUTTON_FLAGS[i];
+        }
+    }
+    state.left_stick_x = to_stick_value(input->get_joy_axis(device, JOY_AXIS_LEFT_X), false);
+    state.left_stick_y = to_stick_value(input->get_joy_axis(device, JOY_AXIS_LEFT_Y), true);
+    state.right_stick_x = to_stick_value(input->get_joy_axis(device, JOY_AXIS_RIGHT_X), false);
+    state.right_stick_y = to_stick_value(input->get_joy_axis(device, JOY_AXIS_RIGHT_Y), true);
+    state.left_trigger = to_trigger_value(input->get_joy_axis(device, JOY_AXIS_TRIGGER_LEFT));
+    state.right_trigger = to_trigger_value(input->get_joy_axis(device, JOY_AXIS_TRIGGER_RIGHT));
+    return state;
+}
+
+int GamepadSampler::get_button_flag(int joy_button) {
+    if (joy_button < 0 || joy_button >= JOY_BUTTON_FLAG_COUNT) {
+        return 0;
+    }
+    return JOY_BUTTON_FLAGS[joy_button];
+}
+
+int16_t GamepadSampler::to_stick_value(float value, bool invert) {
+    // Godot 的 Y 轴向下为正，Limelight 向上为正
+    float clamped = std::clamp(invert ? -value : value, -1.0f, 1.0f);
+    return (int16_t)(clamped * 32767.0f);
+}
+
+uint8_t GamepadSampler::to_trigger_value(float value) {
+    return (uint8_t)(std::clamp(value, 0.0f, 1.0f) * 255.0f);
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+#include "input_sender.h"
+
+// 手柄状态采样器
+// 独立线程以固定频率 (默认 1000 Hz) 读取 Godot Input 单例中的手柄轴与按钮，
+// 打包为 Limelight 多手柄状态交给 InputSender，只有状态变化时才会发送。
+// 不经过 GDScript，也不受主线程帧率限制；Input 的查询方法是线程安全的。
+// 采样到的状态的新鲜度取决于平台手柄后端更新 Input 的频率。
+class GamepadSampler {
+public:
+    GamepadSampler();
+    ~GamepadSampler();
+
+    void start(InputSender *p_sender, int rate_hz);
+    void stop();
+    bool is_running() const { return running.load(); }
+
+    // 指定 Limelight 手柄编号对应的 Godot 设备号，-1 表示不再采样
+    void set_controller_device(int controller, int device);
+    uint64_t get_sample_count() const { return sample_count.load(std::memory_order_relaxed); }
+
+    // 读取一个 Godot 手柄的完整状态
+    static InputSender::ControllerState sample_device(int device);
+
+    // Godot JoyButton -> Limelight 按钮标志，未映射时返回 0
+    static int get_button_flag(int joy_button);
+    // Godot 轴值 (-1~1 / 0~1) -> Limelight 摇杆与扳机值
+    static int16_t to_stick_value(float value, bool invert);
+    static uint8_t to_trigger_value(float value);
+
+private:
+    std::thread worker;
+    std::atomic<bool> running{ false };
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool stop_requested = false;
+    InputSender *sender = nullptr;
+    int interval_us = 1000;
+    int devices[InputSender::MAX_CONTROLLERS];
+    std::atomic<uint64_t> sample_count{ 0 };
+
+    void _run();
+};
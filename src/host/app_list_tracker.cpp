@@ -0,0 +1,93 @@
+#include "host/app_list_tracker.h"
+
+#include <algorithm>
+#include <cctype>
+
+uint64_t AppListTracker::hash_content(const char *data, size_t length) {
+    // FNV-1a 64
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= (uint8_t)data[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+AppListTracker::Result AppListTracker::update(const char *data, size_t length, Diff *r_diff, int *r_status_code) {
+    r_diff->added.clear();
+    r_diff->changed.clear();
+    r_diff->removed.clear();
+
+    uint64_t hash = hash_content(data, length);
+    if (has_hash && hash == content_hash) {
+        if (r_status_code) {
+            *r_status_code = 200;
+        }
+        return RESULT_UNCHANGED;
+    }
+
+    std::vector<AppInfo> new_apps;
+    if (!parse_app_list(data, length, &new_apps, r_status_code)) {
+        return RESULT_ERROR;
+    }
+    // 空列表视为无效响应 (与 computermanager.cpp 一致)，避免主机暂时异常时清空列表
+    if (new_apps.empty()) {
+        return RESULT_ERROR;
+    }
+
+    std::map<int, AppInfo> next;
+    for (AppInfo &app : new_apps) {
+        auto existing = apps.find(app.id);
+        if (existing == apps.end()) {
+            r_diff->added.push_back(app);
+        } else if (existing->second != app) {
+            r_diff->changed.push_back(app);
+        }
+        next[app.id] = std::move(app);
+    }
+    for (auto &entry : apps) {
+        if (next.find(entry.first) == next.end()) {
+            r_diff->removed.push_back(entry.first);
+        }
+    }
+
+    apps.swap(next);
+    has_hash = true;
+    content_hash = hash;
+
+    bool changed = !r_diff->added.empty() || !r_diff->changed.empty() || !r_diff->removed.empty();
+    return changed ? RESULT_CHANGED : RESULT_UNCHANGED;
+}
+
+void AppListTracker::clear() {
+    has_hash = false;
+    content_hash = 0;
+    apps.clear();
+}
+
+static std::string to_lower(const std::string &str) {
+    std::string lower = str;
+    std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+    return lower;
+}
+
+std::vector<AppInfo> AppListTracker::get_sorted_apps() const {
+    std::vector<std::pair<std::string, const AppInfo *>> keyed;
+    keyed.reserve(apps.size());
+    for (auto &entry : apps) {
+        keyed.push_back({ to_lower(entry.second.name), &entry.second });
+    }
+    std::stable_sort(keyed.begin(), keyed.end(), [](const auto &a, const auto &b) { return a.first < b.first; });
+
+    std::vector<AppInfo> result;
+    result.reserve(keyed.size());
+    for (auto &entry : keyed) {
+        result.push_back(*entry.second);
+    }
+    return result;
+}
+
+const AppInfo *AppListTracker::get_app(int app_id) const {
+    auto it = apps.find(app_id);
+    return it == apps.end() ? nullptr : &it->second;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "host/server_info.h"
+
+#include <cstdint>
+#include <map>
+#include <vector>
+
+// 单台主机的应用列表状态
+// 对原始 /applist 响应做内容哈希：与上一次完全相同时直接跳过，不解析也不比较；
+// 内容变化时按 appId 计算新增、删除和修改的应用，调用方只需要更新差异部分。
+class AppListTracker {
+public:
+    enum Result {
+        RESULT_UNCHANGED,   // 响应与上次相同 (哈希一致或解析后内容一致)
+        RESULT_CHANGED,     // r_diff 中包含差异
+        RESULT_ERROR,       // 响应无效，保留原列表
+    };
+
+    struct Diff {
+        std::vector<AppInfo> added;
+        std::vector<AppInfo> changed;
+        std::vector<int> removed;
+    };
+
+    Result update(const char *data, size_t length, Diff *r_diff, int *r_status_code = nullptr);
+    void clear();
+
+    // 按名称 (不区分大小写) 排序的应用列表，与 NvComputer::sortAppList 一致
+    std::vector<AppInfo> get_sorted_apps() const;
+    const AppInfo *get_app(int app_id) const;
+    size_t get_app_count() const { return apps.size(); }
+    bool has_list() const { return has_hash; }
+
+    static uint64_t hash_content(const char *data, size_t length);
+
+private:
+    bool has_hash = false;
+    uint64_t content_hash = 0;
+    std::map<int, AppInfo> apps;
+};
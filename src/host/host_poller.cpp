@@ -0,0 +1,646 @@
+#include "host/host_poller.h"
+
+#include "net/http_message.h"
+
+#include <algorithm>
+#include <cstring>
+
+// 响应上限，/serverinfo 一般只有几 KB
+static const size_t MAX_RESPONSE_SIZE = 1024 * 1024;
+
+// 唤醒包的发送时间 (相对第一次发送)；休眠的网卡或无线网络可能丢掉单个包，
+// 主机启动后网卡重新初始化期间也可能需要再次唤醒
+static const uint64_t WAKE_BURST_OFFSETS_MS[] = { 0, 100, 300, 700, 1500, 3000, 6000 };
+static const size_t WAKE_BURST_COUNT = sizeof(WAKE_BURST_OFFSETS_MS) / sizeof(WAKE_BURST_OFFSETS_MS[0]);
+// 唤醒期间单个地址的超时，启动中的主机不响应 SYN，不必等满 request_timeout_ms
+static const int WAKE_REQUEST_TIMEOUT_MS = 1500;
+
+HostPoller::HostPoller() {
+    memset(&wake_address, 0, sizeof(wake_address));
+}
+
+HostPoller::~HostPoller() {
+    stop();
+}
+
+bool HostPoller::start() {
+    if (running.load()) {
+        return true;
+    }
+    net::startup();
+
+    // 用绑定到回环地址的 UDP socket 唤醒 poll()，Windows 上没有 pipe 可用
+    wake_socket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (wake_socket == NET_INVALID_SOCKET) {
+        return false;
+    }
+    sockaddr_in *addr = (sockaddr_in *)&wake_address;
+    addr->sin_family = AF_INET;
+    addr->sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr->sin_port = 0;
+    socklen_t len = sizeof(sockaddr_in);
+    if (bind(wake_socket, (const sockaddr *)addr, len) != 0 ||
+            getsockname(wake_socket, (sockaddr *)addr, &len) != 0 ||
+            !net::set_nonblocking(wake_socket, true)) {
+        net::close_socket(wake_socket);
+        wake_socket = NET_INVALID_SOCKET;
+        return false;
+    }
+
+    // WoL 发送失败不影响轮询
+    int one = 1;
+    wol_socket4 = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (wol_socket4 != NET_INVALID_SOCKET) {
+        setsockopt(wol_socket4, SOL_SOCKET, SO_BROADCAST, (const char *)&one, sizeof(one));
+        net::set_nonblocking(wol_socket4, true);
+    }
+    wol_socket6 = socket(AF_INET6, SOCK_DGRAM, IPPROTO_UDP);
+    if (wol_socket6 != NET_INVALID_SOCKET) {
+        net::set_nonblocking(wol_socket6, true);
+    }
+
+    // 主机名解析完成后唤醒 reactor，重新读取缓存
+    resolver.start([this]() { _wake(); });
+
+    running = true;
+    reactor_thread = std::thread(&HostPoller::_run, this);
+    return true;
+}
+
+void HostPoller::stop() {
+    if (!running.exchange(false)) {
+        return;
+    }
+    _wake();
+    if (reactor_thread.joinable()) {
+        reactor_thread.join();
+    }
+    resolver.stop();
+    net::close_socket(wake_socket);
+    wake_socket = NET_INVALID_SOCKET;
+    net::close_socket(wol_socket4);
+    wol_socket4 = NET_INVALID_SOCKET;
+    net::close_socket(wol_socket6);
+    wol_socket6 = NET_INVALID_SOCKET;
+}
+
+void HostPoller::set_config(const Config &p_config) {
+    {
+        std::lock_guard<std::mutex> lock(command_mutex);
+        config = p_config;
+    }
+    _wake();
+}
+
+HostPoller::Config HostPoller::get_config() {
+    std::lock_guard<std::mutex> lock(command_mutex);
+    return config;
+}
+
+void HostPoller::set_host(const std::string &host_id, const std::vector<Address> &addresses) {
+    {
+        std::lock_guard<std::mutex> lock(command_mutex);
+        commands.push_back({ Command::SET_HOST, host_id, addresses, {} });
+    }
+    _wake();
+}
+
+void HostPoller::remove_host(const std::string &host_id) {
+    {
+        std::lock_guard<std::mutex> lock(command_mutex);
+        commands.push_back({ Command::REMOVE_HOST, host_id, {}, {} });
+    }
+    _wake();
+}
+
+void HostPoller::poll_now(const std::string &host_id) {
+    {
+        std::lock_guard<std::mutex> lock(command_mutex);
+        commands.push_back({ Command::POLL_NOW, host_id, {}, {} });
+    }
+    _wake();
+}
+
+void HostPoller::wake_host(const std::string &host_id, const wol::MacAddress &mac) {
+    {
+        std::lock_guard<std::mutex> lock(command_mutex);
+        commands.push_back({ Command::WAKE, host_id, {}, mac });
+    }
+    _wake();
+}
+
+std::vector<HostPoller::Event> HostPoller::take_events() {
+    std::lock_guard<std::mutex> lock(event_mutex);
+    std::vector<Event> result;
+    result.swap(events);
+    events_pending.store(false, std::memory_order_release);
+    return result;
+}
+
+void HostPoller::_wake() {
+    if (wake_socket != NET_INVALID_SOCKET) {
+        char byte = 0;
+        sendto(wake_socket, &byte, 1, 0, (const sockaddr *)&wake_address, sizeof(sockaddr_in));
+    }
+}
+
+void HostPoller::_apply_commands(uint64_t now) {
+    std::vector<Command> pending;
+    {
+        std::lock_guard<std::mutex> lock(command_mutex);
+        pending.swap(commands);
+        active_config = config;
+    }
+
+    for (Command &command : pending) {
+        switch (command.type) {
+            case Command::SET_HOST: {
+                Host &host = hosts[command.host_id];
+                host.id = command.host_id;
+                host.addresses = command.addresses;
+                // 地址变化后重新开始一轮
+                _close_requests(host);
+                host.polling = false;
+                host.next_poll_ms = now;
+                host.backoff_ms = 0;
+            } break;
+            case Command::REMOVE_HOST: {
+                auto it = hosts.find(command.host_id);
+                if (it != hosts.end()) {
+                    _close_requests(it->second);
+                    hosts.erase(it);
+                }
+            } break;
+            case Command::POLL_NOW: {
+                for (auto &entry : hosts) {
+                    Host &host = entry.second;
+                    if ((command.host_id.empty() || host.id == command.host_id) && !host.polling) {
+                        host.next_poll_ms = now;
+                        host.backoff_ms = 0;
+                    }
+                }
+            } break;
+            case Command::WAKE: {
+                auto it = hosts.find(command.host_id);
+                if (it != hosts.end() && it->second.state != HOST_ONLINE) {
+                    _begin_wake_on_lan(it->second, command.mac, now);
+                }
+            } break;
+        }
+    }
+}
+
+void HostPoller::_run() {
+    std::vector<struct pollfd> fds;
+    std::vector<Host *> fd_hosts;
+
+    while (running.load()) {
+        uint64_t now = net::now_ms();
+        _apply_commands(now);
+
+        // 有主机名解析完成：等待解析的主机立即开始轮询，唤醒中的主机补上新解析的单播目标
+        uint64_t generation = resolver.get_generation();
+        if (generation != resolve_generation) {
+            resolve_generation = generation;
+            for (auto &entry : hosts) {
+                if (entry.second.awaiting_resolve) {
+                    entry.second.awaiting_resolve = false;
+                    entry.second.next_poll_ms = now;
+                }
+                if (entry.second.waking) {
+                    _build_wake_targets(entry.second);
+                }
+            }
+        }
+
+        for (auto &entry : hosts) {
+            Host &host = entry.second;
+            if (host.waking) {
+                _update_wake_on_lan(host, now);
+            }
+            if (!host.polling && now >= host.next_poll_ms) {
+                _begin_round(host, now);
+                continue;
+            }
+            if (!host.polling) {
+                continue;
+            }
+            _expire_attempts(host, now);
+            // 错开启动：上一个地址在 attempt_delay_ms 内没有结果就并发尝试下一个
+            if (host.polling && host.next_target < host.targets.size() && now >= host.next_attempt_ms) {
+                _start_next_attempt(host, now);
+            }
+        }
+
+        fds.clear();
+        fd_hosts.clear();
+        struct pollfd wake_fd;
+        wake_fd.fd = wake_socket;
+        wake_fd.events = POLLIN;
+        wake_fd.revents = 0;
+        fds.push_back(wake_fd);
+        fd_hosts.push_back(nullptr);
+
+        // 计算下一个需要处理的时间点
+        uint64_t next_wakeup = now + 1000;
+        for (auto &entry : hosts) {
+            Host &host = entry.second;
+            if (host.waking) {
+                next_wakeup = std::min(next_wakeup, host.wake_burst_base_ms + active_config.wake_timeout_ms);
+                if (host.wake_bursts_sent < WAKE_BURST_COUNT) {
+                    next_wakeup = std::min(next_wakeup, host.next_wake_burst_ms);
+                }
+            }
+            if (!host.polling) {
+                next_wakeup = std::min(next_wakeup, host.next_poll_ms);
+                continue;
+            }
+            if (host.next_target < host.targets.size()) {
+                next_wakeup = std::min(next_wakeup, host.next_attempt_ms);
+            }
+            for (const Request &request : host.requests) {
+                struct pollfd pfd;
+                pfd.fd = request.sock;
+                pfd.events = request.phase == Request::RECEIVING ? POLLIN : POLLOUT;
+                pfd.revents = 0;
+                fds.push_back(pfd);
+                fd_hosts.push_back(&host);
+                next_wakeup = std::min(next_wakeup, request.deadline_ms);
+            }
+        }
+
+        int timeout = next_wakeup > now ? (int)(next_wakeup - now) : 0;
+        int ready = net::poll_sockets(fds.data(), fds.size(), timeout);
+        if (ready <= 0) {
+            continue;
+        }
+
+        if (fds[0].revents & POLLIN) {
+            char drain[64];
+            while (recv(wake_socket, drain, sizeof(drain), 0) > 0) {
+            }
+        }
+
+        now = net::now_ms();
+        for (size_t i = 1; i < fds.size(); i++) {
+            if (fds[i].revents == 0) {
+                continue;
+            }
+            // 处理前面的 socket 时可能已结束本轮或关闭了其他尝试，按 socket 重新查找
+            Host &host = *fd_hosts[i];
+            for (size_t j = 0; j < host.requests.size(); j++) {
+                if (host.requests[j].sock == fds[i].fd) {
+                    _handle_io(host, j, fds[i].revents, now);
+                    break;
+                }
+            }
+        }
+    }
+
+    // 保留主机列表与状态，重新启动后继续轮询
+    for (auto &entry : hosts) {
+        _close_requests(entry.second);
+        entry.second.polling = false;
+        entry.second.next_poll_ms = 0;
+        entry.second.waking = false;
+    }
+}
+
+void HostPoller::_begin_round(Host &host, uint64_t now) {
+    if (!_build_targets(host) && host.targets.empty()) {
+        // 没有可用地址且仍有主机名在解析：解析完成后 (或超时后) 再开始本轮
+        host.awaiting_resolve = true;
+        host.next_poll_ms = now + active_config.request_timeout_ms;
+        return;
+    }
+    host.awaiting_resolve = false;
+    host.polling = true;
+    host.was_online = host.state == HOST_ONLINE;
+    host.failed_rounds = 0;
+    _advance(host, now);
+}
+
+bool HostPoller::_build_targets(Host &host) {
+    host.targets.clear();
+    host.next_target = 0;
+
+    bool all_resolved = true;
+    std::vector<Target> preferred;
+    std::vector<Target> others[2]; // IPv6, IPv4
+    int first_family = -1;
+    for (size_t i = 0; i < host.addresses.size(); i++) {
+        const Address &address = host.addresses[i];
+        // 只读取解析缓存，不阻塞 reactor 线程；尚未解析的主机名本轮跳过
+        std::vector<sockaddr_storage> resolved;
+        all_resolved = resolver.lookup(address.host, address.port, &resolved) && all_resolved;
+        if (resolved.empty()) {
+            continue;
+        }
+        bool is_preferred = address.host == host.active_address.host && address.port == host.active_address.port;
+        for (const sockaddr_storage &resolved_address : resolved) {
+            if (is_preferred) {
+                preferred.push_back({ resolved_address, i });
+                continue;
+            }
+            int family = resolved_address.ss_family == AF_INET6 ? 0 : 1;
+            if (first_family < 0) {
+                first_family = family;
+            }
+            others[family].push_back({ resolved_address, i });
+        }
+    }
+
+    // 上次成功的地址排在最前，其余按协议族交替排列 (RFC 8305)，
+    // 避免整个 IPv6 或 IPv4 不可达时依次等待该协议族的每个地址
+    host.targets = preferred;
+    if (first_family < 0) {
+        return all_resolved;
+    }
+    size_t index[2] = { 0, 0 };
+    int family = first_family;
+    while (index[0] < others[0].size() || index[1] < others[1].size()) {
+        if (index[family] < others[family].size()) {
+            host.targets.push_back(others[family][index[family]++]);
+        }
+        family = 1 - family;
+    }
+    return all_resolved;
+}
+
+bool HostPoller::_start_next_attempt(Host &host, uint64_t now) {
+    while (host.next_target < host.targets.size()) {
+        size_t target_index = host.next_target++;
+        const Target &target = host.targets[target_index];
+        int err = 0;
+        socket_t sock = net::start_connect(target.address, &err);
+        if (sock == NET_INVALID_SOCKET) {
+            continue;
+        }
+
+        const Address &address = host.addresses[target.address_index];
+        Request request;
+        request.sock = sock;
+        request.phase = Request::CONNECTING;
+        request.out = net::build_http_get(address.host, address.port,
+                build_gamestream_path("serverinfo", std::string(), active_config.unique_id));
+        int timeout_ms = host.waking ? std::min(active_config.request_timeout_ms, WAKE_REQUEST_TIMEOUT_MS) : active_config.request_timeout_ms;
+        request.deadline_ms = now + timeout_ms;
+        request.target_index = target_index;
+        host.requests.push_back(std::move(request));
+        host.next_attempt_ms = now + active_config.attempt_delay_ms;
+        return true;
+    }
+    return false;
+}
+
+void HostPoller::_advance(Host &host, uint64_t now) {
+    // 还有进行中的尝试时等待其结果或错开定时器
+    while (host.requests.empty()) {
+        if (_start_next_attempt(host, now)) {
+            return;
+        }
+
+        // 本轮所有地址都失败
+        host.failed_rounds++;
+        if (!host.was_online || host.failed_rounds >= TRIES_BEFORE_OFFLINING) {
+            break;
+        }
+        _build_targets(host);
+        if (host.targets.empty()) {
+            break;
+        }
+    }
+    if (host.requests.empty()) {
+        _finish_round(host, false, nullptr, nullptr, now);
+    }
+}
+
+void HostPoller::_fail_attempt(Host &host, size_t request_index, uint64_t now) {
+    net::close_socket(host.requests[request_index].sock);
+    host.requests.erase(host.requests.begin() + request_index);
+    // 某个地址明确失败时不必等待错开间隔，立即尝试下一个
+    if (!_start_next_attempt(host, now)) {
+        _advance(host, now);
+    }
+}
+
+void HostPoller::_expire_attempts(Host &host, uint64_t now) {
+    size_t i = 0;
+    while (host.polling && i < host.requests.size()) {
+        if (now >= host.requests[i].deadline_ms) {
+            _fail_attempt(host, i, now);
+            // 新启动的尝试追加在末尾，i 位置已是下一个元素
+            continue;
+        }
+        i++;
+    }
+}
+
+void HostPoller::_handle_io(Host &host, size_t request_index, short revents, uint64_t now) {
+    Request &request = host.requests[request_index];
+
+    if (request.phase == Request::CONNECTING) {
+        if (net::get_socket_error(request.sock) != 0 || (revents & POLLERR)) {
+            _fail_attempt(host, request_index, now);
+            return;
+        }
+        request.phase = Request::SENDING;
+    }
+
+    if (request.phase == Request::SENDING) {
+        while (request.sent < request.out.size()) {
+#ifdef MSG_NOSIGNAL
+            int n = (int)send(request.sock, request.out.data() + request.sent, request.out.size() - request.sent, MSG_NOSIGNAL);
+#else
+            int n = (int)send(request.sock, request.out.data() + request.sent, (int)(request.out.size() - request.sent), 0);
+#endif
+            if (n < 0) {
+                if (net::is_would_block(net::last_error())) {
+                    return;
+                }
+                _fail_attempt(host, request_index, now);
+                return;
+            }
+            request.sent += n;
+        }
+        request.phase = Request::RECEIVING;
+        return;
+    }
+
+    // RECEIVING
+    uint8_t buffer[8192];
+    while (true) {
+        int n = (int)recv(request.sock, (char *)buffer, sizeof(buffer), 0);
+        if (n > 0) {
+            request.in.insert(request.in.end(), buffer, buffer + n);
+            if (request.in.size() > MAX_RESPONSE_SIZE) {
+                _fail_attempt(host, request_index, now);
+                return;
+            }
+            continue;
+        }
+        if (n == 0) {
+            if (!_try_complete(host, request_index, true, now)) {
+                _fail_attempt(host, request_index, now);
+            }
+            return;
+        }
+        if (net::is_would_block(net::last_error())) {
+            _try_complete(host, request_index, false, now);
+        } else {
+            _fail_attempt(host, request_index, now);
+        }
+        return;
+    }
+}
+
+bool HostPoller::_try_complete(Host &host, size_t request_index, bool eof, uint64_t now) {
+    Request &request = host.requests[request_index];
+
+    size_t offset = 0;
+    net::HttpReadFunc read_func = [&request, &offset](uint8_t *out, size_t size) {
+        size_t count = std::min(size, request.in.size() - offset);
+        memcpy(out, request.in.data() + offset, count);
+        offset += count;
+        return (int)count;
+    };
+    net::HttpResponse response;
+    bool received_any = false;
+    // 没有 Content-Length 的响应要读到连接关闭才算完整
+    if (!net::read_http_response(read_func, &response, &received_any) || (!response.keep_alive && !eof)) {
+        return false;
+    }
+
+    ServerInfo info;
+    if (response.status_code != 200 ||
+            !parse_server_info((const char *)response.body.data(), response.body.size(), &info) ||
+            (host.has_info && info.uniqueid != host.info.uniqueid)) {
+        // 该地址上响应的是另一台主机 (例如 DHCP 地址变化)
+        _fail_attempt(host, request_index, now);
+        return true;
+    }
+
+    // 最先成功的地址胜出，取消其余尝试
+    Address address = host.addresses[host.targets[request.target_index].address_index];
+    _close_requests(host);
+    _finish_round(host, true, &info, &address, now);
+    return true;
+}
+
+void HostPoller::_finish_round(Host &host, bool success, const ServerInfo *info, const Address *address, uint64_t now) {
+    host.polling = false;
+    host.targets.clear();
+    host.next_target = 0;
+
+    bool changed = false;
+    uint64_t wake_latency_ms = 0;
+    if (success) {
+        if (host.waking) {
+            host.waking = false;
+            wake_latency_ms = std::max<uint64_t>(now - host.wake_started_ms, 1);
+        }
+        changed = wake_latency_ms > 0 || host.state != HOST_ONLINE || !host.has_info || host.info != *info ||
+                host.active_address.host != address->host || host.active_address.port != address->port;
+        host.state = HOST_ONLINE;
+        host.has_info = true;
+        host.info = *info;
+        host.active_address = *address;
+        host.backoff_ms = 0;
+        host.next_poll_ms = now + active_config.poll_interval_ms;
+    } else {
+        changed = host.state != HOST_OFFLINE;
+        host.state = HOST_OFFLINE;
+        // 离线主机逐步降低轮询频率
+        host.backoff_ms = host.backoff_ms == 0 ? active_config.poll_interval_ms : std::min(host.backoff_ms * 2, active_config.max_backoff_ms);
+        host.next_poll_ms = now + host.backoff_ms;
+        if (host.waking) {
+            // 唤醒期间不退避
+            host.backoff_ms = 0;
+            host.next_poll_ms = now + active_config.wake_probe_interval_ms;
+        }
+    }
+
+    if (changed) {
+        _push_event(host, wake_latency_ms, false);
+    }
+}
+
+void HostPoller::_close_requests(Host &host) {
+    for (Request &request : host.requests) {
+        net::close_socket(request.sock);
+    }
+    host.requests.clear();
+}
+
+void HostPoller::_begin_wake_on_lan(Host &host, const wol::MacAddress &mac, uint64_t now) {
+    // 重复唤醒时上线耗时从第一次算起，发送计划与超时从本次重新开始
+    if (!host.waking) {
+        host.wake_started_ms = now;
+    }
+    host.waking = true;
+    host.wake_burst_base_ms = now;
+    host.wake_bursts_sent = 0;
+    host.next_wake_burst_ms = now;
+    host.wake_packet = wol::build_magic_packet(mac);
+    _build_wake_targets(host);
+
+    // 放弃进行中的慢速探测，立即开始快速探测
+    _close_requests(host);
+    host.polling = false;
+    host.targets.clear();
+    host.next_target = 0;
+    host.backoff_ms = 0;
+    host.next_poll_ms = now;
+}
+
+void HostPoller::_build_wake_targets(Host &host) {
+    // 只读取解析缓存；尚未解析的主机名先只发送广播，解析完成后再补上
+    std::vector<wol::HostAddress> addresses;
+    for (const Address &address : host.addresses) {
+        wol::HostAddress wake_address;
+        wake_address.http_port = address.port;
+        resolver.lookup(address.host, 0, &wake_address.resolved);
+        addresses.push_back(std::move(wake_address));
+    }
+    host.wake_targets = wol::build_wake_targets(addresses);
+}
+
+void HostPoller::_update_wake_on_lan(Host &host, uint64_t now) {
+    if (now >= host.wake_burst_base_ms + active_config.wake_timeout_ms) {
+        host.waking = false;
+        host.wake_targets.clear();
+        _push_event(host, 0, true);
+        return;
+    }
+    if (host.wake_bursts_sent >= WAKE_BURST_COUNT || now < host.next_wake_burst_ms) {
+        return;
+    }
+
+    for (const sockaddr_storage &target : host.wake_targets) {
+        socket_t sock = target.ss_family == AF_INET6 ? wol_socket6 : wol_socket4;
+        if (sock == NET_INVALID_SOCKET) {
+            continue;
+        }
+        // 非阻塞发送，缓冲区满或目标不可达时直接跳过，下一批会再次发送
+        sendto(sock, host.wake_packet.data(), (int)host.wake_packet.size(), 0, (const sockaddr *)&target, net::address_length(target));
+    }
+    host.wake_bursts_sent++;
+    if (host.wake_bursts_sent < WAKE_BURST_COUNT) {
+        host.next_wake_burst_ms = host.wake_burst_base_ms + WAKE_BURST_OFFSETS_MS[host.wake_bursts_sent];
+    }
+}
+
+void HostPoller::_push_event(const Host &host, uint64_t wake_latency_ms, bool wake_timed_out) {
+    Event event;
+    event.host_id = host.id;
+    event.state = host.state;
+    event.has_info = host.has_info;
+    event.info = host.info;
+    event.active_address = host.active_address;
+    event.wake_latency_ms = wake_latency_ms;
+    event.wake_timed_out = wake_timed_out;
+
+    std::lock_guard<std::mutex> lock(event_mutex);
+    events.push_back(event);
+    events_pending.store(true, std::memory_order_release);
+}
@@ -0,0 +1,189 @@
+#pragma once
+
+#include "host/server_info.h"
+#include "host/wake_on_lan.h"
+#include "net/net_socket.h"
+#include "net/resolver_cache.h"
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 主机在线状态轮询引擎
+// 所有主机的 /serverinfo 请求都由同一个 reactor 线程通过非阻塞 socket + poll() 多路复用，
+// 线程数与主机数量无关 (原实现每台主机一个 PcMonitorThread，外加各自的 QNetworkAccessManager 线程)。
+// 状态变化以事件形式排队，由调用方在自己的线程中取出。
+// 一台主机的多个地址 (局域网、外网、IPv6、手动地址) 按 Happy Eyeballs (RFC 8305) 错开启动并发探测，
+// 取最先成功的地址，并在下一轮中优先尝试它；原实现逐个地址串行等待超时。
+// 主机名由 ResolverCache 在后台线程解析并缓存，reactor 线程从不调用 getaddrinfo。
+// wake_host() 在 reactor 线程中用非阻塞 UDP socket 分批发送 WoL 魔术包，同时把该主机切换为快速探测，
+// 上线时间取决于主机的启动时间而不是轮询间隔，并报告从发出唤醒包到上线的耗时。
+class HostPoller {
+public:
+    enum HostState {
+        HOST_UNKNOWN = 0,
+        HOST_ONLINE = 1,
+        HOST_OFFLINE = 2,
+    };
+
+    struct Address {
+        std::string host;
+        uint16_t port = GAMESTREAM_DEFAULT_HTTP_PORT;
+    };
+
+    struct Config {
+        uint64_t poll_interval_ms = 3000;   // 在线主机的轮询间隔
+        uint64_t max_backoff_ms = 30000;    // 离线主机的最大轮询间隔 (从 poll_interval_ms 开始翻倍)
+        int request_timeout_ms = 3000;      // 单个地址的连接 + 响应超时
+        int attempt_delay_ms = 250;         // 相邻地址的启动间隔 (RFC 8305 建议 250ms)
+        uint64_t wake_probe_interval_ms = 500; // 唤醒期间的轮询间隔
+        uint64_t wake_timeout_ms = 120000;     // 唤醒后超过此时间仍未上线则恢复正常轮询
+        std::string unique_id = GAMESTREAM_CLIENT_UNIQUE_ID;
+    };
+
+    // 只有在线状态、serverinfo 内容或响应地址发生变化时才会产生事件
+    struct Event {
+        std::string host_id;
+        HostState state = HOST_UNKNOWN;
+        bool has_info = false;
+        ServerInfo info;
+        Address active_address;
+        uint64_t wake_latency_ms = 0; // 唤醒后首次上线时为发出唤醒包到上线的耗时
+        bool wake_timed_out = false;  // 唤醒超时，其余字段与上一个事件相同
+    };
+
+    HostPoller();
+    ~HostPoller();
+
+    bool start();
+    void stop();
+    bool is_running() const { return running.load(); }
+
+    void set_config(const Config &p_config);
+    Config get_config();
+
+    // 添加主机或更新其地址列表 (按顺序错开启动，上次成功的地址总是最先尝试)
+    void set_host(const std::string &host_id, const std::vector<Address> &addresses);
+    void remove_host(const std::string &host_id);
+    // 立即轮询并清除退避，host_id 为空表示所有主机
+    void poll_now(const std::string &host_id);
+    // 发送 WoL 魔术包并快速探测直到主机上线或 wake_timeout_ms 超时；主机已在线时忽略
+    void wake_host(const std::string &host_id, const wol::MacAddress &mac);
+
+    bool has_events() const { return events_pending.load(std::memory_order_acquire); }
+    std::vector<Event> take_events();
+
+private:
+    // 连续失败多少轮后将在线主机标记为离线 (与 computermanager.cpp 一致)
+    static const int TRIES_BEFORE_OFFLINING = 2;
+
+    struct Command {
+        enum Type {
+            SET_HOST,
+            REMOVE_HOST,
+            POLL_NOW,
+            WAKE,
+        } type;
+        std::string host_id;
+        std::vector<Address> addresses;
+        wol::MacAddress mac;
+    };
+
+    struct Request {
+        enum Phase {
+            CONNECTING,
+            SENDING,
+            RECEIVING,
+        };
+        socket_t sock = NET_INVALID_SOCKET;
+        Phase phase = CONNECTING;
+        std::string out;
+        size_t sent = 0;
+        std::vector<uint8_t> in;
+        uint64_t deadline_ms = 0;
+        size_t target_index = 0; // 对应 Host::targets
+    };
+
+    struct Target {
+        sockaddr_storage address;
+        size_t address_index; // 对应 Host::addresses
+    };
+
+    struct Host {
+        std::string id;
+        std::vector<Address> addresses;
+        HostState state = HOST_UNKNOWN;
+        bool has_info = false;
+        ServerInfo info;
+        Address active_address; // 上次成功的地址，下一轮排在最前
+
+        uint64_t next_poll_ms = 0;
+        uint64_t backoff_ms = 0;
+
+        // 主机名首次解析完成后才开始轮询，避免在解析期间误报离线
+        bool awaiting_resolve = false;
+
+        // 当前一轮轮询
+        bool polling = false;
+        bool was_online = false;
+        int failed_rounds = 0;
+        std::vector<Target> targets;
+        size_t next_target = 0;
+        uint64_t next_attempt_ms = 0;
+        std::vector<Request> requests; // 并发进行中的尝试
+
+        // 唤醒
+        bool waking = false;
+        uint64_t wake_started_ms = 0;    // 第一次唤醒的时间，只用于计算上线耗时
+        uint64_t wake_burst_base_ms = 0; // 最近一次唤醒的时间，发送计划与超时从这里算起
+        size_t wake_bursts_sent = 0;
+        uint64_t next_wake_burst_ms = 0;
+        std::string wake_packet;
+        std::vector<sockaddr_storage> wake_targets;
+    };
+
+    std::thread reactor_thread;
+    std::atomic<bool> running{ false };
+    socket_t wake_socket = NET_INVALID_SOCKET;
+    sockaddr_storage wake_address;
+    // 发送 WoL 魔术包 (允许广播)
+    socket_t wol_socket4 = NET_INVALID_SOCKET;
+    socket_t wol_socket6 = NET_INVALID_SOCKET;
+
+    std::mutex command_mutex;
+    std::vector<Command> commands;
+    Config config;
+
+    std::mutex event_mutex;
+    std::vector<Event> events;
+    std::atomic<bool> events_pending{ false };
+
+    net::ResolverCache resolver;
+
+    // 以下成员只在 reactor 线程中访问
+    std::map<std::string, Host> hosts;
+    Config active_config;
+    uint64_t resolve_generation = 0;
+
+    void _wake();
+    void _run();
+    void _apply_commands(uint64_t now);
+    void _begin_round(Host &host, uint64_t now);
+    bool _build_targets(Host &host);
+    bool _start_next_attempt(Host &host, uint64_t now);
+    void _advance(Host &host, uint64_t now);
+    void _fail_attempt(Host &host, size_t request_index, uint64_t now);
+    void _expire_attempts(Host &host, uint64_t now);
+    void _handle_io(Host &host, size_t request_index, short revents, uint64_t now);
+    bool _try_complete(Host &host, size_t request_index, bool eof, uint64_t now);
+    void _finish_round(Host &host, bool success, const ServerInfo *info, const Address *address, uint64_t now);
+    void _close_requests(Host &host);
+    void _begin_wake_on_lan(Host &host, const wol::MacAddress &mac, uint64_t now);
+    void _build_wake_targets(Host &host);
+    void _update_wake_on_lan(Host &host, uint64_t now);
+    void _push_event(const Host &host, uint64_t wake_latency_ms, bool wake_timed_out);
+};
@@ -0,0 +1,506 @@
+#include "host/host_store.h"
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static uint64_t steady_ms() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+struct Crc32Table {
+    uint32_t entries[256];
+};
+
+// 编译期生成，多个线程同时计算 CRC 时无需初始化
+static constexpr Crc32Table make_crc32_table() {
+    Crc32Table table = {};
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; k++) {
+            c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+        }
+        table.entries[i] = c;
+    }
+    return table;
+}
+
+static constexpr Crc32Table CRC32_TABLE = make_crc32_table();
+
+static uint32_t crc32(const uint8_t *data, size_t length) {
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < length; i++) {
+        crc = CRC32_TABLE.entries[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+static void put_u32(std::string *r_buffer, uint32_t value) {
+    char bytes[4] = { (char)(value & 0xFF), (char)((value >> 8) & 0xFF), (char)((value >> 16) & 0xFF), (char)(value >> 24) };
+    r_buffer->append(bytes, 4);
+}
+
+static uint32_t get_u32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// --- 平台相关的文件操作 ---
+
+#ifdef _WIN32
+static std::wstring widen(const std::string &text) {
+    int length = MultiByteToWideChar(CP_UTF8, 0, text.c_str(), -1, nullptr, 0);
+    std::wstring out(length > 0 ? length - 1 : 0, L'\0');
+    if (length > 1) {
+        MultiByteToWideChar(CP_UTF8, 0, text.c_str(), -1, &out[0], length);
+    }
+    return out;
+}
+#endif
+
+// 映射整个文件并交给 parse；文件不存在时 *r_exists 为 false
+template <typename F>
+static bool map_file(const std::string &path, bool *r_exists, F parse) {
+    *r_exists = true;
+#ifdef _WIN32
+    HANDLE file = CreateFileW(widen(path).c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        *r_exists = GetLastError() != ERROR_FILE_NOT_FOUND && GetLastError() != ERROR_PATH_NOT_FOUND;
+        return false;
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size)) {
+        CloseHandle(file);
+        return false;
+    }
+    if (size.QuadPart == 0) {
+        CloseHandle(file);
+        parse((const uint8_t *)nullptr, (size_t)0);
+        return true;
+    }
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    const uint8_t *data = mapping ? (const uint8_t *)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (data) {
+        parse(data, (size_t)size.QuadPart);
+        UnmapViewOfFile(data);
+    }
+    if (mapping) {
+        CloseHandle(mapping);
+    }
+    CloseHandle(file);
+    return data != nullptr;
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        *r_exists = errno != ENOENT;
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        ::close(fd);
+        return false;
+    }
+    if (st.st_size == 0) {
+        ::close(fd);
+        parse((const uint8_t *)nullptr, (size_t)0);
+        return true;
+    }
+    void *data = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED) {
+        return false;
+    }
+    parse((const uint8_t *)data, (size_t)st.st_size);
+    munmap(data, (size_t)st.st_size);
+    return true;
+#endif
+}
+
+// 在 offset 处写入 data，截断其后的内容并落盘
+static bool write_file_at(const std::string &path, uint64_t offset, const std::string &data) {
+#ifdef _WIN32
+    HANDLE file = CreateFileW(widen(path).c_str(), GENERIC_WRITE, FILE_SHARE_READ, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER position;
+    position.QuadPart = (LONGLONG)offset;
+    bool ok = SetFilePointerEx(file, position, nullptr, FILE_BEGIN) != 0;
+    size_t written = 0;
+    while (ok && written < data.size()) {
+        DWORD n = 0;
+        ok = WriteFile(file, data.data() + written, (DWORD)(data.size() - written), &n, nullptr) != 0;
+        written += n;
+    }
+    ok = ok && SetEndOfFile(file) && FlushFileBuffers(file);
+    CloseHandle(file);
+    return ok;
+#else
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    bool ok = lseek(fd, (off_t)offset, SEEK_SET) == (off_t)offset;
+    size_t written = 0;
+    while (ok && written < data.size()) {
+        ssize_t n = ::write(fd, data.data() + written, data.size() - written);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        ok = n > 0;
+        written += ok ? (size_t)n : 0;
+    }
+    ok = ok && ftruncate(fd, (off_t)(offset + data.size())) == 0 && fsync(fd) == 0;
+    ::close(fd);
+    return ok;
+#endif
+}
+
+static bool replace_file(const std::string &from, const std::string &to) {
+#ifdef _WIN32
+    return MoveFileExW(widen(from).c_str(), widen(to).c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    if (rename(from.c_str(), to.c_str()) != 0) {
+        return false;
+    }
+    // 重命名修改的是目录项，目录落盘后断电才不会回到旧文件。
+    // 此时新文件已经就位，目录 fsync 失败不影响本次替换的结果
+    std::string::size_type slash = to.find_last_of('/');
+    std::string dir = slash == std::string::npos ? "." : (slash == 0 ? "/" : to.substr(0, slash));
+    int fd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY);
+    if (fd >= 0) {
+        fsync(fd);
+        ::close(fd);
+    }
+    return true;
+#endif
+}
+
+static void remove_file(const std::string &path) {
+#ifdef _WIN32
+    DeleteFileW(widen(path).c_str());
+#else
+    unlink(path.c_str());
+#endif
+}
+
+// --- HostStore ---
+
+HostStore::HostStore() {
+}
+
+HostStore::~HostStore() {
+    close();
+}
+
+bool HostStore::open(const std::string &p_path, std::string *r_error) {
+    close();
+
+    std::lock_guard<std::mutex> io_lock(io_mutex);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        entries.clear();
+        dirty.clear();
+        first_dirty_ms = 0;
+    }
+    path = p_path;
+    valid_size = 0;
+    stats = Stats();
+    if (!_load(r_error)) {
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = false;
+        opened = true;
+    }
+    flusher = std::thread(&HostStore::_run, this);
+    return true;
+}
+
+void HostStore::close() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!opened) {
+            return;
+        }
+        stopping = true;
+    }
+    flush_cv.notify_all();
+    if (flusher.joinable()) {
+        flusher.join();
+    }
+    flush();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    opened = false;
+    entries.clear();
+    dirty.clear();
+}
+
+bool HostStore::_load(std::string *r_error) {
+    bool exists = false;
+    bool header_ok = false;
+    std::map<std::string, std::string> loaded;
+    uint64_t end = 0;
+
+    bool mapped = map_file(path, &exists, [&](const uint8_t *data, size_t size) {
+        if (size < HEADER_SIZE || get_u32(data) != FILE_MAGIC || get_u32(data + 4) != FILE_VERSION) {
+            header_ok = size == 0;
+            return;
+        }
+        header_ok = true;
+        size_t pos = HEADER_SIZE;
+        while (pos + RECORD_HEADER_SIZE <= size) {
+            const uint8_t *record = data + pos;
+            uint8_t type = record[4];
+            uint32_t key_length = get_u32(record + 5);
+            uint32_t value_length = get_u32(record + 9);
+            uint64_t record_size = (uint64_t)RECORD_HEADER_SIZE + key_length + value_length;
+            // 崩溃时写了一半的记录：长度越界或 CRC 不符，之后的内容全部丢弃
+            if (record_size > size - pos || crc32(record + 4, (size_t)record_size - 4) != get_u32(record)) {
+                break;
+            }
+            std::string key((const char *)record + RECORD_HEADER_SIZE, key_length);
+            if (type == RECORD_PUT) {
+                loaded[key].assign((const char *)record + RECORD_HEADER_SIZE + key_length, value_length);
+            } else if (type == RECORD_DELETE) {
+                loaded.erase(key);
+            } else {
+                break;
+            }
+            pos += (size_t)record_size;
+        }
+        end = pos;
+    });
+
+    if (!mapped && exists) {
+        *r_error = "Unable to read host store " + path;
+        return false;
+    }
+    if (mapped && !header_ok) {
+        *r_error = "Not a host store: " + path;
+        return false;
+    }
+
+    if (end < HEADER_SIZE) {
+        // 新文件
+        std::string header;
+        put_u32(&header, FILE_MAGIC);
+        put_u32(&header, FILE_VERSION);
+        if (!write_file_at(path, 0, header)) {
+            *r_error = "Unable to create host store " + path;
+            return false;
+        }
+        end = HEADER_SIZE;
+    }
+
+    valid_size = end;
+    stats.file_size = end;
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.swap(loaded);
+    return true;
+}
+
+void HostStore::put(const std::string &host_id, const std::string &value) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = entries.find(host_id);
+        // 与 m_LastSerializedHosts 的作用相同：内容未变化时不写入
+        if (it != entries.end() && it->second == value) {
+            return;
+        }
+        entries[host_id] = value;
+        dirty[host_id] = false;
+        if (first_dirty_ms == 0) {
+            first_dirty_ms = steady_ms();
+        }
+    }
+    flush_cv.notify_all();
+}
+
+bool HostStore::remove(const std::string &host_id) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (entries.erase(host_id) == 0) {
+            return false;
+        }
+        dirty[host_id] = true;
+        if (first_dirty_ms == 0) {
+            first_dirty_ms = steady_ms();
+        }
+    }
+    flush_cv.notify_all();
+    return true;
+}
+
+bool HostStore::get(const std::string &host_id, std::string *r_value) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = entries.find(host_id);
+    if (it == entries.end()) {
+        return false;
+    }
+    *r_value = it->second;
+    return true;
+}
+
+std::vector<std::string> HostStore::get_host_ids() {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<std::string> ids;
+    ids.reserve(entries.size());
+    for (const auto &entry : entries) {
+        ids.push_back(entry.first);
+    }
+    return ids;
+}
+
+bool HostStore::flush() {
+    std::lock_guard<std::mutex> io_lock(io_mutex);
+    if (path.empty()) {
+        return false;
+    }
+    return _flush_locked();
+}
+
+void HostStore::set_flush_interval_ms(uint64_t p_ms) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        flush_interval_ms = p_ms;
+    }
+    flush_cv.notify_all();
+}
+
+uint64_t HostStore::get_flush_interval_ms() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return flush_interval_ms;
+}
+
+HostStore::Stats HostStore::get_stats() {
+    std::lock_guard<std::mutex> io_lock(io_mutex);
+    Stats result = stats;
+    result.live_size = _live_size_locked();
+    return result;
+}
+
+void HostStore::_run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stopping) {
+        if (dirty.empty()) {
+            flush_cv.wait(lock);
+            continue;
+        }
+        // 第一次修改后等待 flush_interval_ms，期间的修改合并为一次写入
+        uint64_t now = steady_ms();
+        uint64_t due = first_dirty_ms + flush_interval_ms;
+        if (now < due) {
+            flush_cv.wait_for(lock, std::chrono::milliseconds(due - now));
+            continue;
+        }
+        lock.unlock();
+        {
+            std::lock_guard<std::mutex> io_lock(io_mutex);
+            _flush_locked();
+        }
+        lock.lock();
+    }
+}
+
+void HostStore::_append_record(std::string *r_buffer, RecordType type, const std::string &key, const std::string &value) {
+    size_t start = r_buffer->size();
+    put_u32(r_buffer, 0); // crc 占位
+    r_buffer->push_back((char)type);
+    put_u32(r_buffer, (uint32_t)key.size());
+    put_u32(r_buffer, (uint32_t)value.size());
+    r_buffer->append(key);
+    r_buffer->append(value);
+
+    uint32_t crc = crc32((const uint8_t *)r_buffer->data() + start + 4, r_buffer->size() - start - 4);
+    std::string crc_bytes;
+    put_u32(&crc_bytes, crc);
+    r_buffer->replace(start, 4, crc_bytes);
+}
+
+uint64_t HostStore::_live_size_locked() {
+    std::lock_guard<std::mutex> lock(mutex);
+    uint64_t size = HEADER_SIZE;
+    for (const auto &entry : entries) {
+        size += RECORD_HEADER_SIZE + entry.first.size() + entry.second.size();
+    }
+    return size;
+}
+
+bool HostStore::_flush_locked() {
+    std::map<std::string, bool> pending;
+    std::string buffer;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (dirty.empty()) {
+            return true;
+        }
+        for (const auto &entry : dirty) {
+            if (entry.second) {
+                _append_record(&buffer, RECORD_DELETE, entry.first, std::string());
+            } else {
+                _append_record(&buffer, RECORD_PUT, entry.first, entries[entry.first]);
+            }
+        }
+        pending.swap(dirty);
+        first_dirty_ms = 0;
+    }
+
+    // 只追加脏主机的记录，覆盖上次崩溃可能留下的半条记录
+    if (!write_file_at(path, valid_size, buffer)) {
+        // 写入失败：重新标记，稍后重试；期间更新过的主机以新状态为准
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const auto &entry : pending) {
+            dirty.insert(entry);
+        }
+        first_dirty_ms = steady_ms();
+        return false;
+    }
+    valid_size += buffer.size();
+    stats.file_size = valid_size;
+    stats.flush_count++;
+    stats.records_written += pending.size();
+
+    uint64_t live_size = _live_size_locked();
+    if (valid_size > COMPACT_MIN_SIZE && valid_size > live_size * 2) {
+        _compact_locked();
+    }
+    return true;
+}
+
+bool HostStore::_compact_locked() {
+    std::string buffer;
+    put_u32(&buffer, FILE_MAGIC);
+    put_u32(&buffer, FILE_VERSION);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const auto &entry : entries) {
+            _append_record(&buffer, RECORD_PUT, entry.first, entry.second);
+        }
+    }
+
+    // 先完整写入并落盘临时文件，再原子替换
+    std::string temp_path = path + ".tmp";
+    if (!write_file_at(temp_path, 0, buffer) || !replace_file(temp_path, path)) {
+        remove_file(temp_path);
+        return false;
+    }
+    valid_size = buffer.size();
+    stats.file_size = valid_size;
+    stats.compaction_count++;
+    return true;
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 主机数据库 (替代 ComputerManager::saveHosts 每次重写全部主机的 QSettings 持久化)
+// 数据保存在单个日志文件中：文件头之后是一串带 CRC 的 PUT / DELETE 记录，后写入的记录覆盖先前的。
+// - 修改只标记主机为脏，后台线程按 flush_interval_ms 合并后只追加脏主机的记录；
+//   内容与已保存的完全相同时不标记。
+// - 日志中失效记录过多时在后台压缩：写入临时文件并 fsync 后原子重命名，崩溃时新旧文件总有一个完整。
+// - 追加过程中崩溃留下的半条记录在加载时通过 CRC 识别并丢弃，下次追加会覆盖它。
+// - 启动时通过 mmap 一次性读取整个文件。
+// 记录内容对本类是不透明的字节串，由调用方负责序列化。
+class HostStore {
+public:
+    struct Stats {
+        uint64_t file_size = 0;
+        uint64_t live_size = 0;     // 压缩后的文件大小
+        uint64_t flush_count = 0;
+        uint64_t compaction_count = 0;
+        uint64_t records_written = 0;
+    };
+
+    HostStore();
+    ~HostStore();
+
+    bool open(const std::string &path, std::string *r_error);
+    // 写入所有未保存的修改并停止后台线程
+    void close();
+    bool is_open() const { return opened.load(std::memory_order_acquire); }
+
+    void put(const std::string &host_id, const std::string &value);
+    bool remove(const std::string &host_id);
+    bool get(const std::string &host_id, std::string *r_value);
+    std::vector<std::string> get_host_ids();
+
+    // 立即写入未保存的修改 (阻塞)
+    bool flush();
+
+    void set_flush_interval_ms(uint64_t p_ms);
+    uint64_t get_flush_interval_ms();
+    Stats get_stats();
+
+private:
+    // 文件头：魔数 + 版本
+    static const uint32_t FILE_MAGIC = 0x53484C4D; // "MLHS"
+    static const uint32_t FILE_VERSION = 1;
+    static const size_t HEADER_SIZE = 8;
+    // 记录头：crc32 + 类型 + 键长度 + 值长度
+    static const size_t RECORD_HEADER_SIZE = 13;
+    // 文件超过此大小且失效记录占一半以上时压缩
+    static const uint64_t COMPACT_MIN_SIZE = 64 * 1024;
+
+    enum RecordType : uint8_t {
+        RECORD_PUT = 1,
+        RECORD_DELETE = 2,
+    };
+
+    std::mutex mutex; // 保护 entries、dirty 与配置
+    std::map<std::string, std::string> entries;
+    std::map<std::string, bool> dirty; // host_id -> 是否已删除
+    uint64_t first_dirty_ms = 0;
+    uint64_t flush_interval_ms = 2000;
+    std::atomic<bool> opened{ false }; // 在 mutex 内修改，is_open() 可在任意线程无锁读取
+
+    std::mutex io_mutex; // 串行化文件写入，以下成员只在持有 io_mutex 时访问
+    std::string path;
+    uint64_t valid_size = 0; // 最后一条完整记录的结尾
+    Stats stats;
+
+    std::thread flusher;
+    std::condition_variable flush_cv;
+    bool stopping = false;
+
+    bool _load(std::string *r_error);
+    void _run();
+    bool _flush_locked();
+    bool _compact_locked();
+    uint64_t _live_size_locked();
+    static void _append_record(std::string *r_buffer, RecordType type, const std::string &key, const std::string &value);
+};
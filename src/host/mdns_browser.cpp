@@ -0,0 +1,704 @@
+#include "host/mdns_browser.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+static const char SERVICE_NAME[] = "_nvstream._tcp.local";
+
+enum {
+    DNS_TYPE_A = 1,
+    DNS_TYPE_PTR = 12,
+    DNS_TYPE_TXT = 16,
+    DNS_TYPE_AAAA = 28,
+    DNS_TYPE_SRV = 33,
+    DNS_CLASS_IN = 1,
+};
+
+// 每条记录在 TTL 的这些百分比处发送刷新查询 (RFC 6762 5.2)
+static const int REFRESH_PERCENTS[] = { 80, 85, 90, 95 };
+static const int REFRESH_COUNT = sizeof(REFRESH_PERCENTS) / sizeof(REFRESH_PERCENTS[0]);
+
+// 查询中只携带剩余 TTL 超过一半的已知答案 (RFC 6762 7.1)
+static bool is_fresh_known_answer(uint64_t expires_ms, uint32_t ttl, uint64_t now) {
+    return expires_ms > now && (expires_ms - now) > (uint64_t)ttl * 500;
+}
+
+// 单个查询包的上限：以太网 MTU 1500 减去 IPv6 与 UDP 头，避免 IP 分片。
+// 已知答案超出时拆成多个包 (RFC 6762 7.2)
+static const size_t MAX_QUERY_SIZE = 1500 - 40 - 8;
+static const size_t DNS_HEADER_SIZE = 12;
+static const uint16_t DNS_FLAG_TC = 0x0200;
+
+
+// "MyPC._nvstream._tcp.local" -> "MyPC"
+static std::string instance_label(const std::string &instance) {
+    size_t suffix_len = sizeof(SERVICE_NAME) - 1;
+    if (instance.size() > suffix_len + 1 && instance[instance.size() - suffix_len - 1] == '.') {
+        return instance.substr(0, instance.size() - suffix_len - 1);
+    }
+    return instance;
+}
+
+static std::string to_lower(std::string str) {
+    std::transform(str.begin(), str.end(), str.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+    return str;
+}
+
+// --- DNS 报文编码 ---
+
+static void write_u16(std::vector<uint8_t> &out, uint16_t value) {
+    out.push_back((uint8_t)(value >> 8));
+    out.push_back((uint8_t)(value & 0xFF));
+}
+
+static void write_u32(std::vector<uint8_t> &out, uint32_t value) {
+    write_u16(out, (uint16_t)(value >> 16));
+    write_u16(out, (uint16_t)(value & 0xFFFF));
+}
+
+static void write_name(std::vector<uint8_t> &out, const std::string &name) {
+    size_t begin = 0;
+    while (begin < name.size()) {
+        size_t end = name.find('.', begin);
+        if (end == std::string::npos) {
+            end = name.size();
+        }
+        size_t len = std::min<size_t>(end - begin, 63);
+        out.push_back((uint8_t)len);
+        out.insert(out.end(), name.begin() + begin, name.begin() + begin + len);
+        begin = end + 1;
+    }
+    out.push_back(0);
+}
+
+// --- DNS 报文解析 ---
+
+static bool read_u16(const uint8_t *data, size_t length, size_t offset, uint16_t *r_value) {
+    if (offset + 2 > length) {
+        return false;
+    }
+    *r_value = (uint16_t)((data[offset] << 8) | data[offset + 1]);
+    return true;
+}
+
+// 读取可能带压缩指针的域名，r_next 为名字之后的偏移
+static bool read_name(const uint8_t *data, size_t length, size_t offset, std::string *r_name, size_t *r_next) {
+    std::string name;
+    bool jumped = false;
+    int jumps = 0;
+    while (true) {
+        if (offset >= length) {
+            return false;
+        }
+        uint8_t len = data[offset];
+        if (len == 0) {
+            if (!jumped) {
+                *r_next = offset + 1;
+            }
+            break;
+        }
+        if ((len & 0xC0) == 0xC0) {
+            if (offset + 1 >= length || ++jumps > 16) {
+                return false;
+            }
+            if (!jumped) {
+                *r_next = offset + 2;
+            }
+            offset = ((len & 0x3F) << 8) | data[offset + 1];
+            jumped = true;
+            continue;
+        }
+        if ((len & 0xC0) != 0 || offset + 1 + len > length) {
+            return false;
+        }
+        if (!name.empty()) {
+            name += '.';
+        }
+        name.append((const char *)data + offset + 1, len);
+        offset += 1 + len;
+    }
+    *r_name = name;
+    return true;
+}
+
+bool MdnsBrowser::_parse_packet(const uint8_t *data, size_t length, std::vector<ParsedRecord> *r_records) {
+    uint16_t flags, qdcount, ancount, nscount, arcount;
+    if (!read_u16(data, length, 2, &flags) || !read_u16(data, length, 4, &qdcount) ||
+            !read_u16(data, length, 6, &ancount) || !read_u16(data, length, 8, &nscount) ||
+            !read_u16(data, length, 10, &arcount)) {
+        return false;
+    }
+    // 只处理响应 (QR 位)
+    if ((flags & 0x8000) == 0) {
+        return false;
+    }
+
+    size_t offset = 12;
+    for (int i = 0; i < qdcount; i++) {
+        std::string name;
+        if (!read_name(data, length, offset, &name, &offset)) {
+            return false;
+        }
+        offset += 4;
+    }
+
+    int record_count = ancount + nscount + arcount;
+    for (int i = 0; i < record_count; i++) {
+        ParsedRecord record;
+        uint16_t rrclass, rdlength, ttl_hi, ttl_lo;
+        if (!read_name(data, length, offset, &record.name, &offset) ||
+                !read_u16(data, length, offset, &record.type) ||
+                !read_u16(data, length, offset + 2, &rrclass) ||
+                !read_u16(data, length, offset + 4, &ttl_hi) ||
+                !read_u16(data, length, offset + 6, &ttl_lo) ||
+                !read_u16(data, length, offset + 8, &rdlength)) {
+            return false;
+        }
+        offset += 10;
+        if (offset + rdlength > length) {
+            return false;
+        }
+        record.cache_flush = (rrclass & 0x8000) != 0;
+        record.ttl = ((uint32_t)ttl_hi << 16) | ttl_lo;
+
+        bool valid = (rrclass & 0x7FFF) == DNS_CLASS_IN;
+        if (valid) {
+            size_t next;
+            switch (record.type) {
+                case DNS_TYPE_PTR:
+                    valid = read_name(data, length, offset, &record.ptr_target, &next);
+                    break;
+                case DNS_TYPE_SRV:
+                    valid = rdlength >= 7 && read_u16(data, length, offset + 4, &record.srv_port) &&
+                            read_name(data, length, offset + 6, &record.srv_target, &next);
+                    break;
+                case DNS_TYPE_A:
+                case DNS_TYPE_AAAA: {
+                    char text[INET6_ADDRSTRLEN] = {};
+                    if (record.type == DNS_TYPE_A && rdlength == 4) {
+                        valid = inet_ntop(AF_INET, (void *)(data + offset), text, sizeof(text)) != nullptr;
+                    } else if (record.type == DNS_TYPE_AAAA && rdlength == 16) {
+                        // 链路本地地址 (fe80::/10) 缺少作用域 ID 无法直接连接，忽略
+                        bool link_local = data[offset] == 0xFE && (data[offset + 1] & 0xC0) == 0x80;
+                        valid = !link_local && inet_ntop(AF_INET6, (void *)(data + offset), text, sizeof(text)) != nullptr;
+                    } else {
+                        valid = false;
+                    }
+                    record.address = text;
+                } break;
+                default:
+                    valid = false;
+                    break;
+            }
+        }
+        if (valid) {
+            r_records->push_back(record);
+        }
+        offset += rdlength;
+    }
+    return true;
+}
+
+// --- MdnsBrowser ---
+
+void MdnsBrowser::Expiry::renew(uint32_t p_ttl, uint64_t now) {
+    // TTL 为 0 表示记录失效 (goodbye)，保留 1 秒后过期 (RFC 6762 10.1)
+    expires_ms = now + (p_ttl == 0 ? 1000 : (uint64_t)p_ttl * 1000);
+    ttl = p_ttl;
+    refreshes_sent = 0;
+}
+
+uint64_t MdnsBrowser::Expiry::refresh_due_ms() const {
+    if (ttl == 0 || refreshes_sent >= REFRESH_COUNT) {
+        return UINT64_MAX;
+    }
+    uint64_t ttl_ms = (uint64_t)ttl * 1000;
+    return expires_ms - ttl_ms + ttl_ms * REFRESH_PERCENTS[refreshes_sent] / 100;
+}
+
+bool MdnsBrowser::Expiry::take_due_refresh(uint64_t now) {
+    bool due = false;
+    while (refresh_due_ms() <= now) {
+        refreshes_sent++;
+        due = true;
+    }
+    return due;
+}
+
+MdnsBrowser::MdnsBrowser() {
+}
+
+MdnsBrowser::~MdnsBrowser() {
+    stop();
+}
+
+socket_t MdnsBrowser::_open_socket(int family) {
+    socket_t sock = socket(family, SOCK_DGRAM, IPPROTO_UDP);
+    if (sock == NET_INVALID_SOCKET) {
+        return NET_INVALID_SOCKET;
+    }
+
+    // 与系统的 mDNS 响应器 (Avahi、Bonjour) 共享 5353 端口
+    int one = 1;
+    setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, (const char *)&one, sizeof(one));
+#ifdef SO_REUSEPORT
+    setsockopt(sock, SOL_SOCKET, SO_REUSEPORT, (const char *)&one, sizeof(one));
+#endif
+
+    sockaddr_storage bind_address;
+    memset(&bind_address, 0, sizeof(bind_address));
+    bool joined;
+    if (family == AF_INET) {
+        sockaddr_in *addr = (sockaddr_in *)&bind_address;
+        addr->sin_family = AF_INET;
+        addr->sin_addr.s_addr = htonl(INADDR_ANY);
+        addr->sin_port = htons(config.port);
+        if (bind(sock, (const sockaddr *)addr, sizeof(sockaddr_in)) != 0) {
+            // 端口被独占时退回临时端口，响应器会以单播回复 (legacy unicast)
+            addr->sin_port = 0;
+            bind(sock, (const sockaddr *)addr, sizeof(sockaddr_in));
+        }
+
+        struct ip_mreq mreq;
+        inet_pton(AF_INET, "224.0.0.251", &mreq.imr_multiaddr);
+        mreq.imr_interface.s_addr = htonl(INADDR_ANY);
+        joined = setsockopt(sock, IPPROTO_IP, IP_ADD_MEMBERSHIP, (const char *)&mreq, sizeof(mreq)) == 0;
+        unsigned char ttl = 255;
+        setsockopt(sock, IPPROTO_IP, IP_MULTICAST_TTL, (const char *)&ttl, sizeof(ttl));
+        unsigned char loop = 1;
+        setsockopt(sock, IPPROTO_IP, IP_MULTICAST_LOOP, (const char *)&loop, sizeof(loop));
+    } else {
+        setsockopt(sock, IPPROTO_IPV6, IPV6_V6ONLY, (const char *)&one, sizeof(one));
+        sockaddr_in6 *addr = (sockaddr_in6 *)&bind_address;
+        addr->sin6_family = AF_INET6;
+        addr->sin6_addr = in6addr_any;
+        addr->sin6_port = htons(config.port);
+        if (bind(sock, (const sockaddr *)addr, sizeof(sockaddr_in6)) != 0) {
+            addr->sin6_port = 0;
+            bind(sock, (const sockaddr *)addr, sizeof(sockaddr_in6));
+        }
+
+        struct ipv6_mreq mreq;
+        inet_pton(AF_INET6, "ff02::fb", &mreq.ipv6mr_multiaddr);
+        mreq.ipv6mr_interface = 0;
+        joined = setsockopt(sock, IPPROTO_IPV6, IPV6_JOIN_GROUP, (const char *)&mreq, sizeof(mreq)) == 0;
+        int hops = 255;
+        setsockopt(sock, IPPROTO_IPV6, IPV6_MULTICAST_HOPS, (const char *)&hops, sizeof(hops));
+        unsigned int loop = 1;
+        setsockopt(sock, IPPROTO_IPV6, IPV6_MULTICAST_LOOP, (const char *)&loop, sizeof(loop));
+    }
+
+    if (!joined || !net::set_nonblocking(sock, true)) {
+        net::close_socket(sock);
+        return NET_INVALID_SOCKET;
+    }
+    return sock;
+}
+
+bool MdnsBrowser::start(const Config &p_config) {
+    if (running.load()) {
+        return true;
+    }
+    net::startup();
+    config = p_config;
+
+    socket_v4 = config.use_ipv4 ? _open_socket(AF_INET) : NET_INVALID_SOCKET;
+    socket_v6 = config.use_ipv6 ? _open_socket(AF_INET6) : NET_INVALID_SOCKET;
+    if (socket_v4 == NET_INVALID_SOCKET && socket_v6 == NET_INVALID_SOCKET) {
+        return false;
+    }
+
+    services.clear();
+    addresses.clear();
+    reported.clear();
+    running = true;
+    browser_thread = std::thread(&MdnsBrowser::_run, this);
+    return true;
+}
+
+void MdnsBrowser::stop() {
+    if (!running.exchange(false)) {
+        return;
+    }
+    if (browser_thread.joinable()) {
+        browser_thread.join();
+    }
+    net::close_socket(socket_v4);
+    net::close_socket(socket_v6);
+    socket_v4 = NET_INVALID_SOCKET;
+    socket_v6 = NET_INVALID_SOCKET;
+
+    // 未取走的事件属于本次浏览，不能在下次 start() 后再报告
+    std::lock_guard<std::mutex> lock(event_mutex);
+    events.clear();
+    events_pending.store(false, std::memory_order_release);
+}
+
+void MdnsBrowser::query_now() {
+    query_requested = true;
+}
+
+std::vector<MdnsBrowser::Event> MdnsBrowser::take_events() {
+    std::lock_guard<std::mutex> lock(event_mutex);
+    std::vector<Event> result;
+    result.swap(events);
+    events_pending.store(false, std::memory_order_release);
+    return result;
+}
+
+void MdnsBrowser::_push_event(Event::Type type, const std::string &instance, const std::string &hostname, const std::string &address, uint16_t port) {
+    Event event;
+    event.type = type;
+    event.instance = instance_label(instance);
+    event.hostname = hostname;
+    event.address = address;
+    event.port = port;
+
+    std::lock_guard<std::mutex> lock(event_mutex);
+    events.push_back(event);
+    events_pending.store(true, std::memory_order_release);
+}
+
+void MdnsBrowser::_run() {
+    uint64_t query_interval = config.initial_query_interval_ms;
+    uint64_t next_query_ms = 0;
+    uint8_t buffer[9000];
+
+    while (running.load()) {
+        uint64_t now = net::now_ms();
+        if (query_requested.exchange(false)) {
+            query_interval = config.initial_query_interval_ms;
+            next_query_ms = now;
+        }
+        if (now >= next_query_ms) {
+            _send_query(now, true);
+            next_query_ms = now + query_interval;
+            query_interval = std::min(query_interval * 2, config.max_query_interval_ms);
+        } else if (now >= _next_refresh_ms()) {
+            _send_query(now, false);
+        }
+
+        struct pollfd fds[2];
+        size_t count = 0;
+        for (socket_t sock : { socket_v4, socket_v6 }) {
+            if (sock != NET_INVALID_SOCKET) {
+                fds[count].fd = sock;
+                fds[count].events = POLLIN;
+                fds[count].revents = 0;
+                count++;
+            }
+        }
+
+        // 限制等待时间，以便及时响应 stop() 与 query_now()
+        uint64_t next_wakeup = std::min(next_query_ms, _next_refresh_ms());
+        int timeout = next_wakeup > now ? (int)std::min<uint64_t>(next_wakeup - now, 200) : 0;
+        if (net::poll_sockets(fds, count, timeout) > 0) {
+            for (size_t i = 0; i < count; i++) {
+                if ((fds[i].revents & POLLIN) == 0) {
+                    continue;
+                }
+                while (true) {
+                    int n = (int)recv(fds[i].fd, (char *)buffer, sizeof(buffer), 0);
+                    if (n <= 0) {
+                        break;
+                    }
+                    _handle_packet(buffer, n, net::now_ms());
+                }
+            }
+        }
+
+        _expire(net::now_ms());
+    }
+}
+
+bool MdnsBrowser::_is_resolved(const ServiceRecord &service) const {
+    if (!service.has_srv) {
+        return false;
+    }
+    auto it = addresses.find(service.target);
+    return it != addresses.end() && !it->second.empty();
+}
+
+uint64_t MdnsBrowser::_next_refresh_ms() const {
+    uint64_t next = UINT64_MAX;
+    for (auto &entry : services) {
+        const ServiceRecord &service = entry.second;
+        next = std::min(next, service.ptr.refresh_due_ms());
+        if (service.has_srv) {
+            next = std::min(next, service.srv.refresh_due_ms());
+        }
+        if (!_is_resolved(service)) {
+            next = std::min(next, service.next_resolve_ms);
+        }
+    }
+    for (auto &host : addresses) {
+        for (auto &address : host.second) {
+            next = std::min(next, address.second.refresh_due_ms());
+        }
+    }
+    return next;
+}
+
+void MdnsBrowser::_send_query(uint64_t now, bool browse) {
+    std::vector<Question> questions;
+    auto add_question = [&questions](const std::string &name, uint16_t type) {
+        for (const Question &question : questions) {
+            if (question.type == type && question.name == name) {
+                return;
+            }
+        }
+        questions.push_back({ name, type });
+    };
+
+    bool query_ptr = browse;
+    for (auto &entry : services) {
+        query_ptr = entry.second.ptr.take_due_refresh(now) || query_ptr;
+    }
+    if (query_ptr) {
+        add_question(SERVICE_NAME, DNS_TYPE_PTR);
+    }
+
+    for (auto &entry : services) {
+        ServiceRecord &service = entry.second;
+        if (!_is_resolved(service)) {
+            if (now >= service.next_resolve_ms) {
+                if (!service.has_srv) {
+                    // 响应器只回复了 PTR：单独询问 SRV 与 TXT
+                    add_question(service.name, DNS_TYPE_SRV);
+                    add_question(service.name, DNS_TYPE_TXT);
+                } else {
+                    // 已有 SRV 但还没有地址的主机，同时查询 A 与 AAAA
+                    add_question(service.target, DNS_TYPE_A);
+                    add_question(service.target, DNS_TYPE_AAAA);
+                }
+                service.resolve_interval_ms = service.resolve_interval_ms == 0 ? config.initial_query_interval_ms
+                                                                               : std::min(service.resolve_interval_ms * 2, config.max_query_interval_ms);
+                service.next_resolve_ms = now + service.resolve_interval_ms;
+            }
+        } else {
+            service.resolve_interval_ms = 0;
+            service.next_resolve_ms = 0;
+        }
+        if (service.has_srv && service.srv.take_due_refresh(now)) {
+            add_question(service.name, DNS_TYPE_SRV);
+            add_question(service.name, DNS_TYPE_TXT);
+        }
+    }
+
+    for (auto &host : addresses) {
+        bool due = false;
+        for (auto &address : host.second) {
+            due = address.second.take_due_refresh(now) || due;
+        }
+        if (due) {
+            add_question(host.first, DNS_TYPE_A);
+            add_question(host.first, DNS_TYPE_AAAA);
+        }
+    }
+
+    if (questions.empty()) {
+        return;
+    }
+
+    // 已知答案：剩余 TTL 超过一半的 PTR 记录。还缺少 SRV 或地址的实例不列入，
+    // 否则响应器不会再回复它，实例一旦丢失 SRV 就要等到 PTR 过期才能重新发现
+    std::vector<std::pair<std::string, uint32_t>> known_answers;
+    if (query_ptr) {
+        for (auto &entry : services) {
+            const ServiceRecord &service = entry.second;
+            const Expiry &ptr = service.ptr;
+            if (ptr.ttl > 0 && is_fresh_known_answer(ptr.expires_ms, ptr.ttl, now) && _is_resolved(service)) {
+                known_answers.push_back({ service.name, (uint32_t)((ptr.expires_ms - now) / 1000) });
+            }
+        }
+    }
+
+    // 第一个包携带全部问题与放得下的已知答案，其余已知答案放在只含答案的后续包中；
+    // 除最后一个包外都设置 TC 位，响应器据此等待后续包再回答
+    std::vector<uint8_t> packet;
+    size_t next_answer = 0;
+    do {
+        bool first = packet.empty();
+        packet.clear();
+        // Header
+        write_u16(packet, 0); // ID
+        write_u16(packet, 0); // 标准查询，TC 位在下面填写
+        write_u16(packet, first ? (uint16_t)questions.size() : 0);
+        write_u16(packet, 0); // 已知答案数，在下面填写
+        write_u16(packet, 0);
+        write_u16(packet, 0);
+
+        if (first) {
+            for (const Question &question : questions) {
+                write_name(packet, question.name);
+                write_u16(packet, question.type);
+                write_u16(packet, DNS_CLASS_IN);
+            }
+        }
+
+        uint16_t answer_count = 0;
+        for (; next_answer < known_answers.size(); next_answer++) {
+            const auto &answer = known_answers[next_answer];
+            size_t record_start = packet.size();
+            std::vector<uint8_t> rdata;
+            write_name(rdata, answer.first);
+            write_name(packet, SERVICE_NAME);
+            write_u16(packet, DNS_TYPE_PTR);
+            write_u16(packet, DNS_CLASS_IN);
+            write_u32(packet, answer.second);
+            write_u16(packet, (uint16_t)rdata.size());
+            packet.insert(packet.end(), rdata.begin(), rdata.end());
+            // 包中至少保留一条内容，保证每个包都有进展
+            if (packet.size() > MAX_QUERY_SIZE && record_start > DNS_HEADER_SIZE) {
+                packet.resize(record_start);
+                break;
+            }
+            answer_count++;
+        }
+
+        uint16_t flags = next_answer < known_answers.size() ? DNS_FLAG_TC : 0;
+        packet[2] = (uint8_t)(flags >> 8);
+        packet[3] = (uint8_t)(flags & 0xFF);
+        packet[6] = (uint8_t)(answer_count >> 8);
+        packet[7] = (uint8_t)(answer_count & 0xFF);
+        _send_packet(packet);
+    } while (next_answer < known_answers.size());
+}
+
+void MdnsBrowser::_send_packet(const std::vector<uint8_t> &packet) {
+    if (socket_v4 != NET_INVALID_SOCKET) {
+        sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(config.port);
+        inet_pton(AF_INET, "224.0.0.251", &addr.sin_addr);
+        sendto(socket_v4, (const char *)packet.data(), (int)packet.size(), 0, (const sockaddr *)&addr, sizeof(addr));
+    }
+    if (socket_v6 != NET_INVALID_SOCKET) {
+        sockaddr_in6 addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin6_family = AF_INET6;
+        addr.sin6_port = htons(config.port);
+        inet_pton(AF_INET6, "ff02::fb", &addr.sin6_addr);
+        sendto(socket_v6, (const char *)packet.data(), (int)packet.size(), 0, (const sockaddr *)&addr, sizeof(addr));
+    }
+}
+
+void MdnsBrowser::_handle_packet(const uint8_t *data, size_t length, uint64_t now) {
+    std::vector<ParsedRecord> records;
+    if (!_parse_packet(data, length, &records)) {
+        return;
+    }
+
+    std::string service_lower = to_lower(SERVICE_NAME);
+    std::set<std::string> flushed;
+    for (const ParsedRecord &record : records) {
+        switch (record.type) {
+            case DNS_TYPE_PTR: {
+                if (to_lower(record.name) != service_lower) {
+                    break;
+                }
+                ServiceRecord &service = services[to_lower(record.ptr_target)];
+                if (service.name.empty()) {
+                    service.name = record.ptr_target;
+                }
+                service.ptr.renew(record.ttl, now);
+            } break;
+            case DNS_TYPE_SRV: {
+                ServiceRecord &service = services[to_lower(record.name)];
+                if (service.name.empty()) {
+                    service.name = record.name;
+                }
+                service.has_srv = true;
+                service.srv.renew(record.ttl, now);
+                service.target = to_lower(record.srv_target);
+                service.port = record.srv_port;
+                // 只收到 SRV 没有 PTR 时，让实例跟随 SRV 的生命周期
+                if (service.ptr.expires_ms == 0) {
+                    service.ptr = service.srv;
+                }
+            } break;
+            case DNS_TYPE_A:
+            case DNS_TYPE_AAAA: {
+                std::string host = to_lower(record.name);
+                std::map<std::string, Expiry> &host_addresses = addresses[host];
+                // cache-flush 位：同名的其他旧记录在 1 秒后过期 (RFC 6762 10.2)
+                if (record.cache_flush && flushed.insert(host + "/" + std::to_string(record.type)).second) {
+                    bool v6 = record.type == DNS_TYPE_AAAA;
+                    for (auto &entry : host_addresses) {
+                        bool entry_v6 = entry.first.find(':') != std::string::npos;
+                        if (entry_v6 == v6 && entry.first != record.address) {
+                            entry.second.expires_ms = std::min(entry.second.expires_ms, now + 1000);
+                        }
+                    }
+                }
+                host_addresses[record.address].renew(record.ttl, now);
+            } break;
+        }
+    }
+
+    _update_reported();
+}
+
+void MdnsBrowser::_expire(uint64_t now) {
+    bool changed = false;
+    for (auto it = services.begin(); it != services.end();) {
+        ServiceRecord &service = it->second;
+        if (service.has_srv && service.srv.expires_ms <= now) {
+            service.has_srv = false;
+            changed = true;
+        }
+        if (service.ptr.expires_ms <= now) {
+            it = services.erase(it);
+            changed = true;
+        } else {
+            ++it;
+        }
+    }
+    for (auto host = addresses.begin(); host != addresses.end();) {
+        for (auto it = host->second.begin(); it != host->second.end();) {
+            if (it->second.expires_ms <= now) {
+                it = host->second.erase(it);
+                changed = true;
+            } else {
+                ++it;
+            }
+        }
+        host = host->second.empty() ? addresses.erase(host) : std::next(host);
+    }
+
+    if (changed) {
+        _update_reported();
+    }
+}
+
+void MdnsBrowser::_update_reported() {
+    std::set<std::pair<std::string, std::string>> current;
+    for (auto &entry : services) {
+        const ServiceRecord &service = entry.second;
+        if (!service.has_srv) {
+            continue;
+        }
+        auto host = addresses.find(service.target);
+        if (host == addresses.end()) {
+            continue;
+        }
+        for (auto &address : host->second) {
+            std::pair<std::string, std::string> key(entry.first, address.first);
+            current.insert(key);
+            if (reported.emplace(key, service.name).second) {
+                _push_event(Event::FOUND, service.name, service.target, address.first, service.port);
+            }
+        }
+    }
+
+    for (auto it = reported.begin(); it != reported.end();) {
+        if (current.count(it->first) == 0) {
+            _push_event(Event::LOST, it->second, std::string(), it->first.second, 0);
+            it = reported.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
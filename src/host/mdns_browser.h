@@ -0,0 +1,130 @@
+#pragma once
+
+#include "net/net_socket.h"
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+// _nvstream._tcp 服务的 mDNS 浏览/解析器
+// IPv4 (224.0.0.251) 与 IPv6 (ff02::fb) 两个 socket 同时发送查询并接收响应，
+// 缓存按记录 TTL 过期，查询中携带已知答案 (RFC 6762 7.1) 以抑制重复响应。
+// 每条缓存记录在 TTL 的 80%/85%/90%/95% 时重新查询 (RFC 6762 5.2)，在线主机的记录不会过期；
+// 只有 PTR 没有 SRV 的实例单独查询 SRV/TXT，没有地址的主机单独查询 A/AAAA，
+// 这些实例的 PTR 不作为已知答案，以免响应器因此不再发送完整的记录。
+// 同一个响应包中的 PTR/SRV/A/AAAA 记录一起处理，每得到一个新的地址就立即产生 FOUND 事件，
+// 不需要等待整个解析过程完成。DNS 名称不区分大小写。
+class MdnsBrowser {
+public:
+    struct Config {
+        uint16_t port = 5353;               // 测试时可改为其他端口
+        uint64_t initial_query_interval_ms = 1000;
+        uint64_t max_query_interval_ms = 60000; // 查询间隔从 1 秒开始翻倍
+        bool use_ipv4 = true;
+        bool use_ipv6 = true;
+    };
+
+    struct Event {
+        enum Type {
+            FOUND,
+            LOST,
+        } type;
+        std::string instance; // 服务实例名 (通常为主机名)
+        std::string hostname; // SRV 目标主机名
+        std::string address;
+        uint16_t port = 0;
+    };
+
+    MdnsBrowser();
+    ~MdnsBrowser();
+
+    bool start(const Config &p_config);
+    void stop();
+    bool is_running() const { return running.load(); }
+
+    // 立即重新发送查询，并重置查询间隔
+    void query_now();
+
+    bool has_events() const { return events_pending.load(std::memory_order_acquire); }
+    std::vector<Event> take_events();
+
+private:
+    struct Expiry {
+        uint64_t expires_ms = 0;
+        uint32_t ttl = 0;
+        int refreshes_sent = 0; // 本次 TTL 内已发送的刷新查询数
+
+        void renew(uint32_t p_ttl, uint64_t now);
+        // 下一次刷新查询的时间；goodbye 记录或已发送完所有刷新时为 UINT64_MAX
+        uint64_t refresh_due_ms() const;
+        // 跳过所有已到期的刷新点 (线程可能错过了其中几个)，返回是否有到期的刷新
+        bool take_due_refresh(uint64_t now);
+    };
+
+    struct ServiceRecord {
+        std::string name; // 实例名 (原始大小写，用于事件)
+        Expiry ptr;
+        bool has_srv = false;
+        Expiry srv;
+        std::string target; // 小写
+        uint16_t port = 0;
+        // 缺少 SRV 或地址时的单独查询，间隔从 initial_query_interval_ms 开始翻倍
+        uint64_t next_resolve_ms = 0;
+        uint64_t resolve_interval_ms = 0;
+    };
+
+    struct Question {
+        std::string name;
+        uint16_t type;
+    };
+
+    struct ParsedRecord {
+        std::string name;
+        uint16_t type = 0;
+        bool cache_flush = false;
+        uint32_t ttl = 0;
+        std::string ptr_target;
+        std::string srv_target;
+        uint16_t srv_port = 0;
+        std::string address;
+    };
+
+    Config config;
+    std::thread browser_thread;
+    std::atomic<bool> running{ false };
+    std::atomic<bool> query_requested{ false };
+    socket_t socket_v4 = NET_INVALID_SOCKET;
+    socket_t socket_v6 = NET_INVALID_SOCKET;
+
+    std::mutex event_mutex;
+    std::vector<Event> events;
+    std::atomic<bool> events_pending{ false };
+
+    // 以下成员只在浏览线程中访问
+    // 实例名 (小写) -> 记录
+    std::map<std::string, ServiceRecord> services;
+    // 主机名 (小写) -> 地址 -> 过期时间
+    std::map<std::string, std::map<std::string, Expiry>> addresses;
+    // 已报告的 (实例名 (小写), 地址) -> 报告时使用的实例名
+    std::map<std::pair<std::string, std::string>, std::string> reported;
+
+    socket_t _open_socket(int family);
+    void _run();
+    bool _is_resolved(const ServiceRecord &service) const;
+    // 下一次需要发送刷新或解析查询的时间
+    uint64_t _next_refresh_ms() const;
+    // browse 为 true 时总是包含 PTR 问题 (周期性浏览)，否则只发送到期的刷新/解析问题
+    void _send_query(uint64_t now, bool browse);
+    void _send_packet(const std::vector<uint8_t> &packet);
+    void _handle_packet(const uint8_t *data, size_t length, uint64_t now);
+    void _expire(uint64_t now);
+    void _update_reported();
+    void _push_event(Event::Type type, const std::string &instance, const std::string &hostname, const std::string &address, uint16_t port);
+
+    static bool _parse_packet(const uint8_t *data, size_t length, std::vector<ParsedRecord> *r_records);
+};
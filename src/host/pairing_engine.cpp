@@ -0,0 +1,542 @@
+#include "host/pairing_engine.h"
+
+#include "host/xml_pull_parser.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <random>
+
+#ifdef MOONLIGHT_USE_MBEDTLS
+
+// 与 nvpairingmanager.cpp 一致
+static const int REQUEST_TIMEOUT_MS = 5000;
+// 第一阶段要等用户在主机上输入 PIN (原实现不设超时)，可通过 cancel() 提前结束
+static const int PIN_ENTRY_TIMEOUT_MS = 10 * 60 * 1000;
+static const char DEVICE_NAME[] = "roth";
+
+// 配对响应中用到的字段
+struct PairResponse {
+    int status_code = 0;
+    std::string status_message;
+    bool paired = false;
+    std::string plaincert;
+    std::string challengeresponse;
+    std::string pairingsecret;
+};
+
+static bool parse_pair_response(const char *data, size_t length, PairResponse *r_response) {
+    XmlPullParser parser(data, length);
+    bool has_root = false;
+    std::string_view element;
+
+    while (true) {
+        XmlPullParser::Token token = parser.next();
+        if (token == XmlPullParser::END_DOCUMENT) {
+            break;
+        }
+        if (token == XmlPullParser::ERROR) {
+            return false;
+        }
+
+        if (token == XmlPullParser::START_ELEMENT) {
+            if (parser.depth() == 1) {
+                std::string_view value;
+                if (parser.name() != "root") {
+                    return false;
+                }
+                if (parser.get_attribute("status_code", &value)) {
+                    r_response->status_code = XmlPullParser::to_int(value);
+                }
+                if (parser.get_attribute("status_message", &value) && !XmlPullParser::decode_text(value, &r_response->status_message)) {
+                    return false;
+                }
+                has_root = true;
+            }
+            element = parser.name();
+            continue;
+        }
+        if (token == XmlPullParser::END_ELEMENT) {
+            element = std::string_view();
+            continue;
+        }
+
+        // TEXT：十六进制字段不含实体，直接拷贝
+        std::string_view text = parser.text();
+        if (element == "paired") {
+            r_response->paired = XmlPullParser::to_int(text) == 1;
+        } else if (element == "plaincert") {
+            r_response->plaincert.assign(text.data(), text.size());
+        } else if (element == "challengeresponse") {
+            r_response->challengeresponse.assign(text.data(), text.size());
+        } else if (element == "pairingsecret") {
+            r_response->pairingsecret.assign(text.data(), text.size());
+        }
+    }
+    return has_root;
+}
+
+static std::string to_hex(const uint8_t *data, size_t length) {
+    static const char hex[] = "0123456789abcdef";
+    std::string out;
+    out.reserve(length * 2);
+    for (size_t i = 0; i < length; i++) {
+        out += hex[data[i] >> 4];
+        out += hex[data[i] & 0xF];
+    }
+    return out;
+}
+
+static std::string to_hex(const std::vector<uint8_t> &data) {
+    return to_hex(data.data(), data.size());
+}
+
+static int hex_value(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+static bool from_hex(const std::string &hex, std::vector<uint8_t> *r_data) {
+    if (hex.size() % 2 != 0) {
+        return false;
+    }
+    r_data->resize(hex.size() / 2);
+    for (size_t i = 0; i < r_data->size(); i++) {
+        int high = hex_value(hex[i * 2]);
+        int low = hex_value(hex[i * 2 + 1]);
+        if (high < 0 || low < 0) {
+            return false;
+        }
+        (*r_data)[i] = (uint8_t)((high << 4) | low);
+    }
+    return true;
+}
+
+struct PairingEngine::KeyMaterial {
+    std::shared_ptr<tls::Identity> identity;
+    std::string cert_hex;                // clientcert 参数：PEM 文本的十六进制编码
+    std::vector<uint8_t> cert_signature; // 客户端证书的签名，第三阶段使用
+};
+
+// 配对过程中使用的加密上下文
+class PairingCrypto {
+public:
+    tls::RandomContext random;
+    mbedtls_md_type_t hash_type = MBEDTLS_MD_SHA256;
+    size_t hash_length = 32;
+
+    PairingCrypto() {
+        mbedtls_aes_init(&aes_enc);
+        mbedtls_aes_init(&aes_dec);
+    }
+
+    ~PairingCrypto() {
+        mbedtls_aes_free(&aes_dec);
+        mbedtls_aes_free(&aes_enc);
+    }
+
+    PairingCrypto(const PairingCrypto &) = delete;
+    PairingCrypto &operator=(const PairingCrypto &) = delete;
+
+    bool random_bytes(size_t length, std::vector<uint8_t> *r_data) {
+        r_data->resize(length);
+        return mbedtls_ctr_drbg_random(&random.ctr_drbg, r_data->data(), length) == 0;
+    }
+
+    std::vector<uint8_t> hash(const std::vector<uint8_t> &data) const {
+        std::vector<uint8_t> out(MBEDTLS_MD_MAX_SIZE);
+        mbedtls_md(mbedtls_md_info_from_type(hash_type), data.data(), data.size(), out.data());
+        out.resize(hash_length);
+        return out;
+    }
+
+    // 由加盐的 PIN 派生 AES 密钥，加解密上下文在整个配对过程中复用
+    void set_key(const std::vector<uint8_t> &salted_pin) {
+        std::vector<uint8_t> key = hash(salted_pin);
+        mbedtls_aes_setkey_enc(&aes_enc, key.data(), 128);
+        mbedtls_aes_setkey_dec(&aes_dec, key.data(), 128);
+    }
+
+    // AES-128-ECB，无填充；长度必须是 16 的倍数
+    bool encrypt(const std::vector<uint8_t> &in, std::vector<uint8_t> *r_out) {
+        return _crypt(&aes_enc, MBEDTLS_AES_ENCRYPT, in, r_out);
+    }
+
+    bool decrypt(const std::vector<uint8_t> &in, std::vector<uint8_t> *r_out) {
+        return _crypt(&aes_dec, MBEDTLS_AES_DECRYPT, in, r_out);
+    }
+
+private:
+    mbedtls_aes_context aes_enc;
+    mbedtls_aes_context aes_dec;
+
+    static bool _crypt(mbedtls_aes_context *ctx, int mode, const std::vector<uint8_t> &in, std::vector<uint8_t> *r_out) {
+        if (in.empty() || in.size() % 16 != 0) {
+            return false;
+        }
+        r_out->resize(in.size());
+        for (size_t i = 0; i < in.size(); i += 16) {
+            if (mbedtls_aes_crypt_ecb(ctx, mode, in.data() + i, r_out->data() + i) != 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+static std::vector<uint8_t> certificate_signature(const mbedtls_x509_crt &cert) {
+    const mbedtls_x509_buf &sig = cert.MBEDTLS_PRIVATE(sig);
+    return std::vector<uint8_t>(sig.p, sig.p + sig.len);
+}
+
+// 服务器对 serverSecret 的 SHA-256 签名 (与代数无关)
+static bool verify_signature(const tls::PinnedCertificate &server_cert, const std::vector<uint8_t> &data, const std::vector<uint8_t> &signature) {
+    uint8_t digest[32];
+    mbedtls_md(mbedtls_md_info_from_type(MBEDTLS_MD_SHA256), data.data(), data.size(), digest);
+    mbedtls_pk_context *pk = const_cast<mbedtls_pk_context *>(&server_cert.cert.pk);
+    return mbedtls_pk_verify(pk, MBEDTLS_MD_SHA256, digest, sizeof(digest), signature.data(), signature.size()) == 0;
+}
+
+static bool sign_message(const tls::Identity &identity, PairingCrypto &crypto, const std::vector<uint8_t> &message, std::vector<uint8_t> *r_signature) {
+    uint8_t digest[32];
+    mbedtls_md(mbedtls_md_info_from_type(MBEDTLS_MD_SHA256), message.data(), message.size(), digest);
+    r_signature->resize(MBEDTLS_PK_SIGNATURE_MAX_SIZE);
+    size_t length = 0;
+    mbedtls_pk_context *key = const_cast<mbedtls_pk_context *>(&identity.key);
+    if (tls::pk_sign(key, MBEDTLS_MD_SHA256, digest, sizeof(digest), r_signature->data(), r_signature->size(), &length, &crypto.random.ctr_drbg) != 0) {
+        return false;
+    }
+    r_signature->resize(length);
+    return true;
+}
+
+#else
+
+struct PairingEngine::KeyMaterial {
+};
+
+#endif // MOONLIGHT_USE_MBEDTLS
+
+PairingEngine::PairingEngine() {
+}
+
+PairingEngine::~PairingEngine() {
+    cancel();
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+#ifdef MOONLIGHT_USE_MBEDTLS
+void PairingEngine::set_client_identity(const std::shared_ptr<tls::Identity> &p_identity) {
+    std::shared_ptr<KeyMaterial> keys = std::make_shared<KeyMaterial>();
+    keys->identity = p_identity;
+    keys->cert_hex = to_hex((const uint8_t *)p_identity->cert_pem.data(), p_identity->cert_pem.size());
+    keys->cert_signature = certificate_signature(p_identity->cert);
+
+    std::lock_guard<std::mutex> lock(key_mutex);
+    key_material = keys;
+}
+#endif
+
+bool PairingEngine::set_client_identity_pem(const std::string &cert_pem, const std::string &key_pem, std::string *r_error) {
+#ifdef MOONLIGHT_USE_MBEDTLS
+    std::shared_ptr<tls::Identity> identity = tls::Identity::parse(cert_pem, key_pem, r_error);
+    if (!identity) {
+        return false;
+    }
+    set_client_identity(identity);
+    return true;
+#else
+    (void)cert_pem;
+    (void)key_pem;
+    *r_error = "Built without mbedTLS support";
+    return false;
+#endif
+}
+
+bool PairingEngine::has_client_identity() {
+    std::lock_guard<std::mutex> lock(key_mutex);
+    return key_material != nullptr;
+}
+
+bool PairingEngine::start(const Request &p_request, std::string *r_error) {
+    if (running.load()) {
+        *r_error = "Pairing is already in progress";
+        return false;
+    }
+#ifdef MOONLIGHT_USE_MBEDTLS
+    std::shared_ptr<KeyMaterial> keys;
+    {
+        std::lock_guard<std::mutex> lock(key_mutex);
+        keys = key_material;
+    }
+    if (!keys) {
+        *r_error = "Client certificate has not been set";
+        return false;
+    }
+    if (p_request.pin.size() < 4) {
+        *r_error = "PIN must have at least 4 digits";
+        return false;
+    }
+
+    // 上一次配对的线程已结束，回收后再启动
+    if (worker.joinable()) {
+        worker.join();
+    }
+    cancelled = false;
+    running = true;
+    worker = std::thread(&PairingEngine::_run, this, p_request, keys);
+    return true;
+#else
+    (void)p_request;
+    *r_error = "Built without mbedTLS support";
+    return false;
+#endif
+}
+
+void PairingEngine::cancel() {
+    if (running.load()) {
+        cancelled = true;
+    }
+}
+
+std::vector<PairingEngine::Event> PairingEngine::take_events() {
+    std::lock_guard<std::mutex> lock(event_mutex);
+    std::vector<Event> result;
+    result.swap(events);
+    events_pending.store(false, std::memory_order_release);
+    return result;
+}
+
+std::string PairingEngine::generate_pin() {
+    std::random_device rd;
+    std::uniform_int_distribution<int> digit(0, 9);
+    std::string pin;
+    for (int i = 0; i < 4; i++) {
+        pin += (char)('0' + digit(rd));
+    }
+    return pin;
+}
+
+void PairingEngine::_push_event(const Event &p_event) {
+    std::lock_guard<std::mutex> lock(event_mutex);
+    events.push_back(p_event);
+    events_pending.store(true, std::memory_order_release);
+}
+
+void PairingEngine::_run(Request p_request, std::shared_ptr<KeyMaterial> p_keys) {
+    Event event;
+    event.finished = true;
+    event.result = _pair(p_request, *p_keys, &event.server_cert_pem, &event.message);
+    if (event.result != RESULT_PAIRED && cancelled.load()) {
+        event.result = RESULT_CANCELLED;
+        event.message = "Pairing was cancelled";
+    }
+    _push_event(event);
+    running = false;
+}
+
+#ifdef MOONLIGHT_USE_MBEDTLS
+
+PairingEngine::Result PairingEngine::_pair(const Request &p_request, const KeyMaterial &p_keys, std::string *r_server_cert_pem, std::string *r_message) {
+    // 每次配对使用独立的连接池：第五阶段需要绑定本次收到的服务器证书
+    HttpConnectionPool pool;
+    pool.set_client_identity(p_keys.identity);
+
+    auto progress = [this](Phase phase) {
+        Event event;
+        event.phase = phase;
+        _push_event(event);
+    };
+
+    auto send = [&](const std::string &query, bool use_tls, int timeout_ms, PairResponse *r_response) {
+        std::string path = build_gamestream_path("pair", std::string("devicename=") + DEVICE_NAME + "&updateState=1&" + query, p_request.unique_id);
+        uint16_t port = use_tls ? p_request.https_port : p_request.http_port;
+        net::HttpResponse response = pool.get(p_request.address, port, path, use_tls, timeout_ms, &cancelled);
+        if (!response.error.empty()) {
+            *r_message = response.error;
+            return false;
+        }
+        if (response.status_code != 200 ||
+                !parse_pair_response((const char *)response.body.data(), response.body.size(), r_response)) {
+            *r_message = "Invalid pairing response (HTTP " + std::to_string(response.status_code) + ")";
+            return false;
+        }
+        if (r_response->status_code != 200) {
+            *r_message = r_response->status_message.empty() ? "Pairing request failed with status " + std::to_string(r_response->status_code) : r_response->status_message;
+            return false;
+        }
+        return true;
+    };
+
+    // 出错时通知主机取消本次配对；取消后也要发送，所以不传入取消标志
+    auto unpair = [&]() {
+        pool.get(p_request.address, p_request.http_port, build_gamestream_path("unpair", std::string(), p_request.unique_id), false, REQUEST_TIMEOUT_MS);
+    };
+
+    // message 为空时保留 send() 给出的错误
+    auto fail = [&](const std::string &message, Result result) {
+        if (!message.empty()) {
+            *r_message = message;
+        }
+        unpair();
+        return result;
+    };
+
+    PairingCrypto crypto;
+    if (!crypto.random.seed("moonlight-godot-pairing")) {
+        *r_message = "Unable to seed random number generator";
+        return RESULT_FAILED;
+    }
+
+    // 7 代及以后的主机使用 SHA-256，之前使用 SHA-1
+    int server_major_version = atoi(p_request.app_version.c_str());
+    if (server_major_version >= 7) {
+        crypto.hash_type = MBEDTLS_MD_SHA256;
+        crypto.hash_length = 32;
+    } else {
+        crypto.hash_type = MBEDTLS_MD_SHA1;
+        crypto.hash_length = 20;
+    }
+
+    std::vector<uint8_t> salt;
+    crypto.random_bytes(16, &salt);
+    std::vector<uint8_t> salted_pin = salt;
+    salted_pin.insert(salted_pin.end(), p_request.pin.begin(), p_request.pin.end());
+    crypto.set_key(salted_pin);
+
+    // 第一阶段：获取服务器证书 (阻塞到用户输入 PIN)
+    progress(PHASE_GET_SERVER_CERT);
+    PairResponse cert_response;
+    if (!send("phrase=getservercert&salt=" + to_hex(salt) + "&clientcert=" + p_keys.cert_hex, false, PIN_ENTRY_TIMEOUT_MS, &cert_response)) {
+        // 超时或取消时主机可能仍在等待 PIN，通知主机放弃这次配对
+        return fail(std::string(), RESULT_FAILED);
+    }
+    if (!cert_response.paired) {
+        *r_message = "Failed pairing at stage #1";
+        return RESULT_FAILED;
+    }
+    std::vector<uint8_t> server_cert_bytes;
+    if (cert_response.plaincert.empty() || !from_hex(cert_response.plaincert, &server_cert_bytes)) {
+        // 主机正在与其他客户端配对
+        return fail("Server likely already pairing", RESULT_ALREADY_IN_PROGRESS);
+    }
+    std::string server_cert_pem(server_cert_bytes.begin(), server_cert_bytes.end());
+    std::string error;
+    std::shared_ptr<tls::PinnedCertificate> server_cert = tls::PinnedCertificate::parse(server_cert_pem, &error);
+    if (!server_cert) {
+        return fail("Failed to parse plaincert: " + error, RESULT_FAILED);
+    }
+    // 配对完成前即绑定该证书，成功后由调用方随主机一起保存
+    pool.set_pinned_server_certificate(server_cert);
+    std::vector<uint8_t> server_cert_signature = certificate_signature(server_cert->cert);
+
+    // 第二阶段：发送客户端挑战
+    progress(PHASE_CLIENT_CHALLENGE);
+    std::vector<uint8_t> random_challenge;
+    std::vector<uint8_t> encrypted_challenge;
+    crypto.random_bytes(16, &random_challenge);
+    crypto.encrypt(random_challenge, &encrypted_challenge);
+    PairResponse challenge_response;
+    if (!send("clientchallenge=" + to_hex(encrypted_challenge), false, REQUEST_TIMEOUT_MS, &challenge_response)) {
+        return fail(std::string(), RESULT_FAILED);
+    }
+    if (!challenge_response.paired) {
+        return fail("Failed pairing at stage #2", RESULT_FAILED);
+    }
+
+    std::vector<uint8_t> encrypted_response;
+    std::vector<uint8_t> challenge_response_data;
+    if (!from_hex(challenge_response.challengeresponse, &encrypted_response) ||
+            !crypto.decrypt(encrypted_response, &challenge_response_data) ||
+            challenge_response_data.size() < crypto.hash_length + 16) {
+        return fail("Invalid challenge response", RESULT_FAILED);
+    }
+    std::vector<uint8_t> server_response(challenge_response_data.begin(), challenge_response_data.begin() + crypto.hash_length);
+
+    // 第三阶段：回应服务器挑战
+    progress(PHASE_SERVER_CHALLENGE_RESPONSE);
+    std::vector<uint8_t> client_secret;
+    crypto.random_bytes(16, &client_secret);
+    std::vector<uint8_t> server_challenge(challenge_response_data.begin() + crypto.hash_length, challenge_response_data.begin() + crypto.hash_length + 16);
+    server_challenge.insert(server_challenge.end(), p_keys.cert_signature.begin(), p_keys.cert_signature.end());
+    server_challenge.insert(server_challenge.end(), client_secret.begin(), client_secret.end());
+    std::vector<uint8_t> padded_hash = crypto.hash(server_challenge);
+    padded_hash.resize(32);
+    std::vector<uint8_t> encrypted_hash;
+    crypto.encrypt(padded_hash, &encrypted_hash);
+    PairResponse secret_response;
+    if (!send("serverchallengeresp=" + to_hex(encrypted_hash), false, REQUEST_TIMEOUT_MS, &secret_response)) {
+        return fail(std::string(), RESULT_FAILED);
+    }
+    if (!secret_response.paired) {
+        return fail("Failed pairing at stage #3", RESULT_FAILED);
+    }
+
+    std::vector<uint8_t> pairing_secret;
+    if (!from_hex(secret_response.pairingsecret, &pairing_secret) || pairing_secret.size() <= 16) {
+        return fail("Invalid pairing secret", RESULT_FAILED);
+    }
+    std::vector<uint8_t> server_secret(pairing_secret.begin(), pairing_secret.begin() + 16);
+    std::vector<uint8_t> server_signature(pairing_secret.begin() + 16, pairing_secret.end());
+    if (!verify_signature(*server_cert, server_secret, server_signature)) {
+        return fail("MITM detected", RESULT_FAILED);
+    }
+
+    std::vector<uint8_t> expected_response_data = random_challenge;
+    expected_response_data.insert(expected_response_data.end(), server_cert_signature.begin(), server_cert_signature.end());
+    expected_response_data.insert(expected_response_data.end(), server_secret.begin(), server_secret.end());
+    if (crypto.hash(expected_response_data) != server_response) {
+        return fail("Incorrect PIN", RESULT_PIN_WRONG);
+    }
+
+    // 第四阶段：发送签名后的客户端密钥
+    progress(PHASE_CLIENT_PAIRING_SECRET);
+    std::vector<uint8_t> client_signature;
+    if (!sign_message(*p_keys.identity, crypto, client_secret, &client_signature)) {
+        return fail("Unable to sign client secret", RESULT_FAILED);
+    }
+    std::vector<uint8_t> client_pairing_secret = client_secret;
+    client_pairing_secret.insert(client_pairing_secret.end(), client_signature.begin(), client_signature.end());
+    PairResponse client_secret_response;
+    if (!send("clientpairingsecret=" + to_hex(client_pairing_secret), false, REQUEST_TIMEOUT_MS, &client_secret_response)) {
+        return fail(std::string(), RESULT_FAILED);
+    }
+    if (!client_secret_response.paired) {
+        return fail("Failed pairing at stage #4", RESULT_FAILED);
+    }
+
+    // 第五阶段：通过 HTTPS 确认 (使用客户端证书，并校验服务器证书与第一阶段一致)
+    progress(PHASE_PAIR_CHALLENGE);
+    PairResponse pair_challenge_response;
+    if (!send("phrase=pairchallenge", true, REQUEST_TIMEOUT_MS, &pair_challenge_response)) {
+        return fail(std::string(), RESULT_FAILED);
+    }
+    if (!pair_challenge_response.paired) {
+        return fail("Failed pairing at stage #5", RESULT_FAILED);
+    }
+
+    *r_server_cert_pem = server_cert_pem;
+    r_message->clear();
+    return RESULT_PAIRED;
+}
+
+#else
+
+PairingEngine::Result PairingEngine::_pair(const Request &p_request, const KeyMaterial &p_keys, std::string *r_server_cert_pem, std::string *r_message) {
+    (void)p_request;
+    (void)p_keys;
+    (void)r_server_cert_pem;
+    *r_message = "Built without mbedTLS support";
+    return RESULT_FAILED;
+}
+
+#endif // MOONLIGHT_USE_MBEDTLS
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "host/server_info.h"
+#include "net/http_connection_pool.h"
+#include "net/tls_identity.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// GameStream 配对状态机 (移植自 NvPairingManager::pair，OpenSSL 换成 mbedTLS)
+// 五个阶段的 HTTP 往返、PIN 加盐、AES-128-ECB、证书解析与 RSA 签名校验都在工作线程中完成，
+// 进度与结果以事件形式排队，由调用方在自己的线程中取出。
+// 客户端证书与私钥在 set_client_identity_pem() 时解析一次，证书的十六进制编码与签名同时预先计算；
+// 第一阶段收到的服务器证书也只解析一次，之后用于签名校验和第五阶段的 HTTPS 证书绑定。
+class PairingEngine {
+public:
+    enum Phase {
+        PHASE_NONE = 0,
+        PHASE_GET_SERVER_CERT = 1,            // 发送盐与客户端证书，等待用户在主机上输入 PIN
+        PHASE_CLIENT_CHALLENGE = 2,           // 发送加密的客户端挑战
+        PHASE_SERVER_CHALLENGE_RESPONSE = 3,  // 回应服务器挑战并取得服务器密钥
+        PHASE_CLIENT_PAIRING_SECRET = 4,      // 发送签名后的客户端密钥
+        PHASE_PAIR_CHALLENGE = 5,             // 通过 HTTPS (绑定服务器证书) 确认配对
+    };
+
+    enum Result {
+        RESULT_PAIRED = 0,
+        RESULT_PIN_WRONG = 1,
+        RESULT_FAILED = 2,
+        RESULT_ALREADY_IN_PROGRESS = 3,
+        RESULT_CANCELLED = 4,
+    };
+
+    struct Request {
+        std::string address;
+        uint16_t http_port = GAMESTREAM_DEFAULT_HTTP_PORT;
+        uint16_t https_port = GAMESTREAM_DEFAULT_HTTPS_PORT;
+        std::string app_version; // serverinfo 的 appversion，决定哈希算法
+        std::string pin;
+        std::string unique_id = GAMESTREAM_CLIENT_UNIQUE_ID;
+    };
+
+    struct Event {
+        bool finished = false;
+        Phase phase = PHASE_NONE;
+        Result result = RESULT_FAILED;
+        std::string server_cert_pem; // 仅 RESULT_PAIRED 时有效，应与主机一起保存
+        std::string message;
+    };
+
+    PairingEngine();
+    ~PairingEngine();
+
+#ifdef MOONLIGHT_USE_MBEDTLS
+    void set_client_identity(const std::shared_ptr<tls::Identity> &p_identity);
+#endif
+    bool set_client_identity_pem(const std::string &cert_pem, const std::string &key_pem, std::string *r_error);
+    bool has_client_identity();
+
+    bool start(const Request &p_request, std::string *r_error);
+    // 取消后工作线程会尽快通知主机取消配对，并以 RESULT_CANCELLED 结束
+    void cancel();
+    bool is_running() const { return running.load(); }
+
+    bool has_events() const { return events_pending.load(std::memory_order_acquire); }
+    std::vector<Event> take_events();
+
+    // 生成 4 位随机 PIN
+    static std::string generate_pin();
+
+private:
+    // 预先计算的客户端密钥材料，同一身份的多次配对共享
+    struct KeyMaterial;
+
+    std::mutex key_mutex;
+    std::shared_ptr<KeyMaterial> key_material;
+
+    std::thread worker;
+    std::atomic<bool> running{ false };
+    std::atomic<bool> cancelled{ false };
+
+    std::mutex event_mutex;
+    std::vector<Event> events;
+    std::atomic<bool> events_pending{ false };
+
+    void _run(Request p_request, std::shared_ptr<KeyMaterial> p_keys);
+    Result _pair(const Request &p_request, const KeyMaterial &p_keys, std::string *r_server_cert_pem, std::string *r_message);
+    void _push_event(const Event &p_event);
+};
@@ -0,0 +1,234 @@
+#include "host/server_info.h"
+
+#include "host/xml_pull_parser.h"
+
+#include <random>
+
+std::string build_gamestream_path(const std::string &command, const std::string &query, const std::string &unique_id) {
+    // 每个请求带一个随机 uuid，与 NvHTTP 一致
+    static const char hex[] = "0123456789abcdef";
+    std::random_device rd;
+    std::mt19937 rng(rd());
+    std::string uuid;
+    for (int i = 0; i < 32; i++) {
+        uuid += hex[rng() & 0xF];
+    }
+
+    std::string path = "/" + command + "?uniqueid=" + unique_id + "&uuid=" + uuid;
+    if (!query.empty()) {
+        path += "&" + query;
+    }
+    return path;
+}
+
+bool ServerInfo::is_busy() const {
+    static const char suffix[] = "_SERVER_BUSY";
+    size_t suffix_len = sizeof(suffix) - 1;
+    return state.size() >= suffix_len && state.compare(state.size() - suffix_len, suffix_len, suffix) == 0;
+}
+
+bool ServerInfo::is_nvidia_server_software() const {
+    return state.find("MJOLNIR") != std::string::npos;
+}
+
+bool ServerInfo::operator==(const ServerInfo &other) const {
+    return hostname == other.hostname && uniqueid == other.uniqueid && mac == other.mac &&
+            state == other.state && app_version == other.app_version && gfe_version == other.gfe_version &&
+            gpu_model == other.gpu_model && local_ip == other.local_ip && external_ip == other.external_ip &&
+            https_port == other.https_port && external_port == other.external_port &&
+            server_codec_mode_support == other.server_codec_mode_support &&
+            max_luma_pixels_hevc == other.max_luma_pixels_hevc && current_game == other.current_game &&
+            paired == other.paired && display_modes == other.display_modes;
+}
+
+// 检查根元素 <root status_code="200">
+static bool check_root(XmlPullParser &parser, int *r_status_code) {
+    std::string_view status;
+    int status_code = 0;
+    if (parser.name() == "root" && parser.get_attribute("status_code", &status)) {
+        status_code = XmlPullParser::to_int(status);
+    }
+    if (r_status_code) {
+        *r_status_code = status_code;
+    }
+    return status_code == 200;
+}
+
+static uint16_t to_port(std::string_view raw, uint16_t fallback) {
+    int port = XmlPullParser::to_int(raw);
+    return port > 0 && port <= 65535 ? (uint16_t)port : fallback;
+}
+
+bool parse_server_info(const char *data, size_t length, ServerInfo *r_info, int *r_status_code) {
+    XmlPullParser parser(data, length);
+    ServerInfo info;
+    info.server_codec_mode_support = -1;
+    int current_game = 0;
+    bool has_root = false;
+    bool in_display_mode = false;
+    std::string_view element;
+
+    while (true) {
+        XmlPullParser::Token token = parser.next();
+        if (token == XmlPullParser::END_DOCUMENT) {
+            break;
+        }
+        if (token == XmlPullParser::ERROR) {
+            return false;
+        }
+
+        if (token == XmlPullParser::START_ELEMENT) {
+            if (parser.depth() == 1) {
+                if (!check_root(parser, r_status_code)) {
+                    return false;
+                }
+                has_root = true;
+            } else if (parser.name() == "DisplayMode") {
+                info.display_modes.emplace_back();
+                in_display_mode = true;
+            }
+            element = parser.name();
+            continue;
+        }
+        if (token == XmlPullParser::END_ELEMENT) {
+            if (parser.name() == "DisplayMode") {
+                in_display_mode = false;
+            }
+            element = std::string_view();
+            continue;
+        }
+
+        // TEXT
+        std::string_view text = parser.text();
+        bool decoded = true;
+        if (in_display_mode) {
+            DisplayMode &mode = info.display_modes.back();
+            if (element == "Width") {
+                mode.width = XmlPullParser::to_int(text);
+            } else if (element == "Height") {
+                mode.height = XmlPullParser::to_int(text);
+            } else if (element == "RefreshRate") {
+                mode.refresh_rate = XmlPullParser::to_int(text);
+            }
+        } else if (element == "hostname") {
+            decoded = XmlPullParser::decode_text(text, &info.hostname);
+        } else if (element == "uniqueid") {
+            decoded = XmlPullParser::decode_text(text, &info.uniqueid);
+        } else if (element == "mac") {
+            decoded = XmlPullParser::decode_text(text, &info.mac);
+        } else if (element == "state") {
+            decoded = XmlPullParser::decode_text(text, &info.state);
+        } else if (element == "appversion") {
+            decoded = XmlPullParser::decode_text(text, &info.app_version);
+        } else if (element == "GfeVersion") {
+            decoded = XmlPullParser::decode_text(text, &info.gfe_version);
+        } else if (element == "gputype") {
+            decoded = XmlPullParser::decode_text(text, &info.gpu_model);
+        } else if (element == "LocalIP") {
+            decoded = XmlPullParser::decode_text(text, &info.local_ip);
+        } else if (element == "ExternalIP") {
+            decoded = XmlPullParser::decode_text(text, &info.external_ip);
+        } else if (element == "PairStatus") {
+            info.paired = XmlPullParser::to_int(text) == 1;
+        } else if (element == "HttpsPort") {
+            info.https_port = to_port(text, GAMESTREAM_DEFAULT_HTTPS_PORT);
+        } else if (element == "ExternalPort") {
+            info.external_port = to_port(text, 0);
+        } else if (element == "ServerCodecModeSupport") {
+            info.server_codec_mode_support = XmlPullParser::to_int(text, -1);
+        } else if (element == "MaxLumaPixelsHEVC") {
+            info.max_luma_pixels_hevc = XmlPullParser::to_int(text);
+        } else if (element == "currentgame") {
+            current_game = XmlPullParser::to_int(text);
+        }
+        if (!decoded) {
+            return false;
+        }
+    }
+
+    if (!has_root || info.uniqueid.empty()) {
+        return false;
+    }
+
+    if (info.hostname.empty()) {
+        info.hostname = "UNKNOWN";
+    }
+    if (info.mac == "00:00:00:00:00:00") {
+        info.mac.clear();
+    }
+    // 使用 GS IPv6 Forwarder 时会得到 IPv4 回环地址
+    if (info.local_ip.compare(0, 4, "127.") == 0) {
+        info.local_ip.clear();
+    }
+    // 未提供时假定只支持 H.264 (SCM_H264)
+    if (info.server_codec_mode_support < 0) {
+        info.server_codec_mode_support = 0x1;
+    }
+    // GFE 2.8 起 currentgame 会保留上一次的游戏，只有在串流中才有意义
+    info.current_game = info.is_busy() ? current_game : 0;
+
+    *r_info = std::move(info);
+    return true;
+}
+
+bool parse_app_list(const char *data, size_t length, std::vector<AppInfo> *r_apps, int *r_status_code) {
+    XmlPullParser parser(data, length);
+    std::vector<AppInfo> apps;
+    bool has_root = false;
+    std::string_view element;
+
+    while (true) {
+        XmlPullParser::Token token = parser.next();
+        if (token == XmlPullParser::END_DOCUMENT) {
+            break;
+        }
+        if (token == XmlPullParser::ERROR) {
+            return false;
+        }
+
+        if (token == XmlPullParser::START_ELEMENT) {
+            if (parser.depth() == 1) {
+                if (!check_root(parser, r_status_code)) {
+                    return false;
+                }
+                has_root = true;
+            } else if (parser.name() == "App") {
+                // 前一个应用必须有效才能继续
+                if (!apps.empty() && (apps.back().id == 0 || apps.back().name.empty())) {
+                    return false;
+                }
+                apps.emplace_back();
+            }
+            element = parser.name();
+            continue;
+        }
+        if (token == XmlPullParser::END_ELEMENT) {
+            element = std::string_view();
+            continue;
+        }
+
+        if (apps.empty()) {
+            continue;
+        }
+        AppInfo &app = apps.back();
+        std::string_view text = parser.text();
+        if (element == "AppTitle") {
+            if (!XmlPullParser::decode_text(text, &app.name)) {
+                return false;
+            }
+        } else if (element == "ID") {
+            app.id = XmlPullParser::to_int(text);
+        } else if (element == "IsHdrSupported") {
+            app.hdr_supported = XmlPullParser::to_int(text) == 1;
+        } else if (element == "IsAppCollectorGame") {
+            app.is_app_collector_game = XmlPullParser::to_int(text) == 1;
+        }
+    }
+
+    if (!has_root || (!apps.empty() && (apps.back().id == 0 || apps.back().name.empty()))) {
+        return false;
+    }
+
+    *r_apps = std::move(apps);
+    return true;
+}
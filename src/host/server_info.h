@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// GameStream 默认端口
+#define GAMESTREAM_DEFAULT_HTTP_PORT 47989
+#define GAMESTREAM_DEFAULT_HTTPS_PORT 47984
+// 请求中携带的客户端 ID (Moonlight 各客户端均使用此固定值)
+#define GAMESTREAM_CLIENT_UNIQUE_ID "0123456789ABCDEF"
+
+// GameStream 请求路径：/<command>?uniqueid=<客户端 ID>&uuid=<随机值>[&query]
+std::string build_gamestream_path(const std::string &command, const std::string &query = std::string(), const std::string &unique_id = GAMESTREAM_CLIENT_UNIQUE_ID);
+
+// /serverinfo 响应中的显示模式
+struct DisplayMode {
+    int width = 0;
+    int height = 0;
+    int refresh_rate = 0;
+
+    bool operator==(const DisplayMode &other) const {
+        return width == other.width && height == other.height && refresh_rate == other.refresh_rate;
+    }
+};
+
+// /serverinfo 响应解析结果 (对应 NvComputer 从 serverinfo 读取的字段)
+struct ServerInfo {
+    std::string hostname;
+    std::string uniqueid;
+    std::string mac;
+    std::string state;
+    std::string app_version;
+    std::string gfe_version;
+    std::string gpu_model;
+    std::string local_ip;
+    std::string external_ip;
+    uint16_t https_port = GAMESTREAM_DEFAULT_HTTPS_PORT;
+    uint16_t external_port = 0; // 0 表示与请求所用的 HTTP 端口相同
+    int server_codec_mode_support = 0;
+    int max_luma_pixels_hevc = 0;
+    int current_game = 0;
+    bool paired = false;
+    std::vector<DisplayMode> display_modes;
+
+    // 主机正在串流 (state 以 _SERVER_BUSY 结尾)
+    bool is_busy() const;
+    // 官方 GeForce Experience 的 state 字段带有 MJOLNIR
+    bool is_nvidia_server_software() const;
+
+    bool operator==(const ServerInfo &other) const;
+    bool operator!=(const ServerInfo &other) const { return !(*this == other); }
+};
+
+// /applist 响应中的应用 (对应 NvApp 中来自主机的字段)
+struct AppInfo {
+    int id = 0;
+    std::string name;
+    bool hdr_supported = false;
+    bool is_app_collector_game = false;
+
+    bool operator==(const AppInfo &other) const {
+        return id == other.id && name == other.name && hdr_supported == other.hdr_supported &&
+                is_app_collector_game == other.is_app_collector_game;
+    }
+    bool operator!=(const AppInfo &other) const { return !(*this == other); }
+};
+
+// 以下解析函数都只对响应做一次扫描 (见 XmlPullParser)。
+// 根元素的 status_code 不为 200 时返回 false，r_status_code 可选，用于区分 401 等错误。
+
+// 解析 /serverinfo 响应，缺少 uniqueid 时返回 false
+bool parse_server_info(const char *data, size_t length, ServerInfo *r_info, int *r_status_code = nullptr);
+// 解析 /applist 响应，存在缺少 ID 或标题的应用时返回 false
+bool parse_app_list(const char *data, size_t length, std::vector<AppInfo> *r_apps, int *r_status_code = nullptr);
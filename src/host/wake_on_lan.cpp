@@ -0,0 +1,124 @@
+#include "host/wake_on_lan.h"
+
+#include "host/server_info.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace wol {
+
+// 直接使用的端口
+static const uint16_t STATIC_WOL_PORTS[] = {
+    9,     // 标准 WoL 端口 (特权端口)
+    47009, // Moonlight Internet Hosting Tool 为 WoL 打开的端口 (非特权端口)
+};
+
+// 按主机 HTTP 端口偏移的端口，适用于使用非默认端口的主机
+static const uint16_t DYNAMIC_WOL_PORTS[] = {
+    47998, 47999, 48000, 48002, 48010, // GFE 打开的端口
+};
+
+static int hex_value(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+bool parse_mac_address(const std::string &text, MacAddress *r_mac) {
+    std::string digits;
+    for (char c : text) {
+        if (c == ':' || c == '-') {
+            continue;
+        }
+        if (hex_value(c) < 0) {
+            return false;
+        }
+        digits.push_back(c);
+    }
+    if (digits.size() != 12) {
+        return false;
+    }
+
+    bool all_zero = true;
+    for (int i = 0; i < 6; i++) {
+        r_mac->bytes[i] = (uint8_t)(hex_value(digits[i * 2]) << 4 | hex_value(digits[i * 2 + 1]));
+        all_zero = all_zero && r_mac->bytes[i] == 0;
+    }
+    return !all_zero;
+}
+
+std::string build_magic_packet(const MacAddress &mac) {
+    std::string packet(6, (char)0xFF);
+    for (int i = 0; i < 16; i++) {
+        packet.append((const char *)mac.bytes, 6);
+    }
+    return packet;
+}
+
+static bool same_address(const sockaddr_storage &a, const sockaddr_storage &b) {
+    return a.ss_family == b.ss_family && memcmp(&a, &b, net::address_length(a)) == 0;
+}
+
+static void add_target(std::vector<sockaddr_storage> *r_targets, sockaddr_storage address, int port) {
+    if (port <= 0 || port > 65535) {
+        return;
+    }
+    net::set_address_port(&address, (uint16_t)port);
+    for (const sockaddr_storage &target : *r_targets) {
+        if (same_address(target, address)) {
+            return;
+        }
+    }
+    r_targets->push_back(address);
+}
+
+static void add_ports(std::vector<sockaddr_storage> *r_targets, const sockaddr_storage &address, const std::vector<uint16_t> &base_ports) {
+    for (uint16_t port : STATIC_WOL_PORTS) {
+        add_target(r_targets, address, port);
+    }
+    for (uint16_t base_port : base_ports) {
+        for (uint16_t port : DYNAMIC_WOL_PORTS) {
+            add_target(r_targets, address, (int)port - GAMESTREAM_DEFAULT_HTTP_PORT + base_port);
+        }
+    }
+}
+
+std::vector<sockaddr_storage> build_wake_targets(const std::vector<HostAddress> &addresses) {
+    std::vector<sockaddr_storage> targets;
+    std::vector<uint16_t> base_ports;
+
+    for (const HostAddress &address : addresses) {
+        if (std::find(base_ports.begin(), base_ports.end(), address.http_port) == base_ports.end()) {
+            base_ports.push_back(address.http_port);
+        }
+        // 已知地址只使用它自己的 HTTP 端口
+        for (const sockaddr_storage &resolved_address : address.resolved) {
+            add_ports(&targets, resolved_address, std::vector<uint16_t>{ address.http_port });
+        }
+    }
+    if (base_ports.empty()) {
+        base_ports.push_back(GAMESTREAM_DEFAULT_HTTP_PORT);
+    }
+
+    std::vector<sockaddr_storage> broadcasts;
+    sockaddr_storage limited;
+    memset(&limited, 0, sizeof(limited));
+    sockaddr_in *in = (sockaddr_in *)&limited;
+    in->sin_family = AF_INET;
+    in->sin_addr.s_addr = htonl(INADDR_BROADCAST);
+    broadcasts.push_back(limited);
+    net::get_broadcast_addresses(&broadcasts);
+    for (const sockaddr_storage &broadcast : broadcasts) {
+        add_ports(&targets, broadcast, base_ports);
+    }
+    return targets;
+}
+
+} // namespace wol
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "net/net_socket.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Wake-on-LAN 魔术包与发送目标 (移植自 NvComputer::wake)
+namespace wol {
+
+struct MacAddress {
+    uint8_t bytes[6] = { 0, 0, 0, 0, 0, 0 };
+};
+
+// 解析 "AA:BB:CC:DD:EE:FF"、"AA-BB-CC-DD-EE-FF" 或 "AABBCCDDEEFF"；全零地址 (主机未上报) 视为无效
+bool parse_mac_address(const std::string &text, MacAddress *r_mac);
+
+// 6 字节 0xFF 后接 16 次 MAC 地址，共 102 字节
+std::string build_magic_packet(const MacAddress &mac);
+
+struct HostAddress {
+    std::vector<sockaddr_storage> resolved; // 该地址解析得到的 IP (端口任意)，主机名尚未解析时为空
+    uint16_t http_port;
+};
+
+// 生成所有发送目标：主机的每个已知地址，以及 255.255.255.255 与各网卡的子网广播 / IPv6 组播地址
+// (主机休眠后 ARP 表项可能已过期，单播包无法送达)。
+// 每个目标都发往固定端口 9 与 47009，以及按 HTTP 端口偏移后的 GFE 端口；广播目标使用所有已知的 HTTP 端口。
+// 主机名由调用方预先解析，本函数不会阻塞。
+std::vector<sockaddr_storage> build_wake_targets(const std::vector<HostAddress> &addresses);
+
+} // namespace wol
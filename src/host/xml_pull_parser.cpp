@@ -0,0 +1,275 @@
+#include "host/xml_pull_parser.h"
+
+#include <cstdint>
+#include <cstring>
+
+static bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+static bool is_name_end(char c) {
+    return is_space(c) || c == '>' || c == '/';
+}
+
+bool XmlPullParser::_skip_past(std::string_view terminator) {
+    std::string_view rest(data + pos, length - pos);
+    size_t found = rest.find(terminator);
+    if (found == std::string_view::npos) {
+        return false;
+    }
+    pos += found + terminator.size();
+    return true;
+}
+
+XmlPullParser::Token XmlPullParser::next() {
+    if (pending_end) {
+        pending_end = false;
+        current_depth--;
+        return END_ELEMENT;
+    }
+
+    while (pos < length) {
+        if (data[pos] != '<') {
+            // 文本直到下一个 '<'；只含空白的文本直接跳过
+            size_t begin = pos;
+            const void *lt = memchr(data + pos, '<', length - pos);
+            pos = lt ? (size_t)((const char *)lt - data) : length;
+            std::string_view raw(data + begin, pos - begin);
+            for (char c : raw) {
+                if (!is_space(c)) {
+                    current_text = raw;
+                    return TEXT;
+                }
+            }
+            continue;
+        }
+
+        std::string_view rest(data + pos, length - pos);
+        if (rest.compare(0, 4, "<!--") == 0) {
+            if (!_skip_past("-->")) {
+                return ERROR;
+            }
+            continue;
+        }
+        if (rest.compare(0, 9, "<![CDATA[") == 0) {
+            size_t begin = pos + 9;
+            if (!_skip_past("]]>")) {
+                return ERROR;
+            }
+            current_text = std::string_view(data + begin, pos - 3 - begin);
+            return TEXT;
+        }
+        if (rest.compare(0, 2, "<?") == 0) {
+            if (!_skip_past("?>")) {
+                return ERROR;
+            }
+            continue;
+        }
+        if (rest.compare(0, 2, "<!") == 0) {
+            // <!DOCTYPE ...>
+            if (!_skip_past(">")) {
+                return ERROR;
+            }
+            continue;
+        }
+
+        bool closing = rest.size() > 1 && rest[1] == '/';
+        size_t name_begin = pos + (closing ? 2 : 1);
+        size_t cursor = name_begin;
+        while (cursor < length && !is_name_end(data[cursor])) {
+            cursor++;
+        }
+        if (cursor == name_begin || cursor >= length) {
+            return ERROR;
+        }
+        current_name = std::string_view(data + name_begin, cursor - name_begin);
+
+        // 找到标签结尾，属性值中的 '>' 需要跳过
+        size_t attr_begin = cursor;
+        char quote = 0;
+        while (cursor < length && (quote || data[cursor] != '>')) {
+            if (quote) {
+                if (data[cursor] == quote) {
+                    quote = 0;
+                }
+            } else if (data[cursor] == '"' || data[cursor] == '\'') {
+                quote = data[cursor];
+            }
+            cursor++;
+        }
+        if (cursor >= length) {
+            return ERROR;
+        }
+        bool self_closing = !closing && cursor > attr_begin && data[cursor - 1] == '/';
+        current_attributes = std::string_view(data + attr_begin, cursor - attr_begin - (self_closing ? 1 : 0));
+        pos = cursor + 1;
+
+        if (closing) {
+            if (open_elements.empty() || open_elements.back() != current_name) {
+                return ERROR;
+            }
+            open_elements.pop_back();
+            current_depth--;
+            return END_ELEMENT;
+        }
+
+        current_depth++;
+        pending_end = self_closing;
+        if (!self_closing) {
+            open_elements.push_back(current_name);
+        }
+        return START_ELEMENT;
+    }
+
+    return current_depth == 0 ? END_DOCUMENT : ERROR;
+}
+
+bool XmlPullParser::get_attribute(std::string_view attribute, std::string_view *r_value) const {
+    std::string_view attrs = current_attributes;
+    size_t cursor = 0;
+    while (cursor < attrs.size()) {
+        while (cursor < attrs.size() && is_space(attrs[cursor])) {
+            cursor++;
+        }
+        size_t name_begin = cursor;
+        while (cursor < attrs.size() && attrs[cursor] != '=' && !is_space(attrs[cursor])) {
+            cursor++;
+        }
+        std::string_view attr_name = attrs.substr(name_begin, cursor - name_begin);
+        while (cursor < attrs.size() && (is_space(attrs[cursor]) || attrs[cursor] == '=')) {
+            cursor++;
+        }
+        if (cursor >= attrs.size() || (attrs[cursor] != '"' && attrs[cursor] != '\'')) {
+            return false;
+        }
+        char quote = attrs[cursor++];
+        size_t value_begin = cursor;
+        while (cursor < attrs.size() && attrs[cursor] != quote) {
+            cursor++;
+        }
+        if (cursor >= attrs.size()) {
+            return false;
+        }
+        if (attr_name == attribute) {
+            *r_value = attrs.substr(value_begin, cursor - value_begin);
+            return true;
+        }
+        cursor++;
+    }
+    return false;
+}
+
+// XML 1.0 的 Char 产生式：禁止 NUL、其他 C0 控制字符 (制表符与换行除外)、代理项与 U+FFFE/U+FFFF
+static bool is_xml_char(uint32_t cp) {
+    if (cp < 0x20) {
+        return cp == 0x9 || cp == 0xA || cp == 0xD;
+    }
+    return (cp < 0xD800 || cp > 0xDFFF) && cp != 0xFFFE && cp != 0xFFFF && cp < 0x110000;
+}
+
+static void append_utf8(std::string *r_out, uint32_t cp) {
+    if (cp < 0x80) {
+        r_out->push_back((char)cp);
+    } else if (cp < 0x800) {
+        r_out->push_back((char)(0xC0 | (cp >> 6)));
+        r_out->push_back((char)(0x80 | (cp & 0x3F)));
+    } else if (cp < 0x10000) {
+        r_out->push_back((char)(0xE0 | (cp >> 12)));
+        r_out->push_back((char)(0x80 | ((cp >> 6) & 0x3F)));
+        r_out->push_back((char)(0x80 | (cp & 0x3F)));
+    } else if (cp < 0x110000) {
+        r_out->push_back((char)(0xF0 | (cp >> 18)));
+        r_out->push_back((char)(0x80 | ((cp >> 12) & 0x3F)));
+        r_out->push_back((char)(0x80 | ((cp >> 6) & 0x3F)));
+        r_out->push_back((char)(0x80 | (cp & 0x3F)));
+    }
+}
+
+bool XmlPullParser::decode_text(std::string_view raw, std::string *r_out) {
+    r_out->clear();
+    // XML 文本中不允许出现 NUL，无论是原始字节还是 &#0;
+    if (memchr(raw.data(), '\0', raw.size())) {
+        return false;
+    }
+    size_t amp = raw.find('&');
+    if (amp == std::string_view::npos) {
+        r_out->assign(raw.data(), raw.size());
+        return true;
+    }
+
+    r_out->reserve(raw.size());
+    size_t cursor = 0;
+    while (amp != std::string_view::npos) {
+        r_out->append(raw.data() + cursor, amp - cursor);
+        size_t semi = raw.find(';', amp);
+        if (semi == std::string_view::npos || semi - amp > 10) {
+            // 不是合法实体，原样保留
+            r_out->push_back('&');
+            cursor = amp + 1;
+        } else {
+            std::string_view entity = raw.substr(amp + 1, semi - amp - 1);
+            if (entity == "lt") {
+                r_out->push_back('<');
+            } else if (entity == "gt") {
+                r_out->push_back('>');
+            } else if (entity == "amp") {
+                r_out->push_back('&');
+            } else if (entity == "quot") {
+                r_out->push_back('"');
+            } else if (entity == "apos") {
+                r_out->push_back('\'');
+            } else if (entity.size() > 1 && entity[0] == '#') {
+                bool hex = entity[1] == 'x' || entity[1] == 'X';
+                if (hex && entity.size() == 2) {
+                    return false;
+                }
+                uint32_t cp = 0;
+                for (size_t i = hex ? 2 : 1; i < entity.size(); i++) {
+                    char c = entity[i];
+                    int digit = c >= '0' && c <= '9' ? c - '0' : (hex && c >= 'a' && c <= 'f' ? c - 'a' + 10 : (hex && c >= 'A' && c <= 'F' ? c - 'A' + 10 : -1));
+                    if (digit < 0) {
+                        cp = 0x110000;
+                        break;
+                    }
+                    cp = cp * (hex ? 16 : 10) + digit;
+                }
+                if (!is_xml_char(cp)) {
+                    return false;
+                }
+                append_utf8(r_out, cp);
+            } else {
+                r_out->append(raw.data() + amp, semi - amp + 1);
+            }
+            cursor = semi + 1;
+        }
+        amp = raw.find('&', cursor);
+    }
+    r_out->append(raw.data() + cursor, raw.size() - cursor);
+    return true;
+}
+
+int XmlPullParser::to_int(std::string_view raw, int fallback) {
+    size_t cursor = 0;
+    while (cursor < raw.size() && is_space(raw[cursor])) {
+        cursor++;
+    }
+    bool negative = cursor < raw.size() && raw[cursor] == '-';
+    if (negative || (cursor < raw.size() && raw[cursor] == '+')) {
+        cursor++;
+    }
+    if (cursor >= raw.size() || raw[cursor] < '0' || raw[cursor] > '9') {
+        return fallback;
+    }
+    int64_t value = 0;
+    while (cursor < raw.size() && raw[cursor] >= '0' && raw[cursor] <= '9') {
+        value = value * 10 + (raw[cursor] - '0');
+        if (value > INT32_MAX) {
+            return fallback;
+        }
+        cursor++;
+    }
+    while (cursor < raw.size() && is_space(raw[cursor])) {
+        cursor++;
+    }
+    return cursor == raw.size() ? (int)(negative ? -value : value) : fallback;
+}
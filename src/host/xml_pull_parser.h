@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// 单次扫描的 XML 拉取式解析器
+// 直接在响应缓冲区上前进，返回的元素名、属性和文本都是指向原缓冲区的 string_view，不做任何拷贝；
+// 只有文本中含有实体 (&amp; 等) 时，调用方才需要用 decode_text() 解码。
+// 只支持 GameStream 响应用到的 XML 子集：不处理命名空间与 DTD，未闭合或与开始标签不匹配的结束标签视为错误。
+class XmlPullParser {
+public:
+    enum Token {
+        START_ELEMENT,
+        END_ELEMENT,
+        TEXT,
+        END_DOCUMENT,
+        ERROR,
+    };
+
+    XmlPullParser(const char *p_data, size_t p_length) :
+            data(p_data), length(p_length) {}
+
+    Token next();
+
+    // START_ELEMENT / END_ELEMENT 的元素名
+    std::string_view name() const { return current_name; }
+    // TEXT 的原始文本 (未解码)
+    std::string_view text() const { return current_text; }
+    // 当前 START_ELEMENT 的属性值 (原始文本)
+    bool get_attribute(std::string_view attribute, std::string_view *r_value) const;
+    // 当前元素的嵌套深度 (根元素为 1)
+    int depth() const { return current_depth; }
+
+    // 解码 &lt; &gt; &amp; &quot; &apos; 与数字字符引用。
+    // 含有 NUL 字节或引用了 XML 不允许的字符 (&#0;、代理项、超出 Unicode 范围等) 时返回 false
+    static bool decode_text(std::string_view raw, std::string *r_out);
+    // 解析十进制整数，忽略前后空白；格式错误时返回 fallback
+    static int to_int(std::string_view raw, int fallback = 0);
+
+private:
+    const char *data;
+    size_t length;
+    size_t pos = 0;
+    int current_depth = 0;
+    bool pending_end = false; // 自闭合标签 <a/> 需要补发 END_ELEMENT
+    // 尚未闭合的元素名 (指向原缓冲区)，用于检查结束标签
+    std::vector<std::string_view> open_elements;
+
+    std::string_view current_name;
+    std::string_view current_text;
+    std::string_view current_attributes;
+
+    bool _skip_past(std::string_view terminator);
+};
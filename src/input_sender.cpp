@@ -0,0 +1,483 @@
+#include "input_sender.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+// 映射到的全部按钮 (见 MoonlightInput)
+static const uint32_t SUPPORTED_BUTTON_FLAGS = A_FLAG | B_FLAG | X_FLAG | Y_FLAG |
+        UP_FLAG | DOWN_FLAG | LEFT_FLAG | RIGHT_FLAG | LB_FLAG | RB_FLAG |
+        PLAY_FLAG | BACK_FLAG | LS_CLK_FLAG | RS_CLK_FLAG | SPECIAL_FLAG |
+        PADDLE1_FLAG | PADDLE2_FLAG | PADDLE3_FLAG | PADDLE4_FLAG | TOUCHPAD_FLAG | MISC_FLAG;
+
+bool InputSender::ControllerState::operator==(const ControllerState &p_other) const {
+    return button_flags == p_other.button_flags &&
+            left_trigger == p_other.left_trigger && right_trigger == p_other.right_trigger &&
+            left_stick_x == p_other.left_stick_x && left_stick_y == p_other.left_stick_y &&
+            right_stick_x == p_other.right_stick_x && right_stick_y == p_other.right_stick_y;
+}
+
+InputSender::InputSender() {
+}
+
+InputSender::~InputSender() {
+    stop();
+}
+
+void InputSender::start(int p_tick_interval_us) {
+    stop();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop_requested = false;
+        tick_interval_us = std::max(100, p_tick_interval_us);
+        queue.clear();
+        dirty_mask = active_mask;
+        arrival_mask = active_mask & info_mask;
+        stats = Stats();
+    }
+    // 新连接上主机端没有任何手柄，已连接的手柄需要重新发送
+    sent_mask = 0;
+    for (ControllerState &state : sent_controllers) {
+        state = ControllerState();
+    }
+    remainder_x = 0.0f;
+    remainder_y = 0.0f;
+    touch_supported = true;
+    pen_supported = true;
+    emulated_button_down = false;
+    running = true;
+    worker = std::thread(&InputSender::_run, this);
+}
+
+void InputSender::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop_requested = true;
+    }
+    condition.notify_all();
+    if (worker.joinable()) {
+        worker.join();
+    }
+    running = false;
+}
+
+void InputSender::queue_mouse_motion(float delta_x, float delta_y) {
+    if (delta_x == 0.0f && delta_y == 0.0f) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stats.queued_events++;
+        if (!queue.empty() && queue.back().type == EVENT_MOUSE_MOVE) {
+            queue.back().x += delta_x;
+            queue.back().y += delta_y;
+            stats.coalesced_events++;
+            return;
+        }
+        Event event;
+        event.type = EVENT_MOUSE_MOVE;
+        event.x = delta_x;
+        event.y = delta_y;
+        queue.push_back(event);
+    }
+    condition.notify_one();
+}
+
+void InputSender::queue_mouse_button(int button, bool pressed) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stats.queued_events++;
+        Event event;
+        event.type = EVENT_MOUSE_BUTTON;
+        event.button = button;
+        event.pressed = pressed;
+        queue.push_back(event);
+    }
+    condition.notify_one();
+}
+
+void InputSender::queue_scroll(int amount, bool horizontal) {
+    if (amount == 0) {
+        return;
+    }
+    EventType type = horizontal ? EVENT_HSCROLL : EVENT_SCROLL;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stats.queued_events++;
+        if (!queue.empty() && queue.back().type == type) {
+            queue.back().amount += amount;
+            stats.coalesced_events++;
+            return;
+        }
+        Event event;
+        event.type = type;
+        event.amount = amount;
+        queue.push_back(event);
+    }
+    condition.notify_one();
+}
+
+void InputSender::queue_key(uint8_t key_code, bool pressed, uint8_t modifiers, uint8_t flags) {
+    Event event;
+    event.type = EVENT_KEY;
+    event.key_code = key_code;
+    event.pressed = pressed;
+    event.modifiers = modifiers;
+    event.key_flags = flags;
+    _push_event(event);
+}
+
+void InputSender::queue_text(const std::string &utf8) {
+    if (utf8.empty()) {
+        return;
+    }
+    Event event;
+    event.type = EVENT_TEXT;
+    event.text = utf8;
+    _push_event(event);
+}
+
+void InputSender::queue_mouse_position(float x, float y, int reference_width, int reference_height) {
+    Event event;
+    event.type = EVENT_MOUSE_POSITION;
+    event.x = x;
+    event.y = y;
+    event.reference_width = reference_width;
+    event.reference_height = reference_height;
+    _push_event(event);
+}
+
+void InputSender::queue_touch(uint8_t event_type, uint32_t pointer_id, float x, float y, float pressure, int reference_width, int reference_height) {
+    Event event;
+    event.type = EVENT_TOUCH;
+    event.touch_type = event_type;
+    event.pointer_id = pointer_id;
+    event.x = x;
+    event.y = y;
+    event.pressure = pressure;
+    event.reference_width = reference_width;
+    event.reference_height = reference_height;
+    _push_event(event);
+}
+
+void InputSender::queue_pen(uint8_t event_type, uint8_t tool_type, uint8_t buttons, float x, float y, float pressure,
+        uint16_t rotation, uint8_t tilt, int reference_width, int reference_height) {
+    Event event;
+    event.type = EVENT_PEN;
+    event.touch_type = event_type;
+    event.tool_type = tool_type;
+    event.pen_buttons = buttons;
+    event.x = x;
+    event.y = y;
+    event.pressure = pressure;
+    event.rotation = rotation;
+    event.tilt = tilt;
+    event.reference_width = reference_width;
+    event.reference_height = reference_height;
+    _push_event(event);
+}
+
+void InputSender::_push_event(const Event &p_event) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stats.queued_events++;
+        if (_coalesce_position(p_event)) {
+            stats.coalesced_events++;
+            return;
+        }
+        queue.push_back(p_event);
+    }
+    condition.notify_one();
+}
+
+// 用新位置覆盖队列中尚未发送的同类移动事件 (需持有 mutex)
+bool InputSender::_coalesce_position(const Event &p_event) {
+    if (queue.empty()) {
+        return false;
+    }
+    bool is_move = p_event.touch_type == LI_TOUCH_EVENT_MOVE || p_event.touch_type == LI_TOUCH_EVENT_HOVER;
+    switch (p_event.type) {
+        case EVENT_MOUSE_POSITION: {
+            if (queue.back().type == EVENT_MOUSE_POSITION) {
+                queue.back() = p_event;
+                return true;
+            }
+        } break;
+        case EVENT_TOUCH: {
+            if (!is_move) {
+                return false;
+            }
+            // 多点触控时各触点的移动交替到达，在末尾连续的移动事件中查找同一触点
+            for (size_t i = queue.size(); i > 0; i--) {
+                Event &queued = queue[i - 1];
+                if (queued.type != EVENT_TOUCH || (queued.touch_type != LI_TOUCH_EVENT_MOVE && queued.touch_type != LI_TOUCH_EVENT_HOVER)) {
+                    break;
+                }
+                if (queued.pointer_id == p_event.pointer_id && queued.touch_type == p_event.touch_type) {
+                    queued = p_event;
+                    return true;
+                }
+            }
+        } break;
+        case EVENT_PEN: {
+            const Event &last = queue.back();
+            if (is_move && last.type == EVENT_PEN && last.touch_type == p_event.touch_type &&
+                    last.tool_type == p_event.tool_type && last.pen_buttons == p_event.pen_buttons) {
+                queue.back() = p_event;
+                return true;
+            }
+        } break;
+        default:
+            break;
+    }
+    return false;
+}
+
+void InputSender::set_controller_state(int controller, const ControllerState &state) {
+    if (controller < 0 || controller >= MAX_CONTROLLERS) {
+        return;
+    }
+    uint16_t bit = (uint16_t)(1 << controller);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stats.queued_events++;
+        if ((active_mask & bit) && controllers[controller] == state) {
+            stats.skipped_controller_states++;
+            return;
+        }
+        controllers[controller] = state;
+        active_mask |= bit;
+        dirty_mask |= bit;
+    }
+    condition.notify_one();
+}
+
+void InputSender::set_controller_info(int controller, uint8_t type, uint16_t capabilities) {
+    if (controller < 0 || controller >= MAX_CONTROLLERS) {
+        return;
+    }
+    uint16_t bit = (uint16_t)(1 << controller);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        controller_types[controller] = type;
+        controller_capabilities[controller] = capabilities;
+        info_mask |= bit;
+        arrival_mask |= bit;
+        active_mask |= bit;
+        dirty_mask |= bit;
+    }
+    condition.notify_one();
+}
+
+void InputSender::set_controller_connected(int controller, bool connected) {
+    if (controller < 0 || controller >= MAX_CONTROLLERS) {
+        return;
+    }
+    uint16_t bit = (uint16_t)(1 << controller);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (((active_mask & bit) != 0) == connected) {
+            return;
+        }
+        controllers[controller] = ControllerState();
+        if (connected) {
+            active_mask |= bit;
+        } else {
+            active_mask &= ~bit;
+            info_mask &= ~bit;
+            arrival_mask &= ~bit;
+        }
+        dirty_mask |= bit;
+    }
+    condition.notify_one();
+}
+
+void InputSender::clear_controllers() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        dirty_mask |= active_mask;
+        active_mask = 0;
+        info_mask = 0;
+        arrival_mask = 0;
+        for (ControllerState &state : controllers) {
+            state = ControllerState();
+        }
+    }
+    condition.notify_one();
+}
+
+InputSender::Stats InputSender::get_stats() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+void InputSender::_run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        condition.wait(lock, [this]() { return stop_requested || _has_work(); });
+        if (stop_requested) {
+            break;
+        }
+
+        sending.clear();
+        sending.swap(queue);
+        uint16_t mask = active_mask;
+        uint16_t dirty = dirty_mask;
+        uint16_t arrivals = arrival_mask & dirty;
+        dirty_mask = 0;
+        arrival_mask &= ~arrivals;
+        ControllerState states[MAX_CONTROLLERS];
+        uint8_t types[MAX_CONTROLLERS];
+        uint16_t capabilities[MAX_CONTROLLERS];
+        for (int i = 0; i < MAX_CONTROLLERS; i++) {
+            if (dirty & (1 << i)) {
+                states[i] = controllers[i];
+                types[i] = controller_types[i];
+                capabilities[i] = controller_capabilities[i];
+            }
+        }
+        lock.unlock();
+
+        uint64_t sent = 0;
+        uint64_t skipped = 0;
+        for (const Event &event : sending) {
+            sent += _send_event(event);
+        }
+        for (int i = 0; i < MAX_CONTROLLERS; i++) {
+            uint16_t bit = (uint16_t)(1 << i);
+            if (!(dirty & bit)) {
+                continue;
+            }
+            if ((arrivals & bit) && (mask & bit)) {
+                LiSendControllerArrivalEvent((uint8_t)i, mask, types[i], SUPPORTED_BUTTON_FLAGS, capabilities[i]);
+                sent++;
+            }
+            // 移除的手柄发送一次不含自身的 activeGamepadMask
+            if ((mask & bit) == (sent_mask & bit) && (!(mask & bit) || states[i] == sent_controllers[i])) {
+                skipped++;
+                continue;
+            }
+            const ControllerState &state = states[i];
+            LiSendMultiControllerEvent((short)i, (short)mask, state.button_flags,
+                    state.left_trigger, state.right_trigger,
+                    state.left_stick_x, state.left_stick_y, state.right_stick_x, state.right_stick_y);
+            sent_controllers[i] = state;
+            sent_mask = (uint16_t)((sent_mask & ~bit) | (mask & bit));
+            sent++;
+        }
+
+        lock.lock();
+        stats.sent_events += sent;
+        stats.skipped_controller_states += skipped;
+        // 在一个 tick 内到达的移动事件合并后再发送
+        condition.wait_for(lock, std::chrono::microseconds(tick_interval_us), [this]() { return stop_requested; });
+    }
+}
+
+int InputSender::_send_event(const Event &p_event) {
+    switch (p_event.type) {
+        case EVENT_MOUSE_MOVE:
+            return _send_mouse_motion(p_event.x, p_event.y);
+        case EVENT_MOUSE_BUTTON:
+            LiSendMouseButtonEvent(p_event.pressed ? BUTTON_ACTION_PRESS : BUTTON_ACTION_RELEASE, p_event.button);
+            return 1;
+        case EVENT_SCROLL:
+            LiSendHighResScrollEvent((short)std::clamp(p_event.amount, -32768, 32767));
+            return 1;
+        case EVENT_HSCROLL:
+            LiSendHighResHScrollEvent((short)std::clamp(p_event.amount, -32768, 32767));
+            return 1;
+        case EVENT_MOUSE_POSITION:
+            return _send_mouse_position(p_event);
+        case EVENT_KEY:
+            // 最高位为 GameStream 协议要求的虚拟键码前缀
+            LiSendKeyboardEvent2((short)(0x8000 | p_event.key_code), p_event.pressed ? KEY_ACTION_DOWN : KEY_ACTION_UP,
+                    (char)p_event.modifiers, (char)p_event.key_flags);
+            return 1;
+        case EVENT_TEXT:
+            LiSendUtf8TextEvent(p_event.text.data(), (unsigned int)p_event.text.size());
+            return 1;
+        case EVENT_TOUCH: {
+            if (touch_supported) {
+                int err = LiSendTouchEvent(p_event.touch_type, p_event.pointer_id, p_event.x, p_event.y,
+                        p_event.pressure, 0.0f, 0.0f, LI_ROT_UNKNOWN);
+                if (err != LI_ERR_UNSUPPORTED) {
+                    return 1;
+                }
+                touch_supported = false;
+            }
+            // 只用第一个按下的触点模拟鼠标
+            if (p_event.touch_type == LI_TOUCH_EVENT_DOWN && !emulated_button_down) {
+                emulated_pointer = p_event.pointer_id;
+            } else if (p_event.pointer_id != emulated_pointer) {
+                return 0;
+            }
+            bool up = p_event.touch_type == LI_TOUCH_EVENT_UP || p_event.touch_type == LI_TOUCH_EVENT_CANCEL ||
+                    p_event.touch_type == LI_TOUCH_EVENT_CANCEL_ALL;
+            return _emulate_pointer(p_event, p_event.touch_type == LI_TOUCH_EVENT_DOWN, up);
+        }
+        case EVENT_PEN: {
+            if (pen_supported) {
+                int err = LiSendPenEvent(p_event.touch_type, p_event.tool_type, p_event.pen_buttons, p_event.x, p_event.y,
+                        p_event.pressure, 0.0f, 0.0f, p_event.rotation, p_event.tilt);
+                if (err != LI_ERR_UNSUPPORTED) {
+                    return 1;
+                }
+                pen_supported = false;
+            }
+            bool up = p_event.touch_type == LI_TOUCH_EVENT_UP || p_event.touch_type == LI_TOUCH_EVENT_CANCEL ||
+                    p_event.touch_type == LI_TOUCH_EVENT_CANCEL_ALL;
+            return _emulate_pointer(p_event, p_event.touch_type == LI_TOUCH_EVENT_DOWN, up);
+        }
+    }
+    return 0;
+}
+
+int InputSender::_send_mouse_position(const Event &p_event) {
+    if (p_event.reference_width <= 0 || p_event.reference_height <= 0) {
+        return 0;
+    }
+    // 坐标以串流分辨率为参考，主机端按实际桌面分辨率缩放
+    short x = (short)std::clamp((int)std::lround(p_event.x * (p_event.reference_width - 1)), 0, 32767);
+    short y = (short)std::clamp((int)std::lround(p_event.y * (p_event.reference_height - 1)), 0, 32767);
+    LiSendMousePositionEvent(x, y, (short)std::min(p_event.reference_width, 32767), (short)std::min(p_event.reference_height, 32767));
+    return 1;
+}
+
+int InputSender::_emulate_pointer(const Event &p_event, bool p_down, bool p_up) {
+    if (p_event.touch_type == LI_TOUCH_EVENT_HOVER_LEAVE) {
+        return 0;
+    }
+    int sent = _send_mouse_position(p_event);
+    if (p_down && !emulated_button_down) {
+        LiSendMouseButtonEvent(BUTTON_ACTION_PRESS, BUTTON_LEFT);
+        emulated_button_down = true;
+        sent++;
+    } else if (p_up && emulated_button_down) {
+        LiSendMouseButtonEvent(BUTTON_ACTION_RELEASE, BUTTON_LEFT);
+        emulated_button_down = false;
+        sent++;
+    }
+    return sent;
+}
+
+int InputSender::_send_mouse_motion(float delta_x, float delta_y) {
+    // 亚像素的移动累积到下一次发送
+    float total_x = delta_x + remainder_x;
+    float total_y = delta_y + remainder_y;
+    int move_x = (int)std::trunc(total_x);
+    int move_y = (int)std::trunc(total_y);
+    remainder_x = total_x - move_x;
+    remainder_y = total_y - move_y;
+
+    int sent = 0;
+    while (move_x != 0 || move_y != 0) {
+        short step_x = (short)std::clamp(move_x, -32768, 32767);
+        short step_y = (short)std::clamp(move_y, -32768, 32767);
+        LiSendMouseMoveEvent(step_x, step_y);
+        move_x -= step_x;
+        move_y -= step_y;
+        sent++;
+    }
+    return sent;
+}
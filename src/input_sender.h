@@ -0,0 +1,160 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+extern "C" {
+#include "lib/moonlight-common-c/src/Limelight.h"
+}
+
+// 输入发送线程
+// 主线程只把输入事件放入队列，由独立的输入线程调用 LiSend* 发送，输入延迟不受引擎帧率影响。
+//   - 相对鼠标移动：相邻的移动事件合并为一次，每个发送周期 (tick) 最多发送一次
+//   - 滚轮：相邻的滚动合并为一次高精度滚动事件
+//   - 按键/按钮/文本：保持顺序，之前积累的移动先于按钮发送
+//   - 手柄：每个手柄只保留最新状态，与上次发送的状态相同时不发送
+//   - 绝对鼠标位置、触摸/笔的移动与悬停：相邻的同一指针只保留最新位置
+// 主机不支持触摸/笔事件时 (LI_ERR_UNSUPPORTED)，第一个触点与笔改用绝对鼠标位置与左键模拟。
+// LiSend* 本身是线程安全的，Limelight 的输入流会再做一次批量打包。
+class InputSender {
+public:
+    static const int MAX_CONTROLLERS = 16;
+
+    struct ControllerState {
+        int button_flags = 0;
+        uint8_t left_trigger = 0;
+        uint8_t right_trigger = 0;
+        int16_t left_stick_x = 0;
+        int16_t left_stick_y = 0;
+        int16_t right_stick_x = 0;
+        int16_t right_stick_y = 0;
+
+        bool operator==(const ControllerState &p_other) const;
+        bool operator!=(const ControllerState &p_other) const { return !(*this == p_other); }
+    };
+
+    struct Stats {
+        uint64_t queued_events = 0;     // 放入队列的事件数
+        uint64_t sent_events = 0;       // 实际调用 LiSend* 的次数
+        uint64_t coalesced_events = 0;  // 被合并的移动/滚动事件数
+        uint64_t skipped_controller_states = 0; // 与上次相同而未发送的手柄状态
+    };
+
+    InputSender();
+    ~InputSender();
+
+    // tick_interval_us 为两次发送之间的最小间隔
+    void start(int tick_interval_us);
+    void stop();
+    bool is_running() const { return running.load(); }
+
+    void queue_mouse_motion(float delta_x, float delta_y);
+    // button 为 BUTTON_LEFT 等
+    void queue_mouse_button(int button, bool pressed);
+    // amount 以 WHEEL_DELTA (120) 为一格
+    void queue_scroll(int amount, bool horizontal);
+
+    // key_code 为 Windows 虚拟键码，modifiers 为 MODIFIER_* 的组合，flags 为 SS_KBE_FLAG_*
+    void queue_key(uint8_t key_code, bool pressed, uint8_t modifiers, uint8_t flags);
+    void queue_text(const std::string &utf8);
+
+    // 绝对位置均为串流画面内的归一化坐标 (0~1)，reference_width/height 为串流分辨率
+    void queue_mouse_position(float x, float y, int reference_width, int reference_height);
+    // event_type 为 LI_TOUCH_EVENT_*
+    void queue_touch(uint8_t event_type, uint32_t pointer_id, float x, float y, float pressure, int reference_width, int reference_height);
+    // tool_type 为 LI_TOOL_TYPE_*，buttons 为 LI_PEN_BUTTON_* 的组合
+    void queue_pen(uint8_t event_type, uint8_t tool_type, uint8_t buttons, float x, float y, float pressure,
+            uint16_t rotation, uint8_t tilt, int reference_width, int reference_height);
+
+    void set_controller_state(int controller, const ControllerState &state);
+    // 手柄类型与能力 (LI_CTYPE_* / LI_CCAP_*)，在该手柄的第一个状态之前以 arrival 事件发送，
+    // 主机端据此创建对应类型的虚拟手柄
+    void set_controller_info(int controller, uint8_t type, uint16_t capabilities);
+    // 断开的手柄从 activeGamepadMask 中移除，主机端会拔出对应的虚拟手柄
+    void set_controller_connected(int controller, bool connected);
+    void clear_controllers();
+
+    Stats get_stats();
+
+private:
+    enum EventType {
+        EVENT_MOUSE_MOVE,
+        EVENT_MOUSE_BUTTON,
+        EVENT_SCROLL,
+        EVENT_HSCROLL,
+        EVENT_MOUSE_POSITION,
+        EVENT_TOUCH,
+        EVENT_PEN,
+        EVENT_KEY,
+        EVENT_TEXT,
+    };
+
+    struct Event {
+        EventType type;
+        float x = 0.0f;
+        float y = 0.0f;
+        int button = 0;
+        int amount = 0;
+        bool pressed = false;
+
+        // 绝对位置事件
+        int reference_width = 0;
+        int reference_height = 0;
+        uint8_t touch_type = 0;
+        uint32_t pointer_id = 0;
+        float pressure = 0.0f;
+        uint8_t tool_type = 0;
+        uint8_t pen_buttons = 0;
+        uint16_t rotation = LI_ROT_UNKNOWN;
+        uint8_t tilt = LI_TILT_UNKNOWN;
+
+        // 键盘事件
+        uint8_t key_code = 0;
+        uint8_t modifiers = 0;
+        uint8_t key_flags = 0;
+        std::string text;
+    };
+
+    std::thread worker;
+    std::atomic<bool> running{ false };
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool stop_requested = false;
+    int tick_interval_us = 1000;
+
+    // 以下受 mutex 保护
+    std::vector<Event> queue;
+    ControllerState controllers[MAX_CONTROLLERS];
+    uint8_t controller_types[MAX_CONTROLLERS] = {};
+    uint16_t controller_capabilities[MAX_CONTROLLERS] = {};
+    uint16_t active_mask = 0;
+    uint16_t dirty_mask = 0;
+    uint16_t info_mask = 0;     // 已设置类型与能力的手柄
+    uint16_t arrival_mask = 0;  // 等待发送 arrival 事件的手柄
+    Stats stats;
+
+    // 以下仅在输入线程中访问
+    std::vector<Event> sending;
+    ControllerState sent_controllers[MAX_CONTROLLERS];
+    uint16_t sent_mask = 0;
+    float remainder_x = 0.0f;
+    float remainder_y = 0.0f;
+    bool touch_supported = true;
+    bool pen_supported = true;
+    bool emulated_button_down = false;
+    uint32_t emulated_pointer = 0;
+
+    bool _has_work() const { return !queue.empty() || dirty_mask != 0; }
+    bool _coalesce_position(const Event &p_event);
+    void _push_event(const Event &p_event);
+    void _run();
+    int _send_event(const Event &p_event);
+    int _send_mouse_motion(float delta_x, float delta_y);
+    int _send_mouse_position(const Event &p_event);
+    int _emulate_pointer(const Event &p_event, bool p_down, bool p_up);
+};
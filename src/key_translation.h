@@ -0,0 +1,173 @@
+#pragma once
+
+#include <godot_cpp/classes/global_constants.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Godot Key -> Windows 虚拟键码 (GameStream 键盘事件使用的键码)
+// 查找表在编译期生成：可打印字符按 ASCII 直接索引，特殊键 (KEY_SPECIAL | n) 按低 8 位索引，
+// 每次按键只需一次数组访问。物理键码 (physical_keycode) 与键码使用同一套 Key 值，
+// 对应美式布局的按键位置，因此同一张表也用于与布局无关的模式。
+namespace key_translation {
+
+struct KeyMapping {
+    uint64_t key;
+    uint8_t virtual_key;
+};
+
+// 左侧修饰键；右侧的修饰键按 InputEventKey 的 location 加 1 (VK_RSHIFT 等)
+constexpr uint8_t VK_LSHIFT = 0xA0;
+constexpr uint8_t VK_LCONTROL = 0xA2;
+constexpr uint8_t VK_LMENU = 0xA4;
+constexpr uint8_t VK_LWIN = 0x5B;
+constexpr uint8_t VK_RWIN = 0x5C;
+
+constexpr KeyMapping SPECIAL_KEYS[] = {
+    { godot::KEY_ESCAPE, 0x1B },
+    { godot::KEY_TAB, 0x09 },
+    { godot::KEY_BACKTAB, 0x09 },
+    { godot::KEY_BACKSPACE, 0x08 },
+    { godot::KEY_ENTER, 0x0D },
+    { godot::KEY_KP_ENTER, 0x0D },
+    { godot::KEY_INSERT, 0x2D },
+    { godot::KEY_DELETE, 0x2E },
+    { godot::KEY_PAUSE, 0x13 },
+    { godot::KEY_PRINT, 0x2C },
+    { godot::KEY_SYSREQ, 0x2C },
+    { godot::KEY_CLEAR, 0x0C },
+    { godot::KEY_HOME, 0x24 },
+    { godot::KEY_END, 0x23 },
+    { godot::KEY_LEFT, 0x25 },
+    { godot::KEY_UP, 0x26 },
+    { godot::KEY_RIGHT, 0x27 },
+    { godot::KEY_DOWN, 0x28 },
+    { godot::KEY_PAGEUP, 0x21 },
+    { godot::KEY_PAGEDOWN, 0x22 },
+    { godot::KEY_SHIFT, VK_LSHIFT },
+    { godot::KEY_CTRL, VK_LCONTROL },
+    { godot::KEY_META, VK_LWIN },
+    { godot::KEY_ALT, VK_LMENU },
+    { godot::KEY_CAPSLOCK, 0x14 },
+    { godot::KEY_NUMLOCK, 0x90 },
+    { godot::KEY_SCROLLLOCK, 0x91 },
+    { godot::KEY_F1, 0x70 },
+    { godot::KEY_F2, 0x71 },
+    { godot::KEY_F3, 0x72 },
+    { godot::KEY_F4, 0x73 },
+    { godot::KEY_F5, 0x74 },
+    { godot::KEY_F6, 0x75 },
+    { godot::KEY_F7, 0x76 },
+    { godot::KEY_F8, 0x77 },
+    { godot::KEY_F9, 0x78 },
+    { godot::KEY_F10, 0x79 },
+    { godot::KEY_F11, 0x7A },
+    { godot::KEY_F12, 0x7B },
+    { godot::KEY_F13, 0x7C },
+    { godot::KEY_F14, 0x7D },
+    { godot::KEY_F15, 0x7E },
+    { godot::KEY_F16, 0x7F },
+    { godot::KEY_F17, 0x80 },
+    { godot::KEY_F18, 0x81 },
+    { godot::KEY_F19, 0x82 },
+    { godot::KEY_F20, 0x83 },
+    { godot::KEY_F21, 0x84 },
+    { godot::KEY_F22, 0x85 },
+    { godot::KEY_F23, 0x86 },
+    { godot::KEY_F24, 0x87 },
+    { godot::KEY_KP_MULTIPLY, 0x6A },
+    { godot::KEY_KP_DIVIDE, 0x6F },
+    { godot::KEY_KP_SUBTRACT, 0x6D },
+    { godot::KEY_KP_PERIOD, 0x6E },
+    { godot::KEY_KP_ADD, 0x6B },
+    { godot::KEY_KP_0, 0x60 },
+    { godot::KEY_KP_1, 0x61 },
+    { godot::KEY_KP_2, 0x62 },
+    { godot::KEY_KP_3, 0x63 },
+    { godot::KEY_KP_4, 0x64 },
+    { godot::KEY_KP_5, 0x65 },
+    { godot::KEY_KP_6, 0x66 },
+    { godot::KEY_KP_7, 0x67 },
+    { godot::KEY_KP_8, 0x68 },
+    { godot::KEY_KP_9, 0x69 },
+    { godot::KEY_MENU, 0x5D },
+    { godot::KEY_BACK, 0xA6 },
+    { godot::KEY_FORWARD, 0xA7 },
+    { godot::KEY_REFRESH, 0xA8 },
+    { godot::KEY_STOP, 0xA9 },
+    { godot::KEY_SEARCH, 0xAA },
+    { godot::KEY_FAVORITES, 0xAB },
+    { godot::KEY_HOMEPAGE, 0xAC },
+    { godot::KEY_VOLUMEMUTE, 0xAD },
+    { godot::KEY_VOLUMEDOWN, 0xAE },
+    { godot::KEY_VOLUMEUP, 0xAF },
+    { godot::KEY_MEDIANEXT, 0xB0 },
+    { godot::KEY_MEDIAPREVIOUS, 0xB1 },
+    { godot::KEY_MEDIASTOP, 0xB2 },
+    { godot::KEY_MEDIAPLAY, 0xB3 },
+    { godot::KEY_LAUNCHMAIL, 0xB4 },
+    { godot::KEY_LAUNCHMEDIA, 0xB5 },
+    { godot::KEY_STANDBY, 0x5F },
+};
+
+// 可打印字符中位置固定的符号键 (美式布局的 VK_OEM_*)
+constexpr KeyMapping PRINTABLE_KEYS[] = {
+    { godot::KEY_SPACE, 0x20 },
+    { godot::KEY_SEMICOLON, 0xBA },
+    { godot::KEY_EQUAL, 0xBB },
+    { godot::KEY_COMMA, 0xBC },
+    { godot::KEY_MINUS, 0xBD },
+    { godot::KEY_PERIOD, 0xBE },
+    { godot::KEY_SLASH, 0xBF },
+    { godot::KEY_QUOTELEFT, 0xC0 },
+    { godot::KEY_BRACKETLEFT, 0xDB },
+    { godot::KEY_BACKSLASH, 0xDC },
+    { godot::KEY_BRACKETRIGHT, 0xDD },
+    { godot::KEY_APOSTROPHE, 0xDE },
+};
+
+constexpr size_t SPECIAL_TABLE_SIZE = 0x100;
+constexpr size_t PRINTABLE_TABLE_SIZE = 0x80;
+
+constexpr std::array<uint8_t, SPECIAL_TABLE_SIZE> build_special_table() {
+    std::array<uint8_t, SPECIAL_TABLE_SIZE> table = {};
+    for (const KeyMapping &mapping : SPECIAL_KEYS) {
+        table[mapping.key & (SPECIAL_TABLE_SIZE - 1)] = mapping.virtual_key;
+    }
+    return table;
+}
+
+constexpr std::array<uint8_t, PRINTABLE_TABLE_SIZE> build_printable_table() {
+    std::array<uint8_t, PRINTABLE_TABLE_SIZE> table = {};
+    // 字母与数字的虚拟键码与大写 ASCII 相同
+    for (uint8_t c = '0'; c <= '9'; c++) {
+        table[c] = c;
+    }
+    for (uint8_t c = 'A'; c <= 'Z'; c++) {
+        table[c] = c;
+        table[c - 'A' + 'a'] = c;
+    }
+    for (const KeyMapping &mapping : PRINTABLE_KEYS) {
+        table[mapping.key] = mapping.virtual_key;
+    }
+    return table;
+}
+
+constexpr std::array<uint8_t, SPECIAL_TABLE_SIZE> SPECIAL_TABLE = build_special_table();
+constexpr std::array<uint8_t, PRINTABLE_TABLE_SIZE> PRINTABLE_TABLE = build_printable_table();
+
+// 返回 0 表示没有对应的虚拟键码 (例如非美式布局的字符，应改用文本事件发送)
+constexpr uint8_t to_virtual_key(uint64_t key) {
+    if (key & godot::KEY_SPECIAL) {
+        uint64_t index = key & ~(uint64_t)godot::KEY_SPECIAL;
+        return index < SPECIAL_TABLE_SIZE ? SPECIAL_TABLE[index] : 0;
+    }
+    return key < PRINTABLE_TABLE_SIZE ? PRINTABLE_TABLE[key] : 0;
+}
+
+static_assert(to_virtual_key(godot::KEY_A) == 0x41, "letters map to their uppercase ASCII code");
+static_assert(to_virtual_key(godot::KEY_ESCAPE) == 0x1B, "special keys are indexed by their low bits");
+static_assert(to_virtual_key(godot::KEY_KP_9) == 0x69, "keypad keys fit in the special table");
+
+} // namespace key_translation
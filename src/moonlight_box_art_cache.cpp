@@ -0,0 +1,628 @@
+#include "moonlight_box_art_cache.h"
+
+#include <godot_cpp/classes/dir_access.hpp>
+#include <godot_cpp/classes/file_access.hpp>
+#include <godot_cpp/classes/rendering_server.hpp>
+#include <godot_cpp/core/class_db.hpp>
+#include <godot_cpp/variant/utility_functions.hpp>
+
+#include "host/app_list_tracker.h"
+#include "host/server_info.h"
+
+#include <cstring>
+
+// 与 boxartmanager.cpp 一致：4 个线程既能较快加载大量封面，又不会让主机同时处理太多请求
+static const int WORKER_COUNT = 4;
+static const int REQUEST_TIMEOUT_MS = 5000;
+
+// 变体文件：魔数 + 版本 + 宽 + 高 + 格式 + 是否有 mipmap + 数据长度 + 原始像素数据
+static const uint32_t VARIANT_MAGIC = 0x41424C4D; // "MLBA"
+static const uint32_t VARIANT_VERSION = 1;
+
+void MoonlightBoxArtCache::_bind_methods() {
+    ClassDB::bind_method(D_METHOD("get_box_art", "host_uuid", "app_id", "client", "address", "https_port", "max_size"), &MoonlightBoxArtCache::get_box_art, DEFVAL(0));
+    ClassDB::bind_method(D_METHOD("has_box_art", "host_uuid", "app_id", "max_size"), &MoonlightBoxArtCache::has_box_art, DEFVAL(0));
+    ClassDB::bind_method(D_METHOD("clear_memory_cache"), &MoonlightBoxArtCache::clear_memory_cache);
+    ClassDB::bind_method(D_METHOD("delete_host_box_art", "host_uuid"), &MoonlightBoxArtCache::delete_host_box_art);
+
+    ClassDB::bind_method(D_METHOD("set_memory_budget_mb", "mb"), &MoonlightBoxArtCache::set_memory_budget_mb);
+    ClassDB::bind_method(D_METHOD("get_memory_budget_mb"), &MoonlightBoxArtCache::get_memory_budget_mb);
+    ClassDB::bind_method(D_METHOD("set_max_uploads_per_frame", "count"), &MoonlightBoxArtCache::set_max_uploads_per_frame);
+    ClassDB::bind_method(D_METHOD("get_max_uploads_per_frame"), &MoonlightBoxArtCache::get_max_uploads_per_frame);
+    ClassDB::bind_method(D_METHOD("get_memory_usage"), &MoonlightBoxArtCache::get_memory_usage);
+    ADD_PROPERTY(PropertyInfo(Variant::INT, "memory_budget_mb"), "set_memory_budget_mb", "get_memory_budget_mb");
+    ADD_PROPERTY(PropertyInfo(Variant::INT, "max_uploads_per_frame"), "set_max_uploads_per_frame", "get_max_uploads_per_frame");
+
+    ClassDB::bind_method(D_METHOD("set_thumbnail_sizes", "sizes"), &MoonlightBoxArtCache::set_thumbnail_sizes);
+    ClassDB::bind_method(D_METHOD("get_thumbnail_sizes"), &MoonlightBoxArtCache::get_thumbnail_sizes);
+    ClassDB::bind_method(D_METHOD("set_compress_thumbnails", "enabled"), &MoonlightBoxArtCache::set_compress_thumbnails);
+    ClassDB::bind_method(D_METHOD("is_compressing_thumbnails"), &MoonlightBoxArtCache::is_compressing_thumbnails);
+    ADD_PROPERTY(PropertyInfo(Variant::PACKED_INT32_ARRAY, "thumbnail_sizes"), "set_thumbnail_sizes", "get_thumbnail_sizes");
+    ADD_PROPERTY(PropertyInfo(Variant::BOOL, "compress_thumbnails"), "set_compress_thumbnails", "is_compressing_thumbnails");
+
+    ADD_SIGNAL(MethodInfo("box_art_loaded", PropertyInfo(Variant::STRING, "host_uuid"), PropertyInfo(Variant::INT, "app_id"), PropertyInfo(Variant::INT, "max_size"), PropertyInfo(Variant::OBJECT, "texture", PROPERTY_HINT_RESOURCE_TYPE, "Texture2D")));
+    ADD_SIGNAL(MethodInfo("box_art_failed", PropertyInfo(Variant::STRING, "host_uuid"), PropertyInfo(Variant::INT, "app_id")));
+}
+
+MoonlightBoxArtCache::MoonlightBoxArtCache() {
+    set_process_internal(true);
+}
+
+MoonlightBoxArtCache::~MoonlightBoxArtCache() {
+    _stop_workers();
+}
+
+void MoonlightBoxArtCache::_notification(int p_what) {
+    switch (p_what) {
+        case NOTIFICATION_INTERNAL_PROCESS: {
+            if (results_pending.load(std::memory_order_acquire)) {
+                _dispatch_results();
+            }
+            if (!identity_pending_jobs.empty()) {
+                _requeue_identity_pending();
+            }
+        } break;
+        case NOTIFICATION_EXIT_TREE: {
+            _stop_workers();
+            // 未完成的请求已被丢弃，允许重新进入场景树后再次请求
+            identity_pending_jobs.clear();
+            in_flight.clear();
+        } break;
+    }
+}
+
+std::string MoonlightBoxArtCache::_make_key(const String &p_host_uuid, int p_app_id, int p_size) {
+    return std::string(p_host_uuid.utf8().get_data()) + "/" + std::to_string(p_app_id) + "/" + std::to_string(p_size);
+}
+
+// 选择不小于 p_max_size 的最小变体尺寸；没有合适的变体时使用原图 (0)
+int MoonlightBoxArtCache::_select_size(int p_max_size) const {
+    if (p_max_size <= 0) {
+        return 0;
+    }
+    int selected = 0;
+    for (int size : thumbnail_sizes) {
+        if (size >= p_max_size && (selected == 0 || size < selected)) {
+            selected = size;
+        }
+    }
+    return selected;
+}
+
+void MoonlightBoxArtCache::_detect_compress_mode() {
+    compress_mode_detected = true;
+    compress_mode = -1;
+    compress_suffix = String();
+    RenderingServer *rs = RenderingServer::get_singleton();
+    if (!compress_thumbnails || rs == nullptr) {
+        return;
+    }
+    // 桌面 GPU 使用 BCn，移动 GPU 使用 ETC2
+    if (rs->has_os_feature("s3tc")) {
+        compress_mode = Image::COMPRESS_S3TC;
+        compress_suffix = "bc";
+    } else if (rs->has_os_feature("etc2")) {
+        compress_mode = Image::COMPRESS_ETC2;
+        compress_suffix = "etc2";
+    }
+}
+
+// --- 工作线程 ---
+
+void MoonlightBoxArtCache::_start_workers() {
+    std::lock_guard<std::mutex> lock(job_mutex);
+    if (workers_running) {
+        return;
+    }
+    workers_running = true;
+    cancel_requests.store(false, std::memory_order_relaxed);
+    for (int i = 0; i < WORKER_COUNT; i++) {
+        workers.emplace_back(&MoonlightBoxArtCache::_worker_loop, this);
+    }
+}
+
+void MoonlightBoxArtCache::_stop_workers() {
+    {
+        std::lock_guard<std::mutex> lock(job_mutex);
+        if (!workers_running) {
+            return;
+        }
+        workers_running = false;
+        jobs.clear();
+    }
+    cancel_requests.store(true, std::memory_order_relaxed);
+    job_cv.notify_all();
+    for (std::thread &worker : workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+    workers.clear();
+
+    std::lock_guard<std::mutex> lock(result_mutex);
+    results.clear();
+    results_pending.store(false, std::memory_order_release);
+}
+
+void MoonlightBoxArtCache::_worker_loop() {
+    while (true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(job_mutex);
+            job_cv.wait(lock, [this] { return !workers_running || !jobs.empty(); });
+            if (!workers_running) {
+                return;
+            }
+            // 后进先出：滚动列表时优先加载最新可见的封面
+            job = std::move(jobs.back());
+            jobs.pop_back();
+        }
+
+        Result result;
+        result.key = job.key;
+        result.host_uuid = job.host_uuid;
+        result.app_id = job.app_id;
+        result.size = job.size;
+        result.image = _load(job, &result.identity_pending);
+        if (result.identity_pending) {
+            result.job = std::move(job);
+        }
+
+        std::lock_guard<std::mutex> lock(result_mutex);
+        results.push_back(std::move(result));
+        results_pending.store(true, std::memory_order_release);
+    }
+}
+
+String MoonlightBoxArtCache::_host_dir(const String &p_host_uuid) const {
+    return cache_dir.path_join(p_host_uuid.validate_filename());
+}
+
+std::unordered_map<int, String> &MoonlightBoxArtCache::_get_disk_index(const String &p_host_uuid) {
+    // 调用方持有 disk_mutex
+    std::string host_key = p_host_uuid.utf8().get_data();
+    auto it = disk_index.find(host_key);
+    if (it != disk_index.end()) {
+        return it->second;
+    }
+
+    std::unordered_map<int, String> &index = disk_index[host_key];
+    // 文件名：<appId>.<内容哈希>.<扩展名>
+    PackedStringArray files = DirAccess::get_files_at(_host_dir(p_host_uuid));
+    for (int64_t i = 0; i < files.size(); i++) {
+        const String &file = files[i];
+        PackedStringArray parts = file.split(".");
+        if (parts.size() == 3 && parts[0].is_valid_int() && !file.ends_with(".tmp")) {
+            index[(int)parts[0].to_int()] = file;
+        }
+    }
+    return index;
+}
+
+String MoonlightBoxArtCache::_find_original(const Job &p_job) {
+    std::lock_guard<std::mutex> lock(disk_mutex);
+    std::unordered_map<int, String> &index = _get_disk_index(p_job.host_uuid);
+    auto it = index.find(p_job.app_id);
+    return it == index.end() ? String() : it->second;
+}
+
+Ref<Image> MoonlightBoxArtCache::_load(const Job &p_job, bool *r_identity_pending) {
+    String dir = _host_dir(p_job.host_uuid);
+    String original = _find_original(p_job);
+
+    // 已生成的变体直接加载，不需要解码
+    if (p_job.size > 0 && !original.is_empty()) {
+        Ref<Image> variant = _load_variant(dir.path_join(_variant_file_name(original, p_job.size, p_job.compress_suffix)));
+        if (variant.is_valid()) {
+            return variant;
+        }
+    }
+
+    Ref<Image> image;
+    if (!original.is_empty()) {
+        String path = dir.path_join(original);
+        image = _decode(FileAccess::get_file_as_bytes(path));
+        if (image.is_null()) {
+            // 文件损坏，删除后从网络重新获取
+            DirAccess::remove_absolute(path);
+            std::lock_guard<std::mutex> lock(disk_mutex);
+            _get_disk_index(p_job.host_uuid).erase(p_job.app_id);
+            original = String();
+        }
+    }
+    if (image.is_null() && p_job.client.is_valid()) {
+        Error identity_error;
+        HttpConnectionPool &pool = p_job.client->get_pool(&identity_error);
+        if (identity_error == ERR_BUSY) {
+            // 首次启动时身份仍在生成：没有客户端证书的请求会被主机拒绝，等身份就绪后重新加载
+            *r_identity_pending = true;
+            return Ref<Image>();
+        }
+        // 身份生成失败时无法访问主机，只使用磁盘缓存
+        if (identity_error == OK) {
+            image = _load_from_network(p_job, pool, &original);
+            if (image.is_null() && !cancel_requests.load(std::memory_order_relaxed)) {
+                // 失败时再试一次 (与 boxartmanager.cpp 一致)
+                image = _load_from_network(p_job, pool, &original);
+            }
+        }
+    }
+    if (image.is_null()) {
+        return image;
+    }
+
+    // 入库：生成所有尚不存在的变体
+    Ref<Image> requested = image;
+    for (int size : p_job.sizes) {
+        String path = dir.path_join(_variant_file_name(original, size, p_job.compress_suffix));
+        if (size != p_job.size && FileAccess::file_exists(path)) {
+            continue;
+        }
+        Ref<Image> variant = _make_variant(image, size, p_job.compress_mode);
+        if (!original.is_empty()) {
+            _save_variant(path, variant);
+        }
+        if (size == p_job.size) {
+            requested = variant;
+        }
+    }
+    return requested;
+}
+
+Ref<Image> MoonlightBoxArtCache::_load_from_network(const Job &p_job, HttpConnectionPool &p_pool, String *r_file_name) {
+    std::string path = build_gamestream_path("appasset", "appid=" + std::to_string(p_job.app_id) + "&AssetType=2&AssetIdx=0");
+    net::HttpResponse response = p_pool.get(p_job.address, p_job.https_port, path, true, REQUEST_TIMEOUT_MS, &cancel_requests);
+    if (!response.error.empty() || response.status_code != 200 || response.body.empty()) {
+        return Ref<Image>();
+    }
+
+    PackedByteArray data;
+    data.resize((int64_t)response.body.size());
+    memcpy(data.ptrw(), response.body.data(), response.body.size());
+
+    Ref<Image> image = _decode(data);
+    if (image.is_valid()) {
+        // 保存原始字节，不重新编码
+        *r_file_name = _save_original(p_job, data);
+    }
+    return image;
+}
+
+String MoonlightBoxArtCache::_save_original(const Job &p_job, const PackedByteArray &p_data) {
+    String dir = _host_dir(p_job.host_uuid);
+    DirAccess::make_dir_recursive_absolute(dir);
+
+    bool png = p_data.size() > 4 && p_data[0] == 0x89 && p_data[1] == 'P';
+    uint64_t hash = AppListTracker::hash_content((const char *)p_data.ptr(), (size_t)p_data.size());
+    String file_name = String::num_int64(p_job.app_id) + "." + String::num_uint64(hash, 16) + (png ? ".png" : ".jpg");
+    String path = dir.path_join(file_name);
+
+    // 先写临时文件再重命名，避免中断时留下不完整的缓存
+    String temp_path = path + ".tmp";
+    Ref<FileAccess> file = FileAccess::open(temp_path, FileAccess::WRITE);
+    if (file.is_null()) {
+        return String();
+    }
+    file->store_buffer(p_data);
+    file->close();
+    if (DirAccess::rename_absolute(temp_path, path) != OK) {
+        DirAccess::remove_absolute(temp_path);
+        return String();
+    }
+
+    std::lock_guard<std::mutex> lock(disk_mutex);
+    std::unordered_map<int, String> &index = _get_disk_index(p_job.host_uuid);
+    auto it = index.find(p_job.app_id);
+    if (it != index.end() && it->second != file_name) {
+        // 封面内容变化：删除旧原图及其所有变体
+        String old_stem = it->second.get_basename() + ".";
+        PackedStringArray files = DirAccess::get_files_at(dir);
+        for (int64_t i = 0; i < files.size(); i++) {
+            if (files[i].begins_with(old_stem)) {
+                DirAccess::remove_absolute(dir.path_join(files[i]));
+            }
+        }
+    }
+    index[p_job.app_id] = file_name;
+    return file_name;
+}
+
+Ref<Image> MoonlightBoxArtCache::_decode(const PackedByteArray &p_data) {
+    if (p_data.size() < 4) {
+        return Ref<Image>();
+    }
+    Ref<Image> image;
+    image.instantiate();
+    Error err;
+    if (p_data[0] == 0x89 && p_data[1] == 'P') {
+        err = image->load_png_from_buffer(p_data);
+    } else if (p_data[0] == 0xFF && p_data[1] == 0xD8) {
+        err = image->load_jpg_from_buffer(p_data);
+    } else {
+        err = ERR_FILE_UNRECOGNIZED;
+    }
+    if (err != OK || image->is_empty()) {
+        return Ref<Image>();
+    }
+    return image;
+}
+
+// "12.abcd.png" -> "12.abcd.256.tex" / "12.abcd.256bc.tex"
+String MoonlightBoxArtCache::_variant_file_name(const String &p_original, int p_size, const String &p_suffix) {
+    return p_original.get_basename() + "." + String::num_int64(p_size) + p_suffix + ".tex";
+}
+
+Ref<Image> MoonlightBoxArtCache::_make_variant(const Ref<Image> &p_image, int p_size, int p_compress_mode) {
+    Ref<Image> variant = Image::create_from_data(p_image->get_width(), p_image->get_height(), false, p_image->get_format(), p_image->get_data());
+    if (variant->get_format() != Image::FORMAT_RGBA8 && variant->get_format() != Image::FORMAT_RGB8) {
+        variant->convert(Image::FORMAT_RGBA8);
+    }
+
+    // 按最长边缩小，只缩不放
+    int width = variant->get_width();
+    int height = variant->get_height();
+    int longest = MAX(width, height);
+    if (longest > p_size) {
+        width = MAX(1, width * p_size / longest);
+        height = MAX(1, height * p_size / longest);
+    }
+    // 块压缩格式以 4x4 为单位
+    if (p_compress_mode >= 0) {
+        width = MAX(4, (width + 3) & ~3);
+        height = MAX(4, (height + 3) & ~3);
+    }
+    if (width != variant->get_width() || height != variant->get_height()) {
+        variant->resize(width, height, Image::INTERPOLATE_LANCZOS);
+    }
+
+    // 网格中的封面经常以小于变体的尺寸显示，mipmap 避免缩小时闪烁
+    variant->generate_mipmaps();
+    if (p_compress_mode >= 0 && variant->compress((Image::CompressMode)p_compress_mode, Image::COMPRESS_SOURCE_SRGB) != OK) {
+        // 导出模板可能未包含压缩器，此时保留未压缩的变体
+        UtilityFunctions::push_warning("MoonlightBoxArtCache: thumbnail compression is unavailable, keeping uncompressed variant");
+    }
+    return variant;
+}
+
+Ref<Image> MoonlightBoxArtCache::_load_variant(const String &p_path) {
+    Ref<FileAccess> file = FileAccess::open(p_path, FileAccess::READ);
+    if (file.is_null()) {
+        return Ref<Image>();
+    }
+    if (file->get_32() != VARIANT_MAGIC || file->get_32() != VARIANT_VERSION) {
+        return Ref<Image>();
+    }
+    int width = (int)file->get_32();
+    int height = (int)file->get_32();
+    Image::Format format = (Image::Format)file->get_32();
+    bool mipmaps = file->get_32() != 0;
+    uint64_t length = file->get_64();
+    if (width <= 0 || height <= 0 || format >= Image::FORMAT_MAX || length != file->get_length() - file->get_position()) {
+        return Ref<Image>();
+    }
+    PackedByteArray data = file->get_buffer((int64_t)length);
+    if ((uint64_t)data.size() != length) {
+        return Ref<Image>();
+    }
+    Ref<Image> image = Image::create_from_data(width, height, mipmaps, format, data);
+    if (image.is_null() || image->is_empty()) {
+        return Ref<Image>();
+    }
+    return image;
+}
+
+void MoonlightBoxArtCache::_save_variant(const String &p_path, const Ref<Image> &p_image) {
+    String temp_path = p_path + ".tmp";
+    Ref<FileAccess> file = FileAccess::open(temp_path, FileAccess::WRITE);
+    if (file.is_null()) {
+        return;
+    }
+    PackedByteArray data = p_image->get_data();
+    file->store_32(VARIANT_MAGIC);
+    file->store_32(VARIANT_VERSION);
+    file->store_32((uint32_t)p_image->get_width());
+    file->store_32((uint32_t)p_image->get_height());
+    file->store_32((uint32_t)p_image->get_format());
+    file->store_32(p_image->has_mipmaps() ? 1 : 0);
+    file->store_64((uint64_t)data.size());
+    file->store_buffer(data);
+    file->close();
+    if (DirAccess::rename_absolute(temp_path, p_path) != OK) {
+        DirAccess::remove_absolute(temp_path);
+    }
+}
+
+// --- 主线程 ---
+
+void MoonlightBoxArtCache::_dispatch_results() {
+    // 每帧只创建有限数量的纹理，避免一次性上传大量封面造成卡顿
+    std::vector<Result> ready;
+    {
+        std::lock_guard<std::mutex> lock(result_mutex);
+        while (!results.empty() && (int)ready.size() < max_uploads_per_frame) {
+            ready.push_back(std::move(results.front()));
+            results.pop_front();
+        }
+        results_pending.store(!results.empty(), std::memory_order_release);
+    }
+
+    for (Result &result : ready) {
+        if (result.identity_pending) {
+            identity_pending_jobs.push_back(std::move(result.job));
+            continue;
+        }
+        in_flight.erase(result.key);
+        if (result.image.is_null()) {
+            emit_signal("box_art_failed", result.host_uuid, result.app_id);
+            continue;
+        }
+        Ref<ImageTexture> texture = ImageTexture::create_from_image(result.image);
+        _lru_insert(result.key, texture, result.image->get_data().size());
+        emit_signal("box_art_loaded", result.host_uuid, result.app_id, result.size, texture);
+    }
+}
+
+// 客户端身份就绪 (或确定生成失败) 后把等待中的任务重新交给工作线程
+void MoonlightBoxArtCache::_requeue_identity_pending() {
+    Error identity_error;
+    identity_pending_jobs.front().client->get_pool(&identity_error);
+    if (identity_error == ERR_BUSY) {
+        return;
+    }
+    _start_workers();
+    {
+        std::lock_guard<std::mutex> lock(job_mutex);
+        for (Job &job : identity_pending_jobs) {
+            jobs.push_back(std::move(job));
+        }
+    }
+    identity_pending_jobs.clear();
+    job_cv.notify_all();
+}
+
+void MoonlightBoxArtCache::_lru_insert(const std::string &p_key, const Ref<ImageTexture> &p_texture, int64_t p_bytes) {
+    auto it = lru_index.find(p_key);
+    if (it != lru_index.end()) {
+        memory_bytes -= it->second->bytes;
+        lru.erase(it->second);
+        lru_index.erase(it);
+    }
+
+    LruEntry entry;
+    entry.key = p_key;
+    entry.texture = p_texture;
+    // 按实际像素数据大小计算 (压缩格式与 mipmap 都会影响)
+    entry.bytes = p_bytes;
+    lru.push_front(entry);
+    lru_index[p_key] = lru.begin();
+    memory_bytes += entry.bytes;
+    _lru_trim();
+}
+
+void MoonlightBoxArtCache::_lru_trim() {
+    // 至少保留最近使用的一项
+    while (memory_bytes > memory_budget_bytes && lru.size() > 1) {
+        LruEntry &victim = lru.back();
+        memory_bytes -= victim.bytes;
+        lru_index.erase(victim.key);
+        lru.pop_back();
+    }
+}
+
+Ref<Texture2D> MoonlightBoxArtCache::get_box_art(const String &p_host_uuid, int p_app_id, const Ref<MoonlightHttpsClient> &p_client, const String &p_address, int p_https_port, int p_max_size) {
+    int size = _select_size(p_max_size);
+    std::string key = _make_key(p_host_uuid, p_app_id, size);
+
+    auto it = lru_index.find(key);
+    if (it != lru_index.end()) {
+        lru.splice(lru.begin(), lru, it->second);
+        return it->second->texture;
+    }
+
+    // 已在加载中的请求直接合并
+    if (!in_flight.insert(key).second) {
+        return Ref<Texture2D>();
+    }
+
+    if (!compress_mode_detected) {
+        _detect_compress_mode();
+    }
+
+    _start_workers();
+    Job job;
+    job.key = key;
+    job.host_uuid = p_host_uuid;
+    job.app_id = p_app_id;
+    job.client = p_client;
+    job.address = p_address.utf8().get_data();
+    job.https_port = p_https_port > 0 && p_https_port <= 65535 ? (uint16_t)p_https_port : GAMESTREAM_DEFAULT_HTTPS_PORT;
+    job.size = size;
+    job.sizes = thumbnail_sizes;
+    job.compress_mode = compress_mode;
+    job.compress_suffix = compress_suffix;
+    {
+        std::lock_guard<std::mutex> lock(job_mutex);
+        jobs.push_back(std::move(job));
+    }
+    job_cv.notify_one();
+    return Ref<Texture2D>();
+}
+
+bool MoonlightBoxArtCache::has_box_art(const String &p_host_uuid, int p_app_id, int p_max_size) const {
+    return lru_index.find(_make_key(p_host_uuid, p_app_id, _select_size(p_max_size))) != lru_index.end();
+}
+
+void MoonlightBoxArtCache::clear_memory_cache() {
+    lru.clear();
+    lru_index.clear();
+    memory_bytes = 0;
+}
+
+void MoonlightBoxArtCache::delete_host_box_art(const String &p_host_uuid) {
+    std::string prefix = std::string(p_host_uuid.utf8().get_data()) + "/";
+    for (auto it = lru.begin(); it != lru.end();) {
+        if (it->key.compare(0, prefix.size(), prefix) == 0) {
+            memory_bytes -= it->bytes;
+            lru_index.erase(it->key);
+            it = lru.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(disk_mutex);
+    String dir = _host_dir(p_host_uuid);
+    PackedStringArray files = DirAccess::get_files_at(dir);
+    for (int64_t i = 0; i < files.size(); i++) {
+        DirAccess::remove_absolute(dir.path_join(files[i]));
+    }
+    DirAccess::remove_absolute(dir);
+    disk_index.erase(p_host_uuid.utf8().get_data());
+}
+
+void MoonlightBoxArtCache::set_memory_budget_mb(int p_mb) {
+    memory_budget_bytes = (int64_t)MAX(p_mb, 1) * 1024 * 1024;
+    _lru_trim();
+}
+
+int MoonlightBoxArtCache::get_memory_budget_mb() const {
+    return (int)(memory_budget_bytes / (1024 * 1024));
+}
+
+void MoonlightBoxArtCache::set_max_uploads_per_frame(int p_count) {
+    max_uploads_per_frame = MAX(p_count, 1);
+}
+
+int MoonlightBoxArtCache::get_max_uploads_per_frame() const {
+    return max_uploads_per_frame;
+}
+
+int MoonlightBoxArtCache::get_memory_usage() const {
+    return (int)memory_bytes;
+}
+
+void MoonlightBoxArtCache::set_thumbnail_sizes(const PackedInt32Array &p_sizes) {
+    thumbnail_sizes.clear();
+    for (int64_t i = 0; i < p_sizes.size(); i++) {
+        if (p_sizes[i] > 0) {
+            thumbnail_sizes.push_back(p_sizes[i]);
+        }
+    }
+}
+
+PackedInt32Array MoonlightBoxArtCache::get_thumbnail_sizes() const {
+    PackedInt32Array sizes;
+    for (int size : thumbnail_sizes) {
+        sizes.append(size);
+    }
+    return sizes;
+}
+
+void MoonlightBoxArtCache::set_compress_thumbnails(bool p_enabled) {
+    compress_thumbnails = p_enabled;
+    compress_mode_detected = false;
+}
+
+bool MoonlightBoxArtCache::is_compressing_thumbnails() const {
+    return compress_thumbnails;
+}
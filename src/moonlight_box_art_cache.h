@@ -0,0 +1,145 @@
+#pragma once
+
+#include <godot_cpp/classes/image.hpp>
+#include <godot_cpp/classes/image_texture.hpp>
+#include <godot_cpp/classes/node.hpp>
+#include <godot_cpp/classes/texture2d.hpp>
+#include <godot_cpp/variant/packed_int32_array.hpp>
+
+#include "moonlight_https_client.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <list>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+using namespace godot;
+
+// 应用封面缓存
+// 三级：内存中按字节数限制的纹理 LRU -> 磁盘缓存 (按主机 uuid、appId 与内容哈希命名) -> 网络 (/appasset)。
+// 磁盘读取、网络请求和 PNG/JPEG 解码都在工作线程中完成，主线程只负责创建纹理；
+// 同一张封面的多个请求会合并为一次加载。
+// 配置 thumbnail_sizes 后，封面入库时会按每个尺寸生成缩小的带 mipmap 变体 (可选 GPU 压缩)，
+// 以原始像素格式保存到磁盘，之后直接加载而无需解码和缩放。
+class MoonlightBoxArtCache : public Node {
+    GDCLASS(MoonlightBoxArtCache, Node)
+
+private:
+    struct Job {
+        std::string key;
+        String host_uuid;
+        int app_id = 0;
+        Ref<MoonlightHttpsClient> client;
+        std::string address;
+        uint16_t https_port = 0;
+        int size = 0;                   // 请求的变体尺寸，0 表示原图
+        std::vector<int> sizes;         // 入库时需要生成的所有变体尺寸
+        int compress_mode = -1;         // Image::CompressMode，-1 表示不压缩
+        String compress_suffix;
+    };
+
+    struct Result {
+        std::string key;
+        String host_uuid;
+        int app_id = 0;
+        int size = 0;
+        Ref<Image> image;
+        // 客户端身份仍在生成，没有发送网络请求；job 交回主线程等待重新排队
+        bool identity_pending = false;
+        Job job;
+    };
+
+    struct LruEntry {
+        std::string key;
+        Ref<ImageTexture> texture;
+        int64_t bytes = 0;
+    };
+
+    // --- 内存 LRU (仅主线程访问) ---
+    std::list<LruEntry> lru;
+    std::unordered_map<std::string, std::list<LruEntry>::iterator> lru_index;
+    int64_t memory_bytes = 0;
+    int64_t memory_budget_bytes = 128 * 1024 * 1024;
+    int max_uploads_per_frame = 4;
+
+    // --- 缩略图变体 (仅主线程访问，随任务复制给工作线程) ---
+    std::vector<int> thumbnail_sizes;
+    bool compress_thumbnails = false;
+    bool compress_mode_detected = false;
+    int compress_mode = -1;
+    String compress_suffix;
+
+    // --- 工作线程 ---
+    std::vector<std::thread> workers;
+    std::mutex job_mutex;
+    std::condition_variable job_cv;
+    std::deque<Job> jobs;
+    bool workers_running = false;
+    // 停止工作线程时置位，中止进行中的网络请求，使退出场景树时不必等待请求超时
+    std::atomic<bool> cancel_requests{ false };
+    // 已排队或正在加载的封面 (主线程访问)，用于合并重复请求
+    std::unordered_set<std::string> in_flight;
+    // 等待客户端身份生成完成的任务 (主线程访问)，仍计入 in_flight
+    std::deque<Job> identity_pending_jobs;
+
+    std::mutex result_mutex;
+    std::deque<Result> results;
+    std::atomic<bool> results_pending{ false };
+
+    String cache_dir = "user://addons/moonlight-godot/boxart";
+    // 磁盘缓存索引：主机 uuid -> appId -> 文件名，每台主机首次访问时扫描一次目录
+    std::mutex disk_mutex;
+    std::unordered_map<std::string, std::unordered_map<int, String>> disk_index;
+
+    static std::string _make_key(const String &p_host_uuid, int p_app_id, int p_size);
+    int _select_size(int p_max_size) const;
+    void _detect_compress_mode();
+    void _start_workers();
+    void _stop_workers();
+    void _worker_loop();
+    String _host_dir(const String &p_host_uuid) const;
+    std::unordered_map<int, String> &_get_disk_index(const String &p_host_uuid);
+    Ref<Image> _load(const Job &p_job, bool *r_identity_pending);
+    String _find_original(const Job &p_job);
+    String _save_original(const Job &p_job, const PackedByteArray &p_data);
+    Ref<Image> _load_from_network(const Job &p_job, HttpConnectionPool &p_pool, String *r_file_name);
+    static Ref<Image> _decode(const PackedByteArray &p_data);
+    static String _variant_file_name(const String &p_original, int p_size, const String &p_suffix);
+    static Ref<Image> _make_variant(const Ref<Image> &p_image, int p_size, int p_compress_mode);
+    static Ref<Image> _load_variant(const String &p_path);
+    static void _save_variant(const String &p_path, const Ref<Image> &p_image);
+    void _dispatch_results();
+    void _requeue_identity_pending();
+    void _lru_insert(const std::string &p_key, const Ref<ImageTexture> &p_texture, int64_t p_bytes);
+    void _lru_trim();
+
+protected:
+    static void _bind_methods();
+    void _notification(int p_what);
+
+public:
+    MoonlightBoxArtCache();
+    ~MoonlightBoxArtCache();
+
+    Ref<Texture2D> get_box_art(const String &p_host_uuid, int p_app_id, const Ref<MoonlightHttpsClient> &p_client, const String &p_address, int p_https_port, int p_max_size = 0);
+    bool has_box_art(const String &p_host_uuid, int p_app_id, int p_max_size = 0) const;
+    void clear_memory_cache();
+    void delete_host_box_art(const String &p_host_uuid);
+
+    void set_memory_budget_mb(int p_mb);
+    int get_memory_budget_mb() const;
+    void set_max_uploads_per_frame(int p_count);
+    int get_max_uploads_per_frame() const;
+    int get_memory_usage() const;
+
+    void set_thumbnail_sizes(const PackedInt32Array &p_sizes);
+    PackedInt32Array get_thumbnail_sizes() const;
+    void set_compress_thumbnails(bool p_enabled);
+    bool is_compressing_thumbnails() const;
+};
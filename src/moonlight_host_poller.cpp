@@ -0,0 +1,362 @@
+#include "moonlight_host_poller.h"
+
+#include <godot_cpp/core/class_db.hpp>
+#include <godot_cpp/variant/utility_functions.hpp>
+
+static Dictionary server_info_to_dictionary(const ServerInfo &info) {
+    Dictionary dict;
+    dict["hostname"] = String::utf8(info.hostname.c_str());
+    dict["uniqueid"] = String::utf8(info.uniqueid.c_str());
+    dict["mac"] = String(info.mac.c_str());
+    dict["state"] = String(info.state.c_str());
+    dict["app_version"] = String(info.app_version.c_str());
+    dict["gfe_version"] = String(info.gfe_version.c_str());
+    dict["gpu_model"] = String::utf8(info.gpu_model.c_str());
+    dict["local_ip"] = String(info.local_ip.c_str());
+    dict["external_ip"] = String(info.external_ip.c_str());
+    dict["https_port"] = info.https_port;
+    dict["external_port"] = info.external_port;
+    dict["server_codec_mode_support"] = info.server_codec_mode_support;
+    dict["max_luma_pixels_hevc"] = info.max_luma_pixels_hevc;
+    dict["current_game"] = info.current_game;
+    dict["paired"] = info.paired;
+    dict["nvidia_server_software"] = info.is_nvidia_server_software();
+
+    Array modes;
+    for (const DisplayMode &mode : info.display_modes) {
+        Dictionary m;
+        m["width"] = mode.width;
+        m["height"] = mode.height;
+        m["refresh_rate"] = mode.refresh_rate;
+        modes.append(m);
+    }
+    dict["display_modes"] = modes;
+    return dict;
+}
+
+static Dictionary app_info_to_dictionary(const AppInfo &app) {
+    Dictionary dict;
+    dict["id"] = app.id;
+    dict["name"] = String::utf8(app.name.c_str());
+    dict["hdr_supported"] = app.hdr_supported;
+    dict["is_app_collector_game"] = app.is_app_collector_game;
+    return dict;
+}
+
+static Array app_infos_to_array(const std::vector<AppInfo> &apps) {
+    Array array;
+    for (const AppInfo &app : apps) {
+        array.append(app_info_to_dictionary(app));
+    }
+    return array;
+}
+
+// 解析 "host"、"host:port"、"[v6]:port" 形式的地址
+static bool parse_address(const String &p_address, HostPoller::Address *r_address) {
+    std::string text = p_address.strip_edges().utf8().get_data();
+    if (text.empty()) {
+        return false;
+    }
+
+    std::string host = text;
+    int port = GAMESTREAM_DEFAULT_HTTP_PORT;
+    if (text[0] == '[') {
+        size_t close = text.find(']');
+        if (close == std::string::npos) {
+            return false;
+        }
+        host = text.substr(1, close - 1);
+        if (close + 1 < text.size() && text[close + 1] == ':') {
+            port = atoi(text.c_str() + close + 2);
+        }
+    } else if (text.find(':') == text.rfind(':') && text.find(':') != std::string::npos) {
+        // 只有一个冒号：host:port；多个冒号视为不带端口的 IPv6 字面量
+        size_t colon = text.find(':');
+        host = text.substr(0, colon);
+        port = atoi(text.c_str() + colon + 1);
+    }
+
+    if (host.empty() || port <= 0 || port > 65535) {
+        return false;
+    }
+    r_address->host = host;
+    r_address->port = (uint16_t)port;
+    return true;
+}
+
+void MoonlightHostPoller::_bind_methods() {
+    ClassDB::bind_method(D_METHOD("start_polling"), &MoonlightHostPoller::start_polling);
+    ClassDB::bind_method(D_METHOD("stop_polling"), &MoonlightHostPoller::stop_polling);
+    ClassDB::bind_method(D_METHOD("is_polling"), &MoonlightHostPoller::is_polling);
+
+    ClassDB::bind_method(D_METHOD("add_host", "host_id", "addresses"), &MoonlightHostPoller::add_host);
+    ClassDB::bind_method(D_METHOD("remove_host", "host_id"), &MoonlightHostPoller::remove_host);
+    ClassDB::bind_method(D_METHOD("poll_now", "host_id"), &MoonlightHostPoller::poll_now, DEFVAL(String()));
+    ClassDB::bind_method(D_METHOD("wake_host", "host_id", "mac_address"), &MoonlightHostPoller::wake_host, DEFVAL(String()));
+
+    ClassDB::bind_method(D_METHOD("get_host_state", "host_id"), &MoonlightHostPoller::get_host_state);
+    ClassDB::bind_method(D_METHOD("get_host_info", "host_id"), &MoonlightHostPoller::get_host_info);
+    ClassDB::bind_method(D_METHOD("get_host_ids"), &MoonlightHostPoller::get_host_ids);
+
+    ClassDB::bind_method(D_METHOD("submit_app_list", "host_id", "response"), &MoonlightHostPoller::submit_app_list);
+    ClassDB::bind_method(D_METHOD("get_app_list", "host_id"), &MoonlightHostPoller::get_app_list);
+
+    ClassDB::bind_method(D_METHOD("set_poll_interval_ms", "ms"), &MoonlightHostPoller::set_poll_interval_ms);
+    ClassDB::bind_method(D_METHOD("get_poll_interval_ms"), &MoonlightHostPoller::get_poll_interval_ms);
+    ClassDB::bind_method(D_METHOD("set_max_backoff_ms", "ms"), &MoonlightHostPoller::set_max_backoff_ms);
+    ClassDB::bind_method(D_METHOD("get_max_backoff_ms"), &MoonlightHostPoller::get_max_backoff_ms);
+    ClassDB::bind_method(D_METHOD("set_request_timeout_ms", "ms"), &MoonlightHostPoller::set_request_timeout_ms);
+    ClassDB::bind_method(D_METHOD("get_request_timeout_ms"), &MoonlightHostPoller::get_request_timeout_ms);
+    ADD_PROPERTY(PropertyInfo(Variant::INT, "poll_interval_ms"), "set_poll_interval_ms", "get_poll_interval_ms");
+    ADD_PROPERTY(PropertyInfo(Variant::INT, "max_backoff_ms"), "set_max_backoff_ms", "get_max_backoff_ms");
+    ClassDB::bind_method(D_METHOD("set_attempt_delay_ms", "ms"), &MoonlightHostPoller::set_attempt_delay_ms);
+    ClassDB::bind_method(D_METHOD("get_attempt_delay_ms"), &MoonlightHostPoller::get_attempt_delay_ms);
+    ADD_PROPERTY(PropertyInfo(Variant::INT, "request_timeout_ms"), "set_request_timeout_ms", "get_request_timeout_ms");
+    ADD_PROPERTY(PropertyInfo(Variant::INT, "attempt_delay_ms"), "set_attempt_delay_ms", "get_attempt_delay_ms");
+    ClassDB::bind_method(D_METHOD("set_wake_probe_interval_ms", "ms"), &MoonlightHostPoller::set_wake_probe_interval_ms);
+    ClassDB::bind_method(D_METHOD("get_wake_probe_interval_ms"), &MoonlightHostPoller::get_wake_probe_interval_ms);
+    ClassDB::bind_method(D_METHOD("set_wake_timeout_ms", "ms"), &MoonlightHostPoller::set_wake_timeout_ms);
+    ClassDB::bind_method(D_METHOD("get_wake_timeout_ms"), &MoonlightHostPoller::get_wake_timeout_ms);
+    ADD_PROPERTY(PropertyInfo(Variant::INT, "wake_probe_interval_ms"), "set_wake_probe_interval_ms", "get_wake_probe_interval_ms");
+    ADD_PROPERTY(PropertyInfo(Variant::INT, "wake_timeout_ms"), "set_wake_timeout_ms", "get_wake_timeout_ms");
+
+    BIND_ENUM_CONSTANT(HOST_STATE_UNKNOWN);
+    BIND_ENUM_CONSTANT(HOST_STATE_ONLINE);
+    BIND_ENUM_CONSTANT(HOST_STATE_OFFLINE);
+
+    ADD_SIGNAL(MethodInfo("host_state_changed", PropertyInfo(Variant::STRING, "host_id"), PropertyInfo(Variant::INT, "state"), PropertyInfo(Variant::DICTIONARY, "info")));
+    ADD_SIGNAL(MethodInfo("host_woken", PropertyInfo(Variant::STRING, "host_id"), PropertyInfo(Variant::INT, "latency_ms")));
+    ADD_SIGNAL(MethodInfo("host_wake_timed_out", PropertyInfo(Variant::STRING, "host_id")));
+    ADD_SIGNAL(MethodInfo("app_list_changed", PropertyInfo(Variant::STRING, "host_id"), PropertyInfo(Variant::ARRAY, "added"), PropertyInfo(Variant::PACKED_INT32_ARRAY, "removed"), PropertyInfo(Variant::ARRAY, "changed")));
+}
+
+MoonlightHostPoller::MoonlightHostPoller() {
+    set_process_internal(true);
+}
+
+MoonlightHostPoller::~MoonlightHostPoller() {
+    poller.stop();
+}
+
+void MoonlightHostPoller::_notification(int p_what) {
+    switch (p_what) {
+        case NOTIFICATION_INTERNAL_PROCESS: {
+            if (poller.has_events()) {
+                _dispatch_events();
+            }
+        } break;
+        case NOTIFICATION_EXIT_TREE: {
+            stop_polling();
+        } break;
+    }
+}
+
+void MoonlightHostPoller::_dispatch_events() {
+    for (const HostPoller::Event &event : poller.take_events()) {
+        String host_id = String::utf8(event.host_id.c_str());
+        // 事件可能晚于 remove_host 到达
+        if (!host_infos.has(host_id)) {
+            continue;
+        }
+        if (event.wake_timed_out) {
+            emit_signal("host_wake_timed_out", host_id);
+            continue;
+        }
+        Dictionary info = event.has_info ? server_info_to_dictionary(event.info) : Dictionary();
+        info["state"] = (int)event.state;
+        if (event.state == HostPoller::HOST_ONLINE) {
+            info["active_address"] = String::utf8(event.active_address.host.c_str());
+            info["active_port"] = event.active_address.port;
+        }
+        host_infos[host_id] = info;
+        emit_signal("host_state_changed", host_id, (int)event.state, info);
+        if (event.wake_latency_ms > 0) {
+            emit_signal("host_woken", host_id, (int64_t)event.wake_latency_ms);
+        }
+    }
+}
+
+bool MoonlightHostPoller::start_polling() {
+    if (!poller.start()) {
+        UtilityFunctions::push_error("MoonlightHostPoller: Failed to start polling thread");
+        return false;
+    }
+    return true;
+}
+
+void MoonlightHostPoller::stop_polling() {
+    poller.stop();
+}
+
+bool MoonlightHostPoller::is_polling() const {
+    return poller.is_running();
+}
+
+void MoonlightHostPoller::add_host(const String &p_host_id, const PackedStringArray &p_addresses) {
+    std::vector<HostPoller::Address> addresses;
+    for (int64_t i = 0; i < p_addresses.size(); i++) {
+        HostPoller::Address address;
+        if (!parse_address(p_addresses[i], &address)) {
+            UtilityFunctions::push_warning("MoonlightHostPoller: Ignoring invalid address ", p_addresses[i]);
+            continue;
+        }
+        addresses.push_back(address);
+    }
+
+    if (!host_infos.has(p_host_id)) {
+        Dictionary info;
+        info["state"] = (int)HOST_STATE_UNKNOWN;
+        host_infos[p_host_id] = info;
+    }
+    poller.set_host(p_host_id.utf8().get_data(), addresses);
+}
+
+void MoonlightHostPoller::remove_host(const String &p_host_id) {
+    host_infos.erase(p_host_id);
+    app_lists.erase(p_host_id.utf8().get_data());
+    poller.remove_host(p_host_id.utf8().get_data());
+}
+
+void MoonlightHostPoller::poll_now(const String &p_host_id) {
+    poller.poll_now(p_host_id.utf8().get_data());
+}
+
+Error MoonlightHostPoller::wake_host(const String &p_host_id, const String &p_mac_address) {
+    if (!host_infos.has(p_host_id)) {
+        return ERR_DOES_NOT_EXIST;
+    }
+    if (!poller.is_running()) {
+        UtilityFunctions::push_error("MoonlightHostPoller: wake_host requires start_polling()");
+        return ERR_UNCONFIGURED;
+    }
+
+    // 未指定时使用主机上次在线时 serverinfo 报告的 MAC 地址
+    String mac_text = p_mac_address;
+    if (mac_text.is_empty()) {
+        Dictionary info = host_infos[p_host_id];
+        mac_text = info.get("mac", String());
+    }
+    wol::MacAddress mac;
+    if (!wol::parse_mac_address(mac_text.utf8().get_data(), &mac)) {
+        UtilityFunctions::push_warning("MoonlightHostPoller: ", p_host_id, " has no valid MAC address");
+        return ERR_INVALID_PARAMETER;
+    }
+
+    poller.wake_host(p_host_id.utf8().get_data(), mac);
+    return OK;
+}
+
+int MoonlightHostPoller::get_host_state(const String &p_host_id) const {
+    if (!host_infos.has(p_host_id)) {
+        return HOST_STATE_UNKNOWN;
+    }
+    Dictionary info = host_infos[p_host_id];
+    return info.get("state", (int)HOST_STATE_UNKNOWN);
+}
+
+Dictionary MoonlightHostPoller::get_host_info(const String &p_host_id) const {
+    if (!host_infos.has(p_host_id)) {
+        return Dictionary();
+    }
+    return host_infos[p_host_id];
+}
+
+PackedStringArray MoonlightHostPoller::get_host_ids() const {
+    PackedStringArray ids;
+    Array keys = host_infos.keys();
+    for (int64_t i = 0; i < keys.size(); i++) {
+        ids.append(keys[i]);
+    }
+    return ids;
+}
+
+void MoonlightHostPoller::set_poll_interval_ms(int p_ms) {
+    HostPoller::Config config = poller.get_config();
+    config.poll_interval_ms = (uint64_t)MAX(p_ms, 500);
+    poller.set_config(config);
+}
+
+int MoonlightHostPoller::get_poll_interval_ms() {
+    return (int)poller.get_config().poll_interval_ms;
+}
+
+void MoonlightHostPoller::set_max_backoff_ms(int p_ms) {
+    HostPoller::Config config = poller.get_config();
+    config.max_backoff_ms = (uint64_t)MAX(p_ms, 500);
+    poller.set_config(config);
+}
+
+int MoonlightHostPoller::get_max_backoff_ms() {
+    return (int)poller.get_config().max_backoff_ms;
+}
+
+void MoonlightHostPoller::set_request_timeout_ms(int p_ms) {
+    HostPoller::Config config = poller.get_config();
+    config.request_timeout_ms = MAX(p_ms, 100);
+    poller.set_config(config);
+}
+
+int MoonlightHostPoller::get_request_timeout_ms() {
+    return poller.get_config().request_timeout_ms;
+}
+
+void MoonlightHostPoller::set_attempt_delay_ms(int p_ms) {
+    HostPoller::Config config = poller.get_config();
+    config.attempt_delay_ms = MAX(p_ms, 10);
+    poller.set_config(config);
+}
+
+int MoonlightHostPoller::get_attempt_delay_ms() {
+    return poller.get_config().attempt_delay_ms;
+}
+
+void MoonlightHostPoller::set_wake_probe_interval_ms(int p_ms) {
+    HostPoller::Config config = poller.get_config();
+    config.wake_probe_interval_ms = (uint64_t)MAX(p_ms, 100);
+    poller.set_config(config);
+}
+
+int MoonlightHostPoller::get_wake_probe_interval_ms() {
+    return (int)poller.get_config().wake_probe_interval_ms;
+}
+
+void MoonlightHostPoller::set_wake_timeout_ms(int p_ms) {
+    HostPoller::Config config = poller.get_config();
+    config.wake_timeout_ms = (uint64_t)MAX(p_ms, 1000);
+    poller.set_config(config);
+}
+
+int MoonlightHostPoller::get_wake_timeout_ms() {
+    return (int)poller.get_config().wake_timeout_ms;
+}
+
+Error MoonlightHostPoller::submit_app_list(const String &p_host_id, const PackedByteArray &p_response) {
+    if (!host_infos.has(p_host_id)) {
+        return ERR_DOES_NOT_EXIST;
+    }
+
+    AppListTracker &tracker = app_lists[p_host_id.utf8().get_data()];
+    AppListTracker::Diff diff;
+    AppListTracker::Result result = tracker.update((const char *)p_response.ptr(), (size_t)p_response.size(), &diff);
+    if (result == AppListTracker::RESULT_ERROR) {
+        return ERR_PARSE_ERROR;
+    }
+    if (result == AppListTracker::RESULT_UNCHANGED) {
+        return OK;
+    }
+
+    PackedInt32Array removed;
+    for (int app_id : diff.removed) {
+        removed.append(app_id);
+    }
+    emit_signal("app_list_changed", p_host_id, app_infos_to_array(diff.added), removed, app_infos_to_array(diff.changed));
+    return OK;
+}
+
+Array MoonlightHostPoller::get_app_list(const String &p_host_id) const {
+    auto it = app_lists.find(p_host_id.utf8().get_data());
+    if (it == app_lists.end()) {
+        return Array();
+    }
+    return app_infos_to_array(it->second.get_sorted_apps());
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <godot_cpp/classes/node.hpp>
+#include <godot_cpp/variant/array.hpp>
+#include <godot_cpp/variant/dictionary.hpp>
+#include <godot_cpp/variant/packed_byte_array.hpp>
+#include <godot_cpp/variant/packed_int32_array.hpp>
+#include <godot_cpp/variant/packed_string_array.hpp>
+
+#include "host/app_list_tracker.h"
+#include "host/host_poller.h"
+
+#include <map>
+#include <string>
+
+using namespace godot;
+
+// 主机在线状态轮询节点
+// 封装 HostPoller：轮询在单个后台线程中进行，状态变化在主线程的 internal process 中以信号发出。
+class MoonlightHostPoller : public Node {
+    GDCLASS(MoonlightHostPoller, Node)
+
+public:
+    enum HostState {
+        HOST_STATE_UNKNOWN = HostPoller::HOST_UNKNOWN,
+        HOST_STATE_ONLINE = HostPoller::HOST_ONLINE,
+        HOST_STATE_OFFLINE = HostPoller::HOST_OFFLINE,
+    };
+
+private:
+    HostPoller poller;
+    // 主线程缓存的最新状态 (host_id -> 信息字典)
+    Dictionary host_infos;
+    // 主线程维护的应用列表 (host_id -> 列表状态)
+    std::map<std::string, AppListTracker> app_lists;
+
+    void _dispatch_events();
+
+protected:
+    static void _bind_methods();
+    void _notification(int p_what);
+
+public:
+    MoonlightHostPoller();
+    ~MoonlightHostPoller();
+
+    bool start_polling();
+    void stop_polling();
+    bool is_polling() const;
+
+    void add_host(const String &p_host_id, const PackedStringArray &p_addresses);
+    void remove_host(const String &p_host_id);
+    void poll_now(const String &p_host_id = String());
+    Error wake_host(const String &p_host_id, const String &p_mac_address = String());
+
+    int get_host_state(const String &p_host_id) const;
+    Dictionary get_host_info(const String &p_host_id) const;
+    PackedStringArray get_host_ids() const;
+
+    Error submit_app_list(const String &p_host_id, const PackedByteArray &p_response);
+    Array get_app_list(const String &p_host_id) const;
+
+    void set_poll_interval_ms(int p_ms);
+    int get_poll_interval_ms();
+    void set_max_backoff_ms(int p_ms);
+    int get_max_backoff_ms();
+    void set_request_timeout_ms(int p_ms);
+    int get_request_timeout_ms();
+    void set_attempt_delay_ms(int p_ms);
+    int get_attempt_delay_ms();
+    void set_wake_probe_interval_ms(int p_ms);
+    int get_wake_probe_interval_ms();
+    void set_wake_timeout_ms(int p_ms);
+    int get_wake_timeout_ms();
+};
+
+VARIANT_ENUM_CAST(MoonlightHostPoller::HostState);
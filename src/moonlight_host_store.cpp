@@ -0,0 +1,128 @@
+#include "moonlight_host_store.h"
+
+#include <godot_cpp/classes/dir_access.hpp>
+#include <godot_cpp/classes/project_settings.hpp>
+#include <godot_cpp/core/class_db.hpp>
+#include <godot_cpp/variant/utility_functions.hpp>
+
+#include <cstring>
+
+void MoonlightHostStore::_bind_methods() {
+    ClassDB::bind_method(D_METHOD("open", "path"), &MoonlightHostStore::open, DEFVAL("user://addons/moonlight-godot/hosts.db"));
+    ClassDB::bind_method(D_METHOD("close"), &MoonlightHostStore::close);
+    ClassDB::bind_method(D_METHOD("is_open"), &MoonlightHostStore::is_open);
+
+    ClassDB::bind_method(D_METHOD("set_host", "host_id", "host"), &MoonlightHostStore::set_host);
+    ClassDB::bind_method(D_METHOD("remove_host", "host_id"), &MoonlightHostStore::remove_host);
+    ClassDB::bind_method(D_METHOD("has_host", "host_id"), &MoonlightHostStore::has_host);
+    ClassDB::bind_method(D_METHOD("get_host", "host_id"), &MoonlightHostStore::get_host);
+    ClassDB::bind_method(D_METHOD("get_host_ids"), &MoonlightHostStore::get_host_ids);
+    ClassDB::bind_method(D_METHOD("flush"), &MoonlightHostStore::flush);
+
+    ClassDB::bind_method(D_METHOD("set_flush_interval_ms", "ms"), &MoonlightHostStore::set_flush_interval_ms);
+    ClassDB::bind_method(D_METHOD("get_flush_interval_ms"), &MoonlightHostStore::get_flush_interval_ms);
+    ADD_PROPERTY(PropertyInfo(Variant::INT, "flush_interval_ms"), "set_flush_interval_ms", "get_flush_interval_ms");
+
+    ClassDB::bind_method(D_METHOD("get_stats"), &MoonlightHostStore::get_stats);
+}
+
+MoonlightHostStore::MoonlightHostStore() {
+}
+
+MoonlightHostStore::~MoonlightHostStore() {
+    store.close();
+}
+
+Error MoonlightHostStore::open(const String &p_path) {
+    String path = ProjectSettings::get_singleton()->globalize_path(p_path);
+    DirAccess::make_dir_recursive_absolute(path.get_base_dir());
+
+    std::string error;
+    if (!store.open(path.utf8().get_data(), &error)) {
+        UtilityFunctions::push_error("MoonlightHostStore: ", String::utf8(error.c_str()));
+        return ERR_CANT_OPEN;
+    }
+    return OK;
+}
+
+void MoonlightHostStore::close() {
+    store.close();
+}
+
+bool MoonlightHostStore::is_open() const {
+    return store.is_open();
+}
+
+void MoonlightHostStore::set_host(const String &p_host_id, const Dictionary &p_host) {
+    if (!store.is_open()) {
+        UtilityFunctions::push_error("MoonlightHostStore: store is not open");
+        return;
+    }
+    PackedByteArray bytes = UtilityFunctions::var_to_bytes(p_host);
+    store.put(p_host_id.utf8().get_data(), std::string((const char *)bytes.ptr(), bytes.size()));
+}
+
+bool MoonlightHostStore::remove_host(const String &p_host_id) {
+    return store.remove(p_host_id.utf8().get_data());
+}
+
+bool MoonlightHostStore::has_host(const String &p_host_id) {
+    std::string value;
+    return store.get(p_host_id.utf8().get_data(), &value);
+}
+
+Dictionary MoonlightHostStore::get_host(const String &p_host_id) {
+    std::string value;
+    if (!store.get(p_host_id.utf8().get_data(), &value)) {
+        return Dictionary();
+    }
+    PackedByteArray bytes;
+    bytes.resize(value.size());
+    if (!value.empty()) {
+        memcpy(bytes.ptrw(), value.data(), value.size());
+    }
+    Variant host = UtilityFunctions::bytes_to_var(bytes);
+    if (host.get_type() != Variant::DICTIONARY) {
+        UtilityFunctions::push_warning("MoonlightHostStore: corrupt entry for host ", p_host_id);
+        return Dictionary();
+    }
+    return host;
+}
+
+PackedStringArray MoonlightHostStore::get_host_ids() {
+    PackedStringArray ids;
+    for (const std::string &id : store.get_host_ids()) {
+        ids.push_back(String::utf8(id.c_str()));
+    }
+    return ids;
+}
+
+Error MoonlightHostStore::flush() {
+    if (!store.is_open()) {
+        return ERR_UNCONFIGURED;
+    }
+    if (!store.flush()) {
+        UtilityFunctions::push_error("MoonlightHostStore: failed to write host store");
+        return ERR_FILE_CANT_WRITE;
+    }
+    return OK;
+}
+
+void MoonlightHostStore::set_flush_interval_ms(int p_ms) {
+    store.set_flush_interval_ms(p_ms > 0 ? (uint64_t)p_ms : 0);
+}
+
+int MoonlightHostStore::get_flush_interval_ms() {
+    return (int)store.get_flush_interval_ms();
+}
+
+Dictionary MoonlightHostStore::get_stats() {
+    HostStore::Stats stats = store.get_stats();
+    Dictionary result;
+    result["file_size"] = (int64_t)stats.file_size;
+    result["live_size"] = (int64_t)stats.live_size;
+    result["flush_count"] = (int64_t)stats.flush_count;
+    result["compaction_count"] = (int64_t)stats.compaction_count;
+    result["records_written"] = (int64_t)stats.records_written;
+    return result;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <godot_cpp/classes/ref_counted.hpp>
+#include <godot_cpp/variant/dictionary.hpp>
+#include <godot_cpp/variant/packed_string_array.hpp>
+#include <godot_cpp/variant/string.hpp>
+
+#include "host/host_store.h"
+
+using namespace godot;
+
+// 主机数据库
+// set_host() 只更新内存并把主机标记为脏，由后台线程合并后追加写入日志文件；
+// 主机内容以 var_to_bytes 编码保存，get_host() 时才解码。
+class MoonlightHostStore : public RefCounted {
+    GDCLASS(MoonlightHostStore, RefCounted)
+
+private:
+    HostStore store;
+
+protected:
+    static void _bind_methods();
+
+public:
+    MoonlightHostStore();
+    ~MoonlightHostStore();
+
+    Error open(const String &p_path = "user://addons/moonlight-godot/hosts.db");
+    void close();
+    bool is_open() const;
+
+    void set_host(const String &p_host_id, const Dictionary &p_host);
+    bool remove_host(const String &p_host_id);
+    bool has_host(const String &p_host_id);
+    Dictionary get_host(const String &p_host_id);
+    PackedStringArray get_host_ids();
+
+    Error flush();
+
+    void set_flush_interval_ms(int p_ms);
+    int get_flush_interval_ms();
+
+    Dictionary get_stats();
+};
@@ -0,0 +1,131 @@
+#include "moonlight_https_client.h"
+
+#include "moonlight_identity.h"
+
+#include <godot_cpp/core/class_db.hpp>
+#include <godot_cpp/variant/utility_functions.hpp>
+
+void MoonlightHttpsClient::_bind_methods() {
+    ClassDB::bind_method(D_METHOD("set_client_certificate", "cert_pem", "key_pem"), &MoonlightHttpsClient::set_client_certificate);
+    ClassDB::bind_method(D_METHOD("set_server_certificate", "cert_pem"), &MoonlightHttpsClient::set_server_certificate);
+    ClassDB::bind_method(D_METHOD("set_verify_server", "enabled"), &MoonlightHttpsClient::set_verify_server);
+    ClassDB::bind_method(D_METHOD("is_verifying_server"), &MoonlightHttpsClient::is_verifying_server);
+    ADD_PROPERTY(PropertyInfo(Variant::BOOL, "verify_server"), "set_verify_server", "is_verifying_server");
+
+    ClassDB::bind_method(D_METHOD("request", "host", "port", "path", "use_tls", "timeout_ms"), &MoonlightHttpsClient::request, DEFVAL(true), DEFVAL(5000));
+    ClassDB::bind_method(D_METHOD("close_connections"), &MoonlightHttpsClient::close_connections);
+
+    ClassDB::bind_method(D_METHOD("get_handshake_count"), &MoonlightHttpsClient::get_handshake_count);
+    ClassDB::bind_method(D_METHOD("get_connection_count"), &MoonlightHttpsClient::get_connection_count);
+}
+
+MoonlightHttpsClient::MoonlightHttpsClient() {
+}
+
+MoonlightHttpsClient::~MoonlightHttpsClient() {
+    pool.close_all();
+}
+
+Error MoonlightHttpsClient::set_client_certificate(const String &p_cert_pem, const String &p_key_pem) {
+    std::string error;
+    std::lock_guard<std::mutex> lock(identity_mutex);
+    if (!pool.set_client_identity_pem(p_cert_pem.utf8().get_data(), p_key_pem.utf8().get_data(), &error)) {
+        UtilityFunctions::push_error("MoonlightHttpsClient: ", String::utf8(error.c_str()));
+        return ERR_INVALID_DATA;
+    }
+    has_identity.store(true, std::memory_order_release);
+    return OK;
+}
+
+Error MoonlightHttpsClient::_ensure_identity(String *r_message) {
+#ifdef MOONLIGHT_USE_MBEDTLS
+    if (has_identity.load(std::memory_order_acquire)) {
+        return OK;
+    }
+    MoonlightIdentity *identity = MoonlightIdentity::get_singleton();
+    if (identity == nullptr) {
+        return OK;
+    }
+    // 不等待：首次启动时身份可能仍在生成，而 request() 可能在主线程中调用
+    if (!identity->is_ready()) {
+        String error = identity->get_error();
+        if (r_message) {
+            *r_message = error.is_empty() ? String("Client identity is not ready yet") : error;
+        }
+        return error.is_empty() ? ERR_BUSY : ERR_CANT_CREATE;
+    }
+    std::shared_ptr<tls::Identity> shared = identity->get_identity(0);
+    // 先设置身份再发布标志：其他线程看到 has_identity 时池中一定已有证书。
+    // 显式设置的身份优先，可能已在其他线程中被设置
+    std::lock_guard<std::mutex> lock(identity_mutex);
+    if (shared && !has_identity.load(std::memory_order_relaxed)) {
+        pool.set_client_identity(shared);
+        has_identity.store(true, std::memory_order_release);
+    }
+#endif
+    return OK;
+}
+
+Error MoonlightHttpsClient::set_server_certificate(const String &p_cert_pem) {
+    std::string error;
+    if (!pool.set_pinned_server_certificate(p_cert_pem.utf8().get_data(), &error)) {
+        UtilityFunctions::push_error("MoonlightHttpsClient: ", String::utf8(error.c_str()));
+        return ERR_INVALID_DATA;
+    }
+    return OK;
+}
+
+void MoonlightHttpsClient::set_verify_server(bool p_enabled) {
+    pool.set_verify_server(p_enabled);
+}
+
+bool MoonlightHttpsClient::is_verifying_server() const {
+    return pool.is_verifying_server();
+}
+
+Dictionary MoonlightHttpsClient::request(const String &p_host, int p_port, const String &p_path, bool p_use_tls, int p_timeout_ms) {
+    Dictionary result;
+    if (p_port <= 0 || p_port > 65535) {
+        result["error"] = ERR_INVALID_PARAMETER;
+        result["status_code"] = 0;
+        result["body"] = PackedByteArray();
+        result["message"] = "Invalid port";
+        return result;
+    }
+
+    // 使用 TLS 时需要客户端身份；尚未生成完成时立即返回，不阻塞调用线程
+    String identity_message;
+    Error identity_error = p_use_tls ? _ensure_identity(&identity_message) : OK;
+    if (identity_error != OK) {
+        result["error"] = identity_error;
+        result["status_code"] = 0;
+        result["body"] = PackedByteArray();
+        result["message"] = identity_message;
+        return result;
+    }
+    net::HttpResponse response = pool.get(p_host.utf8().get_data(), (uint16_t)p_port, p_path.utf8().get_data(), p_use_tls, p_timeout_ms);
+
+    PackedByteArray body;
+    body.resize((int64_t)response.body.size());
+    if (!response.body.empty()) {
+        memcpy(body.ptrw(), response.body.data(), response.body.size());
+    }
+
+    result["error"] = response.error.empty() ? OK : ERR_CONNECTION_ERROR;
+    result["status_code"] = response.status_code;
+    result["body"] = body;
+    result["message"] = String::utf8(response.error.c_str());
+    return result;
+}
+
+void MoonlightHttpsClient::close_connections() {
+    pool.close_all();
+}
+
+int MoonlightHttpsClient::get_handshake_count() const {
+    return (int)pool.get_handshake_count();
+}
+
+int MoonlightHttpsClient::get_connection_count() {
+    return pool.get_connection_count();
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <godot_cpp/classes/ref_counted.hpp>
+#include <godot_cpp/variant/dictionary.hpp>
+#include <godot_cpp/variant/string.hpp>
+
+#include "net/http_connection_pool.h"
+
+#include <atomic>
+#include <mutex>
+
+using namespace godot;
+
+// GameStream 主机的 HTTP/HTTPS 客户端
+// 对每个主机保持一个 keep-alive 的 mTLS 连接，替代每个请求都重新握手的 HTTPClient。
+// request() 是阻塞调用，应在 Thread / WorkerThreadPool 中使用。
+// 未调用 set_client_certificate() 时使用 MoonlightIdentity 的共享身份；身份尚未生成完成时 HTTPS 请求立即失败 (ERR_BUSY)。
+class MoonlightHttpsClient : public RefCounted {
+    GDCLASS(MoonlightHttpsClient, RefCounted)
+
+private:
+    HttpConnectionPool pool;
+    // 已设置身份 (显式设置或取自 MoonlightIdentity)；在池中的身份设置完成后才以 release 置位
+    std::atomic<bool> has_identity{ false };
+    // 串行化设置身份与置位 has_identity，避免共享身份覆盖显式设置的身份
+    std::mutex identity_mutex;
+
+    // 从 MoonlightIdentity 取得共享身份，不等待；尚未就绪时返回 ERR_BUSY，生成失败时返回 ERR_CANT_CREATE
+    Error _ensure_identity(String *r_message = nullptr);
+
+protected:
+    static void _bind_methods();
+
+public:
+    MoonlightHttpsClient();
+    ~MoonlightHttpsClient();
+
+    Error set_client_certificate(const String &p_cert_pem, const String &p_key_pem);
+    Error set_server_certificate(const String &p_cert_pem);
+    void set_verify_server(bool p_enabled);
+    bool is_verifying_server() const;
+
+    Dictionary request(const String &p_host, int p_port, const String &p_path, bool p_use_tls = true, int p_timeout_ms = 5000);
+    void close_connections();
+
+    int get_handshake_count() const;
+    int get_connection_count();
+
+    // 供其他 C++ 组件在工作线程中直接发送请求。r_identity_error 为 OK 以外的值时池中没有客户端证书，
+    // 不应发送 HTTPS 请求：ERR_BUSY 表示身份仍在生成，稍后重试；ERR_CANT_CREATE 表示生成失败
+    HttpConnectionPool &get_pool(Error *r_identity_error) {
+        *r_identity_error = _ensure_identity();
+        return pool;
+    }
+};
@@ -0,0 +1,153 @@
+#include "moonlight_identity.h"
+
+#include <godot_cpp/classes/dir_access.hpp>
+#include <godot_cpp/classes/file_access.hpp>
+#include <godot_cpp/core/class_db.hpp>
+#include <godot_cpp/variant/utility_functions.hpp>
+
+#include <chrono>
+
+static const char IDENTITY_DIR[] = "user://addons/moonlight-godot";
+static const char CERT_FILE[] = "client_cert.pem";
+static const char KEY_FILE[] = "client_key.pem";
+
+MoonlightIdentity *MoonlightIdentity::singleton = nullptr;
+
+void MoonlightIdentity::_bind_methods() {
+    ClassDB::bind_method(D_METHOD("is_ready"), &MoonlightIdentity::is_ready);
+    ClassDB::bind_method(D_METHOD("wait_until_ready", "timeout_ms"), &MoonlightIdentity::wait_until_ready);
+    ClassDB::bind_method(D_METHOD("get_certificate"), &MoonlightIdentity::get_certificate);
+    ClassDB::bind_method(D_METHOD("get_private_key"), &MoonlightIdentity::get_private_key);
+    ClassDB::bind_method(D_METHOD("get_error"), &MoonlightIdentity::get_error);
+
+    ADD_SIGNAL(MethodInfo("identity_ready", PropertyInfo(Variant::BOOL, "success")));
+}
+
+MoonlightIdentity::MoonlightIdentity() {
+    singleton = this;
+}
+
+MoonlightIdentity::~MoonlightIdentity() {
+    // 生成 RSA 密钥无法中断，退出时等待其完成
+    if (loader.joinable()) {
+        loader.join();
+    }
+    if (singleton == this) {
+        singleton = nullptr;
+    }
+}
+
+void MoonlightIdentity::start_loading() {
+    if (loader.joinable()) {
+        return;
+    }
+    loader = std::thread(&MoonlightIdentity::_load, this);
+}
+
+// 写入临时文件后重命名，避免中断时留下半个身份
+static bool write_atomically(const String &p_path, const String &p_text) {
+    String temp_path = p_path + ".tmp";
+    Ref<FileAccess> file = FileAccess::open(temp_path, FileAccess::WRITE);
+    if (file.is_null()) {
+        return false;
+    }
+    file->store_string(p_text);
+    file->close();
+    if (DirAccess::rename_absolute(temp_path, p_path) != OK) {
+        DirAccess::remove_absolute(temp_path);
+        return false;
+    }
+    return true;
+}
+
+void MoonlightIdentity::_load() {
+    String cert_path = String(IDENTITY_DIR).path_join(CERT_FILE);
+    String key_path = String(IDENTITY_DIR).path_join(KEY_FILE);
+    String cert;
+    String key;
+    String load_error;
+
+#ifdef MOONLIGHT_USE_MBEDTLS
+    std::shared_ptr<tls::Identity> parsed;
+    std::string parse_error;
+    if (FileAccess::file_exists(cert_path) && FileAccess::file_exists(key_path)) {
+        cert = FileAccess::get_file_as_string(cert_path);
+        key = FileAccess::get_file_as_string(key_path);
+        parsed = tls::Identity::parse(cert.utf8().get_data(), key.utf8().get_data(), &parse_error);
+        if (!parsed) {
+            UtilityFunctions::push_warning("MoonlightIdentity: Saved identity is unreadable, generating a new one: ", String::utf8(parse_error.c_str()));
+        }
+    }
+
+    if (!parsed) {
+        std::string cert_text;
+        std::string key_text;
+        if (tls::generate_identity(&cert_text, &key_text, &parse_error)) {
+            parsed = tls::Identity::parse(cert_text, key_text, &parse_error);
+        }
+        if (parsed) {
+            cert = String::utf8(cert_text.c_str());
+            key = String::utf8(key_text.c_str());
+            // 保存失败时本次仍可使用，下次启动会重新生成 (需要重新配对)
+            DirAccess::make_dir_recursive_absolute(IDENTITY_DIR);
+            if (!write_atomically(key_path, key) || !write_atomically(cert_path, cert)) {
+                UtilityFunctions::push_warning("MoonlightIdentity: Unable to save client identity to ", IDENTITY_DIR);
+            }
+        } else {
+            load_error = String::utf8(parse_error.c_str());
+        }
+    }
+#else
+    load_error = "Built without mbedTLS support";
+#endif
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (load_error.is_empty()) {
+            cert_pem = cert;
+            key_pem = key;
+#ifdef MOONLIGHT_USE_MBEDTLS
+            identity = parsed;
+#endif
+        } else {
+            error = load_error;
+        }
+        ready = true;
+    }
+    ready_cv.notify_all();
+    call_deferred("emit_signal", "identity_ready", load_error.is_empty());
+}
+
+bool MoonlightIdentity::is_ready() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return ready && error.is_empty();
+}
+
+bool MoonlightIdentity::wait_until_ready(int p_timeout_ms) {
+    std::unique_lock<std::mutex> lock(mutex);
+    ready_cv.wait_for(lock, std::chrono::milliseconds(MAX(p_timeout_ms, 0)), [this] { return ready; });
+    return ready && error.is_empty();
+}
+
+String MoonlightIdentity::get_certificate() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return cert_pem;
+}
+
+String MoonlightIdentity::get_private_key() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return key_pem;
+}
+
+String MoonlightIdentity::get_error() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return error;
+}
+
+#ifdef MOONLIGHT_USE_MBEDTLS
+std::shared_ptr<tls::Identity> MoonlightIdentity::get_identity(int p_timeout_ms) {
+    std::unique_lock<std::mutex> lock(mutex);
+    ready_cv.wait_for(lock, std::chrono::milliseconds(MAX(p_timeout_ms, 0)), [this] { return ready; });
+    return identity;
+}
+#endif
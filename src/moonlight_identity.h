@@ -0,0 +1,61 @@
+#pragma once
+
+#include <godot_cpp/classes/object.hpp>
+#include <godot_cpp/variant/string.hpp>
+
+#include "net/tls_identity.h"
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+using namespace godot;
+
+// 客户端身份 (证书 + 私钥) 单例，对应原实现的 IdentityManager
+// 插件加载时即在后台线程中读取 user://addons/moonlight-godot 下保存的身份，不存在或无法解析时生成新身份并保存，
+// 首次启动不会因为生成 RSA 密钥而卡住主线程。
+// 证书与私钥只解析一次，所有 MoonlightHttpsClient 连接与配对共享同一份 mbedTLS 上下文。
+class MoonlightIdentity : public Object {
+    GDCLASS(MoonlightIdentity, Object)
+
+private:
+    static MoonlightIdentity *singleton;
+
+    std::thread loader;
+    std::mutex mutex;
+    std::condition_variable ready_cv;
+    bool ready = false;
+    String cert_pem;
+    String key_pem;
+    String error;
+#ifdef MOONLIGHT_USE_MBEDTLS
+    std::shared_ptr<tls::Identity> identity;
+#endif
+
+    void _load();
+
+protected:
+    static void _bind_methods();
+
+public:
+    static MoonlightIdentity *get_singleton() { return singleton; }
+
+    MoonlightIdentity();
+    ~MoonlightIdentity();
+
+    // 由 register_types 在插件加载时调用
+    void start_loading();
+
+    bool is_ready();
+    // 最多等待 timeout_ms，身份可用时返回 true
+    bool wait_until_ready(int p_timeout_ms);
+    String get_certificate();
+    String get_private_key();
+    String get_error();
+
+#ifdef MOONLIGHT_USE_MBEDTLS
+    // 供 C++ 组件使用的已解析身份，最多等待 timeout_ms；尚未就绪或生成失败时返回 nullptr
+    std::shared_ptr<tls::Identity> get_identity(int p_timeout_ms);
+#endif
+};
@@ -0,0 +1,878 @@
+#include "moonlight_input.h"
+
+#include "gamepad_sampler.h"
+#include "key_translation.h"
+#include "moonlight_stream_core.h"
+
+#include <godot_cpp/classes/input.hpp>
+#include <godot_cpp/classes/input_event_joypad_button.hpp>
+#include <godot_cpp/classes/input_event_joypad_motion.hpp>
+#include <godot_cpp/classes/input_event_key.hpp>
+#include <godot_cpp/classes/input_event_mouse.hpp>
+#include <godot_cpp/classes/input_event_mouse_button.hpp>
+#include <godot_cpp/classes/input_event_mouse_motion.hpp>
+#include <godot_cpp/classes/input_event_screen_drag.hpp>
+#include <godot_cpp/classes/input_event_screen_touch.hpp>
+#include <godot_cpp/classes/viewport.hpp>
+#include <godot_cpp/core/class_db.hpp>
+#include <godot_cpp/variant/typed_array.hpp>
+
+#include <cmath>
+
+// 一格滚轮对应的高精度滚动量
+static const int WHEEL_DELTA = 120;
+
+// 单个 UTF-8 文本事件的最大字节数 (moonlight-common-c 的 UTF8_TEXT_EVENT_MAX_COUNT)
+static const int MAX_TEXT_EVENT_BYTES = 32;
+
+// 由触摸模拟出的鼠标事件的设备号 (InputEvent::DEVICE_ID_EMULATION)
+static const int DEVICE_ID_EMULATION = -1;
+
+// Godot 的笔倾斜 (-1~1) -> Limelight 的倾斜角 (0~90 度) 与方位角 (0~359 度，0 为正上方)
+static void pen_tilt_to_limelight(const Vector2 &p_tilt, uint8_t *r_tilt, uint16_t *r_rotation) {
+    float magnitude = MIN(p_tilt.length(), 1.0f);
+    if (magnitude <= 0.0f) {
+        *r_tilt = LI_TILT_UNKNOWN;
+        *r_rotation = LI_ROT_UNKNOWN;
+        return;
+    }
+    *r_tilt = (uint8_t)std::lround(magnitude * 90.0f);
+    float degrees = std::atan2(p_tilt.x, -p_tilt.y) * 180.0f / (float)Math_PI;
+    *r_rotation = (uint16_t)((int)std::lround(degrees + 360.0f) % 360);
+}
+
+// 根据手柄名称判断主机端虚拟手柄的类型 (影响按钮图标与 PS 触摸板等特性)
+static uint8_t controller_type_for_name(const String &p_name) {
+    String name = p_name.to_lower();
+    if (name.contains("dualsense") || name.contains("dualshock") || name.contains("playstation") ||
+            name.contains("ps3") || name.contains("ps4") || name.contains("ps5")) {
+        return LI_CTYPE_PS;
+    }
+    if (name.contains("nintendo") || name.contains("switch") || name.contains("joy-con")) {
+        return LI_CTYPE_NINTENDO;
+    }
+    if (name.contains("xbox") || name.contains("xinput")) {
+        return LI_CTYPE_XBOX;
+    }
+    return LI_CTYPE_UNKNOWN;
+}
+
+void MoonlightInput::_bind_methods() {
+    ClassDB::bind_method(D_METHOD("handle_input_event", "event"), &MoonlightInput::handle_input_event);
+
+    ClassDB::bind_method(D_METHOD("set_stream_core", "core"), &MoonlightInput::set_stream_core);
+    ClassDB::bind_method(D_METHOD("get_stream_core"), &MoonlightInput::get_stream_core);
+    ClassDB::bind_method(D_METHOD("set_capture_mouse", "enabled"), &MoonlightInput::set_capture_mouse);
+    ClassDB::bind_method(D_METHOD("is_capturing_mouse"), &MoonlightInput::is_capturing_mouse);
+    ClassDB::bind_method(D_METHOD("set_capture_gamepads", "enabled"), &MoonlightInput::set_capture_gamepads);
+    ClassDB::bind_method(D_METHOD("is_capturing_gamepads"), &MoonlightInput::is_capturing_gamepads);
+    ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "stream_core", PROPERTY_HINT_NODE_TYPE, "MoonlightStreamCore", PROPERTY_USAGE_NONE), "set_stream_core", "get_stream_core");
+    ADD_PROPERTY(PropertyInfo(Variant::BOOL, "capture_mouse"), "set_capture_mouse", "is_capturing_mouse");
+    ADD_PROPERTY(PropertyInfo(Variant::BOOL, "capture_gamepads"), "set_capture_gamepads", "is_capturing_gamepads");
+
+    ClassDB::bind_method(D_METHOD("set_capture_touch", "enabled"), &MoonlightInput::set_capture_touch);
+    ClassDB::bind_method(D_METHOD("is_capturing_touch"), &MoonlightInput::is_capturing_touch);
+    ClassDB::bind_method(D_METHOD("set_capture_pen", "enabled"), &MoonlightInput::set_capture_pen);
+    ClassDB::bind_method(D_METHOD("is_capturing_pen"), &MoonlightInput::is_capturing_pen);
+    ClassDB::bind_method(D_METHOD("set_mouse_mode", "mode"), &MoonlightInput::set_mouse_mode);
+    ClassDB::bind_method(D_METHOD("get_mouse_mode"), &MoonlightInput::get_mouse_mode);
+    ClassDB::bind_method(D_METHOD("set_input_control", "control"), &MoonlightInput::set_input_control);
+    ClassDB::bind_method(D_METHOD("get_input_control"), &MoonlightInput::get_input_control);
+    ClassDB::bind_method(D_METHOD("invalidate_transform"), &MoonlightInput::invalidate_transform);
+    ADD_PROPERTY(PropertyInfo(Variant::BOOL, "capture_touch"), "set_capture_touch", "is_capturing_touch");
+    ADD_PROPERTY(PropertyInfo(Variant::BOOL, "capture_pen"), "set_capture_pen", "is_capturing_pen");
+    ADD_PROPERTY(PropertyInfo(Variant::INT, "mouse_mode", PROPERTY_HINT_ENUM, "Relative,Absolute"), "set_mouse_mode", "get_mouse_mode");
+    ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "input_control", PROPERTY_HINT_NODE_TYPE, "Control", PROPERTY_USAGE_NONE), "set_input_control", "get_input_control");
+
+    ClassDB::bind_method(D_METHOD("set_capture_keyboard", "enabled"), &MoonlightInput::set_capture_keyboard);
+    ClassDB::bind_method(D_METHOD("is_capturing_keyboard"), &MoonlightInput::is_capturing_keyboard);
+    ClassDB::bind_method(D_METHOD("set_use_physical_keys", "enabled"), &MoonlightInput::set_use_physical_keys);
+    ClassDB::bind_method(D_METHOD("is_using_physical_keys"), &MoonlightInput::is_using_physical_keys);
+    ClassDB::bind_method(D_METHOD("set_text_input", "enabled"), &MoonlightInput::set_text_input);
+    ClassDB::bind_method(D_METHOD("is_text_input_enabled"), &MoonlightInput::is_text_input_enabled);
+    ClassDB::bind_method(D_METHOD("send_key_event", "keycode", "pressed"), &MoonlightInput::send_key_event);
+    ClassDB::bind_method(D_METHOD("send_text", "text"), &MoonlightInput::send_text);
+    ClassDB::bind_method(D_METHOD("release_all"), &MoonlightInput::release_all);
+    ADD_PROPERTY(PropertyInfo(Variant::BOOL, "capture_keyboard"), "set_capture_keyboard", "is_capturing_keyboard");
+    ADD_PROPERTY(PropertyInfo(Variant::BOOL, "use_physical_keys"), "set_use_physical_keys", "is_using_physical_keys");
+    ADD_PROPERTY(PropertyInfo(Variant::BOOL, "text_input"), "set_text_input", "is_text_input_enabled");
+
+    BIND_ENUM_CONSTANT(MOUSE_MODE_RELATIVE);
+    BIND_ENUM_CONSTANT(MOUSE_MODE_ABSOLUTE);
+
+    ClassDB::bind_method(D_METHOD("get_input_stats"), &MoonlightInput::get_input_stats);
+}
+
+MoonlightInput::MoonlightInput() {
+    for (int &device : controller_devices) {
+        device = -1;
+    }
+    set_process_input(true);
+}
+
+void MoonlightInput::_notification(int p_what) {
+    switch (p_what) {
+        case NOTIFICATION_ENTER_TREE: {
+            if (!get_stream_core()) {
+                set_stream_core(Object::cast_to<MoonlightStreamCore>(get_parent()));
+            }
+            Input::get_singleton()->connect("joy_connection_changed", callable_mp(this, &MoonlightInput::_on_joy_connection_changed));
+            _assign_connected_joypads();
+        } break;
+        case NOTIFICATION_EXIT_TREE: {
+            Callable on_joy_connection_changed = callable_mp(this, &MoonlightInput::_on_joy_connection_changed);
+            if (Input::get_singleton()->is_connected("joy_connection_changed", on_joy_connection_changed)) {
+                Input::get_singleton()->disconnect("joy_connection_changed", on_joy_connection_changed);
+            }
+            // 离开场景树后不再采样，并从主机端拔出手柄
+            _release_all_controllers();
+            release_all();
+        } break;
+        case NOTIFICATION_APPLICATION_FOCUS_OUT: {
+            // 失去焦点后收不到松开事件，先全部松开
+            release_all();
+        } break;
+    }
+}
+
+void MoonlightInput::_input(const Ref<InputEvent> &p_event) {
+    handle_input_event(p_event);
+}
+
+bool MoonlightInput::handle_input_event(const Ref<InputEvent> &p_event) {
+    if (p_event.is_null()) {
+        return false;
+    }
+    InputSender *sender = _get_sender();
+    if (!sender) {
+        return false;
+    }
+    if (capture_keyboard && _handle_key_event(p_event, sender)) {
+        return true;
+    }
+    if (capture_touch && _handle_touch_event(p_event, sender)) {
+        return true;
+    }
+    if (capture_pen && _handle_pen_event(p_event, sender)) {
+        return true;
+    }
+    if (capture_mouse && mouse_mode == MOUSE_MODE_ABSOLUTE && _handle_absolute_mouse_event(p_event, sender)) {
+        return true;
+    }
+    if (capture_mouse && _handle_mouse_event(p_event, sender)) {
+        return true;
+    }
+    if (capture_gamepads && _handle_joypad_event(p_event, sender)) {
+        return true;
+    }
+    return false;
+}
+
+InputSender *MoonlightInput::_get_sender() const {
+    MoonlightStreamCore *core = get_stream_core();
+    if (!core || !core->is_streaming) {
+        return nullptr;
+    }
+    return core->get_input_sender();
+}
+
+bool MoonlightInput::_handle_mouse_event(const Ref<InputEvent> &p_event, InputSender *p_sender) {
+    Ref<InputEventMouseMotion> motion = p_event;
+    if (motion.is_valid()) {
+        Vector2 relative = motion->get_relative();
+        p_sender->queue_mouse_motion(relative.x, relative.y);
+        return true;
+    }
+
+    Ref<InputEventMouseButton> button = p_event;
+    if (button.is_null()) {
+        return false;
+    }
+    // 滚轮只在按下时计数，factor 为触控板等设备的精细滚动比例
+    int wheel = (int)(WHEEL_DELTA * (button->get_factor() > 0.0f ? button->get_factor() : 1.0f));
+    switch (button->get_button_index()) {
+        case MOUSE_BUTTON_LEFT:
+            _queue_mouse_button(p_sender, BUTTON_LEFT, button->is_pressed());
+            return true;
+        case MOUSE_BUTTON_MIDDLE:
+            _queue_mouse_button(p_sender, BUTTON_MIDDLE, button->is_pressed());
+            return true;
+        case MOUSE_BUTTON_RIGHT:
+            _queue_mouse_button(p_sender, BUTTON_RIGHT, button->is_pressed());
+            return true;
+        case MOUSE_BUTTON_XBUTTON1:
+            _queue_mouse_button(p_sender, BUTTON_X1, button->is_pressed());
+            return true;
+        case MOUSE_BUTTON_XBUTTON2:
+            _queue_mouse_button(p_sender, BUTTON_X2, button->is_pressed());
+            return true;
+        case MOUSE_BUTTON_WHEEL_UP:
+            if (button->is_pressed()) {
+                p_sender->queue_scroll(wheel, false);
+            }
+            return true;
+        case MOUSE_BUTTON_WHEEL_DOWN:
+            if (button->is_pressed()) {
+                p_sender->queue_scroll(-wheel, false);
+            }
+            return true;
+        case MOUSE_BUTTON_WHEEL_LEFT:
+            if (button->is_pressed()) {
+                p_sender->queue_scroll(-wheel, true);
+            }
+            return true;
+        case MOUSE_BUTTON_WHEEL_RIGHT:
+            if (button->is_pressed()) {
+                p_sender->queue_scroll(wheel, true);
+            }
+            return true;
+        default:
+            return false;
+    }
+}
+
+void MoonlightInput::_queue_mouse_button(InputSender *p_sender, int p_button, bool p_pressed) {
+    uint8_t bit = 1 << p_button;
+    pressed_mouse_buttons = p_pressed ? (pressed_mouse_buttons | bit) : (pressed_mouse_buttons & ~bit);
+    p_sender->queue_mouse_button(p_button, p_pressed);
+}
+
+bool MoonlightInput::_handle_key_event(const Ref<InputEvent> &p_event, InputSender *p_sender) {
+    Ref<InputEventKey> key = p_event;
+    if (key.is_null()) {
+        return false;
+    }
+    // 按住时的重复由主机端自行产生
+    if (key->is_echo()) {
+        return true;
+    }
+    // 物理键码对应美式布局的按键位置，主机端按自己的布局解释；
+    // 部分平台 (如 Web 的屏幕键盘) 没有物理键码，退回到键码
+    Key keycode = use_physical_keys ? key->get_physical_keycode() : key->get_keycode();
+    if (keycode == KEY_NONE) {
+        keycode = use_physical_keys ? key->get_keycode() : key->get_physical_keycode();
+    }
+    uint8_t virtual_key = key_translation::to_virtual_key(keycode);
+    if (virtual_key == 0) {
+        // 当前布局特有的字符没有虚拟键码，按下时以文本发送
+        if (text_input && key->is_pressed() && key->get_unicode() != 0) {
+            _queue_text(p_sender, String::chr(key->get_unicode()));
+            return true;
+        }
+        return false;
+    }
+    if (key->get_location() == KEY_LOCATION_RIGHT) {
+        if (virtual_key == key_translation::VK_LWIN) {
+            virtual_key = key_translation::VK_RWIN;
+        } else if (virtual_key == key_translation::VK_LSHIFT || virtual_key == key_translation::VK_LCONTROL ||
+                virtual_key == key_translation::VK_LMENU) {
+            virtual_key++;
+        }
+    }
+
+    uint8_t modifiers = 0;
+    if (key->is_shift_pressed()) {
+        modifiers |= MODIFIER_SHIFT;
+    }
+    if (key->is_ctrl_pressed()) {
+        modifiers |= MODIFIER_CTRL;
+    }
+    if (key->is_alt_pressed()) {
+        modifiers |= MODIFIER_ALT;
+    }
+    if (key->is_meta_pressed()) {
+        modifiers |= MODIFIER_META;
+    }
+    _queue_key(p_sender, virtual_key, key->is_pressed(), modifiers);
+    return true;
+}
+
+void MoonlightInput::_queue_key(InputSender *p_sender, uint8_t p_virtual_key, bool p_pressed, uint8_t p_modifiers) {
+    pressed_keys[p_virtual_key] = p_pressed;
+    // 键码来自当前布局时要求主机端不再按美式布局归一化
+    p_sender->queue_key(p_virtual_key, p_pressed, p_modifiers, use_physical_keys ? 0 : SS_KBE_FLAG_NON_NORMALIZED);
+}
+
+void MoonlightInput::_queue_text(InputSender *p_sender, const String &p_text) {
+    // 按字符边界拆分为不超过 MAX_TEXT_EVENT_BYTES 的文本事件
+    std::string chunk;
+    for (int64_t i = 0; i < p_text.length(); i++) {
+        CharString character = p_text.substr(i, 1).utf8();
+        if (chunk.size() + (size_t)character.length() > (size_t)MAX_TEXT_EVENT_BYTES) {
+            p_sender->queue_text(chunk);
+            chunk.clear();
+        }
+        chunk.append(character.get_data(), character.length());
+    }
+    p_sender->queue_text(chunk);
+}
+
+bool MoonlightInput::_handle_absolute_mouse_event(const Ref<InputEvent> &p_event, InputSender *p_sender) {
+    Ref<InputEventMouse> mouse = p_event;
+    if (mouse.is_null() || !get_input_control()) {
+        return false;
+    }
+    Vector2 position;
+    Vector2i stream_size;
+    bool inside = _map_to_stream(mouse->get_position(), &position, &stream_size);
+
+    Ref<InputEventMouseButton> button = p_event;
+    if (button.is_valid()) {
+        // 画面外的按下不转发，松开总是转发以免按键卡住
+        if (!inside && button->is_pressed()) {
+            return false;
+        }
+        if (inside) {
+            p_sender->queue_mouse_position(position.x, position.y, stream_size.x, stream_size.y);
+        }
+        return _handle_mouse_event(p_event, p_sender);
+    }
+    if (inside) {
+        p_sender->queue_mouse_position(position.x, position.y, stream_size.x, stream_size.y);
+    }
+    // 画面外的移动也视为已处理，不再作为相对移动发送
+    return true;
+}
+
+// 数位板的笔在 Godot 中以带压力与倾斜的鼠标事件到达。
+// 不带笔数据的事件来自普通鼠标，返回 false 交给鼠标处理 (包括相对移动)
+bool MoonlightInput::_handle_pen_event(const Ref<InputEvent> &p_event, InputSender *p_sender) {
+    Ref<InputEventMouse> mouse = p_event;
+    if (mouse.is_null() || mouse->get_device() == DEVICE_ID_EMULATION || !get_input_control()) {
+        return false;
+    }
+    Vector2 position;
+    Vector2i stream_size;
+    bool inside = _map_to_stream(mouse->get_position(), &position, &stream_size);
+    position = position.clamp(Vector2(), Vector2(1, 1));
+
+    Ref<InputEventMouseMotion> motion = p_event;
+    if (motion.is_valid()) {
+        pen_in_use = motion->get_pressure() > 0.0f || motion->get_tilt() != Vector2() || motion->get_pen_inverted();
+        // 笔尖接触期间总是按笔发送，保证之后的抬起与按下配对
+        if (!pen_in_use && !pen_contact) {
+            return false;
+        }
+        if (!inside && !pen_contact) {
+            return true;
+        }
+        pen_pressure = motion->get_pressure();
+        uint8_t tilt;
+        uint16_t rotation;
+        pen_tilt_to_limelight(motion->get_tilt(), &tilt, &rotation);
+        uint8_t tool = motion->get_pen_inverted() ? LI_TOOL_TYPE_ERASER : LI_TOOL_TYPE_PEN;
+        p_sender->queue_pen(pen_contact ? LI_TOUCH_EVENT_MOVE : LI_TOUCH_EVENT_HOVER, tool, pen_buttons,
+                position.x, position.y, pen_contact ? pen_pressure : 0.0f, rotation, tilt, stream_size.x, stream_size.y);
+        return true;
+    }
+
+    Ref<InputEventMouseButton> button = p_event;
+    if (button.is_null()) {
+        return false;
+    }
+    // 按钮事件不带压力与倾斜：按下时根据之前的移动事件判断来源，
+    // 松开时只有按笔发送过按下的按钮才按笔处理，否则交给鼠标以免鼠标按钮卡住
+    uint8_t event_type;
+    switch (button->get_button_index()) {
+        case MOUSE_BUTTON_LEFT:
+            if (button->is_pressed() ? (!pen_in_use || !inside) : !pen_contact) {
+                return false;
+            }
+            pen_contact = button->is_pressed();
+            event_type = pen_contact ? LI_TOUCH_EVENT_DOWN : LI_TOUCH_EVENT_UP;
+            break;
+        case MOUSE_BUTTON_RIGHT:
+        case MOUSE_BUTTON_MIDDLE: {
+            uint8_t flag = button->get_button_index() == MOUSE_BUTTON_RIGHT ? LI_PEN_BUTTON_PRIMARY : LI_PEN_BUTTON_SECONDARY;
+            if (button->is_pressed() ? !pen_in_use : !(pen_buttons & flag)) {
+                return false;
+            }
+            pen_buttons = button->is_pressed() ? (pen_buttons | flag) : (pen_buttons & ~flag);
+            event_type = LI_TOUCH_EVENT_BUTTON_ONLY;
+        } break;
+        default:
+            // 滚轮等仍按鼠标处理
+            return false;
+    }
+    p_sender->queue_pen(event_type, LI_TOOL_TYPE_PEN, pen_buttons, position.x, position.y,
+            pen_contact ? MAX(pen_pressure, 0.01f) : 0.0f, LI_ROT_UNKNOWN, LI_TILT_UNKNOWN, stream_size.x, stream_size.y);
+    return true;
+}
+
+bool MoonlightInput::_handle_touch_event(const Ref<InputEvent> &p_event, InputSender *p_sender) {
+    // 触摸已原生转发，忽略 Godot 由触摸模拟出的鼠标事件
+    Ref<InputEventMouse> mouse = p_event;
+    if (mouse.is_valid()) {
+        return mouse->get_device() == DEVICE_ID_EMULATION;
+    }
+
+    Ref<InputEventScreenTouch> touch = p_event;
+    if (touch.is_valid()) {
+        int index = touch->get_index();
+        if (index < 0 || index >= 64) {
+            return false;
+        }
+        uint64_t bit = 1ULL << index;
+        Vector2 position;
+        Vector2i stream_size;
+        bool inside = _map_to_stream(touch->get_position(), &position, &stream_size);
+        if (touch->is_pressed()) {
+            if (!inside) {
+                return false;
+            }
+            active_touches |= bit;
+            p_sender->queue_touch(LI_TOUCH_EVENT_DOWN, (uint32_t)index, position.x, position.y, 1.0f, stream_size.x, stream_size.y);
+            return true;
+        }
+        if (!(active_touches & bit)) {
+            return false;
+        }
+        active_touches &= ~bit;
+        position = position.clamp(Vector2(), Vector2(1, 1));
+        uint8_t event_type = touch->is_canceled() ? LI_TOUCH_EVENT_CANCEL : LI_TOUCH_EVENT_UP;
+        p_sender->queue_touch(event_type, (uint32_t)index, position.x, position.y, 0.0f, stream_size.x, stream_size.y);
+        return true;
+    }
+
+    Ref<InputEventScreenDrag> drag = p_event;
+    if (drag.is_null()) {
+        return false;
+    }
+    int index = drag->get_index();
+    if (index < 0 || index >= 64 || !(active_touches & (1ULL << index))) {
+        return false;
+    }
+    Vector2 position;
+    Vector2i stream_size;
+    _map_to_stream(drag->get_position(), &position, &stream_size);
+    position = position.clamp(Vector2(), Vector2(1, 1));
+    // 不支持压力的触摸屏报告 0，按完全按下处理
+    float pressure = drag->get_pressure() > 0.0f ? drag->get_pressure() : 1.0f;
+    p_sender->queue_touch(LI_TOUCH_EVENT_MOVE, (uint32_t)index, position.x, position.y, pressure, stream_size.x, stream_size.y);
+    return true;
+}
+
+// 将视口坐标映射到串流画面的归一化坐标，返回是否位于画面内
+bool MoonlightInput::_map_to_stream(const Vector2 &p_position, Vector2 *r_position, Vector2i *r_stream_size) {
+    MoonlightStreamCore *core = get_stream_core();
+    Control *control = get_input_control();
+    if (!core || !control) {
+        return false;
+    }
+    Vector2i stream_size = core->get_stream_size();
+    if (transform_dirty || stream_size != transform_stream_size || control->get_instance_id() != transform_control_id) {
+        _update_transform(control, stream_size);
+    }
+    if (!transform_valid) {
+        return false;
+    }
+    *r_position = viewport_to_stream.xform(p_position);
+    *r_stream_size = stream_size;
+    return r_position->x >= 0.0f && r_position->x <= 1.0f && r_position->y >= 0.0f && r_position->y <= 1.0f;
+}
+
+// 按保持宽高比居中 (与 TextureRect 的 STRETCH_KEEP_ASPECT_CENTERED 相同) 计算画面区域
+void MoonlightInput::_update_transform(Control *p_control, const Vector2i &p_stream_size) {
+    _watch_control(p_control);
+    transform_dirty = false;
+    transform_stream_size = p_stream_size;
+    transform_valid = false;
+
+    Vector2 size = p_control->get_size();
+    if (p_stream_size.x <= 0 || p_stream_size.y <= 0 || size.x <= 0 || size.y <= 0) {
+        return;
+    }
+    float scale = MIN(size.x / p_stream_size.x, size.y / p_stream_size.y);
+    Vector2 video_size = Vector2(p_stream_size) * scale;
+    Vector2 offset = (size - video_size) / 2;
+
+    Transform2D local_to_stream(0.0f, Size2(1.0f / video_size.x, 1.0f / video_size.y), 0.0f, -offset / video_size);
+    viewport_to_stream = local_to_stream * p_control->get_global_transform_with_canvas().affine_inverse();
+    transform_valid = true;
+}
+
+// 控件或视口尺寸变化时使缓存的映射失效
+void MoonlightInput::_watch_control(Control *p_control) {
+    Callable on_changed = callable_mp(this, &MoonlightInput::invalidate_transform);
+    if (p_control->get_instance_id() == transform_control_id) {
+        return;
+    }
+    if (Control *old_control = Object::cast_to<Control>(ObjectDB::get_instance(transform_control_id))) {
+        if (old_control->is_connected("item_rect_changed", on_changed)) {
+            old_control->disconnect("item_rect_changed", on_changed);
+        }
+        Viewport *old_viewport = old_control->get_viewport();
+        if (old_viewport && old_viewport->is_connected("size_changed", on_changed)) {
+            old_viewport->disconnect("size_changed", on_changed);
+        }
+    }
+    transform_control_id = p_control->get_instance_id();
+    p_control->connect("item_rect_changed", on_changed);
+    if (Viewport *viewport = p_control->get_viewport()) {
+        viewport->connect("size_changed", on_changed);
+    }
+}
+
+void MoonlightInput::invalidate_transform() {
+    transform_dirty = true;
+}
+
+bool MoonlightInput::_handle_joypad_event(const Ref<InputEvent> &p_event, InputSender *p_sender) {
+    Ref<InputEventJoypadButton> button = p_event;
+    Ref<InputEventJoypadMotion> motion = p_event;
+    if (button.is_null() && motion.is_null()) {
+        return false;
+    }
+    // 采样线程运行时手柄状态由其直接读取，事件只用于标记已处理
+    MoonlightStreamCore *core = get_stream_core();
+    if (core && core->get_gamepad_sampler()->is_running()) {
+        return true;
+    }
+
+    if (button.is_valid()) {
+        int flag = GamepadSampler::get_button_flag((int)button->get_button_index());
+        if (flag == 0) {
+            return false;
+        }
+        int controller = _get_controller(button->get_device(), true);
+        if (controller < 0) {
+            return false;
+        }
+        InputSender::ControllerState &state = controller_states[controller];
+        if (button->is_pressed()) {
+            state.button_flags |= flag;
+        } else {
+            state.button_flags &= ~flag;
+        }
+        p_sender->set_controller_state(controller, state);
+        return true;
+    }
+
+    int controller = _get_controller(motion->get_device(), true);
+    if (controller < 0) {
+        return false;
+    }
+    InputSender::ControllerState &state = controller_states[controller];
+    float value = motion->get_axis_value();
+    switch (motion->get_axis()) {
+        case JOY_AXIS_LEFT_X:
+            state.left_stick_x = GamepadSampler::to_stick_value(value, false);
+            break;
+        case JOY_AXIS_LEFT_Y:
+            state.left_stick_y = GamepadSampler::to_stick_value(value, true);
+            break;
+        case JOY_AXIS_RIGHT_X:
+            state.right_stick_x = GamepadSampler::to_stick_value(value, false);
+            break;
+        case JOY_AXIS_RIGHT_Y:
+            state.right_stick_y = GamepadSampler::to_stick_value(value, true);
+            break;
+        case JOY_AXIS_TRIGGER_LEFT:
+            state.left_trigger = GamepadSampler::to_trigger_value(value);
+            break;
+        case JOY_AXIS_TRIGGER_RIGHT:
+            state.right_trigger = GamepadSampler::to_trigger_value(value);
+            break;
+        default:
+            return false;
+    }
+    // 状态未变化 (例如死区内的抖动) 时由 InputSender 丢弃
+    p_sender->set_controller_state(controller, state);
+    return true;
+}
+
+// 按设备出现的顺序分配 Limelight 手柄编号
+int MoonlightInput::_get_controller(int p_device, bool p_allocate) {
+    int free_slot = -1;
+    for (int i = 0; i < InputSender::MAX_CONTROLLERS; i++) {
+        if (controller_devices[i] == p_device) {
+            return i;
+        }
+        if (free_slot < 0 && controller_devices[i] < 0) {
+            free_slot = i;
+        }
+    }
+    if (!p_allocate || free_slot < 0) {
+        return -1;
+    }
+    controller_devices[free_slot] = p_device;
+    controller_states[free_slot] = InputSender::ControllerState();
+    if (MoonlightStreamCore *core = get_stream_core()) {
+        uint8_t type = controller_type_for_name(Input::get_singleton()->get_joy_name(p_device));
+        core->get_input_sender()->set_controller_info(free_slot, type, LI_CCAP_ANALOG_TRIGGERS | LI_CCAP_RUMBLE | LI_CCAP_TRIGGER_RUMBLE);
+        core->get_gamepad_sampler()->set_controller_device(free_slot, p_device);
+    }
+    return free_slot;
+}
+
+void MoonlightInput::_assign_connected_joypads() {
+    if (!capture_gamepads || !is_inside_tree() || !get_stream_core()) {
+        return;
+    }
+    TypedArray<int> joypads = Input::get_singleton()->get_connected_joypads();
+    for (int i = 0; i < joypads.size(); i++) {
+        _get_controller((int)joypads[i], true);
+    }
+}
+
+void MoonlightInput::_release_controller(int p_controller) {
+    int device = controller_devices[p_controller];
+    if (device < 0) {
+        return;
+    }
+    if (rumble_low[p_controller] || rumble_high[p_controller] || rumble_left_trigger[p_controller] || rumble_right_trigger[p_controller]) {
+        Input::get_singleton()->stop_joy_vibration(device);
+    }
+    rumble_low[p_controller] = 0;
+    rumble_high[p_controller] = 0;
+    rumble_left_trigger[p_controller] = 0;
+    rumble_right_trigger[p_controller] = 0;
+    controller_devices[p_controller] = -1;
+    controller_states[p_controller] = InputSender::ControllerState();
+    if (MoonlightStreamCore *core = get_stream_core()) {
+        // 先停止采样，避免断开后又发送一次旧状态
+        core->get_gamepad_sampler()->set_controller_device(p_controller, -1);
+        core->get_input_sender()->set_controller_connected(p_controller, false);
+    }
+}
+
+void MoonlightInput::_release_all_controllers() {
+    for (int i = 0; i < InputSender::MAX_CONTROLLERS; i++) {
+        _release_controller(i);
+    }
+}
+
+void MoonlightInput::_on_joy_connection_changed(int p_device, bool p_connected) {
+    if (p_connected) {
+        if (capture_gamepads && get_stream_core()) {
+            _get_controller(p_device, true);
+        }
+        return;
+    }
+    int controller = _get_controller(p_device, false);
+    if (controller >= 0) {
+        _release_controller(controller);
+    }
+}
+
+void MoonlightInput::_on_controller_rumble(int p_controller, int p_low_frequency, int p_high_frequency) {
+    if (p_controller < 0 || p_controller >= InputSender::MAX_CONTROLLERS) {
+        return;
+    }
+    rumble_low[p_controller] = (uint16_t)p_low_frequency;
+    rumble_high[p_controller] = (uint16_t)p_high_frequency;
+    _apply_vibration(p_controller);
+}
+
+void MoonlightInput::_on_controller_trigger_rumble(int p_controller, int p_left, int p_right) {
+    if (p_controller < 0 || p_controller >= InputSender::MAX_CONTROLLERS) {
+        return;
+    }
+    rumble_left_trigger[p_controller] = (uint16_t)p_left;
+    rumble_right_trigger[p_controller] = (uint16_t)p_right;
+    _apply_vibration(p_controller);
+}
+
+// Godot 只有强/弱两个马达：低频马达对应强马达，高频马达与扳机马达取最大值作为弱马达
+void MoonlightInput::_apply_vibration(int p_controller) {
+    int device = controller_devices[p_controller];
+    if (device < 0) {
+        return;
+    }
+    uint16_t strong = rumble_low[p_controller];
+    uint16_t weak = MAX(rumble_high[p_controller], MAX(rumble_left_trigger[p_controller], rumble_right_trigger[p_controller]));
+    if (strong == 0 && weak == 0) {
+        Input::get_singleton()->stop_joy_vibration(device);
+        return;
+    }
+    // duration 为 0 时持续振动，直到主机发送新的强度
+    Input::get_singleton()->start_joy_vibration(device, weak / 65535.0f, strong / 65535.0f, 0.0f);
+}
+
+void MoonlightInput::set_stream_core(MoonlightStreamCore *p_core) {
+    MoonlightStreamCore *old_core = get_stream_core();
+    if (old_core == p_core) {
+        return;
+    }
+    if (old_core) {
+        _release_all_controllers();
+        old_core->disconnect("controller_rumble", callable_mp(this, &MoonlightInput::_on_controller_rumble));
+        old_core->disconnect("controller_trigger_rumble", callable_mp(this, &MoonlightInput::_on_controller_trigger_rumble));
+    }
+    stream_core_id = p_core ? p_core->get_instance_id() : ObjectID();
+    if (p_core) {
+        p_core->connect("controller_rumble", callable_mp(this, &MoonlightInput::_on_controller_rumble));
+        p_core->connect("controller_trigger_rumble", callable_mp(this, &MoonlightInput::_on_controller_trigger_rumble));
+        _assign_connected_joypads();
+    }
+}
+
+MoonlightStreamCore *MoonlightInput::get_stream_core() const {
+    return Object::cast_to<MoonlightStreamCore>(ObjectDB::get_instance(stream_core_id));
+}
+
+void MoonlightInput::set_capture_mouse(bool p_enabled) {
+    capture_mouse = p_enabled;
+}
+
+bool MoonlightInput::is_capturing_mouse() const {
+    return capture_mouse;
+}
+
+void MoonlightInput::set_capture_gamepads(bool p_enabled) {
+    if (capture_gamepads == p_enabled) {
+        return;
+    }
+    capture_gamepads = p_enabled;
+    if (capture_gamepads) {
+        _assign_connected_joypads();
+    } else {
+        // 停止转发时从主机端拔出所有手柄
+        _release_all_controllers();
+    }
+}
+
+bool MoonlightInput::is_capturing_gamepads() const {
+    return capture_gamepads;
+}
+
+void MoonlightInput::set_capture_touch(bool p_enabled) {
+    capture_touch = p_enabled;
+    active_touches = 0;
+}
+
+bool MoonlightInput::is_capturing_touch() const {
+    return capture_touch;
+}
+
+void MoonlightInput::set_capture_pen(bool p_enabled) {
+    capture_pen = p_enabled;
+    pen_contact = false;
+    pen_buttons = 0;
+    pen_in_use = false;
+}
+
+bool MoonlightInput::is_capturing_pen() const {
+    return capture_pen;
+}
+
+void MoonlightInput::set_mouse_mode(MouseMode p_mode) {
+    mouse_mode = p_mode;
+}
+
+MoonlightInput::MouseMode MoonlightInput::get_mouse_mode() const {
+    return mouse_mode;
+}
+
+void MoonlightInput::set_input_control(Control *p_control) {
+    input_control_id = p_control ? p_control->get_instance_id() : ObjectID();
+    transform_dirty = true;
+}
+
+Control *MoonlightInput::get_input_control() const {
+    if (Control *control = Object::cast_to<Control>(ObjectDB::get_instance(input_control_id))) {
+        return control;
+    }
+    MoonlightStreamCore *core = get_stream_core();
+    return core ? core->get_display_control() : nullptr;
+}
+
+void MoonlightInput::set_capture_keyboard(bool p_enabled) {
+    if (!p_enabled) {
+        release_all();
+    }
+    capture_keyboard = p_enabled;
+}
+
+bool MoonlightInput::is_capturing_keyboard() const {
+    return capture_keyboard;
+}
+
+void MoonlightInput::set_use_physical_keys(bool p_enabled) {
+    if (use_physical_keys == p_enabled) {
+        return;
+    }
+    // 两种模式下同一按键的虚拟键码可能不同，切换前先松开
+    release_all();
+    use_physical_keys = p_enabled;
+}
+
+bool MoonlightInput::is_using_physical_keys() const {
+    return use_physical_keys;
+}
+
+void MoonlightInput::set_text_input(bool p_enabled) {
+    text_input = p_enabled;
+}
+
+bool MoonlightInput::is_text_input_enabled() const {
+    return text_input;
+}
+
+Error MoonlightInput::send_key_event(int64_t p_keycode, bool p_pressed) {
+    InputSender *sender = _get_sender();
+    if (!sender) {
+        return ERR_UNCONFIGURED;
+    }
+    uint8_t virtual_key = key_translation::to_virtual_key(p_keycode & KEY_CODE_MASK);
+    if (virtual_key == 0) {
+        return ERR_INVALID_PARAMETER;
+    }
+    uint8_t modifiers = 0;
+    if (p_keycode & KEY_MASK_SHIFT) {
+        modifiers |= MODIFIER_SHIFT;
+    }
+    if (p_keycode & KEY_MASK_CTRL) {
+        modifiers |= MODIFIER_CTRL;
+    }
+    if (p_keycode & KEY_MASK_ALT) {
+        modifiers |= MODIFIER_ALT;
+    }
+    if (p_keycode & KEY_MASK_META) {
+        modifiers |= MODIFIER_META;
+    }
+    _queue_key(sender, virtual_key, p_pressed, modifiers);
+    return OK;
+}
+
+Error MoonlightInput::send_text(const String &p_text) {
+    InputSender *sender = _get_sender();
+    if (!sender) {
+        return ERR_UNCONFIGURED;
+    }
+    _queue_text(sender, p_text);
+    return OK;
+}
+
+void MoonlightInput::release_all() {
+    InputSender *sender = _get_sender();
+    if (sender) {
+        for (int virtual_key = 0; virtual_key < (int)pressed_keys.size(); virtual_key++) {
+            if (pressed_keys[virtual_key]) {
+                sender->queue_key((uint8_t)virtual_key, false, 0, use_physical_keys ? 0 : SS_KBE_FLAG_NON_NORMALIZED);
+            }
+        }
+        for (int button = BUTTON_LEFT; button <= BUTTON_X2; button++) {
+            if (pressed_mouse_buttons & (1 << button)) {
+                sender->queue_mouse_button(button, false);
+            }
+        }
+    }
+    pressed_keys.reset();
+    pressed_mouse_buttons = 0;
+}
+
+Dictionary MoonlightInput::get_input_stats() const {
+    Dictionary stats;
+    MoonlightStreamCore *core = get_stream_core();
+    if (!core) {
+        return stats;
+    }
+    InputSender::Stats sender_stats = core->get_input_sender()->get_stats();
+    stats["queued_events"] = (int64_t)sender_stats.queued_events;
+    stats["sent_events"] = (int64_t)sender_stats.sent_events;
+    stats["coalesced_events"] = (int64_t)sender_stats.coalesced_events;
+    stats["skipped_controller_states"] = (int64_t)sender_stats.skipped_controller_states;
+    stats["gamepad_samples"] = (int64_t)core->get_gamepad_sampler()->get_sample_count();
+    return stats;
+}
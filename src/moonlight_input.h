@@ -0,0 +1,145 @@
+#pragma once
+
+#include <godot_cpp/classes/control.hpp>
+#include <godot_cpp/classes/input_event.hpp>
+#include <godot_cpp/classes/node.hpp>
+#include <godot_cpp/variant/dictionary.hpp>
+#include <godot_cpp/variant/transform2d.hpp>
+
+#include "input_sender.h"
+
+#include <bitset>
+
+using namespace godot;
+
+class MoonlightStreamCore;
+
+// 输入转发节点
+// 在 C++ 中直接处理 Godot 的 InputEvent，转换后交给 MoonlightStreamCore 的输入线程发送，
+// GDScript 不必为每个输入事件调用一次 Limelight。
+// 默认使用父节点 MoonlightStreamCore，也可通过 stream_core 指定。
+// 已连接的手柄由 MoonlightStreamCore 的 GamepadSampler 高频采样；主机端的振动转发到对应的 Godot 手柄。
+// 触摸、笔与绝对鼠标按显示画面的控件映射到串流坐标，映射矩阵只在布局或串流分辨率变化时重新计算。
+// 键盘通过编译期生成的查找表转换为虚拟键码；当前布局特有的字符与 send_text 以 UTF-8 文本事件发送。
+// 失去焦点时松开所有已按下的键与鼠标按钮。
+class MoonlightInput : public Node {
+    GDCLASS(MoonlightInput, Node)
+
+public:
+    enum MouseMode {
+        MOUSE_MODE_RELATIVE,  // 发送相对移动 (适合捕获鼠标的游戏)
+        MOUSE_MODE_ABSOLUTE,  // 按画面位置发送绝对坐标 (适合桌面操作)
+    };
+
+private:
+    ObjectID stream_core_id;
+    ObjectID input_control_id;
+    bool capture_mouse = true;
+    bool capture_gamepads = true;
+    bool capture_touch = true;
+    bool capture_pen = false;
+    bool capture_keyboard = true;
+    bool use_physical_keys = true;
+    bool text_input = true;
+    MouseMode mouse_mode = MOUSE_MODE_RELATIVE;
+
+    // 视口坐标 -> 串流画面归一化坐标 (0~1)
+    Transform2D viewport_to_stream;
+    bool transform_dirty = true;
+    bool transform_valid = false;
+    Vector2i transform_stream_size;
+    ObjectID transform_control_id;
+
+    // 已按下的触点 (按 index)，用于在画面外抬起时仍然发送 UP
+    uint64_t active_touches = 0;
+    uint8_t pen_buttons = 0;
+    bool pen_contact = false;
+    float pen_pressure = 0.0f;
+    // 最近一次移动事件带有笔数据 (压力、倾斜或橡皮擦)，之后的按钮事件按笔处理
+    bool pen_in_use = false;
+
+    // 已发送按下的虚拟键码与鼠标按钮，失去焦点时统一发送松开，避免主机端按键卡住
+    std::bitset<256> pressed_keys;
+    uint8_t pressed_mouse_buttons = 0;
+
+    // Limelight 手柄编号 -> Godot 设备号 (-1 表示空闲)
+    int controller_devices[InputSender::MAX_CONTROLLERS];
+    InputSender::ControllerState controller_states[InputSender::MAX_CONTROLLERS];
+
+    // 主机端请求的振动强度 (0~65535)
+    uint16_t rumble_low[InputSender::MAX_CONTROLLERS] = {};
+    uint16_t rumble_high[InputSender::MAX_CONTROLLERS] = {};
+    uint16_t rumble_left_trigger[InputSender::MAX_CONTROLLERS] = {};
+    uint16_t rumble_right_trigger[InputSender::MAX_CONTROLLERS] = {};
+
+    InputSender *_get_sender() const;
+    int _get_controller(int p_device, bool p_allocate);
+    void _assign_connected_joypads();
+    void _release_controller(int p_controller);
+    void _release_all_controllers();
+    bool _handle_mouse_event(const Ref<InputEvent> &p_event, InputSender *p_sender);
+    bool _handle_absolute_mouse_event(const Ref<InputEvent> &p_event, InputSender *p_sender);
+    bool _handle_pen_event(const Ref<InputEvent> &p_event, InputSender *p_sender);
+    bool _handle_touch_event(const Ref<InputEvent> &p_event, InputSender *p_sender);
+    bool _handle_key_event(const Ref<InputEvent> &p_event, InputSender *p_sender);
+    void _queue_mouse_button(InputSender *p_sender, int p_button, bool p_pressed);
+    void _queue_key(InputSender *p_sender, uint8_t p_virtual_key, bool p_pressed, uint8_t p_modifiers);
+    void _queue_text(InputSender *p_sender, const String &p_text);
+    bool _map_to_stream(const Vector2 &p_position, Vector2 *r_position, Vector2i *r_stream_size);
+    void _update_transform(Control *p_control, const Vector2i &p_stream_size);
+    void _watch_control(Control *p_control);
+    bool _handle_joypad_event(const Ref<InputEvent> &p_event, InputSender *p_sender);
+    void _on_joy_connection_changed(int p_device, bool p_connected);
+    void _on_controller_rumble(int p_controller, int p_low_frequency, int p_high_frequency);
+    void _on_controller_trigger_rumble(int p_controller, int p_left, int p_right);
+    void _apply_vibration(int p_controller);
+
+protected:
+    static void _bind_methods();
+    void _notification(int p_what);
+
+public:
+    MoonlightInput();
+
+    void _input(const Ref<InputEvent> &p_event) override;
+
+    // 处理一个输入事件，返回是否已转发给主机
+    bool handle_input_event(const Ref<InputEvent> &p_event);
+
+    void set_stream_core(MoonlightStreamCore *p_core);
+    MoonlightStreamCore *get_stream_core() const;
+    void set_capture_mouse(bool p_enabled);
+    bool is_capturing_mouse() const;
+    void set_capture_gamepads(bool p_enabled);
+    bool is_capturing_gamepads() const;
+    void set_capture_touch(bool p_enabled);
+    bool is_capturing_touch() const;
+    void set_capture_pen(bool p_enabled);
+    bool is_capturing_pen() const;
+    void set_mouse_mode(MouseMode p_mode);
+    MouseMode get_mouse_mode() const;
+
+    void set_capture_keyboard(bool p_enabled);
+    bool is_capturing_keyboard() const;
+    void set_use_physical_keys(bool p_enabled);
+    bool is_using_physical_keys() const;
+    void set_text_input(bool p_enabled);
+    bool is_text_input_enabled() const;
+
+    // keycode 为 Godot 的 Key，可带 KEY_MASK_* 修饰键 (与 InputEventKey.get_keycode_with_modifiers 相同)
+    Error send_key_event(int64_t p_keycode, bool p_pressed);
+    // 以 UTF-8 文本发送 (适合输入法与屏幕键盘)
+    Error send_text(const String &p_text);
+    // 松开所有已按下的键与鼠标按钮
+    void release_all();
+
+    // 显示串流画面的控件，为空时使用 MoonlightStreamCore 的 display_control
+    void set_input_control(Control *p_control);
+    Control *get_input_control() const;
+    // 控件的父节点移动或缩放时需手动调用 (控件自身的布局变化会自动检测)
+    void invalidate_transform();
+
+    Dictionary get_input_stats() const;
+};
+
+VARIANT_ENUM_CAST(MoonlightInput::MouseMode);
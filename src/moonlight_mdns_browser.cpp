@@ -0,0 +1,125 @@
+#include "moonlight_mdns_browser.h"
+
+#include <godot_cpp/core/class_db.hpp>
+#include <godot_cpp/variant/packed_string_array.hpp>
+#include <godot_cpp/variant/utility_functions.hpp>
+
+void MoonlightMdnsBrowser::_bind_methods() {
+    ClassDB::bind_method(D_METHOD("start_discovery"), &MoonlightMdnsBrowser::start_discovery);
+    ClassDB::bind_method(D_METHOD("stop_discovery"), &MoonlightMdnsBrowser::stop_discovery);
+    ClassDB::bind_method(D_METHOD("is_discovering"), &MoonlightMdnsBrowser::is_discovering);
+    ClassDB::bind_method(D_METHOD("refresh"), &MoonlightMdnsBrowser::refresh);
+    ClassDB::bind_method(D_METHOD("get_discovered_hosts"), &MoonlightMdnsBrowser::get_discovered_hosts);
+
+    ClassDB::bind_method(D_METHOD("set_use_ipv4", "enabled"), &MoonlightMdnsBrowser::set_use_ipv4);
+    ClassDB::bind_method(D_METHOD("is_using_ipv4"), &MoonlightMdnsBrowser::is_using_ipv4);
+    ClassDB::bind_method(D_METHOD("set_use_ipv6", "enabled"), &MoonlightMdnsBrowser::set_use_ipv6);
+    ClassDB::bind_method(D_METHOD("is_using_ipv6"), &MoonlightMdnsBrowser::is_using_ipv6);
+    ADD_PROPERTY(PropertyInfo(Variant::BOOL, "use_ipv4"), "set_use_ipv4", "is_using_ipv4");
+    ADD_PROPERTY(PropertyInfo(Variant::BOOL, "use_ipv6"), "set_use_ipv6", "is_using_ipv6");
+
+    ADD_SIGNAL(MethodInfo("host_found", PropertyInfo(Variant::STRING, "name"), PropertyInfo(Variant::STRING, "address"), PropertyInfo(Variant::INT, "port")));
+    ADD_SIGNAL(MethodInfo("host_lost", PropertyInfo(Variant::STRING, "name"), PropertyInfo(Variant::STRING, "address")));
+}
+
+MoonlightMdnsBrowser::MoonlightMdnsBrowser() {
+    set_process_internal(true);
+}
+
+MoonlightMdnsBrowser::~MoonlightMdnsBrowser() {
+    browser.stop();
+}
+
+void MoonlightMdnsBrowser::_notification(int p_what) {
+    switch (p_what) {
+        case NOTIFICATION_INTERNAL_PROCESS: {
+            if (browser.has_events()) {
+                _dispatch_events();
+            }
+        } break;
+        case NOTIFICATION_EXIT_TREE: {
+            stop_discovery();
+        } break;
+    }
+}
+
+void MoonlightMdnsBrowser::_dispatch_events() {
+    for (const MdnsBrowser::Event &event : browser.take_events()) {
+        String name = String::utf8(event.instance.c_str());
+        String address = String(event.address.c_str());
+
+        if (event.type == MdnsBrowser::Event::FOUND) {
+            Dictionary host = discovered_hosts.get(name, Dictionary());
+            PackedStringArray addresses = host.get("addresses", PackedStringArray());
+            if (!addresses.has(address)) {
+                addresses.append(address);
+            }
+            host["name"] = name;
+            host["hostname"] = String::utf8(event.hostname.c_str());
+            host["port"] = event.port;
+            host["addresses"] = addresses;
+            discovered_hosts[name] = host;
+            emit_signal("host_found", name, address, event.port);
+        } else {
+            if (discovered_hosts.has(name)) {
+                Dictionary host = discovered_hosts[name];
+                PackedStringArray addresses = host.get("addresses", PackedStringArray());
+                int64_t index = addresses.find(address);
+                if (index >= 0) {
+                    addresses.remove_at(index);
+                }
+                if (addresses.is_empty()) {
+                    discovered_hosts.erase(name);
+                } else {
+                    host["addresses"] = addresses;
+                    discovered_hosts[name] = host;
+                }
+            }
+            emit_signal("host_lost", name, address);
+        }
+    }
+}
+
+bool MoonlightMdnsBrowser::start_discovery() {
+    MdnsBrowser::Config config;
+    config.use_ipv4 = use_ipv4;
+    config.use_ipv6 = use_ipv6;
+    if (!browser.start(config)) {
+        UtilityFunctions::push_error("MoonlightMdnsBrowser: Failed to open mDNS sockets");
+        return false;
+    }
+    return true;
+}
+
+void MoonlightMdnsBrowser::stop_discovery() {
+    browser.stop();
+    discovered_hosts.clear();
+}
+
+bool MoonlightMdnsBrowser::is_discovering() const {
+    return browser.is_running();
+}
+
+void MoonlightMdnsBrowser::refresh() {
+    browser.query_now();
+}
+
+Array MoonlightMdnsBrowser::get_discovered_hosts() const {
+    return discovered_hosts.values();
+}
+
+void MoonlightMdnsBrowser::set_use_ipv4(bool p_enabled) {
+    use_ipv4 = p_enabled;
+}
+
+bool MoonlightMdnsBrowser::is_using_ipv4() const {
+    return use_ipv4;
+}
+
+void MoonlightMdnsBrowser::set_use_ipv6(bool p_enabled) {
+    use_ipv6 = p_enabled;
+}
+
+bool MoonlightMdnsBrowser::is_using_ipv6() const {
+    return use_ipv6;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <godot_cpp/classes/node.hpp>
+#include <godot_cpp/variant/array.hpp>
+#include <godot_cpp/variant/dictionary.hpp>
+
+#include "host/mdns_browser.h"
+
+using namespace godot;
+
+// 局域网主机发现节点 (mDNS _nvstream._tcp)
+// 每解析到一个主机地址就在主线程发出 host_found，无需等待整个发现过程结束。
+class MoonlightMdnsBrowser : public Node {
+    GDCLASS(MoonlightMdnsBrowser, Node)
+
+private:
+    MdnsBrowser browser;
+    bool use_ipv4 = true;
+    bool use_ipv6 = true;
+    // 实例名 -> { hostname, port, addresses }
+    Dictionary discovered_hosts;
+
+    void _dispatch_events();
+
+protected:
+    static void _bind_methods();
+    void _notification(int p_what);
+
+public:
+    MoonlightMdnsBrowser();
+    ~MoonlightMdnsBrowser();
+
+    bool start_discovery();
+    void stop_discovery();
+    bool is_discovering() const;
+    void refresh();
+
+    Array get_discovered_hosts() const;
+
+    void set_use_ipv4(bool p_enabled);
+    bool is_using_ipv4() const;
+    void set_use_ipv6(bool p_enabled);
+    bool is_using_ipv6() const;
+};
@@ -0,0 +1,125 @@
+#include "moonlight_network_probe.h"
+
+#include <godot_cpp/core/class_db.hpp>
+#include <godot_cpp/variant/utility_functions.hpp>
+
+void MoonlightNetworkProbe::_bind_methods() {
+    ClassDB::bind_method(D_METHOD("start_probe", "address", "options"), &MoonlightNetworkProbe::start_probe, DEFVAL(Dictionary()));
+    ClassDB::bind_method(D_METHOD("cancel_probe"), &MoonlightNetworkProbe::cancel_probe);
+    ClassDB::bind_method(D_METHOD("is_probing"), &MoonlightNetworkProbe::is_probing);
+
+    ClassDB::bind_method(D_METHOD("start_echo_server", "port", "bind_address"), &MoonlightNetworkProbe::start_echo_server, DEFVAL(0), DEFVAL("127.0.0.1"));
+    ClassDB::bind_method(D_METHOD("stop_echo_server"), &MoonlightNetworkProbe::stop_echo_server);
+    ClassDB::bind_method(D_METHOD("get_echo_server_port"), &MoonlightNetworkProbe::get_echo_server_port);
+
+    ADD_SIGNAL(MethodInfo("probe_finished", PropertyInfo(Variant::DICTIONARY, "result")));
+}
+
+MoonlightNetworkProbe::MoonlightNetworkProbe() {
+    set_process_internal(true);
+}
+
+MoonlightNetworkProbe::~MoonlightNetworkProbe() {
+    echo_server.stop();
+}
+
+void MoonlightNetworkProbe::_notification(int p_what) {
+    switch (p_what) {
+        case NOTIFICATION_INTERNAL_PROCESS: {
+            if (probe.has_result()) {
+                _dispatch_result();
+            }
+        } break;
+        case NOTIFICATION_EXIT_TREE: {
+            cancel_probe();
+            stop_echo_server();
+        } break;
+    }
+}
+
+void MoonlightNetworkProbe::_dispatch_result() {
+    NetworkProbe::Result result;
+    if (!probe.take_result(&result)) {
+        return;
+    }
+
+    Dictionary dict;
+    dict["success"] = result.success;
+    dict["message"] = String::utf8(result.message.c_str());
+    dict["udp"] = result.udp;
+    dict["samples"] = result.samples;
+    dict["sent"] = result.sent;
+    dict["loss_ratio"] = result.loss_ratio;
+    dict["rtt_min_ms"] = result.rtt_min_ms;
+    dict["rtt_avg_ms"] = result.rtt_avg_ms;
+    dict["jitter_ms"] = result.jitter_ms;
+    dict["bandwidth_measured"] = result.bandwidth_measured;
+    dict["bandwidth_kbps"] = result.bandwidth_kbps;
+    dict["burst_loss_ratio"] = result.burst_loss_ratio;
+    if (result.success) {
+        dict["bitrate_kbps"] = result.bitrate_kbps;
+        dict["width"] = result.width;
+        dict["height"] = result.height;
+        dict["fps"] = result.fps;
+    }
+    emit_signal("probe_finished", dict);
+}
+
+Error MoonlightNetworkProbe::start_probe(const String &p_address, const Dictionary &p_options) {
+    NetworkProbe::Config config;
+    config.address = p_address.strip_edges().utf8().get_data();
+
+    int echo_port = p_options.get("echo_port", 0);
+    int http_port = p_options.get("http_port", (int)config.tcp_port);
+    if (echo_port < 0 || echo_port > 65535 || http_port <= 0 || http_port > 65535) {
+        UtilityFunctions::push_error("MoonlightNetworkProbe: Invalid port");
+        return ERR_INVALID_PARAMETER;
+    }
+    config.echo_port = (uint16_t)echo_port;
+    config.tcp_port = (uint16_t)http_port;
+    config.ping_count = MAX((int)p_options.get("ping_count", config.ping_count), 1);
+    config.ping_interval_ms = MAX((int)p_options.get("ping_interval_ms", config.ping_interval_ms), 1);
+    config.burst_packets = p_options.get("burst_packets", config.burst_packets);
+    config.burst_packet_size = p_options.get("burst_packet_size", config.burst_packet_size);
+    config.timeout_ms = MAX((int)p_options.get("timeout_ms", config.timeout_ms), 50);
+    config.max_width = p_options.get("max_width", config.max_width);
+    config.max_height = p_options.get("max_height", config.max_height);
+    config.max_fps = p_options.get("max_fps", config.max_fps);
+    config.max_bitrate_kbps = p_options.get("max_bitrate_kbps", config.max_bitrate_kbps);
+
+    std::string error;
+    if (!probe.start(config, &error)) {
+        UtilityFunctions::push_error("MoonlightNetworkProbe: ", String::utf8(error.c_str()));
+        return probe.is_running() ? ERR_BUSY : ERR_INVALID_PARAMETER;
+    }
+    return OK;
+}
+
+void MoonlightNetworkProbe::cancel_probe() {
+    probe.cancel();
+}
+
+bool MoonlightNetworkProbe::is_probing() const {
+    return probe.is_running();
+}
+
+Error MoonlightNetworkProbe::start_echo_server(int p_port, const String &p_bind_address) {
+    if (p_port < 0 || p_port > 65535) {
+        return ERR_INVALID_PARAMETER;
+    }
+    echo_server.stop();
+    std::string error;
+    if (!echo_server.start(p_bind_address.utf8().get_data(), (uint16_t)p_port, &error)) {
+        UtilityFunctions::push_error("MoonlightNetworkProbe: ", String::utf8(error.c_str()));
+        return ERR_CANT_CREATE;
+    }
+    return OK;
+}
+
+void MoonlightNetworkProbe::stop_echo_server() {
+    echo_server.stop();
+}
+
+int MoonlightNetworkProbe::get_echo_server_port() const {
+    return echo_server.is_running() ? echo_server.get_port() : 0;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <godot_cpp/classes/node.hpp>
+#include <godot_cpp/variant/dictionary.hpp>
+#include <godot_cpp/variant/string.hpp>
+
+#include "net/network_probe.h"
+
+using namespace godot;
+
+// 连接前的网络质量探测节点
+// 封装 NetworkProbe：探测在工作线程中进行，结果在主线程的 internal process 中以信号发出。
+// 结果中的 bitrate_kbps / width / height / fps 与 MoonlightStreamCore.start_connection 的配置键相同。
+class MoonlightNetworkProbe : public Node {
+    GDCLASS(MoonlightNetworkProbe, Node)
+
+private:
+    NetworkProbe probe;
+    ProbeEchoServer echo_server;
+
+    void _dispatch_result();
+
+protected:
+    static void _bind_methods();
+    void _notification(int p_what);
+
+public:
+    MoonlightNetworkProbe();
+    ~MoonlightNetworkProbe();
+
+    Error start_probe(const String &p_address, const Dictionary &p_options = Dictionary());
+    void cancel_probe();
+    bool is_probing() const;
+
+    Error start_echo_server(int p_port = 0, const String &p_bind_address = "127.0.0.1");
+    void stop_echo_server();
+    int get_echo_server_port() const;
+};
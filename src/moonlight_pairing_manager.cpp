@@ -0,0 +1,120 @@
+#include "moonlight_pairing_manager.h"
+
+#include "moonlight_identity.h"
+
+#include <godot_cpp/core/class_db.hpp>
+#include <godot_cpp/variant/utility_functions.hpp>
+
+void MoonlightPairingManager::_bind_methods() {
+    ClassDB::bind_method(D_METHOD("set_client_certificate", "cert_pem", "key_pem"), &MoonlightPairingManager::set_client_certificate);
+    ClassDB::bind_method(D_METHOD("has_client_certificate"), &MoonlightPairingManager::has_client_certificate);
+
+    ClassDB::bind_method(D_METHOD("start_pairing", "address", "app_version", "pin", "http_port", "https_port"), &MoonlightPairingManager::start_pairing, DEFVAL(GAMESTREAM_DEFAULT_HTTP_PORT), DEFVAL(GAMESTREAM_DEFAULT_HTTPS_PORT));
+    ClassDB::bind_method(D_METHOD("cancel_pairing"), &MoonlightPairingManager::cancel_pairing);
+    ClassDB::bind_method(D_METHOD("is_pairing"), &MoonlightPairingManager::is_pairing);
+    ClassDB::bind_static_method("MoonlightPairingManager", D_METHOD("generate_pin"), &MoonlightPairingManager::generate_pin);
+
+    ADD_SIGNAL(MethodInfo("pairing_progress", PropertyInfo(Variant::INT, "phase")));
+    ADD_SIGNAL(MethodInfo("pairing_finished", PropertyInfo(Variant::INT, "result"), PropertyInfo(Variant::STRING, "server_certificate"), PropertyInfo(Variant::STRING, "message")));
+
+    BIND_ENUM_CONSTANT(PHASE_GET_SERVER_CERT);
+    BIND_ENUM_CONSTANT(PHASE_CLIENT_CHALLENGE);
+    BIND_ENUM_CONSTANT(PHASE_SERVER_CHALLENGE_RESPONSE);
+    BIND_ENUM_CONSTANT(PHASE_CLIENT_PAIRING_SECRET);
+    BIND_ENUM_CONSTANT(PHASE_PAIR_CHALLENGE);
+
+    BIND_ENUM_CONSTANT(PAIRING_PAIRED);
+    BIND_ENUM_CONSTANT(PAIRING_PIN_WRONG);
+    BIND_ENUM_CONSTANT(PAIRING_FAILED);
+    BIND_ENUM_CONSTANT(PAIRING_ALREADY_IN_PROGRESS);
+    BIND_ENUM_CONSTANT(PAIRING_CANCELLED);
+}
+
+MoonlightPairingManager::MoonlightPairingManager() {
+    set_process_internal(true);
+}
+
+MoonlightPairingManager::~MoonlightPairingManager() {
+}
+
+void MoonlightPairingManager::_notification(int p_what) {
+    switch (p_what) {
+        case NOTIFICATION_INTERNAL_PROCESS: {
+            if (engine.has_events()) {
+                _dispatch_events();
+            }
+        } break;
+        case NOTIFICATION_EXIT_TREE: {
+            cancel_pairing();
+        } break;
+    }
+}
+
+void MoonlightPairingManager::_dispatch_events() {
+    for (const PairingEngine::Event &event : engine.take_events()) {
+        if (!event.finished) {
+            emit_signal("pairing_progress", (int)event.phase);
+            continue;
+        }
+        emit_signal("pairing_finished", (int)event.result, String::utf8(event.server_cert_pem.c_str()), String::utf8(event.message.c_str()));
+    }
+}
+
+Error MoonlightPairingManager::set_client_certificate(const String &p_cert_pem, const String &p_key_pem) {
+    std::string error;
+    if (!engine.set_client_identity_pem(p_cert_pem.utf8().get_data(), p_key_pem.utf8().get_data(), &error)) {
+        UtilityFunctions::push_error("MoonlightPairingManager: ", String::utf8(error.c_str()));
+        return ERR_INVALID_DATA;
+    }
+    return OK;
+}
+
+bool MoonlightPairingManager::has_client_certificate() {
+    return engine.has_client_identity();
+}
+
+Error MoonlightPairingManager::start_pairing(const String &p_address, const String &p_app_version, const String &p_pin, int p_http_port, int p_https_port) {
+    if (p_http_port <= 0 || p_http_port > 65535 || p_https_port <= 0 || p_https_port > 65535) {
+        UtilityFunctions::push_error("MoonlightPairingManager: Invalid port");
+        return ERR_INVALID_PARAMETER;
+    }
+
+#ifdef MOONLIGHT_USE_MBEDTLS
+    // 未显式设置证书时使用 MoonlightIdentity 的共享身份
+    MoonlightIdentity *identity = MoonlightIdentity::get_singleton();
+    if (!engine.has_client_identity() && identity) {
+        if (!identity->is_ready()) {
+            String error = identity->get_error();
+            UtilityFunctions::push_error("MoonlightPairingManager: ", error.is_empty() ? String("Client identity is not ready yet") : error);
+            return error.is_empty() ? ERR_BUSY : ERR_CANT_CREATE;
+        }
+        engine.set_client_identity(identity->get_identity(0));
+    }
+#endif
+
+    PairingEngine::Request request;
+    request.address = p_address.utf8().get_data();
+    request.http_port = (uint16_t)p_http_port;
+    request.https_port = (uint16_t)p_https_port;
+    request.app_version = p_app_version.utf8().get_data();
+    request.pin = p_pin.utf8().get_data();
+
+    std::string error;
+    if (!engine.start(request, &error)) {
+        UtilityFunctions::push_error("MoonlightPairingManager: ", String::utf8(error.c_str()));
+        return engine.is_running() ? ERR_BUSY : ERR_CANT_CREATE;
+    }
+    return OK;
+}
+
+void MoonlightPairingManager::cancel_pairing() {
+    engine.cancel();
+}
+
+bool MoonlightPairingManager::is_pairing() const {
+    return engine.is_running();
+}
+
+String MoonlightPairingManager::generate_pin() {
+    return String(PairingEngine::generate_pin().c_str());
+}
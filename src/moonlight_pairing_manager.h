@@ -0,0 +1,57 @@
+#pragma once
+
+#include <godot_cpp/classes/node.hpp>
+#include <godot_cpp/variant/string.hpp>
+
+#include "host/pairing_engine.h"
+
+using namespace godot;
+
+// 主机配对节点
+// 封装 PairingEngine：五个阶段的网络往返与加解密都在后台线程中进行，
+// 进度与结果在主线程的 internal process 中以信号发出，配对期间 UI 不会卡顿。
+class MoonlightPairingManager : public Node {
+    GDCLASS(MoonlightPairingManager, Node)
+
+public:
+    enum PairingPhase {
+        PHASE_GET_SERVER_CERT = PairingEngine::PHASE_GET_SERVER_CERT,
+        PHASE_CLIENT_CHALLENGE = PairingEngine::PHASE_CLIENT_CHALLENGE,
+        PHASE_SERVER_CHALLENGE_RESPONSE = PairingEngine::PHASE_SERVER_CHALLENGE_RESPONSE,
+        PHASE_CLIENT_PAIRING_SECRET = PairingEngine::PHASE_CLIENT_PAIRING_SECRET,
+        PHASE_PAIR_CHALLENGE = PairingEngine::PHASE_PAIR_CHALLENGE,
+    };
+
+    enum PairingResult {
+        PAIRING_PAIRED = PairingEngine::RESULT_PAIRED,
+        PAIRING_PIN_WRONG = PairingEngine::RESULT_PIN_WRONG,
+        PAIRING_FAILED = PairingEngine::RESULT_FAILED,
+        PAIRING_ALREADY_IN_PROGRESS = PairingEngine::RESULT_ALREADY_IN_PROGRESS,
+        PAIRING_CANCELLED = PairingEngine::RESULT_CANCELLED,
+    };
+
+private:
+    PairingEngine engine;
+
+    void _dispatch_events();
+
+protected:
+    static void _bind_methods();
+    void _notification(int p_what);
+
+public:
+    MoonlightPairingManager();
+    ~MoonlightPairingManager();
+
+    Error set_client_certificate(const String &p_cert_pem, const String &p_key_pem);
+    bool has_client_certificate();
+
+    Error start_pairing(const String &p_address, const String &p_app_version, const String &p_pin, int p_http_port = GAMESTREAM_DEFAULT_HTTP_PORT, int p_https_port = GAMESTREAM_DEFAULT_HTTPS_PORT);
+    void cancel_pairing();
+    bool is_pairing() const;
+
+    static String generate_pin();
+};
+
+VARIANT_ENUM_CAST(MoonlightPairingManager::PairingPhase);
+VARIANT_ENUM_CAST(MoonlightPairingManager::PairingResult);
@@ -0,0 +1,180 @@
+#include "moonlight_stats_overlay.h"
+
+#include "moonlight_stream_core.h"
+
+#include <godot_cpp/core/class_db.hpp>
+
+// 文本与背景边缘的间距
+static const float MARGIN = 8.0f;
+
+// 字体变化时预先栅格化到字形图集中的字符，之后刷新数值不会再生成新的字形
+static const char *GLYPH_WARMUP = "0123456789.%:()/x N/A";
+
+void MoonlightStatsOverlay::_bind_methods() {
+    ClassDB::bind_method(D_METHOD("set_stream_core", "core"), &MoonlightStatsOverlay::set_stream_core);
+    ClassDB::bind_method(D_METHOD("get_stream_core"), &MoonlightStatsOverlay::get_stream_core);
+    ClassDB::bind_method(D_METHOD("set_update_interval", "seconds"), &MoonlightStatsOverlay::set_update_interval);
+    ClassDB::bind_method(D_METHOD("get_update_interval"), &MoonlightStatsOverlay::get_update_interval);
+    ClassDB::bind_method(D_METHOD("set_font_size", "size"), &MoonlightStatsOverlay::set_font_size);
+    ClassDB::bind_method(D_METHOD("get_font_size"), &MoonlightStatsOverlay::get_font_size);
+    ClassDB::bind_method(D_METHOD("set_background_color", "color"), &MoonlightStatsOverlay::set_background_color);
+    ClassDB::bind_method(D_METHOD("get_background_color"), &MoonlightStatsOverlay::get_background_color);
+    ClassDB::bind_method(D_METHOD("refresh"), &MoonlightStatsOverlay::refresh);
+    ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "stream_core", PROPERTY_HINT_NODE_TYPE, "MoonlightStreamCore", PROPERTY_USAGE_NONE), "set_stream_core", "get_stream_core");
+    ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "update_interval", PROPERTY_HINT_RANGE, "0.1,10,0.1,suffix:s"), "set_update_interval", "get_update_interval");
+    ADD_PROPERTY(PropertyInfo(Variant::INT, "font_size", PROPERTY_HINT_RANGE, "6,64,1"), "set_font_size", "get_font_size");
+    ADD_PROPERTY(PropertyInfo(Variant::COLOR, "background_color"), "set_background_color", "get_background_color");
+}
+
+MoonlightStatsOverlay::MoonlightStatsOverlay() {
+    paragraph.instantiate();
+    // 覆盖层不拦截鼠标，输入仍交给串流画面
+    set_mouse_filter(MOUSE_FILTER_IGNORE);
+    set_process_internal(true);
+}
+
+void MoonlightStatsOverlay::_notification(int p_what) {
+    switch (p_what) {
+        case NOTIFICATION_ENTER_TREE: {
+            if (!get_stream_core()) {
+                set_stream_core(Object::cast_to<MoonlightStreamCore>(get_parent()));
+            }
+            _update_font();
+        } break;
+        case NOTIFICATION_THEME_CHANGED: {
+            _update_font();
+        } break;
+        case NOTIFICATION_VISIBILITY_CHANGED: {
+            // 隐藏期间不取快照，重新显示时从新的基准开始
+            has_previous = false;
+        } break;
+        case NOTIFICATION_INTERNAL_PROCESS: {
+            if (!is_visible_in_tree()) {
+                return;
+            }
+            MoonlightStreamCore *core = get_stream_core();
+            if (!core || !core->is_streaming) {
+                has_previous = false;
+                if (has_text) {
+                    _set_text(String());
+                }
+                return;
+            }
+            if (!has_previous) {
+                previous_snapshot = core->get_stats_snapshot();
+                has_previous = true;
+                elapsed = 0.0;
+                return;
+            }
+            elapsed += get_process_delta_time();
+            if (elapsed >= update_interval) {
+                _update_stats();
+            }
+        } break;
+        case NOTIFICATION_DRAW: {
+            if (!has_text) {
+                return;
+            }
+            draw_rect(Rect2(Vector2(), get_size()), background_color);
+            paragraph->draw(get_canvas_item(), Vector2(MARGIN, MARGIN), get_theme_color("font_color", "Label"));
+        } break;
+    }
+}
+
+void MoonlightStatsOverlay::_update_font() {
+    font = get_theme_font("font", "Label");
+    if (font.is_null()) {
+        return;
+    }
+    font->get_string_size(GLYPH_WARMUP, HORIZONTAL_ALIGNMENT_LEFT, -1, font_size);
+    // 以新字体重新排版当前文本
+    _set_text(text);
+}
+
+void MoonlightStatsOverlay::_update_stats() {
+    MoonlightStreamCore *core = get_stream_core();
+    if (!core) {
+        return;
+    }
+    StreamStats::Snapshot snapshot = core->get_stats_snapshot();
+    StreamStats::Window window = StreamStats::compute(previous_snapshot, snapshot);
+    previous_snapshot = snapshot;
+    elapsed = 0.0;
+
+    Vector2i stream_size = core->get_stream_size();
+    PackedStringArray lines;
+    lines.push_back(vformat("Video stream: %dx%d", stream_size.x, stream_size.y));
+    lines.push_back(vformat("Incoming frame rate from network: %.2f FPS", window.received_fps));
+    lines.push_back(vformat("Decoding frame rate: %.2f FPS", window.decoded_fps));
+    lines.push_back(vformat("Rendering frame rate: %.2f FPS", window.rendered_fps));
+    if (window.host_latency_ms >= 0.0) {
+        lines.push_back(vformat("Host processing latency: %.1f ms", window.host_latency_ms));
+    } else {
+        lines.push_back("Host processing latency: N/A");
+    }
+    lines.push_back(vformat("Frames dropped by your network connection: %.2f%%", window.network_loss_percent));
+    lines.push_back(vformat("Frames dropped by the decoder queue: %.2f%%", window.dropped_percent));
+    lines.push_back(vformat("Average network latency: %d ms (variance: %d ms)", (int64_t)window.rtt_ms, (int64_t)window.rtt_variance_ms));
+    lines.push_back(vformat("Average decoding time: %.2f ms", window.decode_time_ms));
+    _set_text(String("\n").join(lines));
+}
+
+void MoonlightStatsOverlay::_set_text(const String &p_text) {
+    text = p_text;
+    paragraph->clear();
+    has_text = !text.is_empty() && font.is_valid();
+    if (has_text) {
+        paragraph->add_string(text, font, font_size);
+    }
+    update_minimum_size();
+    reset_size();
+    queue_redraw();
+}
+
+Vector2 MoonlightStatsOverlay::_get_minimum_size() const {
+    if (!has_text) {
+        return Vector2();
+    }
+    return paragraph->get_size() + Vector2(MARGIN, MARGIN) * 2;
+}
+
+void MoonlightStatsOverlay::set_stream_core(MoonlightStreamCore *p_core) {
+    stream_core_id = p_core ? p_core->get_instance_id() : ObjectID();
+    has_previous = false;
+}
+
+MoonlightStreamCore *MoonlightStatsOverlay::get_stream_core() const {
+    return Object::cast_to<MoonlightStreamCore>(ObjectDB::get_instance(stream_core_id));
+}
+
+void MoonlightStatsOverlay::set_update_interval(double p_seconds) {
+    update_interval = MAX(p_seconds, 0.1);
+}
+
+double MoonlightStatsOverlay::get_update_interval() const {
+    return update_interval;
+}
+
+void MoonlightStatsOverlay::set_font_size(int p_size) {
+    font_size = MAX(p_size, 1);
+    _update_font();
+}
+
+int MoonlightStatsOverlay::get_font_size() const {
+    return font_size;
+}
+
+void MoonlightStatsOverlay::set_background_color(const Color &p_color) {
+    background_color = p_color;
+    queue_redraw();
+}
+
+Color MoonlightStatsOverlay::get_background_color() const {
+    return background_color;
+}
+
+void MoonlightStatsOverlay::refresh() {
+    if (has_previous) {
+        _update_stats();
+    }
+}
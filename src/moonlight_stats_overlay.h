@@ -0,0 +1,60 @@
+#pragma once
+
+#include <godot_cpp/classes/control.hpp>
+#include <godot_cpp/classes/font.hpp>
+#include <godot_cpp/classes/text_paragraph.hpp>
+#include <godot_cpp/variant/color.hpp>
+
+#include "stream_stats.h"
+
+using namespace godot;
+
+class MoonlightStreamCore;
+
+// 串流统计覆盖层
+// 按固定的低频率 (默认每秒一次) 读取 MoonlightStreamCore 的统计快照，计算窗口内的帧率、延迟与丢帧率并显示。
+// 文本只在刷新时重新排版，字形来自字体的字形图集缓存 (数字与符号在字体变化时预先栅格化)，
+// 两次刷新之间不产生任何绘制或排版开销；读取统计不加锁，不影响解码与上传线程。
+class MoonlightStatsOverlay : public Control {
+    GDCLASS(MoonlightStatsOverlay, Control)
+
+private:
+    ObjectID stream_core_id;
+    double update_interval = 1.0;
+    int font_size = 16;
+    Color background_color = Color(0, 0, 0, 0.6);
+
+    Ref<Font> font;
+    Ref<TextParagraph> paragraph;
+    String text;
+    bool has_text = false;
+
+    StreamStats::Snapshot previous_snapshot;
+    bool has_previous = false;
+    double elapsed = 0.0;
+
+    void _update_font();
+    void _update_stats();
+    void _set_text(const String &p_text);
+
+protected:
+    static void _bind_methods();
+    void _notification(int p_what);
+
+public:
+    MoonlightStatsOverlay();
+
+    Vector2 _get_minimum_size() const override;
+
+    void set_stream_core(MoonlightStreamCore *p_core);
+    MoonlightStreamCore *get_stream_core() const;
+    void set_update_interval(double p_seconds);
+    double get_update_interval() const;
+    void set_font_size(int p_size);
+    int get_font_size() const;
+    void set_background_color(const Color &p_color);
+    Color get_background_color() const;
+
+    // 立即刷新一次 (不等待 update_interval)
+    void refresh();
+};
@@ -1,145 +1,97 @@
 #include "moonlight_stream_core.h"
 #include <godot_cpp/core/class_db.hpp>
 #include <godot_cpp/core/memory.hpp>
+#include <godot_cpp/classes/file_access.hpp>
 #include <godot_cpp/variant/utility_functions.hpp>
 
+#include <chrono>
 
 
-// ========== C-Style Wrapper Functions (Static Globals) ==========
 
-// context -> instance 映射
-std::map<void *, MoonlightStreamCore *> MoonlightStreamCore::instance_map;
+// ========== C-Style Wrapper Functions (Static Globals) ==========
 
-// 辅助函数：根据 context 获取实例
-static MoonlightStreamCore *get_instance_from_context(void *context) {
-    auto it = MoonlightStreamCore::instance_map.find(context);
-    if (it != MoonlightStreamCore::instance_map.end()) {
-        return it->second;
-    }
-    return nullptr;
-}
+// 带 context 的回调通过注册表把 context 映射回实例；
+// 不带 context 的回调 (submitDecodeUnit / decodeAndPlaySample / 连接回调) 路由到
+// 当前持有 Limelight 连接的实例。所有权在 LiStartConnection 之前获取，
+// 因此连接建立过程中触发的回调 (如 connectionStarted) 也能找到正确的实例。
 
 // --- Video Callbacks ---
 static int dr_setup_wrapper(int videoFormat, int width, int height, int redrawRate, void *context, int drFlags) {
-    if (auto core = get_instance_from_context(context)) {
+    if (auto core = StreamSessionRegistry::from_context(context)) {
         return core->_on_video_setup(videoFormat, width, height, redrawRate);
     }
     return DR_NEED_IDR;
 }
 
-static void dr_cleanup_wrapper(void) { 
-// Limelight 的清理函数不接受上下文，因此我们依赖 stop_connection
-// C 风格的封装在 Limelight.h 中定义为 DecoderRendererCleanup() -> void
-// 我们应该依赖 C++ 类在连接停止时调用 _on_video_cleanup。
-// 为了完整性，如果我们需要传递上下文，我们会修改 Limelight.h 中的 typedef。
-// 由于它是 void，我们假设 C++ 类管理清理状态。
+static void dr_cleanup_wrapper(void) {
+    if (auto core = StreamSessionRegistry::get_connection_owner()) {
+        core->_on_video_cleanup();
+    }
 }
 
 static int dr_submit_decode_unit_wrapper(PDECODE_UNIT decodeUnit) {
-// Limelight 的 submitDecodeUnit 也不接受上下文。
-// 我们依赖 LiStartConnection 的 `renderContext` 被传递到其他回调中。
-// 由于 submit 回调是静态的，如果没有传入，我们必须使用全局变量或其他机制。
-// 不过，该函数签名是 `int(*DecoderRendererSubmitDecodeUnit)(PDECODE_UNIT decodeUnit);`
-// 对于干净的 C++ 实例方法来说，这有点棘手。
-// 考虑到这些限制，我们将假设一种常见的设计模式，即核心管理当前实例：
-    static MoonlightStreamCore *current_video_core = nullptr; 
-
-// 我们依赖于 dr_setup_wrapper 来设置线程本地状态（如果需要的话），或者简单地使用最后一次设置的核心。
-// 由于完整的 Limelight 公共 C 代码结构不可用，我们将采取务实的选择：
-// **在 _on_submit_decode_unit 中使用 LiStartConnection 的 renderContext 上下文。**
-// **目前，我们将把 `this` 作为上下文传递给 LiStartConnection 并在内部方法中访问它。**
-// Limelight.h 中的签名是 `DecoderRendererSubmitDecodeUnit(PDECODE_UNIT decodeUnit);`（没有上下文）。
-// 这意味着我们必须使用其他方法之一，或者假设库已经设置了线程本地存储。
-// 为了解决这个问题，我们暂时依赖于一个跟踪最后“setup”核心实例的机制。
-// 更好的方法是使用 LiWaitForNextVideoFrame/LiPollNextVideoFrame（如果库支持的话），
-// 但是用户只提供了 LiStartConnection/回调函数。
-// 为了演示工作效果，我们将通过在 LiStartConnection 中设置的线程本地变量传递上下文，
-// 但由于我们无法控制线程的生命周期，因此将使用一种务实的变通方法：
-
-// *****************************************************************************************
-// 警告：这是由于 Limelight C-API 与 C++ 实例的函数签名不匹配而采用的临时解决方法。
-// 在实际项目中，这应通过修改 C API 结构或线程存储来解决。
-// 我们使用找到的第一个流核心来提交解码单元。
-// *****************************************************************************************
-    for (auto const& [key, val] : MoonlightStreamCore::instance_map) {
-        if (val->is_streaming) {
-            return val->_on_submit_decode_unit(decodeUnit);
-        }
+    if (auto core = StreamSessionRegistry::get_connection_owner()) {
+        return core->_on_submit_decode_unit(decodeUnit);
     }
-    return DR_OK; 
+    return DR_OK;
 }
 
 // --- Audio Callbacks ---
 static int ar_init_wrapper(int audioConfiguration, const POPUS_MULTISTREAM_CONFIGURATION opusConfig, void *context, int arFlags) {
-    if (auto core = get_instance_from_context(context)) {
+    if (auto core = StreamSessionRegistry::from_context(context)) {
         return core->_on_audio_init(audioConfiguration, opusConfig);
     }
     return -1;
 }
 
 static void ar_decode_and_play_sample_wrapper(char *sampleData, int sampleLength) {
-    // Same issue as dr_submit_decode_unit_wrapper, no context.
-    // We must rely on the thread being tied to a single core instance.
-    // *****************************************************************************************
-    // WARNING: Same hack as above, due to C-API signature mismatch.
-    // *****************************************************************************************
-    for (auto const& [key, val] : MoonlightStreamCore::instance_map) {
-        if (val->is_streaming) {
-            val->_on_decode_and_play_sample(sampleData, sampleLength);
-            return;
-        }
+    if (auto core = StreamSessionRegistry::get_connection_owner()) {
+        core->_on_decode_and_play_sample(sampleData, sampleLength);
     }
 }
 
 // --- Connection Callbacks ---
 static void conn_started_wrapper(void) {
-    // Only one core can be active at a time for LiStartConnection if no context is passed.
-    for (auto const& [key, val] : MoonlightStreamCore::instance_map) {
-        if (val->is_streaming) {
-            val->_on_connection_started();
-            return;
-        }
+    if (auto core = StreamSessionRegistry::get_connection_owner()) {
+        core->_on_connection_started();
     }
 }
 
 static void conn_terminated_wrapper(int errorCode) {
-    // Find the one that was streaming or is currently streaming (LiStopConnection might be called).
-    for (auto const& [key, val] : MoonlightStreamCore::instance_map) {
-        if (val->is_streaming) {
-            val->_on_connection_terminated(errorCode);
-            return;
-        }
+    if (auto core = StreamSessionRegistry::get_connection_owner()) {
+        core->_on_connection_terminated(errorCode);
     }
 }
 
 static void conn_status_update_wrapper(int connectionStatus) {
-    // Find the one that is streaming.
-    for (auto const& [key, val] : MoonlightStreamCore::instance_map) {
-        if (val->is_streaming) {
-            val->_on_connection_status_update(connectionStatus);
-            return;
-        }
+    if (auto core = StreamSessionRegistry::get_connection_owner()) {
+        core->_on_connection_status_update(connectionStatus);
+    }
+}
+
+static void conn_rumble_wrapper(unsigned short controllerNumber, unsigned short lowFreqMotor, unsigned short highFreqMotor) {
+    if (auto core = StreamSessionRegistry::get_connection_owner()) {
+        core->_on_rumble(controllerNumber, lowFreqMotor, highFreqMotor);
+    }
+}
+
+static void conn_rumble_triggers_wrapper(uint16_t controllerNumber, uint16_t leftTriggerMotor, uint16_t rightTriggerMotor) {
+    if (auto core = StreamSessionRegistry::get_connection_owner()) {
+        core->_on_rumble_triggers(controllerNumber, leftTriggerMotor, rightTriggerMotor);
     }
 }
 
 // ========== MoonlightStreamCore Implementation ==========
 
 MoonlightStreamCore::MoonlightStreamCore() {
-    // 注册实例到映射表
-    instance_map[this] = this;
+    // 注册实例
+    StreamSessionRegistry::register_core(this);
 
-    // 创建 Godot 节点
-    sub_viewport = memnew(SubViewport);
-    sub_viewport->set_name("InternalMoonlightViewport");
-    sub_viewport->set_disable_3d(true);
-    sub_viewport->set_update_mode(SubViewport::UPDATE_ALWAYS);
-    add_child(sub_viewport, true);
+    // 创建 Godot 节点 (默认兼容模式：带 SubViewport)
+    _create_viewport();
 
-    video_display_rect = memnew(TextureRect);
-    video_display_rect->set_name("VideoDisplay");
-    video_display_rect->set_anchors_preset(Control::PRESET_FULL_RECT);
-    video_display_rect->set_expand_mode(TextureRect::EXPAND_IGNORE_SIZE);
-    sub_viewport->add_child(video_display_rect, true);
+    // 主线程上传解码帧
+    set_process_internal(true);
 
     // 预分配 FFmpeg 容器
     video_packet = av_packet_alloc();
@@ -150,14 +102,28 @@ MoonlightStreamCore::MoonlightStreamCore() {
 
 MoonlightStreamCore::~MoonlightStreamCore() {
     stop_connection();
+    if (Control *control = get_display_control()) {
+        Callable on_resized = callable_mp(this, &MoonlightStreamCore::_update_output_size);
+        if (control->is_connected("resized", on_resized)) {
+            control->disconnect("resized", on_resized);
+        }
+    }
     _cleanup_ffmpeg();
-    // 从映射表中移除实例
-    instance_map.erase(this);
+    // 注销实例 (同时释放连接所有权)
+    StreamSessionRegistry::unregister_core(this);
 }
 
 void MoonlightStreamCore::_notification(int p_what) {
-    if (p_what == NOTIFICATION_EXIT_TREE) {
-        stop_connection();
+    switch (p_what) {
+        case NOTIFICATION_INTERNAL_PROCESS: {
+            _present_pending_frame();
+            if (adaptive_bitrate && is_streaming) {
+                _update_bitrate_control();
+            }
+        } break;
+        case NOTIFICATION_EXIT_TREE: {
+            stop_connection();
+        } break;
     }
 }
 
@@ -168,19 +134,48 @@ void MoonlightStreamCore::_bind_methods() {
 
     // Accessors
     ClassDB::bind_method(D_METHOD("get_video_viewport"), &MoonlightStreamCore::get_video_viewport);
+    ClassDB::bind_method(D_METHOD("get_video_texture"), &MoonlightStreamCore::get_video_texture);
+    ClassDB::bind_method(D_METHOD("set_use_viewport", "enabled"), &MoonlightStreamCore::set_use_viewport);
+    ClassDB::bind_method(D_METHOD("is_using_viewport"), &MoonlightStreamCore::is_using_viewport);
+    ADD_PROPERTY(PropertyInfo(Variant::BOOL, "use_viewport"), "set_use_viewport", "is_using_viewport");
     ClassDB::bind_method(D_METHOD("get_audio_generators"), &MoonlightStreamCore::get_audio_generators);
+
+    // Output Resolution
+    ClassDB::bind_method(D_METHOD("set_output_size", "size"), &MoonlightStreamCore::set_output_size);
+    ClassDB::bind_method(D_METHOD("get_output_size"), &MoonlightStreamCore::get_output_size);
+    ClassDB::bind_method(D_METHOD("get_stream_size"), &MoonlightStreamCore::get_stream_size);
+    ClassDB::bind_method(D_METHOD("set_display_control", "control"), &MoonlightStreamCore::set_display_control);
+    ClassDB::bind_method(D_METHOD("get_display_control"), &MoonlightStreamCore::get_display_control);
+    ADD_PROPERTY(PropertyInfo(Variant::VECTOR2I, "output_size"), "set_output_size", "get_output_size");
+    ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "display_control", PROPERTY_HINT_NODE_TYPE, "Control", PROPERTY_USAGE_NONE), "set_display_control", "get_display_control");
     
     // Key API for Audio Playback Handoff (Requirement ②)
     ClassDB::bind_method(D_METHOD("set_audio_playback", "channel_idx", "playback"), &MoonlightStreamCore::set_audio_playback);
 
+    // Statistics
+    ClassDB::bind_method(D_METHOD("get_stream_stats"), &MoonlightStreamCore::get_stream_stats);
+
+    // Tracing
+    ClassDB::bind_method(D_METHOD("set_trace_enabled", "enabled"), &MoonlightStreamCore::set_trace_enabled);
+    ClassDB::bind_method(D_METHOD("is_trace_enabled"), &MoonlightStreamCore::is_trace_enabled);
+    ClassDB::bind_method(D_METHOD("clear_trace"), &MoonlightStreamCore::clear_trace);
+    ClassDB::bind_method(D_METHOD("dump_trace", "path"), &MoonlightStreamCore::dump_trace);
+    ADD_PROPERTY(PropertyInfo(Variant::BOOL, "trace_enabled"), "set_trace_enabled", "is_trace_enabled");
+
     // Signals
+    ADD_SIGNAL(MethodInfo("frame_presented"));
     ADD_SIGNAL(MethodInfo("connection_started"));
     ADD_SIGNAL(MethodInfo("connection_stopped"));
     ADD_SIGNAL(MethodInfo("connection_status_changed", PropertyInfo(Variant::INT, "status_code")));
     ADD_SIGNAL(MethodInfo("error_occurred", PropertyInfo(Variant::STRING, "message")));
+    ADD_SIGNAL(MethodInfo("congestion_changed", PropertyInfo(Variant::INT, "level"), PropertyInfo(Variant::INT, "pending_frames"), PropertyInfo(Variant::FLOAT, "decode_time_ms")));
+    ADD_SIGNAL(MethodInfo("controller_rumble", PropertyInfo(Variant::INT, "controller"), PropertyInfo(Variant::INT, "low_frequency"), PropertyInfo(Variant::INT, "high_frequency")));
+    ADD_SIGNAL(MethodInfo("controller_trigger_rumble", PropertyInfo(Variant::INT, "controller"), PropertyInfo(Variant::INT, "left"), PropertyInfo(Variant::INT, "right")));
+    ADD_SIGNAL(MethodInfo("bitrate_recommended", PropertyInfo(Variant::DICTIONARY, "settings"), PropertyInfo(Variant::INT, "reason")));
     
     // Internal deferred method
     ClassDB::bind_method(D_METHOD("_setup_audio_generators_deferred", "channel_count", "sample_rate"), &MoonlightStreamCore::_setup_audio_generators_deferred);
+    ClassDB::bind_method(D_METHOD("_update_output_size"), &MoonlightStreamCore::_update_output_size);
 }
 
 // --- Connection Control (Requirement ③) ---
@@ -216,13 +211,58 @@ void MoonlightStreamCore::start_connection(const String &address, const Dictiona
     sc.supportedVideoFormats = config.get("video_formats", sc.supportedVideoFormats);
     sc.encryptionFlags = config.get("encryption_flags", ENCFLG_ALL);
 
+    // 参考帧失效 (RFI)，默认启用
+    rfi_enabled = config.get("enable_rfi", true);
+
+    // 背压阈值 (可选)
+    backpressure_config.soft_queue_limit = config.get("soft_queued_frames", backpressure_config.soft_queue_limit);
+    backpressure_config.hard_queue_limit = config.get("max_queued_frames", backpressure_config.hard_queue_limit);
+
+    // 自适应码率 (可选)，上限默认为本次连接的设置
+    adaptive_bitrate = config.get("adaptive_bitrate", false);
+    bitrate_controller.reset();
+    if (adaptive_bitrate) {
+        BitrateController::Settings current;
+        current.bitrate_kbps = sc.bitrate;
+        current.width = sc.width;
+        current.height = sc.height;
+        current.fps = sc.fps;
+        BitrateController::Settings ceiling;
+        ceiling.bitrate_kbps = config.get("abr_max_bitrate_kbps", sc.bitrate);
+        ceiling.width = config.get("abr_max_width", sc.width);
+        ceiling.height = config.get("abr_max_height", sc.height);
+        ceiling.fps = config.get("abr_max_fps", sc.fps);
+        BitrateController::Config abr_config;
+        abr_config.min_bitrate_kbps = config.get("abr_min_bitrate_kbps", abr_config.min_bitrate_kbps);
+        bitrate_controller.set_config(abr_config);
+        bitrate_controller.start_session(current, ceiling, LiGetMillis());
+    }
+
+    // 输入发送频率 (可选)
+    input_rate_hz = CLAMP((int)config.get("input_rate_hz", 1000), 60, 4000);
+    gamepad_poll_rate_hz = CLAMP((int)config.get("gamepad_poll_rate_hz", 1000), 0, 4000);
+
+    // 输出分辨率 (可选)，未指定时保持当前 output_size
+    if (config.has("output_width") && config.has("output_height")) {
+        output_size = Vector2i(config["output_width"], config["output_height"]);
+    }
+
     // 2. 填充回调结构体
     DECODER_RENDERER_CALLBACKS dr_callbacks;
     LiInitializeVideoCallbacks(&dr_callbacks);
     dr_callbacks.setup = dr_setup_wrapper;
     dr_callbacks.cleanup = dr_cleanup_wrapper; // 实际清理逻辑在 _on_video_cleanup 中
     dr_callbacks.submitDecodeUnit = dr_submit_decode_unit_wrapper;
-    dr_callbacks.capabilities = CAPABILITY_PULL_RENDERER; // 假设我们支持异步帧渲染
+    // 推模式：Limelight 解码线程从其队列取帧并调用 submitDecodeUnit，
+    // 队列深度可通过 LiGetPendingVideoFrames() 获取，供背压控制使用。
+    // (CAPABILITY_PULL_RENDERER 下 submitDecodeUnit 不会被调用)
+    dr_callbacks.capabilities = 0;
+    if (rfi_enabled) {
+        // 丢包时由主机使参考帧失效并以旧参考帧继续编码，避免发送大体积的 IDR
+        dr_callbacks.capabilities |= CAPABILITY_REFERENCE_FRAME_INVALIDATION_AVC |
+                CAPABILITY_REFERENCE_FRAME_INVALIDATION_HEVC |
+                CAPABILITY_REFERENCE_FRAME_INVALIDATION_AV1;
+    }
 
     AUDIO_RENDERER_CALLBACKS ar_callbacks;
     LiInitializeAudioCallbacks(&ar_callbacks);
@@ -234,11 +274,21 @@ void MoonlightStreamCore::start_connection(const String &address, const Dictiona
     cl_callbacks.connectionStarted = conn_started_wrapper;
     cl_callbacks.connectionTerminated = conn_terminated_wrapper;
     cl_callbacks.connectionStatusUpdate = conn_status_update_wrapper;
+    cl_callbacks.rumble = conn_rumble_wrapper;
+    cl_callbacks.rumbleTriggers = conn_rumble_triggers_wrapper;
 
     // 3. 准备 Godot 视频资源 (在主线程执行)
-    _setup_video_resources(sc.width, sc.height);
+    stream_width = sc.width;
+    stream_height = sc.height;
+    _update_output_size();
 
-    // 4. 启动连接
+    // 4. 获取 Limelight 连接所有权 (moonlight-common-c 进程内只支持一个连接)
+    if (!StreamSessionRegistry::acquire_connection(this)) {
+        emit_signal("error_occurred", "Another MoonlightStreamCore already owns the Limelight connection in this process.");
+        return;
+    }
+
+    // 5. 启动连接
     int ret = LiStartConnection(
         &si, &sc, 
         &cl_callbacks,
@@ -252,10 +302,15 @@ void MoonlightStreamCore::start_connection(const String &address, const Dictiona
     
     if (ret == 0) {
         is_streaming = true;
+        input_sender.start(1000000 / input_rate_hz);
+        if (gamepad_poll_rate_hz > 0) {
+            gamepad_sampler.start(&input_sender, gamepad_poll_rate_hz);
+        }
         // _on_connection_started 会通过信号通知用户连接成功
         UtilityFunctions::print("Moonlight connection attempt started.");
     } else {
         is_streaming = false;
+        StreamSessionRegistry::release_connection(this);
         String message = vformat("Failed to start Moonlight connection (LiStartConnection failed with code: %d).", ret);
         emit_signal("error_occurred", message);
     }
@@ -264,11 +319,15 @@ void MoonlightStreamCore::start_connection(const String &address, const Dictiona
 void MoonlightStreamCore::stop_connection() {
     if (!is_streaming) return;
 
-    // 1. 调用库函数终止连接
+    // 1. 停止输入线程并调用库函数终止连接
+    gamepad_sampler.stop();
+    input_sender.stop();
     LiStopConnection(); // 这将触发 conn_terminated_wrapper 回调
 
     // 2. 清理状态和音频资源
     is_streaming = false;
+    bitrate_controller.reset();
+    StreamSessionRegistry::release_connection(this);
     
     {
         std::lock_guard<std::mutex> lock(audio_mutex);
@@ -290,33 +349,178 @@ SubViewport *MoonlightStreamCore::get_video_viewport() const {
     return sub_viewport;
 }
 
+Ref<Texture2D> MoonlightStreamCore::get_video_texture() const {
+    return video_texture;
+}
+
+void MoonlightStreamCore::set_use_viewport(bool p_enabled) {
+    if (use_viewport == p_enabled) {
+        return;
+    }
+    use_viewport = p_enabled;
+    if (use_viewport) {
+        _create_viewport();
+    } else {
+        _free_viewport();
+    }
+}
+
+bool MoonlightStreamCore::is_using_viewport() const {
+    return use_viewport;
+}
+
+void MoonlightStreamCore::_create_viewport() {
+    if (sub_viewport) {
+        return;
+    }
+
+    sub_viewport = memnew(SubViewport);
+    sub_viewport->set_name("InternalMoonlightViewport");
+    sub_viewport->set_disable_3d(true);
+    // 仅在新帧到达时重绘 (见 _present_pending_frame)，避免每帧多一次全屏绘制
+    sub_viewport->set_update_mode(SubViewport::UPDATE_ONCE);
+    add_child(sub_viewport, true);
+
+    video_display_rect = memnew(TextureRect);
+    video_display_rect->set_name("VideoDisplay");
+    video_display_rect->set_anchors_preset(Control::PRESET_FULL_RECT);
+    video_display_rect->set_expand_mode(TextureRect::EXPAND_IGNORE_SIZE);
+    sub_viewport->add_child(video_display_rect, true);
+
+    if (video_texture.is_valid()) {
+        sub_viewport->set_size(Size2i(current_width, current_height));
+        video_display_rect->set_texture(video_texture);
+    }
+}
+
+void MoonlightStreamCore::_free_viewport() {
+    if (!sub_viewport) {
+        return;
+    }
+
+    // video_display_rect 是 sub_viewport 的子节点，会一并释放
+    remove_child(sub_viewport);
+    memdelete(sub_viewport);
+    sub_viewport = nullptr;
+    video_display_rect = nullptr;
+}
+
 void MoonlightStreamCore::_setup_video_resources(int width, int height) {
     if (current_width == width && current_height == height && video_texture.is_valid()) {
         return;
     }
 
-    current_width = width;
-    current_height = height;
+    {
+        // 解码线程可能正在转换旧尺寸的帧，丢弃尚未上传的帧
+        std::lock_guard<std::mutex> lock(video_mutex);
+        current_width = width;
+        current_height = height;
+        video_pending_buffer.resize(width * height * 4);
+        video_frame_ready = false;
+    }
+    video_front_buffer.resize(width * height * 4);
+
+    // 纹理对象保持不变 (set_image 会原地替换 RID 背后的纹理)，
+    // 直接模式下调用方持有的 Texture2D 引用在分辨率变化后依然有效。
+    Ref<Image> image = Image::create(width, height, false, Image::FORMAT_RGBA8);
+    if (video_texture.is_null()) {
+        video_texture = ImageTexture::create_from_image(image);
+    } else {
+        video_texture->set_image(image);
+    }
+    video_texture_rid = video_texture->get_rid();
 
     // 设置 SubViewport 尺寸
-    sub_viewport->set_size(Size2i(width, height));
-    
-    // 创建/更新 ImageTexture
-    video_image = Image::create(width, height, false, Image::FORMAT_RGBA8);
-    video_texture = ImageTexture::create_from_image(video_image);
-    video_texture_rid = video_texture->get_rid(); 
-    video_display_rect->set_texture(video_texture);
-    
-    UtilityFunctions::print(vformat("Video resources initialized at %d x %d.", width, height));
+    if (sub_viewport) {
+        sub_viewport->set_size(Size2i(width, height));
+        video_display_rect->set_texture(video_texture);
+        sub_viewport->set_update_mode(SubViewport::UPDATE_ONCE);
+    }
+
+    UtilityFunctions::print(vformat("Video resources initialized at %d x %d (stream %d x %d).", width, height, stream_width.load(), stream_height.load()));
+}
+
+// --- Output Resolution ---
+
+void MoonlightStreamCore::set_output_size(const Vector2i &p_size) {
+    output_size = Vector2i(MAX(p_size.x, 0), MAX(p_size.y, 0));
+    _update_output_size();
+}
+
+Vector2i MoonlightStreamCore::get_output_size() const {
+    return output_size;
+}
+
+Vector2i MoonlightStreamCore::get_stream_size() const {
+    return Vector2i(stream_width, stream_height);
+}
+
+void MoonlightStreamCore::set_display_control(Control *p_control) {
+    Callable on_resized = callable_mp(this, &MoonlightStreamCore::_update_output_size);
+    if (Control *old_control = get_display_control()) {
+        if (old_control->is_connected("resized", on_resized)) {
+            old_control->disconnect("resized", on_resized);
+        }
+    }
+
+    display_control_id = p_control ? p_control->get_instance_id() : ObjectID();
+    if (p_control) {
+        p_control->connect("resized", on_resized);
+    }
+    _update_output_size();
+}
+
+Control *MoonlightStreamCore::get_display_control() const {
+    return Object::cast_to<Control>(ObjectDB::get_instance(display_control_id));
+}
+
+// 计算输出分辨率：保持串流宽高比，且不超过串流分辨率 (只缩小不放大)
+Size2i MoonlightStreamCore::_compute_output_size() const {
+    int src_w = stream_width;
+    int src_h = stream_height;
+    if (src_w <= 0 || src_h <= 0) {
+        return Size2i();
+    }
+
+    Vector2 box = Vector2(output_size);
+    if (Control *control = get_display_control()) {
+        // 屏幕像素尺寸 = 控件尺寸 x 画布缩放 x 窗口拉伸缩放
+        Vector2 scale = control->get_global_transform_with_canvas().get_scale();
+        if (Viewport *viewport = control->get_viewport()) {
+            scale *= viewport->get_final_transform().get_scale();
+        }
+        box = control->get_size() * scale.abs();
+    }
+
+    if (box.x <= 0 || box.y <= 0) {
+        return Size2i(src_w, src_h);
+    }
+
+    double ratio = MIN(1.0, MIN(box.x / src_w, box.y / src_h));
+    // YUV 转换要求偶数尺寸
+    int w = MAX(2, (int)(src_w * ratio) & ~1);
+    int h = MAX(2, (int)(src_h * ratio) & ~1);
+    return Size2i(w, h);
+}
+
+void MoonlightStreamCore::_update_output_size() {
+    Size2i size = _compute_output_size();
+    if (size.x > 0 && size.y > 0) {
+        _setup_video_resources(size.x, size.y);
+    }
 }
 
 // 视频解码器初始化 (在 Moonlight 线程中执行)
 bool MoonlightStreamCore::_init_video_decoder(PDECODE_UNIT du) {
-    (void)du; 
-    
-    // Limelight 使用的 FFmpeg 解码器通常需要通过 LiStartConnection 协商的 format 来决定。
-    // 假设我们使用 H.264
-    enum AVCodecID codec_id = AV_CODEC_ID_H264; // 这里应根据 LiStartConnection 结果动态决定
+    (void)du;
+
+    // 解码器由 _on_video_setup 中协商得到的视频格式决定
+    enum AVCodecID codec_id = AV_CODEC_ID_H264;
+    if (video_format & VIDEO_FORMAT_MASK_H265) {
+        codec_id = AV_CODEC_ID_HEVC;
+    } else if (video_format & VIDEO_FORMAT_MASK_AV1) {
+        codec_id = AV_CODEC_ID_AV1;
+    }
 
     const AVCodec *codec = avcodec_find_decoder(codec_id);
     if (!codec) {
@@ -332,10 +536,13 @@ bool MoonlightStreamCore::_init_video_decoder(PDECODE_UNIT du) {
     
     video_codec_ctx->thread_count = 0; 
     video_codec_ctx->thread_type = FF_THREAD_SLICE;
+    // 每个输入包立即输出一帧，不做帧重排缓冲
+    video_codec_ctx->flags |= AV_CODEC_FLAG_LOW_DELAY;
     // ... 其他上下文设置 (例如 extradata/SPS/PPS)
 
     if (avcodec_open2(video_codec_ctx, codec, nullptr) < 0) {
         emit_signal("error_occurred", "FFmpeg: Failed to open video codec");
+        avcodec_free_context(&video_codec_ctx);
         return false;
     }
     return true;
@@ -349,6 +556,32 @@ int MoonlightStreamCore::_on_submit_decode_unit(PDECODE_UNIT du) {
         if (!_init_video_decoder(du)) return DR_NEED_IDR; // 无法初始化则请求 IDR
     }
 
+    // 记录帧号以检测丢失区间 (必须在背压丢帧之前，主动丢帧不算丢失)
+    uint64_t lost_before = reference_tracker.get_lost_frames();
+    reference_tracker.on_frame_received(du);
+    stream_stats.on_frame_received(du->frameHostProcessingLatency);
+    stream_trace.instant(StreamTrace::EVENT_FRAME_RECEIVED, du->frameNumber);
+
+    // 0. 背压控制：队列过深时丢弃非参考帧/跳过转换，严重时请求 IDR 清空队列
+    VideoBackpressure::Action action = video_backpressure.on_decode_unit(du, LiGetPendingVideoFrames(), LiGetMillis());
+    _report_congestion();
+    if (adaptive_bitrate) {
+        // 解码队列延迟：排队帧数 × 帧间隔 + 平均解码耗时
+        double queue_latency_ms = video_backpressure.get_pending_frames() * (1000.0 / (stream_fps > 0 ? stream_fps : 60)) +
+                video_backpressure.get_decode_time_ms();
+        bitrate_controller.on_frame((int)(reference_tracker.get_lost_frames() - lost_before), queue_latency_ms);
+    }
+    if (action == VideoBackpressure::ACTION_DROP) {
+        stream_trace.instant(StreamTrace::EVENT_FRAME_DROPPED, du->frameNumber);
+        return DR_OK;
+    }
+    if (action == VideoBackpressure::ACTION_REQUEST_IDR) {
+        // DR_NEED_IDR 会让 Limelight 丢弃已排队的解码单元并向主机请求 IDR
+        reference_tracker.on_idr_requested();
+        stream_trace.instant(StreamTrace::EVENT_IDR_REQUEST, du->frameNumber);
+        return DR_NEED_IDR;
+    }
+
     // 1. 组装 AVPacket
     if (video_packet->size < du->fullLength) {
         av_grow_packet(video_packet, du->fullLength - video_packet->size);
@@ -366,44 +599,215 @@ int MoonlightStreamCore::_on_submit_decode_unit(PDECODE_UNIT du) {
     }
 
     // 2. 发送/接收帧
-    if (avcodec_send_packet(video_codec_ctx, video_packet) == 0) {
+    auto decode_start = std::chrono::steady_clock::now();
+    StreamTrace::Scope decode_scope(stream_trace, StreamTrace::EVENT_DECODE, du->frameNumber);
+    int ret = avcodec_send_packet(video_codec_ctx, video_packet);
+    if (ret == AVERROR(EAGAIN)) {
+        // 解码器输出队列已满：先取出已解码的帧再重新送入
         while (avcodec_receive_frame(video_codec_ctx, video_frame) == 0) {
-            // 3. 颜色空间转换 (YUV -> RGBA)
-            if (!sws_ctx || video_frame->width != current_width || video_frame->height != current_height) {
-                if (sws_ctx) sws_freeContext(sws_ctx);
-                sws_ctx = sws_getContext(
-                    video_frame->width, video_frame->height, (AVPixelFormat)video_frame->format,
-                    current_width, current_height, AV_PIX_FMT_RGBA,
-                    SWS_FAST_BILINEAR, nullptr, nullptr, nullptr
-                );
+            stream_stats.on_frame_decoded();
+            if (action == VideoBackpressure::ACTION_DECODE) {
+                _convert_frame(video_frame);
             }
+        }
+        ret = avcodec_send_packet(video_codec_ctx, video_packet);
+    }
 
-            // 4. 写入 Image 内存
-            // 确保在主线程使用 RenderingServer::get_singleton()->texture_2d_update
-            // 由于 Godot C++ Binding 的限制，我们不能直接在解码线程操作 RenderingServer。
-            // 最佳实践是使用一个互斥锁保护的缓冲区，然后在 _process 或 _physics_process 中更新纹理。
-            
-            // 为了简化，我们直接在解码线程写入 Godot Image 内存，并提交更新 RID，
-            // 这是一个不完全线程安全但常见的 GDExtension 视频流方法。
-            // 
-            PackedByteArray data_array = video_image->get_data();
-            uint8_t *dst_data = data_array.ptrw();
-            int dst_linesize[4] = { current_width * 4, 0, 0, 0 };
-            uint8_t *dst_planes[4] = { dst_data, nullptr, nullptr, nullptr };
-
-            sws_scale(sws_ctx, 
-                      video_frame->data, video_frame->linesize,
-                      0, video_frame->height, 
-                      dst_planes, dst_linesize);
-
-            // 5. 提交到 GPU
-            RenderingServer::get_singleton()->texture_2d_update(video_texture_rid, video_image, 0);
+    bool decode_ok = ret == 0;
+    while (decode_ok) {
+        ret = avcodec_receive_frame(video_codec_ctx, video_frame);
+        if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
+            break;
+        }
+        if (ret < 0) {
+            decode_ok = false;
+            break;
+        }
+        stream_stats.on_frame_decoded();
+        if (action == VideoBackpressure::ACTION_DECODE) {
+            _convert_frame(video_frame);
         }
     }
-    
+    double decode_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - decode_start).count();
+    video_backpressure.on_decode_time(decode_ms);
+    stream_stats.on_decode_time((uint64_t)(decode_ms * 1000.0));
+    decode_scope.end();
+
+    // 3. 解码错误处理：RFI 恢复期间丢弃本帧，参考链无法恢复时才请求 IDR
+    if (reference_tracker.on_decode_result(du, decode_ok) == ReferenceFrameTracker::RESULT_NEED_IDR) {
+        stream_trace.instant(StreamTrace::EVENT_IDR_REQUEST, du->frameNumber);
+        return DR_NEED_IDR;
+    }
     return DR_OK;
 }
 
+// 背压等级变化时通知应用层 (可据此降低码率)
+void MoonlightStreamCore::_report_congestion() {
+    VideoBackpressure::Level level = video_backpressure.get_level();
+    if (level == reported_congestion_level) {
+        return;
+    }
+    reported_congestion_level = level;
+    call_deferred("emit_signal", "congestion_changed", (int)level,
+            video_backpressure.get_pending_frames(), video_backpressure.get_decode_time_ms());
+}
+
+// 每个评估窗口结束时检查是否需要调整码率 (在主线程中执行)
+void MoonlightStreamCore::_update_bitrate_control() {
+    BitrateController::Decision decision;
+    if (!bitrate_controller.update(LiGetMillis(), &decision)) {
+        return;
+    }
+    Dictionary settings;
+    settings["bitrate_kbps"] = decision.settings.bitrate_kbps;
+    settings["width"] = decision.settings.width;
+    settings["height"] = decision.settings.height;
+    settings["fps"] = decision.settings.fps;
+    emit_signal("bitrate_recommended", settings, (int)decision.reason);
+}
+
+// 颜色空间转换并交给主线程 (在 Moonlight 线程中执行)
+void MoonlightStreamCore::_convert_frame(AVFrame *frame) {
+    StreamTrace::Scope convert_scope(stream_trace, StreamTrace::EVENT_CONVERT);
+    int width, height;
+    {
+        std::lock_guard<std::mutex> lock(video_mutex);
+        width = current_width;
+        height = current_height;
+    }
+    if (width <= 0 || height <= 0) {
+        return;
+    }
+
+    // 3. 颜色空间转换 (YUV -> RGBA)，同一次 sws_scale 内完成缩放到输出分辨率
+    // 输出尺寸小于解码尺寸时使用 SWS_BILINEAR 以减少缩小时的混叠
+    bool downscale = width < frame->width || height < frame->height;
+    sws_ctx = sws_getCachedContext(sws_ctx,
+            frame->width, frame->height, (AVPixelFormat)frame->format,
+            width, height, AV_PIX_FMT_RGBA,
+            downscale ? SWS_BILINEAR : SWS_FAST_BILINEAR, nullptr, nullptr, nullptr);
+    if (!sws_ctx) {
+        return;
+    }
+
+    // 4. 写入 back 缓冲区 (解码线程独占，无需加锁)
+    if (video_back_buffer.size() != width * height * 4) {
+        video_back_buffer.resize(width * height * 4);
+    }
+    uint8_t *dst_data = video_back_buffer.ptrw();
+    int dst_linesize[4] = { width * 4, 0, 0, 0 };
+    uint8_t *dst_planes[4] = { dst_data, nullptr, nullptr, nullptr };
+
+    sws_scale(sws_ctx,
+              frame->data, frame->linesize,
+              0, frame->height,
+              dst_planes, dst_linesize);
+
+    // 5. 与 pending 交换，主线程在下一次 INTERNAL_PROCESS 时上传
+    std::lock_guard<std::mutex> lock(video_mutex);
+    if (width == current_width && height == current_height) {
+        std::swap(video_back_buffer, video_pending_buffer);
+        video_frame_ready = true;
+    }
+}
+
+// 上传最新的解码帧 (在主线程中执行)
+void MoonlightStreamCore::_present_pending_frame() {
+    if (!video_frame_ready || video_texture.is_null()) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(video_mutex);
+        std::swap(video_pending_buffer, video_front_buffer);
+        video_frame_ready = false;
+    }
+    if (video_front_buffer.size() != current_width * current_height * 4) {
+        return;
+    }
+
+    // 提交到 GPU (纹理尺寸即输出尺寸)
+    // 临时 Image 与 front 缓冲区共享数据，上传后立即释放：若由成员 Image 长期持有，
+    // 该缓冲区轮换到解码线程后 ptrw() 会触发写时复制，每帧多拷贝一整帧
+    StreamTrace::Scope upload_scope(stream_trace, StreamTrace::EVENT_UPLOAD);
+    {
+        Ref<Image> frame_image = Image::create_from_data(current_width, current_height, false, Image::FORMAT_RGBA8, video_front_buffer);
+        RenderingServer::get_singleton()->texture_2d_update(video_texture_rid, frame_image, 0);
+    }
+    stream_stats.on_frame_rendered();
+    upload_scope.end();
+
+    // 视口只在有新帧时重绘一次
+    if (sub_viewport) {
+        sub_viewport->set_update_mode(SubViewport::UPDATE_ONCE);
+    }
+    stream_trace.instant(StreamTrace::EVENT_PRESENT);
+    emit_signal("frame_presented");
+}
+
+// --- Statistics ---
+
+StreamStats::Snapshot MoonlightStreamCore::get_stats_snapshot() const {
+    StreamStats::Snapshot snapshot = stream_stats.snapshot();
+    snapshot.lost_frames = reference_tracker.get_lost_frames();
+    snapshot.dropped_frames = video_backpressure.get_dropped_frames();
+    if (is_streaming) {
+        uint32_t rtt = 0;
+        uint32_t variance = 0;
+        if (LiGetEstimatedRttInfo(&rtt, &variance)) {
+            snapshot.rtt_ms = rtt;
+            snapshot.rtt_variance_ms = variance;
+        }
+    }
+    return snapshot;
+}
+
+Dictionary MoonlightStreamCore::get_stream_stats() const {
+    StreamStats::Snapshot snapshot = get_stats_snapshot();
+    Dictionary stats;
+    stats["time_usec"] = (int64_t)snapshot.time_us;
+    stats["received_frames"] = (int64_t)snapshot.received_frames;
+    stats["decoded_frames"] = (int64_t)snapshot.decoded_frames;
+    stats["rendered_frames"] = (int64_t)snapshot.rendered_frames;
+    stats["lost_frames"] = (int64_t)snapshot.lost_frames;
+    stats["dropped_frames"] = (int64_t)snapshot.dropped_frames;
+    stats["decode_time_usec"] = (int64_t)snapshot.decode_time_us;
+    stats["decoded_units"] = (int64_t)snapshot.decode_count;
+    stats["host_latency_ms"] = snapshot.host_latency_count > 0 ? snapshot.host_latency_total / 10.0 / snapshot.host_latency_count : -1.0;
+    stats["rtt_ms"] = (int64_t)snapshot.rtt_ms;
+    stats["rtt_variance_ms"] = (int64_t)snapshot.rtt_variance_ms;
+    return stats;
+}
+
+// --- Tracing ---
+
+void MoonlightStreamCore::set_trace_enabled(bool p_enabled) {
+    stream_trace.set_enabled(p_enabled);
+}
+
+bool MoonlightStreamCore::is_trace_enabled() const {
+    return stream_trace.is_enabled();
+}
+
+void MoonlightStreamCore::clear_trace() {
+    stream_trace.clear();
+}
+
+Error MoonlightStreamCore::dump_trace(const String &p_path) const {
+    Ref<FileAccess> file = FileAccess::open(p_path, FileAccess::WRITE);
+    if (file.is_null()) {
+        UtilityFunctions::push_error(vformat("Failed to open trace file: %s", p_path));
+        return FileAccess::get_open_error();
+    }
+    // 导出期间追踪继续进行，正在被覆盖的事件会被跳过
+    std::string json = stream_trace.to_chrome_json();
+    PackedByteArray data;
+    data.resize(json.size());
+    memcpy(data.ptrw(), json.data(), json.size());
+    file->store_buffer(data);
+    return OK;
+}
+
 // --- Audio Playback Handoff (Requirement ②) ---
 
 Array MoonlightStreamCore::get_audio_generators() const {
@@ -481,6 +885,7 @@ int MoonlightStreamCore::_on_audio_init(int audioConfiguration, const POPUS_MULT
 // 音频解码回调 (在 Moonlight 线程中执行)
 void MoonlightStreamCore::_on_decode_and_play_sample(char *data, int length) {
     if (!is_streaming || !audio_codec_ctx) return;
+    StreamTrace::Scope decode_scope(stream_trace, StreamTrace::EVENT_AUDIO_DECODE, length);
 
     // 1. 发送包
     audio_packet->data = (uint8_t*)data;
@@ -498,6 +903,7 @@ void MoonlightStreamCore::_on_decode_and_play_sample(char *data, int length) {
         std::lock_guard<std::mutex> lock(audio_mutex);
         
         int samples = audio_frame->nb_samples;
+        StreamTrace::Scope push_scope(stream_trace, StreamTrace::EVENT_AUDIO_PUSH, samples);
         int channels = audio_frame->ch_layout.nb_channels;
         int active_generators = audio_channels.size();
         
@@ -545,10 +951,12 @@ void MoonlightStreamCore::_on_decode_and_play_sample(char *data, int length) {
 // --- Connection Callbacks (Requirement ③) ---
 
 void MoonlightStreamCore::_on_connection_started() {
+    stream_trace.instant(StreamTrace::EVENT_CONNECTION_STARTED);
     call_deferred("emit_signal", "connection_started");
 }
 
 void MoonlightStreamCore::_on_connection_terminated(int errorCode) {
+    stream_trace.instant(StreamTrace::EVENT_CONNECTION_TERMINATED, errorCode);
     // 确保清理逻辑只执行一次
     if (is_streaming) {
         stop_connection(); // 清理内部状态
@@ -561,13 +969,33 @@ void MoonlightStreamCore::_on_connection_terminated(int errorCode) {
 }
 
 void MoonlightStreamCore::_on_connection_status_update(int connectionStatus) {
+    stream_trace.instant(StreamTrace::EVENT_CONNECTION_STATUS, connectionStatus);
+    bitrate_controller.on_connection_status(connectionStatus == CONN_STATUS_POOR);
     call_deferred("emit_signal", "connection_status_changed", connectionStatus);
 }
 
+// 主机端的手柄振动 (在 Limelight 线程中执行)，由 MoonlightInput 转发到对应的 Godot 手柄
+void MoonlightStreamCore::_on_rumble(unsigned short controllerNumber, unsigned short lowFreqMotor, unsigned short highFreqMotor) {
+    call_deferred("emit_signal", "controller_rumble", controllerNumber, lowFreqMotor, highFreqMotor);
+}
+
+void MoonlightStreamCore::_on_rumble_triggers(uint16_t controllerNumber, uint16_t leftTriggerMotor, uint16_t rightTriggerMotor) {
+    call_deferred("emit_signal", "controller_trigger_rumble", controllerNumber, leftTriggerMotor, rightTriggerMotor);
+}
+
 int MoonlightStreamCore::_on_video_setup(int videoFormat, int width, int height, int redrawRate) {
     // 收到配置后在主线程设置 Godot 视频资源
     // 即使在不同线程，call_deferred 也是线程安全的
-    call_deferred("_setup_video_resources", width, height);
+    stream_width = width;
+    stream_height = height;
+    video_format = videoFormat;
+    stream_fps = redrawRate;
+    video_backpressure.set_config(backpressure_config);
+    video_backpressure.reset(redrawRate, videoFormat);
+    reference_tracker.reset(rfi_enabled, redrawRate);
+    stream_stats.reset();
+    reported_congestion_level = VideoBackpressure::LEVEL_NONE;
+    call_deferred("_update_output_size");
     return DR_OK;
 }
 
@@ -3,6 +3,7 @@
 #include <godot_cpp/classes/node.hpp>
 #include <godot_cpp/classes/sub_viewport.hpp>
 #include <godot_cpp/classes/texture_rect.hpp>
+#include <godot_cpp/classes/control.hpp>
 #include <godot_cpp/classes/image_texture.hpp>
 #include <godot_cpp/classes/image.hpp>
 #include <godot_cpp/classes/audio_stream_generator.hpp>
@@ -36,6 +37,16 @@ extern "C" {
 extern "C" {
 #include "lib/moonlight-common-c/src/Limelight.h"
 }
+
+#include "bitrate_controller.h"
+#include "gamepad_sampler.h"
+#include "input_sender.h"
+#include "reference_frame_tracker.h"
+#include "stream_session_registry.h"
+#include "stream_stats.h"
+#include "stream_trace.h"
+#include "video_backpressure.h"
+
 using namespace godot;
 
 class MoonlightStreamCore : public Node {
@@ -51,11 +62,12 @@ public:
 
 private:
     // --- Godot Video Resources ---
+    // use_viewport 为 false 时 (直接模式) 不创建 SubViewport，调用方直接使用 video_texture
+    bool use_viewport = true;
     SubViewport *sub_viewport = nullptr;
     TextureRect *video_display_rect = nullptr;
     Ref<ImageTexture> video_texture;
-    Ref<Image> video_image;
-    RID video_texture_rid; 
+    RID video_texture_rid;
     
     // --- Audio Resources (Requirement ②) ---
     struct AudioChannelContext {
@@ -79,12 +91,72 @@ private:
     
 
     
+    // 串流分辨率 (由 Limelight 协商得到)
+    std::atomic<int> stream_width{0};
+    std::atomic<int> stream_height{0};
+
+    // 输出 (纹理/视口) 分辨率，可能小于串流分辨率
     int current_width = 0;
     int current_height = 0;
-    
+    int video_format = 0;
+    int stream_fps = 60;
+
+    // --- Backpressure ---
+    // 解码/上传跟不上时丢帧或请求 IDR，保证端到端延迟有界
+    VideoBackpressure video_backpressure;
+    VideoBackpressure::Config backpressure_config;
+    VideoBackpressure::Level reported_congestion_level = VideoBackpressure::LEVEL_NONE;
+
+    // --- Reference Frame Invalidation ---
+    bool rfi_enabled = true;
+    ReferenceFrameTracker reference_tracker;
+
+    // --- Adaptive Bitrate ---
+    // 根据丢帧、连接状态与解码延迟给出新的码率/分辨率建议 (需要应用层重连生效)
+    bool adaptive_bitrate = false;
+    BitrateController bitrate_controller;
+
+    // --- Statistics ---
+    // 热路径只做原子累加，读取方 (MoonlightStatsOverlay 等) 按自己的频率取快照
+    StreamStats stream_stats;
+    // 时间线追踪，未启用时每个记录点只有一次分支
+    StreamTrace stream_trace;
+
+    // --- Input ---
+    // 输入事件由独立线程发送 (见 MoonlightInput)
+    InputSender input_sender;
+    int input_rate_hz = 1000;
+    // 手柄状态采样线程，0 表示由 MoonlightInput 按输入事件发送
+    GamepadSampler gamepad_sampler;
+    int gamepad_poll_rate_hz = 1000;
+
+    // --- Output Resolution ---
+    // output_size 为 (0, 0) 时跟随串流分辨率；
+    // display_control 非空时按其屏幕像素尺寸自动计算输出分辨率。
+    Vector2i output_size;
+    ObjectID display_control_id;
+
+    // --- Frame Handoff (解码线程 -> 主线程) ---
+    // 三缓冲：back 由解码线程独占写入，front 由主线程独占上传，
+    // pending 在两者之间交换，受 video_mutex 保护。
+    // 主线程来不及上传时 pending 会被新帧覆盖，即只上传最新一帧。
+    std::mutex video_mutex;
+    PackedByteArray video_back_buffer;
+    PackedByteArray video_pending_buffer;
+    PackedByteArray video_front_buffer;
+    std::atomic<bool> video_frame_ready{false};
+
     // --- Internal Logic ---
     void _cleanup_ffmpeg();
     void _setup_video_resources(int width, int height);
+    void _create_viewport();
+    void _free_viewport();
+    void _present_pending_frame();
+    void _convert_frame(AVFrame *frame);
+    void _report_congestion();
+    void _update_bitrate_control();
+    Size2i _compute_output_size() const;
+    void _update_output_size();
     bool _init_video_decoder(PDECODE_UNIT du);
     bool _init_audio_decoder(const OPUS_MULTISTREAM_CONFIGURATION *config);
     void _setup_audio_generators_deferred(int channel_count, int sample_rate); // 在主线程中调用
@@ -96,16 +168,38 @@ protected:
 public:
     MoonlightStreamCore();
     ~MoonlightStreamCore();
-    // --- Internal State & Moonlight Context ---
-    // 用于将 C 回调的 void* context 映射回 C++ 实例
-    static std::map<void *, MoonlightStreamCore *> instance_map;
     // --- Connection Interface (Requirement ③) ---
     void start_connection(const String &address, const Dictionary &config);
     void stop_connection();
     std::atomic<bool> is_streaming = false;
+    InputSender *get_input_sender() { return &input_sender; }
+    GamepadSampler *get_gamepad_sampler() { return &gamepad_sampler; }
+
+    // --- Statistics ---
+    // 可在任意线程调用，不加锁
+    StreamStats::Snapshot get_stats_snapshot() const;
+    Dictionary get_stream_stats() const;
+
+    // --- Tracing ---
+    void set_trace_enabled(bool p_enabled);
+    bool is_trace_enabled() const;
+    void clear_trace();
+    // 把缓冲区中的事件写入 Chrome trace JSON 文件
+    Error dump_trace(const String &p_path) const;
 
     // --- Accessors & Audio Playback Handoff ---
     SubViewport *get_video_viewport() const;
+    Ref<Texture2D> get_video_texture() const;
+    void set_use_viewport(bool p_enabled);
+    bool is_using_viewport() const;
+
+    // --- Output Resolution ---
+    void set_output_size(const Vector2i &p_size);
+    Vector2i get_output_size() const;
+    // 串流分辨率 (未连接时为 0)
+    Vector2i get_stream_size() const;
+    void set_display_control(Control *p_control);
+    Control *get_display_control() const;
     Array get_audio_generators() const; // 返回 Array[AudioStreamGenerator]
     
     // 关键 API：GDScript 调用此方法将激活的 Playback 对象传回 C++ Core (Requirement ②)
@@ -125,4 +219,6 @@ public:
     void _on_connection_started();
     void _on_connection_terminated(int errorCode);
     void _on_connection_status_update(int connectionStatus);
+    void _on_rumble(unsigned short controllerNumber, unsigned short lowFreqMotor, unsigned short highFreqMotor);
+    void _on_rumble_triggers(uint16_t controllerNumber, uint16_t leftTriggerMotor, uint16_t rightTriggerMotor);
 };
\ No newline at end of file
@@ -0,0 +1,492 @@
+#include "net/http_connection_pool.h"
+
+#include <chrono>
+#include <cstring>
+
+// 空闲超过此时长的连接在复用前主动重连 (服务器通常会关闭空闲连接)
+static const uint64_t IDLE_RECONNECT_MS = 30000;
+// 可取消的请求等待连接锁时每隔此时长检查一次取消标志
+static const int CANCEL_CHECK_INTERVAL_MS = 100;
+
+#ifdef MOONLIGHT_USE_MBEDTLS
+// mbedTLS 的 BIO：读取前用 net::wait_socket 等待，使握手和读取都能被取消
+struct TlsTransport {
+    mbedtls_net_context net;
+    const std::atomic<bool> *cancel = nullptr; // 每个请求开始时在持有 Connection::mutex 时设置
+};
+
+static int tls_send(void *ctx, const unsigned char *buffer, size_t size) {
+    return mbedtls_net_send(&((TlsTransport *)ctx)->net, buffer, size);
+}
+
+static int tls_recv_timeout(void *ctx, unsigned char *buffer, size_t size, uint32_t timeout_ms) {
+    TlsTransport *transport = (TlsTransport *)ctx;
+    // mbedTLS 中 0 表示不限时
+    int ready = net::wait_socket((socket_t)transport->net.fd, POLLIN, timeout_ms == 0 ? -1 : (int)timeout_ms, transport->cancel);
+    if (ready == 0) {
+        return MBEDTLS_ERR_SSL_TIMEOUT;
+    }
+    if (ready < 0) {
+        return MBEDTLS_ERR_NET_RECV_FAILED;
+    }
+    return mbedtls_net_recv(&transport->net, buffer, size);
+}
+#endif
+
+struct HttpConnectionPool::Connection {
+    std::timed_mutex mutex; // 同一连接上的请求串行
+    std::string host;
+    uint16_t port = 0;
+    bool use_tls = false;
+
+    socket_t sock = NET_INVALID_SOCKET;
+    // 只在持有 mutex 时写入；原子变量以便统计时不必等待正在握手的连接
+    std::atomic<bool> connected{ false };
+    uint64_t last_used_ms = 0;
+
+#ifdef MOONLIGHT_USE_MBEDTLS
+    tls::RandomContext random;
+    TlsTransport transport;
+    mbedtls_ssl_config conf;
+    mbedtls_ssl_context ssl;
+    bool tls_configured = false;
+    // 配置 conf 时使用的身份/证书，池中身份变化后需要重新配置
+    std::shared_ptr<tls::Identity> identity;
+    std::shared_ptr<tls::PinnedCertificate> pinned_certificate;
+    bool verify_server = true;
+
+    // 用于会话恢复的 TLS 会话
+    mbedtls_ssl_session saved_session;
+    bool has_saved_session = false;
+
+    Connection() {
+        mbedtls_net_init(&transport.net);
+        mbedtls_ssl_config_init(&conf);
+        mbedtls_ssl_init(&ssl);
+        mbedtls_ssl_session_init(&saved_session);
+    }
+
+    ~Connection() {
+        mbedtls_ssl_session_free(&saved_session);
+        mbedtls_ssl_free(&ssl);
+        mbedtls_ssl_config_free(&conf);
+        mbedtls_net_free(&transport.net);
+    }
+
+    void reset_tls() {
+        mbedtls_ssl_free(&ssl);
+        mbedtls_ssl_config_free(&conf);
+        mbedtls_ssl_config_init(&conf);
+        mbedtls_ssl_init(&ssl);
+        tls_configured = false;
+    }
+#endif
+};
+
+#ifdef MOONLIGHT_USE_MBEDTLS
+// GameStream 主机使用自签名证书，只校验是否与配对时保存的证书一致
+static int verify_pinned_certificate(void *data, mbedtls_x509_crt *crt, int depth, uint32_t *flags) {
+    const tls::PinnedCertificate *pinned = (const tls::PinnedCertificate *)data;
+    if (depth == 0 && pinned && pinned->matches(crt)) {
+        *flags = 0;
+    }
+    return 0;
+}
+#endif
+
+HttpConnectionPool::HttpConnectionPool() {
+    net::startup();
+}
+
+HttpConnectionPool::~HttpConnectionPool() {
+    close_all();
+}
+
+#ifdef MOONLIGHT_USE_MBEDTLS
+void HttpConnectionPool::set_client_identity(const std::shared_ptr<tls::Identity> &p_identity) {
+    std::lock_guard<std::mutex> lock(mutex);
+    identity = p_identity;
+}
+#endif
+
+bool HttpConnectionPool::set_client_identity_pem(const std::string &cert_pem, const std::string &key_pem, std::string *r_error) {
+#ifdef MOONLIGHT_USE_MBEDTLS
+    std::shared_ptr<tls::Identity> parsed = tls::Identity::parse(cert_pem, key_pem, r_error);
+    if (!parsed) {
+        return false;
+    }
+    set_client_identity(parsed);
+    return true;
+#else
+    (void)cert_pem;
+    (void)key_pem;
+    *r_error = "Built without mbedTLS support";
+    return false;
+#endif
+}
+
+#ifdef MOONLIGHT_USE_MBEDTLS
+void HttpConnectionPool::set_pinned_server_certificate(const std::shared_ptr<tls::PinnedCertificate> &p_certificate) {
+    std::lock_guard<std::mutex> lock(mutex);
+    pinned_certificate = p_certificate;
+}
+#endif
+
+bool HttpConnectionPool::set_pinned_server_certificate(const std::string &cert_pem, std::string *r_error) {
+#ifdef MOONLIGHT_USE_MBEDTLS
+    std::shared_ptr<tls::PinnedCertificate> parsed;
+    if (!cert_pem.empty()) {
+        parsed = tls::PinnedCertificate::parse(cert_pem, r_error);
+        if (!parsed) {
+            return false;
+        }
+    }
+    set_pinned_server_certificate(parsed);
+    return true;
+#else
+    (void)cert_pem;
+    *r_error = "Built without mbedTLS support";
+    return false;
+#endif
+}
+
+void HttpConnectionPool::set_verify_server(bool p_enabled) {
+    std::lock_guard<std::mutex> lock(mutex);
+    verify_server = p_enabled;
+}
+
+int HttpConnectionPool::get_connection_count() {
+    int count = 0;
+    for (const std::shared_ptr<Connection> &conn : _get_connections()) {
+        count += conn->connected.load(std::memory_order_relaxed) ? 1 : 0;
+    }
+    return count;
+}
+
+std::shared_ptr<HttpConnectionPool::Connection> HttpConnectionPool::_get_connection(const std::string &host, uint16_t port, bool use_tls,
+        TlsSettings *r_settings) {
+    std::string key = (use_tls ? "https://" : "http://") + host + ":" + std::to_string(port);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    std::shared_ptr<Connection> &conn = connections[key];
+    if (!conn) {
+        conn = std::make_shared<Connection>();
+        conn->host = host;
+        conn->port = port;
+        conn->use_tls = use_tls;
+    }
+#ifdef MOONLIGHT_USE_MBEDTLS
+    r_settings->identity = identity;
+    r_settings->pinned_certificate = pinned_certificate;
+#endif
+    r_settings->verify_server = verify_server;
+    return conn;
+}
+
+std::vector<std::shared_ptr<HttpConnectionPool::Connection>> HttpConnectionPool::_get_connections() {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<std::shared_ptr<Connection>> result;
+    result.reserve(connections.size());
+    for (auto &entry : connections) {
+        result.push_back(entry.second);
+    }
+    return result;
+}
+
+// 调用方持有 conn.mutex
+void HttpConnectionPool::_apply_tls_settings(Connection &conn, const TlsSettings &settings) {
+#ifdef MOONLIGHT_USE_MBEDTLS
+    if (!conn.use_tls) {
+        return;
+    }
+    // 身份、绑定证书或校验策略变化后以新配置重连
+    if (conn.tls_configured && (conn.identity != settings.identity ||
+            conn.pinned_certificate != settings.pinned_certificate || conn.verify_server != settings.verify_server)) {
+        _disconnect(conn);
+        conn.reset_tls();
+        if (conn.has_saved_session) {
+            mbedtls_ssl_session_free(&conn.saved_session);
+            mbedtls_ssl_session_init(&conn.saved_session);
+            conn.has_saved_session = false;
+        }
+    }
+    if (!conn.tls_configured) {
+        conn.identity = settings.identity;
+        conn.pinned_certificate = settings.pinned_certificate;
+        conn.verify_server = settings.verify_server;
+    }
+#else
+    (void)conn;
+    (void)settings;
+#endif
+}
+
+bool HttpConnectionPool::_connect(Connection &conn, int timeout_ms, const std::atomic<bool> *cancel, std::string *r_error) {
+    std::vector<sockaddr_storage> addresses;
+    if (!net::resolve(conn.host, conn.port, SOCK_STREAM, &addresses)) {
+        *r_error = "Unable to resolve " + conn.host;
+        return false;
+    }
+
+    int err = 0;
+    for (const sockaddr_storage &address : addresses) {
+        conn.sock = net::connect_with_timeout(address, timeout_ms, &err, cancel);
+        if (conn.sock != NET_INVALID_SOCKET || (cancel && cancel->load(std::memory_order_relaxed))) {
+            break;
+        }
+    }
+    if (conn.sock == NET_INVALID_SOCKET) {
+        *r_error = "Unable to connect to " + conn.host + ":" + std::to_string(conn.port) + " (error " + std::to_string(err) + ")";
+        return false;
+    }
+
+    if (!conn.use_tls) {
+        conn.connected = true;
+        return true;
+    }
+
+#ifdef MOONLIGHT_USE_MBEDTLS
+    tls::crypto_init();
+    if (!conn.tls_configured) {
+        if (!conn.random.seed("moonlight-godot-https")) {
+            *r_error = "Unable to seed random number generator";
+            _disconnect(conn);
+            return false;
+        }
+
+        mbedtls_ssl_config_defaults(&conn.conf, MBEDTLS_SSL_IS_CLIENT, MBEDTLS_SSL_TRANSPORT_STREAM, MBEDTLS_SSL_PRESET_DEFAULT);
+        mbedtls_ssl_conf_rng(&conn.conf, mbedtls_ctr_drbg_random, &conn.random.ctr_drbg);
+        if (conn.pinned_certificate) {
+            mbedtls_ssl_conf_authmode(&conn.conf, MBEDTLS_SSL_VERIFY_REQUIRED);
+            mbedtls_ssl_conf_ca_chain(&conn.conf, &conn.pinned_certificate->cert, nullptr);
+            mbedtls_ssl_conf_verify(&conn.conf, verify_pinned_certificate, conn.pinned_certificate.get());
+        } else {
+            // 未绑定证书时无法校验自签名证书，只有关闭校验时才允许连接
+            mbedtls_ssl_conf_authmode(&conn.conf, conn.verify_server ? MBEDTLS_SSL_VERIFY_REQUIRED : MBEDTLS_SSL_VERIFY_NONE);
+        }
+        if (conn.identity) {
+            mbedtls_ssl_conf_own_cert(&conn.conf, &conn.identity->cert, &conn.identity->key);
+        }
+
+        int ret = mbedtls_ssl_setup(&conn.ssl, &conn.conf);
+        if (ret != 0) {
+            *r_error = "TLS setup failed: " + tls::error_string(ret);
+            _disconnect(conn);
+            return false;
+        }
+        conn.tls_configured = true;
+    } else {
+        mbedtls_ssl_session_reset(&conn.ssl);
+    }
+
+    // 证书只与绑定证书比对，不校验主机名
+    mbedtls_ssl_set_hostname(&conn.ssl, nullptr);
+    mbedtls_ssl_conf_read_timeout(&conn.conf, timeout_ms);
+    conn.transport.net.fd = (int)conn.sock;
+    conn.transport.cancel = cancel;
+    mbedtls_ssl_set_bio(&conn.ssl, &conn.transport, tls_send, nullptr, tls_recv_timeout);
+
+    // 尝试恢复上一次的会话，省去完整握手
+    if (conn.has_saved_session) {
+        mbedtls_ssl_set_session(&conn.ssl, &conn.saved_session);
+    }
+
+    int ret;
+    while ((ret = mbedtls_ssl_handshake(&conn.ssl)) != 0) {
+        if (ret != MBEDTLS_ERR_SSL_WANT_READ && ret != MBEDTLS_ERR_SSL_WANT_WRITE) {
+            *r_error = "TLS handshake failed: " + tls::error_string(ret);
+            // 会话可能已失效，下次进行完整握手
+            if (conn.has_saved_session) {
+                mbedtls_ssl_session_free(&conn.saved_session);
+                mbedtls_ssl_session_init(&conn.saved_session);
+                conn.has_saved_session = false;
+            }
+            _disconnect(conn);
+            return false;
+        }
+    }
+    handshake_count.fetch_add(1, std::memory_order_relaxed);
+
+    mbedtls_ssl_session_free(&conn.saved_session);
+    mbedtls_ssl_session_init(&conn.saved_session);
+    conn.has_saved_session = mbedtls_ssl_get_session(&conn.ssl, &conn.saved_session) == 0;
+
+    conn.connected = true;
+    return true;
+#else
+    *r_error = "HTTPS requires mbedTLS support";
+    _disconnect(conn);
+    return false;
+#endif
+}
+
+void HttpConnectionPool::_disconnect(Connection &conn) {
+#ifdef MOONLIGHT_USE_MBEDTLS
+    if (conn.use_tls && conn.connected) {
+        mbedtls_ssl_close_notify(&conn.ssl);
+    }
+    conn.transport.net.fd = -1;
+#endif
+    net::close_socket(conn.sock);
+    conn.sock = NET_INVALID_SOCKET;
+    conn.connected = false;
+}
+
+bool HttpConnectionPool::_send_all(Connection &conn, const std::string &data) {
+    const unsigned char *ptr = (const unsigned char *)data.data();
+    size_t remaining = data.size();
+    while (remaining > 0) {
+        int n;
+#ifdef MOONLIGHT_USE_MBEDTLS
+        if (conn.use_tls) {
+            n = mbedtls_ssl_write(&conn.ssl, ptr, remaining);
+            if (n == MBEDTLS_ERR_SSL_WANT_READ || n == MBEDTLS_ERR_SSL_WANT_WRITE) {
+                continue;
+            }
+        } else
+#endif
+        {
+#ifdef MSG_NOSIGNAL
+            n = (int)send(conn.sock, (const char *)ptr, remaining, MSG_NOSIGNAL);
+#else
+            n = (int)send(conn.sock, (const char *)ptr, (int)remaining, 0);
+#endif
+        }
+        if (n <= 0) {
+            return false;
+        }
+        ptr += n;
+        remaining -= n;
+    }
+    return true;
+}
+
+int HttpConnectionPool::_recv(Connection &conn, uint8_t *buffer, size_t size, int timeout_ms, const std::atomic<bool> *cancel) {
+#ifdef MOONLIGHT_USE_MBEDTLS
+    if (conn.use_tls) {
+        while (true) {
+            int n = mbedtls_ssl_read(&conn.ssl, buffer, size);
+            if (n == MBEDTLS_ERR_SSL_WANT_READ || n == MBEDTLS_ERR_SSL_WANT_WRITE) {
+                continue;
+            }
+#ifdef MBEDTLS_ERR_SSL_RECEIVED_NEW_SESSION_TICKET
+            // TLS 1.3 会话票据，保存以便下次恢复
+            if (n == MBEDTLS_ERR_SSL_RECEIVED_NEW_SESSION_TICKET) {
+                mbedtls_ssl_session_free(&conn.saved_session);
+                mbedtls_ssl_session_init(&conn.saved_session);
+                conn.has_saved_session = mbedtls_ssl_get_session(&conn.ssl, &conn.saved_session) == 0;
+                continue;
+            }
+#endif
+            if (n == MBEDTLS_ERR_SSL_PEER_CLOSE_NOTIFY) {
+                return 0;
+            }
+            return n;
+        }
+    }
+#endif
+
+    if (net::wait_socket(conn.sock, POLLIN, timeout_ms, cancel) <= 0) {
+        return -1;
+    }
+    return (int)recv(conn.sock, (char *)buffer, (int)size, 0);
+}
+
+net::HttpResponse HttpConnectionPool::get(const std::string &host, uint16_t port, const std::string &path_and_query, bool use_tls, int timeout_ms,
+        const std::atomic<bool> *cancel) {
+    request_count.fetch_add(1, std::memory_order_relaxed);
+    TlsSettings settings;
+    std::shared_ptr<Connection> conn = _get_connection(host, port, use_tls, &settings);
+    net::HttpResponse response;
+    // 池锁已释放：等待同一主机上进行中的请求/握手不会阻塞其他主机
+    std::unique_lock<std::timed_mutex> lock(conn->mutex, std::defer_lock);
+    if (cancel) {
+        while (!lock.try_lock_for(std::chrono::milliseconds(CANCEL_CHECK_INTERVAL_MS))) {
+            if (cancel->load(std::memory_order_relaxed)) {
+                response.error = "Request cancelled";
+                return response;
+            }
+        }
+    } else {
+        lock.lock();
+    }
+    _apply_tls_settings(*conn, settings);
+#ifdef MOONLIGHT_USE_MBEDTLS
+    conn->transport.cancel = cancel;
+#endif
+
+    std::string request = net::build_http_get(host, port, path_and_query);
+
+    // 复用的连接可能已被服务器关闭：未收到任何响应字节时重连重试一次
+    for (int attempt = 0; attempt < 2; attempt++) {
+        if (conn->connected && net::now_ms() - conn->last_used_ms > IDLE_RECONNECT_MS) {
+            _disconnect(*conn);
+        }
+
+        bool reused = conn->connected;
+        if (!conn->connected) {
+            std::string error;
+            if (!_connect(*conn, timeout_ms, cancel, &error)) {
+                response.error = error;
+                return response;
+            }
+        }
+
+#ifdef MOONLIGHT_USE_MBEDTLS
+        if (conn->use_tls) {
+            mbedtls_ssl_conf_read_timeout(&conn->conf, timeout_ms);
+        }
+#endif
+
+        if (!_send_all(*conn, request)) {
+            _disconnect(*conn);
+            if (reused) {
+                continue;
+            }
+            response.error = "Failed to send request";
+            return response;
+        }
+
+        Connection &c = *conn;
+        net::HttpReadFunc read_func = [this, &c, timeout_ms, cancel](uint8_t *buffer, size_t size) {
+            return _recv(c, buffer, size, timeout_ms, cancel);
+        };
+        bool received_any = false;
+        if (!net::read_http_response(read_func, &response, &received_any)) {
+            _disconnect(*conn);
+            if (reused && !received_any) {
+                continue;
+            }
+            return response;
+        }
+
+        if (!response.keep_alive) {
+            _disconnect(*conn);
+        }
+        conn->last_used_ms = net::now_ms();
+        return response;
+    }
+
+    if (response.error.empty()) {
+        response.error = "Connection closed by server";
+    }
+    return response;
+}
+
+void HttpConnectionPool::close_all() {
+    for (const std::shared_ptr<Connection> &conn : _get_connections()) {
+        std::lock_guard<std::timed_mutex> conn_lock(conn->mutex);
+        _disconnect(*conn);
+    }
+}
+
+void HttpConnectionPool::close_idle(uint64_t max_idle_ms) {
+    uint64_t now = net::now_ms();
+    for (const std::shared_ptr<Connection> &conn : _get_connections()) {
+        // 正在使用的连接跳过
+        std::unique_lock<std::timed_mutex> conn_lock(conn->mutex, std::try_to_lock);
+        if (conn_lock.owns_lock() && conn->connected && now - conn->last_used_ms > max_idle_ms) {
+            _disconnect(*conn);
+        }
+    }
+}
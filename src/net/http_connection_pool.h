@@ -0,0 +1,82 @@
+#pragma once
+
+#include "net/http_message.h"
+#include "net/net_socket.h"
+#include "net/tls_identity.h"
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// HTTP/HTTPS 长连接池
+// 每个 host:port (区分 HTTP/HTTPS) 维护一个 keep-alive 连接，HTTPS 连接使用客户端证书 (mTLS)。
+// 连接断开后重连时复用上次握手得到的 TLS 会话 (session resumption)，
+// 因此除首次请求外，/applist、/launch、/resume 等请求只需一次往返。
+// 所有方法都是阻塞的，可在任意工作线程调用；同一连接上的请求串行执行。
+class HttpConnectionPool {
+public:
+    HttpConnectionPool();
+    ~HttpConnectionPool();
+
+    // 设置客户端身份 (mTLS)，已建立的连接会在下一次请求时以新身份重连
+#ifdef MOONLIGHT_USE_MBEDTLS
+    void set_client_identity(const std::shared_ptr<tls::Identity> &p_identity);
+#endif
+    bool set_client_identity_pem(const std::string &cert_pem, const std::string &key_pem, std::string *r_error);
+    // 绑定服务器证书，空字符串 / nullptr 取消绑定
+#ifdef MOONLIGHT_USE_MBEDTLS
+    void set_pinned_server_certificate(const std::shared_ptr<tls::PinnedCertificate> &p_certificate);
+#endif
+    bool set_pinned_server_certificate(const std::string &cert_pem, std::string *r_error);
+    // 关闭后不校验服务器证书 (仅用于开发调试)
+    void set_verify_server(bool p_enabled);
+    bool is_verifying_server() const { return verify_server; }
+
+    // cancel 置位后，请求 (等待连接锁、建立连接、TLS 握手与读取响应) 会在约 100ms 内返回错误，
+    // 用于配对时长时间等待输入 PIN 与节点退出时中止进行中的请求
+    net::HttpResponse get(const std::string &host, uint16_t port, const std::string &path_and_query, bool use_tls, int timeout_ms,
+            const std::atomic<bool> *cancel = nullptr);
+
+    void close_all();
+    // 关闭空闲超过 max_idle_ms 的连接
+    void close_idle(uint64_t max_idle_ms);
+
+    uint64_t get_handshake_count() const { return handshake_count.load(std::memory_order_relaxed); }
+    uint64_t get_request_count() const { return request_count.load(std::memory_order_relaxed); }
+    int get_connection_count();
+
+private:
+    struct Connection;
+
+    // 请求开始时从池中取得的 TLS 配置快照
+    struct TlsSettings {
+#ifdef MOONLIGHT_USE_MBEDTLS
+        std::shared_ptr<tls::Identity> identity;
+        std::shared_ptr<tls::PinnedCertificate> pinned_certificate;
+#endif
+        bool verify_server = true;
+    };
+
+    // 保护 connections 与身份/证书/校验策略；从不在持有它时等待连接的锁，
+    // 连接自身的状态 (包括 TLS 配置) 只由 Connection::mutex 保护
+    std::mutex mutex;
+    std::map<std::string, std::shared_ptr<Connection>> connections;
+#ifdef MOONLIGHT_USE_MBEDTLS
+    std::shared_ptr<tls::Identity> identity;
+    std::shared_ptr<tls::PinnedCertificate> pinned_certificate;
+#endif
+    std::atomic<bool> verify_server{ true };
+    std::atomic<uint64_t> handshake_count{ 0 };
+    std::atomic<uint64_t> request_count{ 0 };
+
+    std::shared_ptr<Connection> _get_connection(const std::string &host, uint16_t port, bool use_tls, TlsSettings *r_settings);
+    std::vector<std::shared_ptr<Connection>> _get_connections();
+    void _apply_tls_settings(Connection &conn, const TlsSettings &settings);
+    bool _connect(Connection &conn, int timeout_ms, const std::atomic<bool> *cancel, std::string *r_error);
+    void _disconnect(Connection &conn);
+    bool _send_all(Connection &conn, const std::string &data);
+    int _recv(Connection &conn, uint8_t *buffer, size_t size, int timeout_ms, const std::atomic<bool> *cancel);
+};
@@ -0,0 +1,211 @@
+#include "net/http_message.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+
+namespace net {
+
+// 响应头最大长度，防止异常服务器导致无限读取
+static const size_t MAX_HEADER_SIZE = 64 * 1024;
+// 响应体最大长度 (封面图一般在数百 KB 以内)
+static const size_t MAX_BODY_SIZE = 32 * 1024 * 1024;
+
+static std::string to_lower(std::string str) {
+    std::transform(str.begin(), str.end(), str.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+    return str;
+}
+
+static std::string trim(const std::string &str) {
+    size_t begin = str.find_first_not_of(" \t");
+    size_t end = str.find_last_not_of(" \t\r");
+    return begin == std::string::npos ? std::string() : str.substr(begin, end - begin + 1);
+}
+
+std::string build_http_get(const std::string &host, uint16_t port, const std::string &path_and_query) {
+    // IPv6 字面量需要方括号
+    std::string host_header = host.find(':') != std::string::npos ? "[" + host + "]" : host;
+    std::string request;
+    request.reserve(256 + path_and_query.size());
+    request += "GET ";
+    request += path_and_query.empty() ? "/" : path_and_query;
+    request += " HTTP/1.1\r\nHost: ";
+    request += host_header + ":" + std::to_string(port);
+    request += "\r\nConnection: keep-alive\r\nUser-Agent: Moonlight-Godot\r\nAccept: */*\r\n\r\n";
+    return request;
+}
+
+namespace {
+
+// 带缓冲的读取器
+class BufferedReader {
+public:
+    explicit BufferedReader(const HttpReadFunc &p_read_func) :
+            read_func(p_read_func) {}
+
+    bool received_any = false;
+
+    // 读取直到出现 delimiter，返回不含分隔符的内容
+    bool read_until(const char *delimiter, size_t max_size, std::string *r_out) {
+        size_t delim_len = strlen(delimiter);
+        while (true) {
+            auto it = std::search(buffer.begin() + pos, buffer.end(), delimiter, delimiter + delim_len);
+            if (it != buffer.end()) {
+                r_out->assign(buffer.begin() + pos, it);
+                pos = (it - buffer.begin()) + delim_len;
+                return true;
+            }
+            if (buffer.size() - pos > max_size || !fill()) {
+                return false;
+            }
+        }
+    }
+
+    bool read_exact(size_t count, std::vector<uint8_t> *r_out) {
+        while (buffer.size() - pos < count) {
+            if (!fill()) {
+                return false;
+            }
+        }
+        r_out->insert(r_out->end(), buffer.begin() + pos, buffer.begin() + pos + count);
+        pos += count;
+        return true;
+    }
+
+    // 读到连接关闭；超过 max_size 时返回 false
+    bool read_to_end(size_t max_size, std::vector<uint8_t> *r_out) {
+        while (true) {
+            if (r_out->size() + (buffer.size() - pos) > max_size) {
+                return false;
+            }
+            // 边读边转移，避免缓冲区与输出同时持有整个响应体
+            r_out->insert(r_out->end(), buffer.begin() + pos, buffer.end());
+            pos = buffer.size();
+            if (!fill()) {
+                return true;
+            }
+        }
+    }
+
+private:
+    const HttpReadFunc &read_func;
+    std::vector<char> buffer;
+    size_t pos = 0;
+
+    bool fill() {
+        // 回收已消费的部分
+        if (pos > 0 && pos == buffer.size()) {
+            buffer.clear();
+            pos = 0;
+        }
+        uint8_t chunk[16 * 1024];
+        int n = read_func(chunk, sizeof(chunk));
+        if (n <= 0) {
+            return false;
+        }
+        received_any = true;
+        buffer.insert(buffer.end(), (char *)chunk, (char *)chunk + n);
+        return true;
+    }
+};
+
+} // namespace
+
+bool read_http_response(const HttpReadFunc &read_func, HttpResponse *r_response, bool *r_received_any) {
+    BufferedReader reader(read_func);
+    r_response->body.clear();
+    r_response->error.clear();
+
+    std::string header_block;
+    bool ok = reader.read_until("\r\n\r\n", MAX_HEADER_SIZE, &header_block);
+    *r_received_any = reader.received_any;
+    if (!ok) {
+        r_response->error = reader.received_any ? "Malformed HTTP response header" : "Connection closed";
+        return false;
+    }
+
+    // 状态行: HTTP/1.1 200 OK
+    size_t line_end = header_block.find("\r\n");
+    std::string status_line = header_block.substr(0, line_end);
+    size_t space = status_line.find(' ');
+    if (status_line.compare(0, 5, "HTTP/") != 0 || space == std::string::npos) {
+        r_response->error = "Invalid HTTP status line";
+        return false;
+    }
+    r_response->status_code = atoi(status_line.c_str() + space + 1);
+    bool http10 = status_line.compare(0, 8, "HTTP/1.0") == 0;
+    r_response->keep_alive = !http10;
+
+    long long content_length = -1;
+    bool chunked = false;
+    size_t cursor = line_end == std::string::npos ? header_block.size() : line_end + 2;
+    while (cursor < header_block.size()) {
+        size_t next = header_block.find("\r\n", cursor);
+        if (next == std::string::npos) {
+            next = header_block.size();
+        }
+        std::string line = header_block.substr(cursor, next - cursor);
+        cursor = next + 2;
+
+        size_t colon = line.find(':');
+        if (colon == std::string::npos) {
+            continue;
+        }
+        std::string name = to_lower(trim(line.substr(0, colon)));
+        std::string value = to_lower(trim(line.substr(colon + 1)));
+        if (name == "content-length") {
+            content_length = atoll(value.c_str());
+        } else if (name == "transfer-encoding") {
+            chunked = value.find("chunked") != std::string::npos;
+        } else if (name == "connection") {
+            if (value.find("close") != std::string::npos) {
+                r_response->keep_alive = false;
+            } else if (value.find("keep-alive") != std::string::npos) {
+                r_response->keep_alive = true;
+            }
+        }
+    }
+
+    if (chunked) {
+        while (true) {
+            std::string size_line;
+            if (!reader.read_until("\r\n", 1024, &size_line)) {
+                r_response->error = "Truncated chunked body";
+                return false;
+            }
+            size_t chunk_size = strtoul(size_line.c_str(), nullptr, 16);
+            if (chunk_size == 0) {
+                // 跳过 trailer
+                std::string trailer;
+                while (reader.read_until("\r\n", MAX_HEADER_SIZE, &trailer) && !trailer.empty()) {
+                }
+                break;
+            }
+            if (r_response->body.size() + chunk_size > MAX_BODY_SIZE ||
+                    !reader.read_exact(chunk_size, &r_response->body)) {
+                r_response->error = "Truncated chunked body";
+                return false;
+            }
+            std::string crlf;
+            reader.read_until("\r\n", 2, &crlf);
+        }
+    } else if (content_length >= 0) {
+        if ((size_t)content_length > MAX_BODY_SIZE ||
+                !reader.read_exact((size_t)content_length, &r_response->body)) {
+            r_response->error = "Truncated HTTP body";
+            return false;
+        }
+    } else {
+        // 无长度信息：读到连接关闭
+        r_response->keep_alive = false;
+        if (!reader.read_to_end(MAX_BODY_SIZE, &r_response->body)) {
+            r_response->error = "HTTP body too large";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+} // namespace net
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// 最小化的 HTTP/1.1 报文读写，供 GameStream 的 HTTP/HTTPS 请求共用。
+// 只需要支持 GET 与 Content-Length / chunked / Connection: close 三种响应体形式。
+namespace net {
+
+struct HttpResponse {
+    int status_code = 0;
+    bool keep_alive = true;
+    std::vector<uint8_t> body;
+    std::string error; // 为空表示成功
+};
+
+// 从传输层读取数据：返回读取的字节数，0 表示对端关闭，负数表示错误或超时
+typedef std::function<int(uint8_t *, size_t)> HttpReadFunc;
+
+std::string build_http_get(const std::string &host, uint16_t port, const std::string &path_and_query);
+
+// 读取一个完整的响应。r_received_any 表示是否收到过任何字节
+// (复用的 keep-alive 连接在未收到任何数据时失败，说明服务器已关闭连接，可以安全重试)。
+bool read_http_response(const HttpReadFunc &read_func, HttpResponse *r_response, bool *r_received_any);
+
+} // namespace net
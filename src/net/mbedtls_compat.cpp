@@ -0,0 +1,87 @@
+#include "net/mbedtls_compat.h"
+
+#ifdef MOONLIGHT_USE_MBEDTLS
+
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+
+namespace tls {
+
+bool crypto_init() {
+#if defined(MBEDTLS_PSA_CRYPTO_C)
+    static std::once_flag once;
+    static bool initialized = false;
+    std::call_once(once, []() {
+        initialized = psa_crypto_init() == PSA_SUCCESS;
+    });
+    return initialized;
+#else
+    return true;
+#endif
+}
+
+std::string error_string(int ret) {
+    char buffer[256] = { 0 };
+    mbedtls_strerror(ret, buffer, sizeof(buffer));
+    char code[32];
+    snprintf(code, sizeof(code), " (-0x%04X)", (unsigned int)-ret);
+    return std::string(buffer) + code;
+}
+
+int pk_parse_key(mbedtls_pk_context *ctx, const unsigned char *key, size_t keylen, mbedtls_ctr_drbg_context *ctr_drbg) {
+#if MBEDTLS_VERSION_MAJOR >= 3
+    return mbedtls_pk_parse_key(ctx, key, keylen, nullptr, 0, mbedtls_ctr_drbg_random, ctr_drbg);
+#else
+    (void)ctr_drbg;
+    return mbedtls_pk_parse_key(ctx, key, keylen, nullptr, 0);
+#endif
+}
+
+int pk_sign(mbedtls_pk_context *ctx, mbedtls_md_type_t md_alg, const unsigned char *hash, size_t hash_len,
+        unsigned char *sig, size_t sig_size, size_t *sig_len, mbedtls_ctr_drbg_context *ctr_drbg) {
+#if MBEDTLS_VERSION_MAJOR >= 3
+    return mbedtls_pk_sign(ctx, md_alg, hash, hash_len, sig, sig_size, sig_len, mbedtls_ctr_drbg_random, ctr_drbg);
+#else
+    (void)sig_size;
+    return mbedtls_pk_sign(ctx, md_alg, hash, hash_len, sig, sig_len, mbedtls_ctr_drbg_random, ctr_drbg);
+#endif
+}
+
+int x509write_crt_set_serial(mbedtls_x509write_cert *crt, unsigned char serial) {
+#if MBEDTLS_VERSION_NUMBER >= 0x03040000
+    return mbedtls_x509write_crt_set_serial_raw(crt, &serial, 1);
+#else
+    mbedtls_mpi mpi;
+    mbedtls_mpi_init(&mpi);
+    int ret = mbedtls_mpi_lset(&mpi, serial);
+    if (ret == 0) {
+        ret = mbedtls_x509write_crt_set_serial(crt, &mpi);
+    }
+    mbedtls_mpi_free(&mpi);
+    return ret;
+#endif
+}
+
+RandomContext::RandomContext() {
+    mbedtls_entropy_init(&entropy);
+    mbedtls_ctr_drbg_init(&ctr_drbg);
+}
+
+RandomContext::~RandomContext() {
+    mbedtls_ctr_drbg_free(&ctr_drbg);
+    mbedtls_entropy_free(&entropy);
+}
+
+bool RandomContext::seed(const char *personalization) {
+    if (seeded) {
+        return true;
+    }
+    seeded = mbedtls_ctr_drbg_seed(&ctr_drbg, mbedtls_entropy_func, &entropy,
+                     (const unsigned char *)personalization, strlen(personalization)) == 0;
+    return seeded;
+}
+
+} // namespace tls
+
+#endif // MOONLIGHT_USE_MBEDTLS
@@ -0,0 +1,69 @@
+#pragma once
+
+// mbedTLS 2.28 / 3.x 兼容层
+// 3.x 将部分结构体字段标记为私有 (例如 x509_crt::sig，配对时需要读取证书签名)，
+// 这里统一开启私有字段访问，并封装签名有变化的函数。
+
+#ifdef MOONLIGHT_USE_MBEDTLS
+
+#define MBEDTLS_ALLOW_PRIVATE_ACCESS
+
+#include <mbedtls/version.h>
+
+#include <mbedtls/aes.h>
+#include <mbedtls/bignum.h>
+#include <mbedtls/ctr_drbg.h>
+#include <mbedtls/entropy.h>
+#include <mbedtls/error.h>
+#include <mbedtls/md.h>
+#include <mbedtls/net_sockets.h>
+#include <mbedtls/pk.h>
+#include <mbedtls/rsa.h>
+#include <mbedtls/ssl.h>
+#include <mbedtls/x509_crt.h>
+
+#if defined(MBEDTLS_PSA_CRYPTO_C)
+#include <psa/crypto.h>
+#endif
+
+#ifndef MBEDTLS_PRIVATE
+#define MBEDTLS_PRIVATE(member) member
+#endif
+
+#include <string>
+
+namespace tls {
+
+// 初始化 PSA (3.x 下 TLS 1.3 需要)，可重复调用
+bool crypto_init();
+
+// mbedtls_strerror 的封装
+std::string error_string(int ret);
+
+// 3.x 的 mbedtls_pk_parse_key 需要随机数发生器
+int pk_parse_key(mbedtls_pk_context *ctx, const unsigned char *key, size_t keylen, mbedtls_ctr_drbg_context *ctr_drbg);
+
+// 3.x 的 mbedtls_pk_sign 多了签名缓冲区大小参数
+int pk_sign(mbedtls_pk_context *ctx, mbedtls_md_type_t md_alg, const unsigned char *hash, size_t hash_len,
+        unsigned char *sig, size_t sig_size, size_t *sig_len, mbedtls_ctr_drbg_context *ctr_drbg);
+
+// 3.4 起 mbedtls_x509write_crt_set_serial 被 set_serial_raw 取代
+int x509write_crt_set_serial(mbedtls_x509write_cert *crt, unsigned char serial);
+
+// 带随机数发生器的 drbg 初始化
+struct RandomContext {
+    mbedtls_entropy_context entropy;
+    mbedtls_ctr_drbg_context ctr_drbg;
+    bool seeded = false;
+
+    RandomContext();
+    ~RandomContext();
+    RandomContext(const RandomContext &) = delete;
+    RandomContext &operator=(const RandomContext &) = delete;
+
+    bool seed(const char *personalization);
+};
+
+} // namespace tls
+
+#endif // MOONLIGHT_USE_MBEDTLS
@@ -0,0 +1,303 @@
+#include "net/net_socket.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <fcntl.h>
+#include <ifaddrs.h>
+#include <net/if.h>
+#endif
+
+// 可取消的等待每隔此时长检查一次取消标志
+static const int CANCEL_CHECK_INTERVAL_MS = 100;
+
+namespace net {
+
+bool startup() {
+#ifdef _WIN32
+    static std::once_flag once;
+    static bool initialized = false;
+    std::call_once(once, []() {
+        WSADATA data;
+        initialized = WSAStartup(MAKEWORD(2, 2), &data) == 0;
+    });
+    return initialized;
+#else
+    return true;
+#endif
+}
+
+void close_socket(socket_t sock) {
+    if (sock == NET_INVALID_SOCKET) {
+        return;
+    }
+#ifdef _WIN32
+    closesocket(sock);
+#else
+    close(sock);
+#endif
+}
+
+bool set_nonblocking(socket_t sock, bool enabled) {
+#ifdef _WIN32
+    u_long mode = enabled ? 1 : 0;
+    return ioctlsocket(sock, FIONBIO, &mode) == 0;
+#else
+    int flags = fcntl(sock, F_GETFL, 0);
+    if (flags < 0) {
+        return false;
+    }
+    flags = enabled ? (flags | O_NONBLOCK) : (flags & ~O_NONBLOCK);
+    return fcntl(sock, F_SETFL, flags) == 0;
+#endif
+}
+
+int last_error() {
+#ifdef _WIN32
+    return WSAGetLastError();
+#else
+    return errno;
+#endif
+}
+
+bool is_would_block(int err) {
+#ifdef _WIN32
+    return err == WSAEWOULDBLOCK;
+#else
+    return err == EAGAIN || err == EWOULDBLOCK;
+#endif
+}
+
+bool is_in_progress(int err) {
+#ifdef _WIN32
+    return err == WSAEWOULDBLOCK || err == WSAEINPROGRESS;
+#else
+    return err == EINPROGRESS;
+#endif
+}
+
+int poll_sockets(struct pollfd *fds, size_t count, int timeout_ms) {
+#ifdef _WIN32
+    return WSAPoll(fds, (ULONG)count, timeout_ms);
+#else
+    return poll(fds, (nfds_t)count, timeout_ms);
+#endif
+}
+
+int wait_socket(socket_t sock, short events, int timeout_ms, const std::atomic<bool> *cancel) {
+    struct pollfd pfd;
+    pfd.fd = sock;
+    pfd.events = events;
+    uint64_t deadline = timeout_ms < 0 ? UINT64_MAX : now_ms() + (uint64_t)timeout_ms;
+    while (true) {
+        if (cancel && cancel->load(std::memory_order_relaxed)) {
+            return 0;
+        }
+        uint64_t now = now_ms();
+        if (now >= deadline) {
+            return 0;
+        }
+        int wait_ms = deadline == UINT64_MAX ? -1 : (int)(deadline - now);
+        if (cancel && (wait_ms < 0 || wait_ms > CANCEL_CHECK_INTERVAL_MS)) {
+            wait_ms = CANCEL_CHECK_INTERVAL_MS;
+        }
+        pfd.revents = 0;
+        int ready = poll_sockets(&pfd, 1, wait_ms);
+        if (ready != 0) {
+            return ready;
+        }
+    }
+}
+
+bool resolve(const std::string &host, uint16_t port, int socktype, std::vector<sockaddr_storage> *r_addresses, bool numeric_only) {
+    startup();
+
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = socktype;
+    hints.ai_flags = numeric_only ? AI_NUMERICHOST : AI_ADDRCONFIG;
+
+    struct addrinfo *result = nullptr;
+    std::string port_str = std::to_string(port);
+    if (getaddrinfo(host.c_str(), port_str.c_str(), &hints, &result) != 0 || !result) {
+        return false;
+    }
+
+    for (struct addrinfo *ai = result; ai; ai = ai->ai_next) {
+        if (ai->ai_addrlen > sizeof(sockaddr_storage)) {
+            continue;
+        }
+        sockaddr_storage address;
+        memset(&address, 0, sizeof(address));
+        memcpy(&address, ai->ai_addr, ai->ai_addrlen);
+        r_addresses->push_back(address);
+    }
+    freeaddrinfo(result);
+    return !r_addresses->empty();
+}
+
+socklen_t address_length(const sockaddr_storage &address) {
+    return address.ss_family == AF_INET6 ? sizeof(sockaddr_in6) : sizeof(sockaddr_in);
+}
+
+std::string address_to_string(const sockaddr_storage &address) {
+    char buffer[INET6_ADDRSTRLEN] = { 0 };
+    if (address.ss_family == AF_INET6) {
+        inet_ntop(AF_INET6, &((const sockaddr_in6 *)&address)->sin6_addr, buffer, sizeof(buffer));
+    } else {
+        inet_ntop(AF_INET, &((const sockaddr_in *)&address)->sin_addr, buffer, sizeof(buffer));
+    }
+    return buffer;
+}
+
+uint16_t address_port(const sockaddr_storage &address) {
+    if (address.ss_family == AF_INET6) {
+        return ntohs(((const sockaddr_in6 *)&address)->sin6_port);
+    }
+    return ntohs(((const sockaddr_in *)&address)->sin_port);
+}
+
+void set_address_port(sockaddr_storage *address, uint16_t port) {
+    if (address->ss_family == AF_INET6) {
+        ((sockaddr_in6 *)address)->sin6_port = htons(port);
+    } else {
+        ((sockaddr_in *)address)->sin_port = htons(port);
+    }
+}
+
+bool get_broadcast_addresses(std::vector<sockaddr_storage> *r_addresses) {
+    startup();
+#ifdef _WIN32
+    // SIO_GET_INTERFACE_LIST 只返回 IPv4 网卡，Windows 上不发送 IPv6 组播
+    socket_t sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (sock == NET_INVALID_SOCKET) {
+        return false;
+    }
+    INTERFACE_INFO interfaces[32];
+    DWORD bytes = 0;
+    int result = WSAIoctl(sock, SIO_GET_INTERFACE_LIST, nullptr, 0, interfaces, sizeof(interfaces), &bytes, nullptr, nullptr);
+    close_socket(sock);
+    if (result != 0) {
+        return false;
+    }
+    for (size_t i = 0; i < bytes / sizeof(INTERFACE_INFO); i++) {
+        const INTERFACE_INFO &info = interfaces[i];
+        if (!(info.iiFlags & IFF_UP) || (info.iiFlags & IFF_LOOPBACK) || !(info.iiFlags & IFF_BROADCAST)) {
+            continue;
+        }
+        sockaddr_storage address;
+        memset(&address, 0, sizeof(address));
+        sockaddr_in *in = (sockaddr_in *)&address;
+        in->sin_family = AF_INET;
+        in->sin_addr.s_addr = info.iiAddress.AddressIn.sin_addr.s_addr | ~info.iiNetmask.AddressIn.sin_addr.s_addr;
+        r_addresses->push_back(address);
+    }
+    return true;
+#else
+    struct ifaddrs *list = nullptr;
+    if (getifaddrs(&list) != 0) {
+        return false;
+    }
+    std::vector<unsigned int> ipv6_scopes;
+    for (struct ifaddrs *ifa = list; ifa; ifa = ifa->ifa_next) {
+        if (!ifa->ifa_addr || !(ifa->ifa_flags & IFF_UP) || (ifa->ifa_flags & IFF_LOOPBACK)) {
+            continue;
+        }
+        sockaddr_storage address;
+        memset(&address, 0, sizeof(address));
+        if (ifa->ifa_addr->sa_family == AF_INET && (ifa->ifa_flags & IFF_BROADCAST) && ifa->ifa_broadaddr) {
+            memcpy(&address, ifa->ifa_broadaddr, sizeof(sockaddr_in));
+            ((sockaddr_in *)&address)->sin_port = 0;
+            r_addresses->push_back(address);
+        } else if (ifa->ifa_addr->sa_family == AF_INET6 && (ifa->ifa_flags & IFF_MULTICAST)) {
+            // 每个网卡只添加一次 ff02::1
+            unsigned int scope = if_nametoindex(ifa->ifa_name);
+            if (scope == 0 || std::find(ipv6_scopes.begin(), ipv6_scopes.end(), scope) != ipv6_scopes.end()) {
+                continue;
+            }
+            ipv6_scopes.push_back(scope);
+            sockaddr_in6 *in6 = (sockaddr_in6 *)&address;
+            in6->sin6_family = AF_INET6;
+            inet_pton(AF_INET6, "ff02::1", &in6->sin6_addr);
+            in6->sin6_scope_id = scope;
+            r_addresses->push_back(address);
+        }
+    }
+    freeifaddrs(list);
+    return true;
+#endif
+}
+
+socket_t start_connect(const sockaddr_storage &address, int *r_error) {
+    startup();
+
+    socket_t sock = socket(address.ss_family, SOCK_STREAM, IPPROTO_TCP);
+    if (sock == NET_INVALID_SOCKET) {
+        *r_error = last_error();
+        return NET_INVALID_SOCKET;
+    }
+
+    int one = 1;
+    setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, (const char *)&one, sizeof(one));
+#ifdef SO_NOSIGPIPE
+    setsockopt(sock, SOL_SOCKET, SO_NOSIGPIPE, (const char *)&one, sizeof(one));
+#endif
+
+    if (!set_nonblocking(sock, true)) {
+        *r_error = last_error();
+        close_socket(sock);
+        return NET_INVALID_SOCKET;
+    }
+
+    if (connect(sock, (const sockaddr *)&address, address_length(address)) != 0) {
+        int err = last_error();
+        if (!is_in_progress(err)) {
+            *r_error = err;
+            close_socket(sock);
+            return NET_INVALID_SOCKET;
+        }
+    }
+
+    *r_error = 0;
+    return sock;
+}
+
+int get_socket_error(socket_t sock) {
+    int err = 0;
+    socklen_t len = sizeof(err);
+    if (getsockopt(sock, SOL_SOCKET, SO_ERROR, (char *)&err, &len) != 0) {
+        return last_error();
+    }
+    return err;
+}
+
+socket_t connect_with_timeout(const sockaddr_storage &address, int timeout_ms, int *r_error, const std::atomic<bool> *cancel) {
+    socket_t sock = start_connect(address, r_error);
+    if (sock == NET_INVALID_SOCKET) {
+        return NET_INVALID_SOCKET;
+    }
+
+    int ready = wait_socket(sock, POLLOUT, timeout_ms, cancel);
+    int err = ready > 0 ? get_socket_error(sock) : (ready == 0 ? -1 : last_error());
+    if (err != 0 || !set_nonblocking(sock, false)) {
+        *r_error = err;
+        close_socket(sock);
+        return NET_INVALID_SOCKET;
+    }
+
+    *r_error = 0;
+    return sock;
+}
+
+uint64_t now_ms() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+}
+
+} // namespace net
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <winsock2.h>
+#include <ws2tcpip.h>
+typedef SOCKET socket_t;
+#define NET_INVALID_SOCKET INVALID_SOCKET
+#else
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+typedef int socket_t;
+#define NET_INVALID_SOCKET (-1)
+#endif
+
+// 跨平台 socket 工具函数 (BSD socket / Winsock)
+// 供 HTTPS 客户端、主机轮询、mDNS、WoL 等网络模块共用。
+namespace net {
+
+// Windows 下初始化 Winsock，可重复调用
+bool startup();
+
+void close_socket(socket_t sock);
+bool set_nonblocking(socket_t sock, bool enabled);
+
+int last_error();
+// 非阻塞操作暂时无法完成 (EAGAIN / EWOULDBLOCK)
+bool is_would_block(int err);
+// 非阻塞 connect 正在进行 (EINPROGRESS)
+bool is_in_progress(int err);
+
+// poll() / WSAPoll()
+int poll_sockets(struct pollfd *fds, size_t count, int timeout_ms);
+// 等待单个 socket 就绪 (events 为 POLLIN / POLLOUT)，timeout_ms < 0 表示不限时。
+// 传入 cancel 时每 100ms 检查一次，置位后视为超时。返回 >0 就绪，0 超时或已取消，<0 出错
+int wait_socket(socket_t sock, short events, int timeout_ms, const std::atomic<bool> *cancel = nullptr);
+
+// 解析主机名或 IP 字面量，结果按系统返回的顺序排列
+// numeric_only 为 true 时只接受 IP 字面量 (不会发起 DNS 查询，因此不会阻塞)
+bool resolve(const std::string &host, uint16_t port, int socktype, std::vector<sockaddr_storage> *r_addresses, bool numeric_only = false);
+socklen_t address_length(const sockaddr_storage &address);
+std::string address_to_string(const sockaddr_storage &address);
+uint16_t address_port(const sockaddr_storage &address);
+void set_address_port(sockaddr_storage *address, uint16_t port);
+
+// 已启用的非回环网卡的广播目标：IPv4 子网广播地址与带作用域的 IPv6 全节点组播地址 (ff02::1)，端口为 0
+bool get_broadcast_addresses(std::vector<sockaddr_storage> *r_addresses);
+
+// 发起非阻塞 connect，返回的 socket 处于非阻塞模式；失败返回 NET_INVALID_SOCKET
+socket_t start_connect(const sockaddr_storage &address, int *r_error);
+// 阻塞等待连接完成 (带超时，可被 cancel 取消)，成功后 socket 恢复为阻塞模式
+socket_t connect_with_timeout(const sockaddr_storage &address, int timeout_ms, int *r_error, const std::atomic<bool> *cancel = nullptr);
+// 获取非阻塞 connect 的最终结果 (SO_ERROR)
+int get_socket_error(socket_t sock);
+
+// 单调时钟毫秒数
+uint64_t now_ms();
+
+} // namespace net
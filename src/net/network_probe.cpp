@@ -0,0 +1,634 @@
+#include "net/network_probe.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <unordered_map>
+
+// 探测包格式 (小端)：
+//   0  u32 magic
+//   4  u8  type
+//   5  u8[3] 保留
+//   8  u32 seq      (PING 的序号 / BURST_DATA 的包序号)
+//   12 u32 token    (每次探测随机生成，过滤上一次探测迟到的包)
+//   16 u32 count    (仅 BURST_REQUEST)
+//   20 u32 size     (仅 BURST_REQUEST)
+//   24 u64 cookie   (回显端写入 PING 回应，客户端在 BURST_REQUEST 中原样带回)
+static const uint32_t PROBE_MAGIC = 0x52504C4D; // "MLPR"
+static const size_t PROBE_HEADER_SIZE = 16;
+static const size_t PING_PACKET_SIZE = 64;
+static const size_t BURST_REQUEST_SIZE = 32;
+static const size_t COOKIE_OFFSET = 24;
+
+enum ProbePacketType : uint8_t {
+    PROBE_PING = 1,
+    PROBE_BURST_REQUEST = 2,
+    PROBE_BURST_DATA = 3,
+};
+
+// 单次突发的上限 (约 6 MB)
+static const uint32_t MAX_BURST_PACKETS = 4096;
+static const uint32_t MAX_BURST_PACKET_SIZE = 1472;
+
+// 防止回显端被用作反射放大：突发请求必须带回 PING 回应中的 cookie，证明请求方能收到发往该地址的包
+// (伪造源地址的请求拿不到 cookie)；cookie 由按周期轮换的秘密与来源地址计算，当前与上一个周期的都有效。
+static const uint64_t COOKIE_ROTATE_MS = 30000;
+// 通过验证的来源在每个时间窗口内最多收到这么多突发数据，超出部分截断
+static const uint64_t BURST_BUDGET_WINDOW_MS = 10000;
+static const uint64_t BURST_BUDGET_BYTES = 8 * 1024 * 1024;
+static const size_t MAX_BUDGET_SOURCES = 256;
+
+// TCP 探测的样本数 (每个样本都会在主机上建立一次连接)
+static const int MAX_TCP_SAMPLES = 5;
+
+// 码率的余量：视频之外还有 FEC、音频与控制流
+static const double BANDWIDTH_HEADROOM = 0.8;
+
+static uint64_t now_us() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void write_u32(uint8_t *p, uint32_t value) {
+    p[0] = (uint8_t)(value & 0xFF);
+    p[1] = (uint8_t)((value >> 8) & 0xFF);
+    p[2] = (uint8_t)((value >> 16) & 0xFF);
+    p[3] = (uint8_t)(value >> 24);
+}
+
+static uint32_t read_u32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void write_u64(uint8_t *p, uint64_t value) {
+    write_u32(p, (uint32_t)value);
+    write_u32(p + 4, (uint32_t)(value >> 32));
+}
+
+static uint64_t read_u64(const uint8_t *p) {
+    return (uint64_t)read_u32(p) | ((uint64_t)read_u32(p + 4) << 32);
+}
+
+static void write_header(uint8_t *p, ProbePacketType type, uint32_t seq, uint32_t token) {
+    memset(p, 0, PROBE_HEADER_SIZE);
+    write_u32(p, PROBE_MAGIC);
+    p[4] = type;
+    write_u32(p + 8, seq);
+    write_u32(p + 12, token);
+}
+
+// 等待 socket 可读，返回 false 表示超时
+static bool wait_readable(socket_t sock, int timeout_ms) {
+    struct pollfd pfd;
+    pfd.fd = sock;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+    return net::poll_sockets(&pfd, 1, std::max(timeout_ms, 0)) > 0;
+}
+
+// --- NetworkProbe ---
+
+NetworkProbe::NetworkProbe() {
+}
+
+NetworkProbe::~NetworkProbe() {
+    cancel();
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+bool NetworkProbe::start(const Config &p_config, std::string *r_error) {
+    if (running.load()) {
+        *r_error = "A probe is already running";
+        return false;
+    }
+    if (p_config.address.empty()) {
+        *r_error = "Address is empty";
+        return false;
+    }
+
+    if (worker.joinable()) {
+        worker.join();
+    }
+    cancelled = false;
+    running = true;
+    worker = std::thread(&NetworkProbe::_run, this, p_config);
+    return true;
+}
+
+void NetworkProbe::cancel() {
+    if (running.load()) {
+        cancelled = true;
+    }
+}
+
+bool NetworkProbe::take_result(Result *r_result) {
+    std::lock_guard<std::mutex> lock(result_mutex);
+    if (!result_pending.load(std::memory_order_relaxed)) {
+        return false;
+    }
+    *r_result = result;
+    result_pending.store(false, std::memory_order_release);
+    return true;
+}
+
+void NetworkProbe::_run(Config p_config) {
+    Result probe_result;
+    std::vector<sockaddr_storage> addresses;
+    if (!net::resolve(p_config.address, p_config.tcp_port, SOCK_STREAM, &addresses)) {
+        probe_result.message = "Unable to resolve " + p_config.address;
+    } else {
+        sockaddr_storage address = addresses[0];
+        bool measured = false;
+        if (p_config.echo_port != 0) {
+            sockaddr_storage echo_address = address;
+            net::set_address_port(&echo_address, p_config.echo_port);
+            measured = _probe_udp(p_config, echo_address, &probe_result);
+        }
+        // 没有回显端时只能测量 TCP 握手
+        if (!measured && !cancelled.load()) {
+            measured = _probe_tcp(p_config, address, &probe_result);
+        }
+
+        if (cancelled.load()) {
+            probe_result.message = "Probe was cancelled";
+        } else if (!measured) {
+            probe_result.message = "Host did not respond";
+        } else {
+            probe_result.success = true;
+            recommend(p_config, &probe_result);
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(result_mutex);
+        result = probe_result;
+        result_pending.store(true, std::memory_order_release);
+    }
+    running = false;
+}
+
+// 按序号排列的 RTT 样本 (未收到为负) 汇总到 Result
+static void summarize_rtts(const std::vector<double> &rtts, NetworkProbe::Result *r_result) {
+    r_result->sent = (int)rtts.size();
+    r_result->samples = 0;
+    double sum = 0.0;
+    double jitter_sum = 0.0;
+    int jitter_count = 0;
+    double previous = -1.0;
+    r_result->rtt_min_ms = 0.0;
+    for (double rtt : rtts) {
+        if (rtt < 0.0) {
+            continue;
+        }
+        if (r_result->samples == 0 || rtt < r_result->rtt_min_ms) {
+            r_result->rtt_min_ms = rtt;
+        }
+        r_result->samples++;
+        sum += rtt;
+        if (previous >= 0.0) {
+            jitter_sum += std::fabs(rtt - previous);
+            jitter_count++;
+        }
+        previous = rtt;
+    }
+    r_result->rtt_avg_ms = r_result->samples > 0 ? sum / r_result->samples : 0.0;
+    r_result->jitter_ms = jitter_count > 0 ? jitter_sum / jitter_count : 0.0;
+    r_result->loss_ratio = r_result->sent > 0 ? 1.0 - (double)r_result->samples / r_result->sent : 0.0;
+}
+
+bool NetworkProbe::_probe_udp(const Config &p_config, const sockaddr_storage &p_address, Result *r_result) {
+    socket_t sock = socket(p_address.ss_family, SOCK_DGRAM, IPPROTO_UDP);
+    if (sock == NET_INVALID_SOCKET) {
+        return false;
+    }
+    // connect 后只接收回显端的包，且能收到端口不可达错误
+    if (connect(sock, (const sockaddr *)&p_address, net::address_length(p_address)) != 0 || !net::set_nonblocking(sock, true)) {
+        net::close_socket(sock);
+        return false;
+    }
+    // 突发测量时接收缓冲区不能成为瓶颈
+    int buffer_size = 4 * 1024 * 1024;
+    setsockopt(sock, SOL_SOCKET, SO_RCVBUF, (const char *)&buffer_size, sizeof(buffer_size));
+
+    std::random_device rd;
+    uint32_t token = rd();
+    int count = std::max(p_config.ping_count, 1);
+    std::vector<uint64_t> send_times(count, 0);
+    std::vector<double> rtts(count, -1.0);
+    int received = 0;
+    uint64_t cookie = 0;
+
+    auto drain = [&]() {
+        uint8_t packet[PING_PACKET_SIZE];
+        while (true) {
+            int n = (int)recv(sock, (char *)packet, sizeof(packet), 0);
+            // 没有更多数据，或端口不可达等错误 (按丢包处理)
+            if (n < 0) {
+                return;
+            }
+            if (n < (int)PROBE_HEADER_SIZE) {
+                continue;
+            }
+            uint32_t seq = read_u32(packet + 8);
+            if (read_u32(packet) != PROBE_MAGIC || packet[4] != PROBE_PING || read_u32(packet + 12) != token || seq >= (uint32_t)count) {
+                continue;
+            }
+            if (rtts[seq] < 0.0) {
+                rtts[seq] = (now_us() - send_times[seq]) / 1000.0;
+                received++;
+            }
+            if (n >= (int)(COOKIE_OFFSET + 8)) {
+                cookie = read_u64(packet + COOKIE_OFFSET);
+            }
+        }
+    };
+
+    // 按固定间隔发送，期间接收回显
+    uint8_t ping[PING_PACKET_SIZE];
+    for (int i = 0; i < count && !cancelled.load(); i++) {
+        write_header(ping, PROBE_PING, (uint32_t)i, token);
+        send_times[i] = now_us();
+        send(sock, (const char *)ping, sizeof(ping), 0);
+
+        uint64_t next_send = send_times[i] + (uint64_t)p_config.ping_interval_ms * 1000;
+        uint64_t now = now_us();
+        while (now < next_send) {
+            if (wait_readable(sock, (int)((next_send - now + 999) / 1000))) {
+                drain();
+            }
+            now = now_us();
+        }
+    }
+    uint64_t deadline = now_us() + (uint64_t)p_config.timeout_ms * 1000;
+    while (received < count && !cancelled.load()) {
+        uint64_t now = now_us();
+        if (now >= deadline) {
+            break;
+        }
+        if (wait_readable(sock, (int)((deadline - now + 999) / 1000))) {
+            drain();
+        }
+    }
+
+    if (received == 0 || cancelled.load()) {
+        net::close_socket(sock);
+        return false;
+    }
+    r_result->udp = true;
+    summarize_rtts(rtts, r_result);
+
+    // 不带 cookie 的回显端 (旧版本或兼容服务) 不会响应突发请求，只报告 RTT 与丢包
+    if (cookie != 0) {
+        _measure_burst(p_config, sock, cookie, r_result);
+    }
+    net::close_socket(sock);
+    return true;
+}
+
+bool NetworkProbe::_measure_burst(const Config &p_config, socket_t p_sock, uint64_t p_cookie, Result *r_result) {
+    uint32_t count = (uint32_t)std::max(0, std::min(p_config.burst_packets, (int)MAX_BURST_PACKETS));
+    uint32_t size = (uint32_t)std::max((int)PROBE_HEADER_SIZE, std::min(p_config.burst_packet_size, (int)MAX_BURST_PACKET_SIZE));
+    if (count < 2) {
+        return false;
+    }
+
+    std::random_device rd;
+    uint32_t token = rd();
+    uint8_t request[BURST_REQUEST_SIZE];
+    write_header(request, PROBE_BURST_REQUEST, 0, token);
+    write_u32(request + 16, count);
+    write_u32(request + 20, size);
+    write_u64(request + COOKIE_OFFSET, p_cookie);
+
+    std::vector<bool> seen(count, false);
+    std::vector<uint8_t> packet(MAX_BURST_PACKET_SIZE);
+    uint32_t received = 0;
+    uint64_t first_us = 0;
+    uint64_t last_us = 0;
+    uint64_t bytes_after_first = 0;
+
+    // 请求包可能丢失，没有收到任何数据时重发
+    const int REQUEST_ATTEMPTS = 3;
+    int wait_ms = std::max(p_config.timeout_ms / REQUEST_ATTEMPTS, 50);
+    // 收到第一个包后，超过此间隔没有新包视为突发结束
+    int idle_ms = std::max(200, (int)(r_result->rtt_avg_ms * 4));
+    for (int attempt = 0; attempt < REQUEST_ATTEMPTS && received == 0 && !cancelled.load(); attempt++) {
+        send(p_sock, (const char *)request, sizeof(request), 0);
+        int timeout = wait_ms;
+        while (received < count && !cancelled.load() && wait_readable(p_sock, timeout)) {
+            while (true) {
+                int n = (int)recv(p_sock, (char *)packet.data(), (int)packet.size(), 0);
+                if (n < 0) {
+                    break;
+                }
+                if (n < (int)PROBE_HEADER_SIZE || read_u32(packet.data()) != PROBE_MAGIC || packet[4] != PROBE_BURST_DATA ||
+                        read_u32(packet.data() + 12) != token) {
+                    continue;
+                }
+                uint32_t index = read_u32(packet.data() + 8);
+                if (index >= count || seen[index]) {
+                    continue;
+                }
+                seen[index] = true;
+                uint64_t now = now_us();
+                if (received == 0) {
+                    first_us = now;
+                } else {
+                    bytes_after_first += (uint64_t)n;
+                }
+                last_us = now;
+                received++;
+            }
+            timeout = idle_ms;
+        }
+    }
+
+    r_result->burst_loss_ratio = 1.0 - (double)received / count;
+    // 到达间隔太短时 (例如回环) 计时精度不足以得出有意义的数值
+    if (received < 8 || last_us <= first_us) {
+        return false;
+    }
+    r_result->bandwidth_measured = true;
+    r_result->bandwidth_kbps = (double)bytes_after_first * 8.0 * 1000.0 / (double)(last_us - first_us);
+    return true;
+}
+
+bool NetworkProbe::_probe_tcp(const Config &p_config, const sockaddr_storage &p_address, Result *r_result) {
+    // 连接建立 (SYN / SYN-ACK) 或被拒绝 (RST) 都需要一个往返
+    int count = std::min(std::max(p_config.ping_count, 1), MAX_TCP_SAMPLES);
+    std::vector<double> rtts(count, -1.0);
+    for (int i = 0; i < count && !cancelled.load(); i++) {
+        uint64_t start = now_us();
+        int err = 0;
+        socket_t sock = net::start_connect(p_address, &err);
+        if (sock != NET_INVALID_SOCKET) {
+            struct pollfd pfd;
+            pfd.fd = sock;
+            pfd.events = POLLOUT;
+            pfd.revents = 0;
+            if (net::poll_sockets(&pfd, 1, p_config.timeout_ms) > 0) {
+                rtts[i] = (now_us() - start) / 1000.0;
+            }
+            net::close_socket(sock);
+        }
+
+        uint64_t next = start + (uint64_t)p_config.ping_interval_ms * 1000;
+        uint64_t now = now_us();
+        if (now < next) {
+            std::this_thread::sleep_for(std::chrono::microseconds(next - now));
+        }
+    }
+
+    summarize_rtts(rtts, r_result);
+    r_result->udp = false;
+    return r_result->samples > 0;
+}
+
+int NetworkProbe::get_default_bitrate_kbps(int width, int height, int fps) {
+    int64_t pixels = (int64_t)width * height;
+    double resolution_factor;
+    if (pixels <= 1280 * 720) {
+        resolution_factor = 5;
+    } else if (pixels <= 1920 * 1080) {
+        resolution_factor = 10;
+    } else if (pixels <= 2560 * 1440) {
+        resolution_factor = 20;
+    } else {
+        resolution_factor = 40;
+    }
+    double frame_rate_factor = (fps <= 60 ? fps : std::sqrt(fps / 60.0) * 60.0) / 30.0;
+    return (int)std::lround(resolution_factor * frame_rate_factor) * 1000;
+}
+
+void NetworkProbe::recommend(const Config &p_config, Result *r_result) {
+    struct Tier {
+        int width;
+        int height;
+        int fps;
+    };
+    // 按所需码率从高到低
+    static const Tier TIERS[] = {
+        { 3840, 2160, 120 },
+        { 3840, 2160, 60 },
+        { 2560, 1440, 120 },
+        { 2560, 1440, 60 },
+        { 1920, 1080, 120 },
+        { 1920, 1080, 60 },
+        { 1280, 720, 120 },
+        { 1920, 1080, 30 },
+        { 1280, 720, 60 },
+        { 1280, 720, 30 },
+    };
+
+    double usable_kbps;
+    if (r_result->bandwidth_measured) {
+        usable_kbps = r_result->bandwidth_kbps * BANDWIDTH_HEADROOM;
+    } else {
+        // 没有吞吐量数据时按 RTT 判断：局域网使用默认的 1080p60 码率，其他情况保守一些
+        usable_kbps = r_result->rtt_min_ms < 5.0 ? 20000.0 : 10000.0;
+    }
+    // 丢包会触发 FEC 之外的重传与 IDR 请求，降低码率给拥塞留出空间
+    double loss = std::max(r_result->loss_ratio, r_result->burst_loss_ratio);
+    if (loss >= 0.10) {
+        usable_kbps *= 0.5;
+    } else if (loss >= 0.02) {
+        usable_kbps *= 0.75;
+    }
+    usable_kbps = std::min(usable_kbps, (double)p_config.max_bitrate_kbps);
+
+    const Tier *chosen = nullptr;
+    const Tier *lowest = nullptr;
+    for (const Tier &tier : TIERS) {
+        if (tier.width > p_config.max_width || tier.height > p_config.max_height || tier.fps > p_config.max_fps) {
+            continue;
+        }
+        lowest = &tier;
+        if (!chosen && get_default_bitrate_kbps(tier.width, tier.height, tier.fps) <= usable_kbps) {
+            chosen = &tier;
+        }
+    }
+    if (!chosen) {
+        chosen = lowest ? lowest : &TIERS[sizeof(TIERS) / sizeof(TIERS[0]) - 1];
+    }
+
+    r_result->width = chosen->width;
+    r_result->height = chosen->height;
+    r_result->fps = chosen->fps;
+    // 最低 1 Mbps (与 Moonlight 的码率滑块下限一致)
+    r_result->bitrate_kbps = std::max(1000, (int)(usable_kbps / 500) * 500);
+}
+
+// --- ProbeEchoServer ---
+
+// splitmix64 的混合函数
+static uint64_t mix64(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xBF58476D1CE4E5B9ULL;
+    x ^= x >> 27;
+    x *= 0x94D049BB133111EBULL;
+    x ^= x >> 31;
+    return x;
+}
+
+// 来源地址的字节表示 (地址族 + IP，可选端口)，用于 cookie 与字节预算
+static std::string address_key(const sockaddr_storage &address, bool with_port) {
+    std::string key(1, (char)address.ss_family);
+    if (address.ss_family == AF_INET) {
+        const sockaddr_in *in = (const sockaddr_in *)&address;
+        key.append((const char *)&in->sin_addr, sizeof(in->sin_addr));
+    } else if (address.ss_family == AF_INET6) {
+        const sockaddr_in6 *in6 = (const sockaddr_in6 *)&address;
+        key.append((const char *)&in6->sin6_addr, sizeof(in6->sin6_addr));
+    }
+    if (with_port) {
+        uint16_t port = net::address_port(address);
+        key.append((const char *)&port, sizeof(port));
+    }
+    return key;
+}
+
+uint64_t ProbeEchoServer::_cookie(const sockaddr_storage &p_address, uint64_t p_secret) {
+    std::string key = address_key(p_address, true);
+    uint64_t hash = mix64(p_secret ^ key.size());
+    for (size_t i = 0; i < key.size(); i += 8) {
+        uint64_t chunk = 0;
+        memcpy(&chunk, key.data() + i, std::min((size_t)8, key.size() - i));
+        hash = mix64(hash ^ chunk ^ p_secret);
+    }
+    // 0 表示回显端不支持 cookie
+    return hash != 0 ? hash : 1;
+}
+
+void ProbeEchoServer::_rotate_secrets(uint64_t p_now_ms) {
+    if (secrets_rotated_ms != 0 && p_now_ms - secrets_rotated_ms < COOKIE_ROTATE_MS) {
+        return;
+    }
+    std::random_device rd;
+    uint64_t secret = ((uint64_t)rd() << 32) | rd();
+    // 首次生成时两个周期都使用新秘密
+    previous_secret = secrets_rotated_ms != 0 ? current_secret : secret;
+    current_secret = secret;
+    secrets_rotated_ms = p_now_ms;
+}
+
+uint32_t ProbeEchoServer::_take_budget(const sockaddr_storage &p_address, uint32_t p_count, uint32_t p_size, uint64_t p_now_ms) {
+    for (auto it = budgets.begin(); it != budgets.end();) {
+        if (p_now_ms - it->second.window_start_ms >= BURST_BUDGET_WINDOW_MS) {
+            it = budgets.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    std::string key = address_key(p_address, false);
+    auto it = budgets.find(key);
+    if (it == budgets.end()) {
+        if (budgets.size() >= MAX_BUDGET_SOURCES) {
+            return 0;
+        }
+        it = budgets.emplace(key, SourceBudget{ p_now_ms, 0 }).first;
+    }
+    uint64_t remaining = BURST_BUDGET_BYTES - std::min(it->second.bytes, BURST_BUDGET_BYTES);
+    uint32_t count = (uint32_t)std::min((uint64_t)p_count, remaining / p_size);
+    it->second.bytes += (uint64_t)count * p_size;
+    return count;
+}
+
+ProbeEchoServer::ProbeEchoServer() {
+}
+
+ProbeEchoServer::~ProbeEchoServer() {
+    stop();
+}
+
+bool ProbeEchoServer::start(const std::string &bind_address, uint16_t p_port, std::string *r_error) {
+    if (running.load()) {
+        *r_error = "Echo server is already running";
+        return false;
+    }
+    std::vector<sockaddr_storage> addresses;
+    if (!net::resolve(bind_address, p_port, SOCK_DGRAM, &addresses)) {
+        *r_error = "Unable to resolve " + bind_address;
+        return false;
+    }
+
+    sockaddr_storage address = addresses[0];
+    sock = socket(address.ss_family, SOCK_DGRAM, IPPROTO_UDP);
+    socklen_t length = net::address_length(address);
+    if (sock == NET_INVALID_SOCKET || bind(sock, (const sockaddr *)&address, length) != 0 ||
+            getsockname(sock, (sockaddr *)&address, &length) != 0) {
+        *r_error = "Unable to bind UDP port " + std::to_string(p_port);
+        net::close_socket(sock);
+        sock = NET_INVALID_SOCKET;
+        return false;
+    }
+    int buffer_size = 4 * 1024 * 1024;
+    setsockopt(sock, SOL_SOCKET, SO_SNDBUF, (const char *)&buffer_size, sizeof(buffer_size));
+    port = net::address_port(address);
+
+    secrets_rotated_ms = 0;
+    _rotate_secrets(net::now_ms());
+    budgets.clear();
+    running = true;
+    worker = std::thread(&ProbeEchoServer::_run, this);
+    return true;
+}
+
+void ProbeEchoServer::stop() {
+    if (!running.exchange(false)) {
+        return;
+    }
+    if (worker.joinable()) {
+        worker.join();
+    }
+    net::close_socket(sock);
+    sock = NET_INVALID_SOCKET;
+    port = 0;
+}
+
+void ProbeEchoServer::_run() {
+    std::vector<uint8_t> packet(MAX_BURST_PACKET_SIZE);
+    while (running.load()) {
+        // 定期返回以检查 running
+        if (!wait_readable(sock, 100)) {
+            continue;
+        }
+        sockaddr_storage from;
+        socklen_t from_length = sizeof(from);
+        int n = (int)recvfrom(sock, (char *)packet.data(), (int)packet.size(), 0, (sockaddr *)&from, &from_length);
+        if (n < (int)PROBE_HEADER_SIZE || read_u32(packet.data()) != PROBE_MAGIC) {
+            continue;
+        }
+
+        uint64_t now = net::now_ms();
+        _rotate_secrets(now);
+
+        // PING 原样返回 (回应不大于请求)，并附上该来源的 cookie
+        if (packet[4] == PROBE_PING) {
+            if (n >= (int)(COOKIE_OFFSET + 8)) {
+                write_u64(packet.data() + COOKIE_OFFSET, _cookie(from, current_secret));
+            }
+            sendto(sock, (const char *)packet.data(), n, 0, (const sockaddr *)&from, from_length);
+            continue;
+        }
+        if (packet[4] != PROBE_BURST_REQUEST || n < (int)BURST_REQUEST_SIZE) {
+            continue;
+        }
+        uint64_t cookie = read_u64(packet.data() + COOKIE_OFFSET);
+        if (cookie != _cookie(from, current_secret) && cookie != _cookie(from, previous_secret)) {
+            continue;
+        }
+
+        uint32_t token = read_u32(packet.data() + 12);
+        uint32_t size = std::max((uint32_t)PROBE_HEADER_SIZE, std::min(read_u32(packet.data() + 20), MAX_BURST_PACKET_SIZE));
+        uint32_t count = _take_budget(from, std::min(read_u32(packet.data() + 16), MAX_BURST_PACKETS), size, now);
+        std::vector<uint8_t> data(size, 0);
+        for (uint32_t i = 0; i < count && running.load(); i++) {
+            write_header(data.data(), PROBE_BURST_DATA, i, token);
+            sendto(sock, (const char *)data.data(), (int)size, 0, (const sockaddr *)&from, from_length);
+        }
+    }
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include "net/net_socket.h"
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// 连接前的网络质量探测 (替代 start_connection 固定使用 20 Mbps)
+// 工作线程测量 RTT、抖动与丢包，并用一次短时突发测量主机到客户端方向的吞吐量，
+// 据此推荐码率、分辨率与帧率档位。
+// 注意：对真实的 GameStream 主机 (Sunshine / GeForce Experience) 不会测量吞吐量。这些主机在串流开始前不回应 UDP，
+// 也不运行 ProbeEchoServer，因此只能对 HTTP 端口做 TCP 握手计时 (RTT 与丢包)，推荐码率只按 RTT 阈值选择
+// (最小 RTT < 5ms 为 20 Mbps，否则 10 Mbps)。只有主机侧另外运行 ProbeEchoServer 时才有突发吞吐量测量。
+class NetworkProbe {
+public:
+    struct Config {
+        std::string address;
+        uint16_t echo_port = 0;                          // ProbeEchoServer 的 UDP 端口，0 表示只做 TCP 探测
+        uint16_t tcp_port = 47989;                       // 主机的 HTTP 端口
+        int ping_count = 20;
+        int ping_interval_ms = 20;
+        int burst_packets = 256;
+        int burst_packet_size = 1200;
+        int timeout_ms = 1000;                           // 最后一个探测包发出后等待回应的时间
+
+        // 推荐档位的上限
+        int max_width = 3840;
+        int max_height = 2160;
+        int max_fps = 120;
+        int max_bitrate_kbps = 150000;
+    };
+
+    struct Result {
+        bool success = false;
+        std::string message;
+
+        bool udp = false;               // 是否使用了 UDP 回显
+        int samples = 0;                // 收到回应的探测次数
+        int sent = 0;
+        double loss_ratio = 0.0;
+        double rtt_min_ms = 0.0;
+        double rtt_avg_ms = 0.0;
+        double jitter_ms = 0.0;         // 相邻 RTT 差值的平均绝对值
+
+        bool bandwidth_measured = false;
+        double bandwidth_kbps = 0.0;
+        double burst_loss_ratio = 0.0;
+
+        int bitrate_kbps = 0;
+        int width = 0;
+        int height = 0;
+        int fps = 0;
+    };
+
+    NetworkProbe();
+    ~NetworkProbe();
+
+    bool start(const Config &p_config, std::string *r_error);
+    void cancel();
+    bool is_running() const { return running.load(); }
+
+    bool has_result() const { return result_pending.load(std::memory_order_acquire); }
+    bool take_result(Result *r_result);
+
+    // 根据测量结果填写 bitrate_kbps / width / height / fps
+    static void recommend(const Config &p_config, Result *r_result);
+    // Moonlight 的默认码率：分辨率系数 (720p 5、1080p 10、1440p 20、4K 40 Mbps) 乘以帧率系数
+    static int get_default_bitrate_kbps(int width, int height, int fps);
+
+private:
+    std::thread worker;
+    std::atomic<bool> running{ false };
+    std::atomic<bool> cancelled{ false };
+
+    std::mutex result_mutex;
+    Result result;
+    std::atomic<bool> result_pending{ false };
+
+    void _run(Config p_config);
+    bool _probe_udp(const Config &p_config, const sockaddr_storage &p_address, Result *r_result);
+    bool _probe_tcp(const Config &p_config, const sockaddr_storage &p_address, Result *r_result);
+    bool _measure_burst(const Config &p_config, socket_t p_sock, uint64_t p_cookie, Result *r_result);
+};
+
+// NetworkProbe 的 UDP 回显端：原样返回探测包，并按请求发送突发数据包
+// 可在主机上与串流软件一起运行，也可在回环地址上用于测试。
+// 突发请求必须带回 PING 回应中的 cookie (返回路由验证)，且每个来源在时间窗口内有字节上限，
+// 因此不能被伪造源地址的请求用作反射放大。
+class ProbeEchoServer {
+public:
+    ProbeEchoServer();
+    ~ProbeEchoServer();
+
+    // port 为 0 时由系统分配；bind_address 为 "0.0.0.0" / "::" 时向其他设备开放
+    bool start(const std::string &bind_address, uint16_t port, std::string *r_error);
+    void stop();
+    bool is_running() const { return running.load(); }
+    uint16_t get_port() const { return port; }
+
+private:
+    std::thread worker;
+    std::atomic<bool> running{ false };
+    socket_t sock = NET_INVALID_SOCKET;
+    uint16_t port = 0;
+
+    // 以下只由工作线程访问 (start 时在线程启动前初始化)
+    struct SourceBudget {
+        uint64_t window_start_ms = 0;
+        uint64_t bytes = 0;
+    };
+    uint64_t current_secret = 0;
+    uint64_t previous_secret = 0;
+    uint64_t secrets_rotated_ms = 0;
+    std::unordered_map<std::string, SourceBudget> budgets; // 按来源 IP (不含端口)
+
+    void _run();
+    static uint64_t _cookie(const sockaddr_storage &p_address, uint64_t p_secret);
+    void _rotate_secrets(uint64_t p_now_ms);
+    // 返回本次允许发送的包数并扣除预算
+    uint32_t _take_budget(const sockaddr_storage &p_address, uint32_t p_count, uint32_t p_size, uint64_t p_now_ms);
+};
@@ -0,0 +1,104 @@
+#include "net/resolver_cache.h"
+
+namespace net {
+
+// 解析成功的结果保留时长；失败的名称较快重试
+static const uint64_t REFRESH_MS = 60000;
+static const uint64_t FAILURE_RETRY_MS = 10000;
+
+ResolverCache::~ResolverCache() {
+    stop();
+}
+
+bool ResolverCache::start(const std::function<void()> &p_on_resolved) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (running) {
+        return true;
+    }
+    on_resolved = p_on_resolved;
+    running = true;
+    thread = std::thread(&ResolverCache::_run, this);
+    return true;
+}
+
+void ResolverCache::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!running) {
+            return;
+        }
+        running = false;
+        // 未完成的解析在下次启动时重新排队
+        queue.clear();
+        for (auto &entry : entries) {
+            entry.second.queued = false;
+        }
+    }
+    condition.notify_all();
+    if (thread.joinable()) {
+        thread.join();
+    }
+}
+
+bool ResolverCache::lookup(const std::string &host, uint16_t port, std::vector<sockaddr_storage> *r_addresses) {
+    // IP 字面量不需要查询
+    if (resolve(host, port, SOCK_STREAM, r_addresses, true)) {
+        return true;
+    }
+
+    bool notify = false;
+    bool resolved = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        Entry &entry = entries[host];
+        if (!entry.queued && (!entry.resolved || now_ms() >= entry.expires_ms)) {
+            entry.queued = true;
+            queue.push_back(host);
+            notify = true;
+        }
+        resolved = entry.resolved;
+        for (sockaddr_storage address : entry.addresses) {
+            set_address_port(&address, port);
+            r_addresses->push_back(address);
+        }
+    }
+    if (notify) {
+        condition.notify_one();
+    }
+    return resolved;
+}
+
+void ResolverCache::_run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        condition.wait(lock, [this]() { return !running || !queue.empty(); });
+        if (!running) {
+            return;
+        }
+        std::string host = queue.front();
+        queue.pop_front();
+
+        lock.unlock();
+        std::vector<sockaddr_storage> addresses;
+        bool ok = resolve(host, 0, SOCK_STREAM, &addresses);
+        lock.lock();
+
+        Entry &entry = entries[host];
+        entry.queued = false;
+        entry.resolved = true;
+        // 刷新失败时保留上一次的结果，主机名暂时无法解析不应让在线主机掉线
+        if (ok || entry.addresses.empty()) {
+            entry.addresses = addresses;
+        }
+        entry.expires_ms = now_ms() + (ok ? REFRESH_MS : FAILURE_RETRY_MS);
+        generation.fetch_add(1, std::memory_order_release);
+
+        lock.unlock();
+        if (on_resolved) {
+            on_resolved();
+        }
+        lock.lock();
+    }
+}
+
+} // namespace net
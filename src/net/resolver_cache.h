@@ -0,0 +1,57 @@
+#pragma once
+
+#include "net/net_socket.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 非阻塞的主机名解析缓存
+// getaddrinfo 可能阻塞数秒，不能在 poll() reactor 线程中调用。
+// lookup() 对 IP 字面量直接解析，对主机名只读取缓存；缓存缺失或过期时交给后台线程解析，
+// 解析完成后调用 on_resolved 通知调用方 (通常用于唤醒 reactor)，过期的结果在刷新完成前继续使用。
+namespace net {
+
+class ResolverCache {
+public:
+    ~ResolverCache();
+
+    bool start(const std::function<void()> &p_on_resolved);
+    void stop();
+
+    // 不会阻塞。返回 false 表示该名称尚未解析过 (已排队解析)；
+    // 返回 true 时 r_addresses 为最近一次的结果 (解析失败时为空)，端口设为 port
+    bool lookup(const std::string &host, uint16_t port, std::vector<sockaddr_storage> *r_addresses);
+
+    // 每完成一次解析加一，调用方据此判断是否需要重新读取缓存
+    uint64_t get_generation() const { return generation.load(std::memory_order_acquire); }
+
+private:
+    struct Entry {
+        std::vector<sockaddr_storage> addresses;
+        bool resolved = false;
+        bool queued = false;
+        uint64_t expires_ms = 0;
+    };
+
+    std::thread thread;
+    bool running = false;
+    std::function<void()> on_resolved;
+
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::map<std::string, Entry> entries;
+    std::deque<std::string> queue;
+    std::atomic<uint64_t> generation{ 0 };
+
+    void _run();
+};
+
+} // namespace net
@@ -0,0 +1,142 @@
+#include "net/tls_identity.h"
+
+#ifdef MOONLIGHT_USE_MBEDTLS
+
+#include <cstring>
+#include <ctime>
+
+namespace tls {
+
+Identity::Identity() {
+    mbedtls_x509_crt_init(&cert);
+    mbedtls_pk_init(&key);
+}
+
+Identity::~Identity() {
+    mbedtls_pk_free(&key);
+    mbedtls_x509_crt_free(&cert);
+}
+
+std::shared_ptr<Identity> Identity::parse(const std::string &cert_pem, const std::string &key_pem, std::string *r_error) {
+    std::shared_ptr<Identity> identity = std::make_shared<Identity>();
+
+    // PEM 解析要求长度包含结尾的 '\0'
+    int ret = mbedtls_x509_crt_parse(&identity->cert, (const unsigned char *)cert_pem.c_str(), cert_pem.size() + 1);
+    if (ret != 0) {
+        *r_error = "Unable to parse client certificate: " + error_string(ret);
+        return nullptr;
+    }
+
+    RandomContext random;
+    if (!random.seed("moonlight-godot-identity")) {
+        *r_error = "Unable to seed random number generator";
+        return nullptr;
+    }
+    ret = pk_parse_key(&identity->key, (const unsigned char *)key_pem.c_str(), key_pem.size() + 1, &random.ctr_drbg);
+    if (ret != 0) {
+        *r_error = "Unable to parse client private key: " + error_string(ret);
+        return nullptr;
+    }
+
+    identity->cert_pem = cert_pem;
+    return identity;
+}
+
+// X.509 时间格式 YYYYMMDDhhmmss (UTC)
+static std::string x509_time(time_t t) {
+    struct tm tm;
+#ifdef _WIN32
+    gmtime_s(&tm, &t);
+#else
+    gmtime_r(&t, &tm);
+#endif
+    char buffer[16];
+    strftime(buffer, sizeof(buffer), "%Y%m%d%H%M%S", &tm);
+    return buffer;
+}
+
+bool generate_identity(std::string *r_cert_pem, std::string *r_key_pem, std::string *r_error) {
+    crypto_init();
+    RandomContext random;
+    if (!random.seed("moonlight-godot-keygen")) {
+        *r_error = "Unable to seed random number generator";
+        return false;
+    }
+
+    mbedtls_pk_context key;
+    mbedtls_x509write_cert crt;
+    mbedtls_pk_init(&key);
+    mbedtls_x509write_crt_init(&crt);
+
+    // PEM 输出缓冲区 (2048 位 RSA 私钥约 1.7KB，证书约 1.1KB)
+    std::string cert_pem(4096, '\0');
+    std::string key_pem(4096, '\0');
+    time_t now = time(nullptr);
+    int ret = mbedtls_pk_setup(&key, mbedtls_pk_info_from_type(MBEDTLS_PK_RSA));
+    if (ret == 0) {
+        ret = mbedtls_rsa_gen_key(mbedtls_pk_rsa(key), mbedtls_ctr_drbg_random, &random.ctr_drbg, 2048, 65537);
+    }
+    if (ret == 0) {
+        mbedtls_x509write_crt_set_version(&crt, MBEDTLS_X509_CRT_VERSION_3);
+        mbedtls_x509write_crt_set_md_alg(&crt, MBEDTLS_MD_SHA256);
+        mbedtls_x509write_crt_set_subject_key(&crt, &key);
+        mbedtls_x509write_crt_set_issuer_key(&crt, &key);
+        ret = x509write_crt_set_serial(&crt, 0);
+    }
+    if (ret == 0) {
+        ret = mbedtls_x509write_crt_set_subject_name(&crt, "CN=NVIDIA GameStream Client");
+    }
+    if (ret == 0) {
+        ret = mbedtls_x509write_crt_set_issuer_name(&crt, "CN=NVIDIA GameStream Client");
+    }
+    if (ret == 0) {
+        ret = mbedtls_x509write_crt_set_validity(&crt, x509_time(now).c_str(), x509_time(now + 60LL * 60 * 24 * 365 * 20).c_str());
+    }
+    if (ret == 0) {
+        ret = mbedtls_x509write_crt_pem(&crt, (unsigned char *)&cert_pem[0], cert_pem.size(), mbedtls_ctr_drbg_random, &random.ctr_drbg);
+    }
+    if (ret == 0) {
+        ret = mbedtls_pk_write_key_pem(&key, (unsigned char *)&key_pem[0], key_pem.size());
+    }
+
+    mbedtls_x509write_crt_free(&crt);
+    mbedtls_pk_free(&key);
+
+    if (ret != 0) {
+        *r_error = "Unable to generate client identity: " + error_string(ret);
+        return false;
+    }
+    cert_pem.resize(strlen(cert_pem.c_str()));
+    key_pem.resize(strlen(key_pem.c_str()));
+    *r_cert_pem = cert_pem;
+    *r_key_pem = key_pem;
+    return true;
+}
+
+PinnedCertificate::PinnedCertificate() {
+    mbedtls_x509_crt_init(&cert);
+}
+
+PinnedCertificate::~PinnedCertificate() {
+    mbedtls_x509_crt_free(&cert);
+}
+
+std::shared_ptr<PinnedCertificate> PinnedCertificate::parse(const std::string &pem, std::string *r_error) {
+    std::shared_ptr<PinnedCertificate> pinned = std::make_shared<PinnedCertificate>();
+    int ret = mbedtls_x509_crt_parse(&pinned->cert, (const unsigned char *)pem.c_str(), pem.size() + 1);
+    if (ret != 0) {
+        *r_error = "Unable to parse server certificate: " + error_string(ret);
+        return nullptr;
+    }
+    pinned->pem = pem;
+    return pinned;
+}
+
+bool PinnedCertificate::matches(const mbedtls_x509_crt *other) const {
+    return other && other->raw.len == cert.raw.len &&
+            memcmp(other->raw.p, cert.raw.p, cert.raw.len) == 0;
+}
+
+} // namespace tls
+
+#endif // MOONLIGHT_USE_MBEDTLS
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "net/mbedtls_compat.h"
+
+#include <memory>
+#include <string>
+
+#ifdef MOONLIGHT_USE_MBEDTLS
+
+namespace tls {
+
+// 已解析的客户端身份 (证书 + 私钥)
+// 只解析一次，由所有使用它的 TLS 连接通过 shared_ptr 共享；
+// 替换身份时旧对象在最后一个连接释放后才会销毁，不会出现悬空指针。
+struct Identity {
+    mbedtls_x509_crt cert;
+    mbedtls_pk_context key;
+    std::string cert_pem;
+
+    Identity();
+    ~Identity();
+    Identity(const Identity &) = delete;
+    Identity &operator=(const Identity &) = delete;
+
+    static std::shared_ptr<Identity> parse(const std::string &cert_pem, const std::string &key_pem, std::string *r_error);
+};
+
+// 生成 2048 位 RSA 私钥与有效期 20 年的自签名客户端证书 (与 IdentityManager::createCredentials 一致)
+// 耗时可达数秒，应在后台线程调用
+bool generate_identity(std::string *r_cert_pem, std::string *r_key_pem, std::string *r_error);
+
+// 服务器证书 (配对时获得，用于证书绑定)
+struct PinnedCertificate {
+    mbedtls_x509_crt cert;
+    std::string pem;
+
+    PinnedCertificate();
+    ~PinnedCertificate();
+    PinnedCertificate(const PinnedCertificate &) = delete;
+    PinnedCertificate &operator=(const PinnedCertificate &) = delete;
+
+    static std::shared_ptr<PinnedCertificate> parse(const std::string &pem, std::string *r_error);
+    // 比较 DER 编码是否一致
+    bool matches(const mbedtls_x509_crt *other) const;
+};
+
+} // namespace tls
+
+#endif // MOONLIGHT_USE_MBEDTLS
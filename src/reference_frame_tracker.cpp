@@ -0,0 +1,53 @@
+#include "reference_frame_tracker.h"
+
+void ReferenceFrameTracker::reset(bool p_rfi_enabled, int fps) {
+    rfi_enabled = p_rfi_enabled;
+    have_reference = false;
+    last_frame_number = -1;
+    consecutive_errors = 0;
+    max_concealed_errors = fps > 0 ? fps / 2 : 30;
+    lost_frames = 0;
+    concealed_frames = 0;
+    idr_requests = 0;
+}
+
+void ReferenceFrameTracker::on_frame_received(PDECODE_UNIT du) {
+    if (du->frameType == FRAME_TYPE_IDR) {
+        // IDR 重置参考链
+        have_reference = true;
+        consecutive_errors = 0;
+    } else if (last_frame_number >= 0 && du->frameNumber > last_frame_number + 1) {
+        // 帧号不连续：[last_frame_number + 1, frameNumber - 1] 已丢失。
+        // 启用 RFI 时 Limelight 已将该区间通知主机；未启用时主机会发送 IDR。
+        lost_frames.fetch_add(du->frameNumber - last_frame_number - 1, std::memory_order_relaxed);
+        if (!rfi_enabled) {
+            have_reference = false;
+        }
+    }
+    last_frame_number = du->frameNumber;
+}
+
+ReferenceFrameTracker::Result ReferenceFrameTracker::on_decode_result(PDECODE_UNIT du, bool decode_ok) {
+    if (decode_ok) {
+        consecutive_errors = 0;
+        return RESULT_OK;
+    }
+
+    consecutive_errors++;
+
+    // IDR 本身解码失败，或从未建立过参考链，只能等待新的 IDR
+    bool recoverable = rfi_enabled && have_reference && du->frameType != FRAME_TYPE_IDR;
+    if (recoverable && consecutive_errors <= max_concealed_errors) {
+        concealed_frames.fetch_add(1, std::memory_order_relaxed);
+        return RESULT_CONCEAL;
+    }
+
+    on_idr_requested();
+    return RESULT_NEED_IDR;
+}
+
+void ReferenceFrameTracker::on_idr_requested() {
+    have_reference = false;
+    consecutive_errors = 0;
+    idr_requests.fetch_add(1, std::memory_order_relaxed);
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+extern "C" {
+#include "lib/moonlight-common-c/src/Limelight.h"
+}
+
+// 参考帧跟踪 (Reference Frame Invalidation)
+// 声明 CAPABILITY_REFERENCE_FRAME_INVALIDATION_* 后，Limelight 在检测到丢包时会向主机发送
+// 失效区间 (丢失的 frameNumber 范围)，主机随后以仍然有效的旧参考帧编码新的 P 帧，而不是发送 IDR。
+// 解码端需要容忍失效区间内的解码错误，只有在参考链确实无法恢复时才返回 DR_NEED_IDR。
+class ReferenceFrameTracker {
+public:
+    enum Result {
+        RESULT_OK,        // 解码正常
+        RESULT_CONCEAL,   // 解码出错，但主机正在通过 RFI 恢复，丢弃本帧即可
+        RESULT_NEED_IDR,  // 参考链无法恢复，需要 IDR
+    };
+
+    void reset(bool p_rfi_enabled, int fps);
+
+    // 在解码前调用，根据 frameNumber 检测丢失的帧
+    void on_frame_received(PDECODE_UNIT du);
+    // 在解码后调用，decode_ok 为 FFmpeg 是否成功接受并解码该帧
+    Result on_decode_result(PDECODE_UNIT du, bool decode_ok);
+    // 外部 (例如背压控制) 请求了 IDR，参考链在下一个 IDR 之前无效
+    void on_idr_requested();
+
+    bool is_rfi_enabled() const { return rfi_enabled; }
+    uint64_t get_lost_frames() const { return lost_frames.load(std::memory_order_relaxed); }
+    uint64_t get_concealed_frames() const { return concealed_frames.load(std::memory_order_relaxed); }
+    uint64_t get_idr_requests() const { return idr_requests.load(std::memory_order_relaxed); }
+
+private:
+    bool rfi_enabled = false;
+    bool have_reference = false;      // 自上一个 IDR 起参考链是否有效
+    int last_frame_number = -1;
+    int consecutive_errors = 0;
+    int max_concealed_errors = 30;    // 连续解码错误超过此值 (约 0.5 秒) 则放弃 RFI，请求 IDR
+
+    std::atomic<uint64_t> lost_frames{ 0 };
+    std::atomic<uint64_t> concealed_frames{ 0 };
+    std::atomic<uint64_t> idr_requests{ 0 };
+};
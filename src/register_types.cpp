@@ -1,26 +1,59 @@
 #include "register_types.h"
 
 #include <gdextension_interface.h>
+#include <godot_cpp/classes/engine.hpp>
 #include <godot_cpp/core/class_db.hpp>
 #include <godot_cpp/core/defs.hpp>
 #include <godot_cpp/godot.hpp>
 
+#include "moonlight_box_art_cache.h"
+#include "moonlight_host_poller.h"
+#include "moonlight_host_store.h"
+#include "moonlight_https_client.h"
+#include "moonlight_identity.h"
+#include "moonlight_input.h"
+#include "moonlight_mdns_browser.h"
+#include "moonlight_network_probe.h"
+#include "moonlight_pairing_manager.h"
+#include "moonlight_stats_overlay.h"
 #include "moonlight_stream_core.h"
 
 using namespace godot;
 
+static MoonlightIdentity *identity_singleton = nullptr;
+
 void initialize_gdextension_types(ModuleInitializationLevel p_level)
 {
 	if (p_level != MODULE_INITIALIZATION_LEVEL_SCENE) {
 		return;
 	}
 	GDREGISTER_CLASS(MoonlightStreamCore);
+	GDREGISTER_CLASS(MoonlightHttpsClient);
+	GDREGISTER_CLASS(MoonlightHostPoller);
+	GDREGISTER_CLASS(MoonlightMdnsBrowser);
+	GDREGISTER_CLASS(MoonlightBoxArtCache);
+	GDREGISTER_CLASS(MoonlightPairingManager);
+	GDREGISTER_CLASS(MoonlightIdentity);
+	GDREGISTER_CLASS(MoonlightHostStore);
+	GDREGISTER_CLASS(MoonlightNetworkProbe);
+	GDREGISTER_CLASS(MoonlightInput);
+	GDREGISTER_CLASS(MoonlightStatsOverlay);
+
+	// 插件加载时即在后台读取或生成客户端身份
+	identity_singleton = memnew(MoonlightIdentity);
+	Engine::get_singleton()->register_singleton("MoonlightIdentity", identity_singleton);
+	identity_singleton->start_loading();
 }
 
 void uninitialize_gdextension_types(ModuleInitializationLevel p_level) {
 	if (p_level != MODULE_INITIALIZATION_LEVEL_SCENE) {
 		return;
 	}
+	if (identity_singleton) {
+		Engine::get_singleton()->unregister_singleton("MoonlightIdentity");
+		memdelete(identity_singleton);
+		identity_singleton = nullptr;
+	}
 }
 
 extern "C"
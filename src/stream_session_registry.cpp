@@ -0,0 +1,42 @@
+#include "stream_session_registry.h"
+
+#include <algorithm>
+
+std::mutex StreamSessionRegistry::mutex;
+std::vector<MoonlightStreamCore *> StreamSessionRegistry::cores;
+std::atomic<MoonlightStreamCore *> StreamSessionRegistry::connection_owner{ nullptr };
+
+void StreamSessionRegistry::register_core(MoonlightStreamCore *core) {
+    std::lock_guard<std::mutex> lock(mutex);
+    cores.push_back(core);
+}
+
+void StreamSessionRegistry::unregister_core(MoonlightStreamCore *core) {
+    release_connection(core);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    cores.erase(std::remove(cores.begin(), cores.end(), core), cores.end());
+}
+
+MoonlightStreamCore *StreamSessionRegistry::from_context(void *context) {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (MoonlightStreamCore *core : cores) {
+        if (core == context) {
+            return core;
+        }
+    }
+    return nullptr;
+}
+
+bool StreamSessionRegistry::acquire_connection(MoonlightStreamCore *core) {
+    MoonlightStreamCore *expected = nullptr;
+    if (connection_owner.compare_exchange_strong(expected, core, std::memory_order_acq_rel)) {
+        return true;
+    }
+    return expected == core;
+}
+
+void StreamSessionRegistry::release_connection(MoonlightStreamCore *core) {
+    MoonlightStreamCore *expected = core;
+    connection_owner.compare_exchange_strong(expected, nullptr, std::memory_order_acq_rel);
+}
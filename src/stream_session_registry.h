@@ -0,0 +1,31 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+class MoonlightStreamCore;
+
+// 串流实例注册表
+// 记录进程内的 MoonlightStreamCore 实例，并管理唯一的 Limelight 连接归哪个实例所有。
+// moonlight-common-c 使用全局状态，进程内同时只能有一个连接：同一时刻只有一个实例在串流，
+// 其他实例的 start_connection 会失败。插件不支持在一个进程中同时串流多路，需要多路时每路使用单独的 Godot 进程。
+// Limelight 的无上下文回调通过 get_connection_owner() 路由到持有连接的实例。
+class StreamSessionRegistry {
+public:
+    static void register_core(MoonlightStreamCore *core);
+    static void unregister_core(MoonlightStreamCore *core);
+    // 将 Limelight 回调中的 context 映射回实例，未注册时返回 nullptr
+    static MoonlightStreamCore *from_context(void *context);
+
+    // --- Limelight 连接所有权 ---
+    // 必须在 LiStartConnection 之前获取：连接建立过程中就会触发回调
+    static bool acquire_connection(MoonlightStreamCore *core);
+    static void release_connection(MoonlightStreamCore *core);
+    static MoonlightStreamCore *get_connection_owner() { return connection_owner.load(std::memory_order_acquire); }
+
+private:
+    static std::mutex mutex;
+    static std::vector<MoonlightStreamCore *> cores;
+    static std::atomic<MoonlightStreamCore *> connection_owner;
+};
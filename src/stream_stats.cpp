@@ -0,0 +1,70 @@
+#include "stream_stats.h"
+
+#include <chrono>
+
+// 计数器在两次快照之间被清零 (新会话) 时，以当前值作为差值
+static uint64_t counter_delta(uint64_t previous, uint64_t current) {
+    return current >= previous ? current - previous : current;
+}
+
+void StreamStats::reset() {
+    received_frames.store(0, std::memory_order_relaxed);
+    decoded_frames.store(0, std::memory_order_relaxed);
+    decode_time_us.store(0, std::memory_order_relaxed);
+    decode_count.store(0, std::memory_order_relaxed);
+    host_latency_total.store(0, std::memory_order_relaxed);
+    host_latency_count.store(0, std::memory_order_relaxed);
+    rendered_frames.store(0, std::memory_order_relaxed);
+}
+
+StreamStats::Snapshot StreamStats::snapshot() const {
+    Snapshot result;
+    result.time_us = now_us();
+    result.received_frames = received_frames.load(std::memory_order_relaxed);
+    result.decoded_frames = decoded_frames.load(std::memory_order_relaxed);
+    result.rendered_frames = rendered_frames.load(std::memory_order_relaxed);
+    result.decode_time_us = decode_time_us.load(std::memory_order_relaxed);
+    result.decode_count = decode_count.load(std::memory_order_relaxed);
+    result.host_latency_total = host_latency_total.load(std::memory_order_relaxed);
+    result.host_latency_count = host_latency_count.load(std::memory_order_relaxed);
+    return result;
+}
+
+StreamStats::Window StreamStats::compute(const Snapshot &p_previous, const Snapshot &p_current) {
+    Window window;
+    window.rtt_ms = p_current.rtt_ms;
+    window.rtt_variance_ms = p_current.rtt_variance_ms;
+    if (p_current.time_us <= p_previous.time_us) {
+        return window;
+    }
+    window.duration_s = (p_current.time_us - p_previous.time_us) / 1000000.0;
+
+    uint64_t received = counter_delta(p_previous.received_frames, p_current.received_frames);
+    uint64_t lost = counter_delta(p_previous.lost_frames, p_current.lost_frames);
+    uint64_t dropped = counter_delta(p_previous.dropped_frames, p_current.dropped_frames);
+    window.received_fps = received / window.duration_s;
+    window.decoded_fps = counter_delta(p_previous.decoded_frames, p_current.decoded_frames) / window.duration_s;
+    window.rendered_fps = counter_delta(p_previous.rendered_frames, p_current.rendered_frames) / window.duration_s;
+    if (received + lost > 0) {
+        window.network_loss_percent = 100.0 * lost / (received + lost);
+    }
+    if (received > 0) {
+        window.dropped_percent = 100.0 * dropped / received;
+    }
+
+    uint64_t decode_count = counter_delta(p_previous.decode_count, p_current.decode_count);
+    if (decode_count > 0) {
+        window.decode_time_ms = counter_delta(p_previous.decode_time_us, p_current.decode_time_us) / 1000.0 / decode_count;
+    }
+    uint64_t host_count = counter_delta(p_previous.host_latency_count, p_current.host_latency_count);
+    if (host_count > 0) {
+        window.host_latency_ms = counter_delta(p_previous.host_latency_total, p_current.host_latency_total) / 10.0 / host_count;
+    }
+    return window;
+}
+
+uint64_t StreamStats::now_us() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// 串流统计计数器
+// 解码线程与主线程只对原子计数器做 relaxed 累加，不加锁，读取方 (统计覆盖层、GDScript) 不会阻塞热路径。
+// 计数器只增不减 (新会话开始时清零)，读取方保存上一次的快照，用两次快照的差值计算一个窗口内的速率与平均值，
+// 因此多个读取方可以各自以不同的频率读取而互不干扰。
+class StreamStats {
+public:
+    struct Snapshot {
+        uint64_t time_us = 0;
+        uint64_t received_frames = 0;   // 从网络收到的帧
+        uint64_t decoded_frames = 0;    // 解码器输出的帧
+        uint64_t rendered_frames = 0;   // 上传到纹理的帧
+        uint64_t lost_frames = 0;       // 网络丢失的帧 (由 ReferenceFrameTracker 统计)
+        uint64_t dropped_frames = 0;    // 背压主动丢弃的帧 (由 VideoBackpressure 统计)
+        uint64_t decode_time_us = 0;    // 解码耗时总和
+        uint64_t decode_count = 0;
+        uint64_t host_latency_total = 0; // 主机处理延迟总和 (0.1 ms)
+        uint64_t host_latency_count = 0; // 带有主机处理延迟的帧数 (旧版主机不提供)
+        uint32_t rtt_ms = 0;            // 估计的网络往返延迟
+        uint32_t rtt_variance_ms = 0;
+    };
+
+    // 两次快照之间的统计
+    struct Window {
+        double duration_s = 0.0;
+        double received_fps = 0.0;
+        double decoded_fps = 0.0;
+        double rendered_fps = 0.0;
+        double network_loss_percent = 0.0; // 网络丢失的帧占应收帧的比例
+        double dropped_percent = 0.0;      // 主动丢弃的帧占收到帧的比例
+        double decode_time_ms = 0.0;       // 平均解码耗时
+        double host_latency_ms = -1.0;     // 平均主机处理延迟，-1 表示主机未提供
+        uint32_t rtt_ms = 0;
+        uint32_t rtt_variance_ms = 0;
+    };
+
+    void reset();
+
+    // 在解码线程中调用
+    // host_latency 为 DECODE_UNIT::frameHostProcessingLatency (0.1 ms，0 表示主机未提供)
+    void on_frame_received(uint16_t host_latency) {
+        received_frames.fetch_add(1, std::memory_order_relaxed);
+        if (host_latency != 0) {
+            host_latency_total.fetch_add(host_latency, std::memory_order_relaxed);
+            host_latency_count.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    void on_frame_decoded() { decoded_frames.fetch_add(1, std::memory_order_relaxed); }
+    void on_decode_time(uint64_t decode_us) {
+        decode_time_us.fetch_add(decode_us, std::memory_order_relaxed);
+        decode_count.fetch_add(1, std::memory_order_relaxed);
+    }
+    // 在主线程中调用
+    void on_frame_rendered() { rendered_frames.fetch_add(1, std::memory_order_relaxed); }
+
+    // 读取本类维护的计数器，lost/dropped/rtt 由调用方补充
+    Snapshot snapshot() const;
+    static Window compute(const Snapshot &p_previous, const Snapshot &p_current);
+
+    static uint64_t now_us();
+
+private:
+    std::atomic<uint64_t> received_frames{ 0 };
+    std::atomic<uint64_t> decoded_frames{ 0 };
+    std::atomic<uint64_t> decode_time_us{ 0 };
+    std::atomic<uint64_t> decode_count{ 0 };
+    std::atomic<uint64_t> host_latency_total{ 0 };
+    std::atomic<uint64_t> host_latency_count{ 0 };
+    // 由主线程写入，与解码线程的计数器分开放在不同的缓存行
+    alignas(64) std::atomic<uint64_t> rendered_frames{ 0 };
+};
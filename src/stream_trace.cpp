@@ -0,0 +1,157 @@
+#include "stream_trace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <map>
+
+struct EventInfo {
+    const char *name;
+    const char *category;
+    const char *arg_name;
+};
+
+static const EventInfo EVENT_INFO[StreamTrace::EVENT_TYPE_MAX] = {
+    { "frame_received", "video", "frame" },
+    { "frame_dropped", "video", "frame" },
+    { "idr_request", "video", "frame" },
+    { "decode", "video", "frame" },
+    { "convert", "video", nullptr },
+    { "upload", "render", nullptr },
+    { "present", "render", nullptr },
+    { "audio_decode", "audio", "bytes" },
+    { "audio_push", "audio", "samples" },
+    { "connection_started", "connection", nullptr },
+    { "connection_terminated", "connection", "error" },
+    { "connection_status", "connection", "status" },
+};
+
+// 按各线程第一个事件的类别命名线程
+static const char *thread_name_for_category(const char *category) {
+    if (strcmp(category, "video") == 0) {
+        return "Video decode";
+    }
+    if (strcmp(category, "audio") == 0) {
+        return "Audio decode";
+    }
+    if (strcmp(category, "render") == 0) {
+        return "Main";
+    }
+    return "Connection";
+}
+
+// 每个线程第一次写入时分配一个从 1 开始的编号
+static uint32_t current_thread_id() {
+    static std::atomic<uint32_t> next_thread_id{ 1 };
+    thread_local uint32_t thread_id = next_thread_id.fetch_add(1, std::memory_order_relaxed);
+    return thread_id;
+}
+
+void StreamTrace::set_enabled(bool p_enabled) {
+    if (p_enabled && !slots) {
+        slots.reset(new Slot[CAPACITY]);
+    }
+    // release：写入方看到 enabled 时缓冲区一定已分配
+    enabled.store(p_enabled, std::memory_order_release);
+}
+
+void StreamTrace::record(EventType type, uint64_t timestamp_us, uint64_t duration_us, int64_t arg) {
+    uint64_t index = write_index.fetch_add(1, std::memory_order_relaxed);
+    Slot &slot = slots[index & (CAPACITY - 1)];
+    slot.sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.timestamp_us.store(timestamp_us, std::memory_order_relaxed);
+    slot.duration_us.store(duration_us, std::memory_order_relaxed);
+    slot.info.store((uint64_t)type | ((uint64_t)current_thread_id() << 32), std::memory_order_relaxed);
+    slot.arg.store(arg, std::memory_order_relaxed);
+    slot.sequence.store(index + 1, std::memory_order_release);
+}
+
+void StreamTrace::clear() {
+    clear_index.store(write_index.load(std::memory_order_acquire), std::memory_order_relaxed);
+}
+
+std::vector<StreamTrace::Event> StreamTrace::collect() const {
+    std::vector<Event> events;
+    if (!slots) {
+        return events;
+    }
+    uint64_t end = write_index.load(std::memory_order_acquire);
+    uint64_t begin = std::max(end > CAPACITY ? end - CAPACITY : 0, clear_index.load(std::memory_order_relaxed));
+    events.reserve(end - begin);
+    for (uint64_t index = begin; index < end; index++) {
+        const Slot &slot = slots[index & (CAPACITY - 1)];
+        // 序号不匹配：尚未写完或已被更新的事件覆盖
+        if (slot.sequence.load(std::memory_order_acquire) != index + 1) {
+            continue;
+        }
+        Event event;
+        event.timestamp_us = slot.timestamp_us.load(std::memory_order_relaxed);
+        event.duration_us = slot.duration_us.load(std::memory_order_relaxed);
+        uint64_t info = slot.info.load(std::memory_order_relaxed);
+        event.arg = slot.arg.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != index + 1) {
+            continue;
+        }
+        uint16_t type = (uint16_t)(info & 0xFFFF);
+        if (type >= EVENT_TYPE_MAX) {
+            continue;
+        }
+        event.type = (EventType)type;
+        event.thread_id = (uint32_t)(info >> 32);
+        events.push_back(event);
+    }
+    // 各线程的耗时事件在结束时写入，按开始时间重新排序
+    std::stable_sort(events.begin(), events.end(), [](const Event &a, const Event &b) {
+        return a.timestamp_us < b.timestamp_us;
+    });
+    return events;
+}
+
+std::string StreamTrace::to_chrome_json() const {
+    std::vector<Event> events = collect();
+    std::string json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    std::map<uint32_t, const char *> thread_names;
+    char buffer[256];
+    bool first = true;
+    for (const Event &event : events) {
+        const EventInfo &info = EVENT_INFO[event.type];
+        thread_names.emplace(event.thread_id, info.category);
+        int length;
+        if (event.duration_us > 0) {
+            length = snprintf(buffer, sizeof(buffer),
+                    "%s{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%" PRIu64 ",\"dur\":%" PRIu64 ",\"pid\":1,\"tid\":%u",
+                    first ? "" : ",", info.name, info.category, event.timestamp_us, event.duration_us, event.thread_id);
+        } else {
+            length = snprintf(buffer, sizeof(buffer),
+                    "%s{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%" PRIu64 ",\"pid\":1,\"tid\":%u",
+                    first ? "" : ",", info.name, info.category, event.timestamp_us, event.thread_id);
+        }
+        json.append(buffer, length);
+        if (info.arg_name) {
+            length = snprintf(buffer, sizeof(buffer), ",\"args\":{\"%s\":%" PRId64 "}", info.arg_name, event.arg);
+            json.append(buffer, length);
+        }
+        json += '}';
+        first = false;
+    }
+    // 线程名元数据，便于在时间线中区分解码、音频与主线程
+    for (const auto &thread : thread_names) {
+        int length = snprintf(buffer, sizeof(buffer),
+                "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+                first ? "" : ",", thread.first, thread_name_for_category(thread.second));
+        json.append(buffer, length);
+        first = false;
+    }
+    json += "]}";
+    return json;
+}
+
+uint64_t StreamTrace::now_us() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// 串流时间线追踪
+// 各线程把事件写入固定容量的环形缓冲区，写满后覆盖最早的事件。写入不加锁：
+// 每个写入方用 fetch_add 领取一个槽位，槽位以序号 (seqlock) 发布，导出时跳过正在被覆盖的槽位。
+// 未启用时每个记录点只有一次 is_enabled() 分支，因此可以常驻在发布版本中。
+// 导出格式为 Chrome trace JSON，可直接用 chrome://tracing 或 Perfetto 打开。
+class StreamTrace {
+public:
+    enum EventType : uint16_t {
+        EVENT_FRAME_RECEIVED,       // 收到一个视频帧 (arg: frameNumber)
+        EVENT_FRAME_DROPPED,        // 背压主动丢弃 (arg: frameNumber)
+        EVENT_IDR_REQUEST,          // 请求 IDR (arg: frameNumber)
+        EVENT_DECODE,               // 视频解码 (arg: frameNumber)
+        EVENT_CONVERT,              // 颜色空间转换与缩放
+        EVENT_UPLOAD,               // 纹理上传
+        EVENT_PRESENT,              // 新帧已显示
+        EVENT_AUDIO_DECODE,         // 音频解码 (arg: 包大小)
+        EVENT_AUDIO_PUSH,           // 推送到 AudioStreamGenerator (arg: 采样数)
+        EVENT_CONNECTION_STARTED,
+        EVENT_CONNECTION_TERMINATED, // arg: 错误码
+        EVENT_CONNECTION_STATUS,    // arg: CONN_STATUS_*
+        EVENT_TYPE_MAX,
+    };
+
+    struct Event {
+        uint64_t timestamp_us = 0;
+        uint64_t duration_us = 0;   // 0 表示瞬时事件
+        EventType type = EVENT_FRAME_RECEIVED;
+        uint32_t thread_id = 0;
+        int64_t arg = 0;
+    };
+
+    // 2^16 个事件约 2.5 MB，60 fps 下可保留数分钟的时间线
+    static const uint32_t CAPACITY = 1 << 16;
+
+    // 记录一段耗时，析构时写入；构造时未启用则什么都不做
+    class Scope {
+    public:
+        Scope(StreamTrace &p_trace, EventType p_type, int64_t p_arg = 0) :
+                trace(p_trace), type(p_type), arg(p_arg), start_us(p_trace.is_enabled() ? now_us() : 0) {}
+        ~Scope() { end(); }
+        // 提前结束 (之后析构不再记录)
+        void end() {
+            if (start_us != 0) {
+                // 至少 1 us，以便与瞬时事件区分
+                uint64_t duration_us = now_us() - start_us;
+                trace.record(type, start_us, duration_us > 0 ? duration_us : 1, arg);
+                start_us = 0;
+            }
+        }
+        void set_arg(int64_t p_arg) { arg = p_arg; }
+
+    private:
+        StreamTrace &trace;
+        EventType type;
+        int64_t arg;
+        uint64_t start_us;
+    };
+
+    // 首次启用时分配缓冲区，之后不再释放 (写入方可能仍在写入)
+    void set_enabled(bool p_enabled);
+    bool is_enabled() const { return enabled.load(std::memory_order_acquire); }
+
+    void instant(EventType type, int64_t arg = 0) {
+        if (is_enabled()) {
+            record(type, now_us(), 0, arg);
+        }
+    }
+    void record(EventType type, uint64_t timestamp_us, uint64_t duration_us, int64_t arg);
+
+    // 丢弃已记录的事件
+    void clear();
+    // 按时间顺序返回缓冲区中的事件
+    std::vector<Event> collect() const;
+    // 生成 Chrome trace JSON
+    std::string to_chrome_json() const;
+
+    static uint64_t now_us();
+
+private:
+    struct Slot {
+        // 0 表示正在写入；否则为写入序号 + 1
+        std::atomic<uint64_t> sequence{ 0 };
+        std::atomic<uint64_t> timestamp_us{ 0 };
+        std::atomic<uint64_t> duration_us{ 0 };
+        std::atomic<uint64_t> info{ 0 };    // 低 16 位为事件类型，高 32 位为线程号
+        std::atomic<int64_t> arg{ 0 };
+    };
+
+    std::unique_ptr<Slot[]> slots;
+    std::atomic<bool> enabled{ false };
+    std::atomic<uint64_t> write_index{ 0 };
+    std::atomic<uint64_t> clear_index{ 0 };
+};
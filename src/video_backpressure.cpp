@@ -0,0 +1,105 @@
+#include "video_backpressure.h"
+
+// 解码耗时指数移动平均系数
+static const double DECODE_TIME_EMA_ALPHA = 0.1;
+
+void VideoBackpressure::reset(int fps, int p_video_format) {
+    video_format = p_video_format;
+    frame_interval_ms = 1000.0 / (fps > 0 ? fps : 60);
+    awaiting_idr = false;
+    last_idr_request_ms = 0;
+    level = LEVEL_NONE;
+    decode_time_ema_ms = 0.0;
+    last_pending_frames = 0;
+    dropped_frames = 0;
+}
+
+void VideoBackpressure::on_decode_time(double decode_ms) {
+    double ema = decode_time_ema_ms.load(std::memory_order_relaxed);
+    ema = ema <= 0.0 ? decode_ms : ema + (decode_ms - ema) * DECODE_TIME_EMA_ALPHA;
+    decode_time_ema_ms.store(ema, std::memory_order_relaxed);
+}
+
+VideoBackpressure::Action VideoBackpressure::on_decode_unit(PDECODE_UNIT du, int pending_frames, uint64_t now_ms) {
+    last_pending_frames.store(pending_frames, std::memory_order_relaxed);
+    bool is_idr = du->frameType == FRAME_TYPE_IDR;
+
+    // 已请求 IDR：IDR 到达前的帧都无法正确解码，直接丢弃
+    if (awaiting_idr) {
+        if (!is_idr) {
+            dropped_frames.fetch_add(1, std::memory_order_relaxed);
+            return ACTION_DROP;
+        }
+        awaiting_idr = false;
+    }
+
+    // 解码器本身跟不上帧率时，即使队列尚浅也按软限制处理
+    bool decoder_slow = decode_time_ema_ms.load(std::memory_order_relaxed) > frame_interval_ms * 0.9;
+
+    if (pending_frames >= config.hard_queue_limit && !is_idr &&
+            now_ms - last_idr_request_ms >= config.idr_cooldown_ms) {
+        last_idr_request_ms = now_ms;
+        awaiting_idr = true;
+        level = LEVEL_RESYNC;
+        dropped_frames.fetch_add(1, std::memory_order_relaxed);
+        return ACTION_REQUEST_IDR;
+    }
+
+    if (pending_frames >= config.soft_queue_limit || decoder_slow) {
+        level = LEVEL_SKIPPING;
+        if (!is_idr && is_non_reference_frame(du, video_format)) {
+            dropped_frames.fetch_add(1, std::memory_order_relaxed);
+            return ACTION_DROP;
+        }
+        // 后面还有排队的帧，这一帧转换后会立即被覆盖
+        return pending_frames > 0 ? ACTION_DECODE_ONLY : ACTION_DECODE;
+    }
+
+    level = LEVEL_NONE;
+    return ACTION_DECODE;
+}
+
+bool VideoBackpressure::is_non_reference_frame(PDECODE_UNIT du, int video_format) {
+    bool is_h264 = (video_format & VIDEO_FORMAT_MASK_H264) != 0;
+    bool is_hevc = (video_format & VIDEO_FORMAT_MASK_H265) != 0;
+    if (!is_h264 && !is_hevc) {
+        // AV1 等格式不解析 OBU，保守地视为参考帧
+        return false;
+    }
+
+    bool found_slice = false;
+    for (PLENTRY entry = du->bufferList; entry; entry = entry->next) {
+        if (entry->bufferType != BUFFER_TYPE_PICDATA) {
+            continue;
+        }
+
+        // 扫描 Annex B 起始码 (00 00 01)，检查每个 slice NAL 的头部
+        const uint8_t *data = (const uint8_t *)entry->data;
+        for (int i = 0; i + 3 < entry->length; i++) {
+            if (data[i] != 0 || data[i + 1] != 0 || data[i + 2] != 1) {
+                continue;
+            }
+            uint8_t header = data[i + 3];
+            if (is_h264) {
+                int nal_type = header & 0x1F;
+                if (nal_type == 1 || nal_type == 5) {
+                    found_slice = true;
+                    if ((header >> 5) & 0x3) {
+                        return false; // nal_ref_idc != 0，参考帧
+                    }
+                }
+            } else {
+                int nal_type = (header >> 1) & 0x3F;
+                if (nal_type <= 21) {
+                    found_slice = true;
+                    // 0..14 中的偶数类型 (TRAIL_N, TSA_N, STSA_N, RADL_N, RASL_N, RSV_VCL_N*) 为子层非参考帧
+                    if (nal_type > 14 || (nal_type & 1)) {
+                        return false;
+                    }
+                }
+            }
+            i += 3;
+        }
+    }
+    return found_slice;
+}
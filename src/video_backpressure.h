@@ -0,0 +1,64 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+extern "C" {
+#include "lib/moonlight-common-c/src/Limelight.h"
+}
+
+// 视频解码背压控制器
+// 在 Limelight 解码线程中逐帧调用，根据 Limelight 解码队列深度和解码耗时决定：
+//   - 正常解码并转换上传
+//   - 解码但跳过 RGBA 转换 (后面还有排队的帧，这一帧上传后马上会被覆盖)
+//   - 丢弃非参考帧 (不解码)
+//   - 请求 IDR 重新同步 (丢弃整个队列，保证延迟有界)
+class VideoBackpressure {
+public:
+    enum Action {
+        ACTION_DECODE,        // 解码 + 转换
+        ACTION_DECODE_ONLY,   // 解码但不转换 (参考帧必须解码)
+        ACTION_DROP,          // 非参考帧，直接丢弃
+        ACTION_REQUEST_IDR,   // 返回 DR_NEED_IDR，Limelight 会清空队列并请求 IDR
+    };
+
+    enum Level {
+        LEVEL_NONE = 0,       // 正常
+        LEVEL_SKIPPING = 1,   // 正在跳帧/丢帧
+        LEVEL_RESYNC = 2,     // 已请求 IDR 重新同步
+    };
+
+    struct Config {
+        int soft_queue_limit = 2;       // 达到此队列深度开始跳过转换/丢弃非参考帧
+        int hard_queue_limit = 6;       // 达到此队列深度请求 IDR
+        uint64_t idr_cooldown_ms = 1000; // 两次 IDR 请求的最小间隔，避免 IDR 风暴
+    };
+
+    void reset(int fps, int video_format);
+    void set_config(const Config &p_config) { config = p_config; }
+
+    // 决定如何处理当前解码单元；pending_frames 为 LiGetPendingVideoFrames() 的值
+    Action on_decode_unit(PDECODE_UNIT du, int pending_frames, uint64_t now_ms);
+    // 报告一次解码 (send_packet + receive_frame) 的耗时
+    void on_decode_time(double decode_ms);
+
+    Level get_level() const { return level.load(std::memory_order_relaxed); }
+    double get_decode_time_ms() const { return decode_time_ema_ms.load(std::memory_order_relaxed); }
+    int get_pending_frames() const { return last_pending_frames.load(std::memory_order_relaxed); }
+    uint64_t get_dropped_frames() const { return dropped_frames.load(std::memory_order_relaxed); }
+
+    // 解析码流判断当前帧是否为非参考帧 (H.264 nal_ref_idc == 0 / HEVC *_N 类型)
+    static bool is_non_reference_frame(PDECODE_UNIT du, int video_format);
+
+private:
+    Config config;
+    int video_format = 0;
+    double frame_interval_ms = 1000.0 / 60.0;
+    bool awaiting_idr = false;
+    uint64_t last_idr_request_ms = 0;
+
+    std::atomic<Level> level{ LEVEL_NONE };
+    std::atomic<double> decode_time_ema_ms{ 0.0 };
+    std::atomic<int> last_pending_frames{ 0 };
+    std::atomic<uint64_t> dropped_frames{ 0 };
+};
@@ -0,0 +1,53 @@
+// applist 解析基准
+// 生成一个与 Sunshine 输出格式相同、含 600 个应用的 /applist 响应 (标题中混有实体与 CDATA)，
+// 重复解析并报告单次耗时与吞吐量。不属于默认测试，用 scons -C tests bench 运行。
+
+#include "host/server_info.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+static const int APP_COUNT = 600;
+
+static std::string build_app_list(int count) {
+    std::string xml = "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n<root status_code=\"200\">\n";
+    char buffer[512];
+    for (int i = 0; i < count; i++) {
+        const char *title_format = i % 3 == 0 ? "Game %d &amp; Friends &#x2122;" : (i % 3 == 1 ? "<![CDATA[Game %d <Deluxe>]]>" : "Game %d");
+        char title[128];
+        snprintf(title, sizeof(title), title_format, i);
+        snprintf(buffer, sizeof(buffer),
+                "<App>\n<IsHdrSupported>%d</IsHdrSupported>\n<AppTitle>%s</AppTitle>\n<UUID>%08X-0000-0000-0000-000000000000</UUID>\n"
+                "<IsAppCollectorGame>0</IsAppCollectorGame>\n<ID>%d</ID>\n</App>\n",
+                i % 2, title, (unsigned)i, 100000 + i);
+        xml += buffer;
+    }
+    xml += "</root>\n";
+    return xml;
+}
+
+int main(int argc, char **argv) {
+    int iterations = argc > 1 ? atoi(argv[1]) : 2000;
+    std::string xml = build_app_list(APP_COUNT);
+
+    std::vector<AppInfo> apps;
+    if (!parse_app_list(xml.data(), xml.size(), &apps) || (int)apps.size() != APP_COUNT) {
+        fprintf(stderr, "parse_app_list failed\n");
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    size_t total_apps = 0;
+    for (int i = 0; i < iterations; i++) {
+        parse_app_list(xml.data(), xml.size(), &apps);
+        total_apps += apps.size();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    printf("%d apps, %zu bytes, %d iterations\n", APP_COUNT, xml.size(), iterations);
+    printf("%.1f us/parse, %.1f MB/s (%zu apps)\n", seconds * 1e6 / iterations, xml.size() * (double)iterations / seconds / 1e6, total_apps);
+    return 0;
+}
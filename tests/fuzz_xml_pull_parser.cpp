@@ -0,0 +1,200 @@
+// XmlPullParser 与 serverinfo/applist 解析的模糊测试
+// 用 libFuzzer 构建时 (clang++ -fsanitize=fuzzer,address,undefined -DMOONLIGHT_LIBFUZZER) 只提供 LLVMFuzzerTestOneInput；
+// 否则编译为普通测试程序：先检查几个已知的畸形输入，再对种子做确定性的随机变异，便于在没有 libFuzzer 的环境中运行。
+//
+// 每个输入检查的不变量：
+//   1. 解析在有限步内结束，返回的元素名与文本都位于输入缓冲区内
+//   2. 深度从不为负，END_DOCUMENT 时所有元素都已闭合
+//   3. END_ELEMENT 的元素名与对应的 START_ELEMENT 相同
+//   4. decode_text 成功时输出不含 NUL
+
+#include "host/server_info.h"
+#include "host/xml_pull_parser.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#define FUZZ_ASSERT(cond)                                                      \
+    do {                                                                       \
+        if (!(cond)) {                                                         \
+            fprintf(stderr, "%s:%d: FUZZ_ASSERT failed: %s\n", __FILE__, __LINE__, #cond); \
+            abort();                                                           \
+        }                                                                      \
+    } while (0)
+
+static bool inside(std::string_view view, const char *data, size_t length) {
+    return view.empty() || (view.data() >= data && view.data() + view.size() <= data + length);
+}
+
+static void check_decode(std::string_view raw) {
+    std::string decoded;
+    if (XmlPullParser::decode_text(raw, &decoded)) {
+        FUZZ_ASSERT(decoded.find('\0') == std::string::npos);
+    }
+}
+
+static void check_parser(const char *data, size_t length) {
+    XmlPullParser parser(data, length);
+    std::vector<std::string_view> open;
+    // 每个 token 至少消耗一个字节 (自闭合标签的 END_ELEMENT 除外)
+    size_t max_tokens = length * 2 + 2;
+    for (size_t i = 0;; i++) {
+        FUZZ_ASSERT(i < max_tokens);
+        XmlPullParser::Token token = parser.next();
+        FUZZ_ASSERT(parser.depth() >= 0);
+        if (token == XmlPullParser::ERROR) {
+            return;
+        }
+        if (token == XmlPullParser::END_DOCUMENT) {
+            FUZZ_ASSERT(open.empty() && parser.depth() == 0);
+            return;
+        }
+        if (token == XmlPullParser::START_ELEMENT) {
+            FUZZ_ASSERT(inside(parser.name(), data, length));
+            open.push_back(parser.name());
+            FUZZ_ASSERT(parser.depth() == (int)open.size());
+            std::string_view value;
+            if (parser.get_attribute("status_message", &value)) {
+                FUZZ_ASSERT(inside(value, data, length));
+                check_decode(value);
+            }
+        } else if (token == XmlPullParser::END_ELEMENT) {
+            FUZZ_ASSERT(!open.empty() && parser.name() == open.back());
+            open.pop_back();
+            FUZZ_ASSERT(parser.depth() == (int)open.size());
+        } else {
+            FUZZ_ASSERT(inside(parser.text(), data, length));
+            check_decode(parser.text());
+        }
+    }
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *input, size_t size) {
+    // 拷贝到恰好等长的缓冲区，越界读取能被 AddressSanitizer 发现
+    std::vector<char> buffer(input, input + size);
+    const char *data = buffer.empty() ? "" : buffer.data();
+
+    check_parser(data, size);
+    check_decode(std::string_view(data, size));
+
+    ServerInfo info;
+    if (parse_server_info(data, size, &info)) {
+        for (const std::string *field : { &info.hostname, &info.uniqueid, &info.mac, &info.gpu_model }) {
+            FUZZ_ASSERT(field->find('\0') == std::string::npos);
+        }
+    }
+    std::vector<AppInfo> apps;
+    if (parse_app_list(data, size, &apps)) {
+        for (const AppInfo &app : apps) {
+            FUZZ_ASSERT(app.name.find('\0') == std::string::npos);
+        }
+    }
+    return 0;
+}
+
+#ifndef MOONLIGHT_LIBFUZZER
+
+static const char *const SEEDS[] = {
+    "<?xml version=\"1.0\" encoding=\"utf-8\"?><root status_code=\"200\"><hostname>PC &amp; Co</hostname>"
+    "<uniqueid>0123456789ABCDEF</uniqueid><mac>00:11:22:33:44:55</mac><HttpsPort>47984</HttpsPort>"
+    "<PairStatus>1</PairStatus><currentgame>0</currentgame><state>SUNSHINE_SERVER_FREE</state>"
+    "<SupportedDisplayMode><DisplayMode><Width>1920</Width><Height>1080</Height><RefreshRate>60</RefreshRate>"
+    "</DisplayMode></SupportedDisplayMode></root>",
+    "<root status_code=\"200\"><App><IsHdrSupported>1</IsHdrSupported><AppTitle>Desktop &#x4E2D;&#25991;</AppTitle>"
+    "<ID>1</ID></App><App><AppTitle><![CDATA[Steam <Big Picture>]]></AppTitle><ID>2</ID></App></root>",
+    "<root status_code=\"401\" status_message=\"The client is not authorized &quot;x&quot;\"/>",
+    "<!-- comment --><!DOCTYPE root><root><a/><b attr='>'>text</b></root>",
+};
+
+// 修复前会被接受的输入
+static void check_regressions() {
+    struct Case {
+        const char *xml;
+        bool server_info_ok;
+    };
+    static const Case CASES[] = {
+        { "<root status_code=\"200\"><uniqueid>A</uniqueid></root>", true },
+        // 结束标签与开始标签不匹配
+        { "<root status_code=\"200\"><uniqueid>A</hostname></root>", false },
+        { "<root status_code=\"200\"><uniqueid>A</uniqueid></toor>", false },
+        // 数字字符引用为 NUL、代理项或超出 Unicode 范围
+        { "<root status_code=\"200\"><uniqueid>A&#0;B</uniqueid></root>", false },
+        { "<root status_code=\"200\"><uniqueid>A&#x0;B</uniqueid></root>", false },
+        { "<root status_code=\"200\"><uniqueid>A&#x;B</uniqueid></root>", false },
+        { "<root status_code=\"200\"><uniqueid>A&#xD800;B</uniqueid></root>", false },
+        { "<root status_code=\"200\"><uniqueid>A&#x110000;B</uniqueid></root>", false },
+        { "<root status_code=\"200\"><uniqueid>A&#1z;B</uniqueid></root>", false },
+    };
+    for (const Case &test : CASES) {
+        ServerInfo info;
+        bool ok = parse_server_info(test.xml, strlen(test.xml), &info);
+        if (ok != test.server_info_ok) {
+            fprintf(stderr, "parse_server_info(%s) returned %d\n", test.xml, ok);
+            exit(1);
+        }
+    }
+
+    const char *app_list = "<root status_code=\"200\"><App><AppTitle>A&#0;</AppTitle><ID>1</ID></App></root>";
+    std::vector<AppInfo> apps;
+    FUZZ_ASSERT(!parse_app_list(app_list, strlen(app_list), &apps));
+
+    std::string decoded;
+    FUZZ_ASSERT(XmlPullParser::decode_text("&#9;&#x1F600;&unknown;", &decoded) && decoded == "\t\xF0\x9F\x98\x80&unknown;");
+}
+
+static void mutate(std::string &data, std::mt19937 &rng) {
+    static const char *const TOKENS[] = { "<", ">", "/", "</", "/>", "&", ";", "&#", "&#x", "&#0;", "<![CDATA[", "]]>", "<!--", "-->", "\"", "'", "<root>", "</root>", "<App>", "</App>" };
+    int edits = 1 + (int)(rng() % 4);
+    for (int i = 0; i < edits; i++) {
+        size_t at = data.empty() ? 0 : rng() % (data.size() + 1);
+        switch (rng() % 5) {
+            case 0: // 删除一段
+                if (!data.empty()) {
+                    data.erase(std::min(at, data.size() - 1), 1 + rng() % 8);
+                }
+                break;
+            case 1: // 替换一个字节
+                if (!data.empty()) {
+                    data[std::min(at, data.size() - 1)] = (char)rng();
+                }
+                break;
+            case 2: // 插入一个 XML 片段
+                data.insert(at, TOKENS[rng() % (sizeof(TOKENS) / sizeof(TOKENS[0]))]);
+                break;
+            case 3: // 复制一段
+                if (!data.empty()) {
+                    size_t from = rng() % data.size();
+                    data.insert(at, data.substr(from, 1 + rng() % 32));
+                }
+                break;
+            default: // 截断
+                data.resize(at);
+                break;
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    check_regressions();
+
+    int iterations = argc > 1 ? atoi(argv[1]) : 200000;
+    std::mt19937 rng(0x4D4C); // 固定种子，失败可以复现
+    size_t seed_count = sizeof(SEEDS) / sizeof(SEEDS[0]);
+    for (size_t i = 0; i < seed_count; i++) {
+        LLVMFuzzerTestOneInput((const uint8_t *)SEEDS[i], strlen(SEEDS[i]));
+    }
+    for (int i = 0; i < iterations; i++) {
+        std::string data = SEEDS[rng() % seed_count];
+        mutate(data, rng);
+        LLVMFuzzerTestOneInput((const uint8_t *)data.data(), data.size());
+    }
+    printf("PASS (%d inputs)\n", iterations);
+    return 0;
+}
+
+#endif
@@ -0,0 +1,380 @@
+// MdnsBrowser 组播回环测试
+// 在本机的测试端口上运行一个最小的 mDNS 响应器，通过真实的组播 socket (IP_MULTICAST_LOOP) 与 MdnsBrowser 交互：
+//   1. 响应器只按问题逐条回答 (PTR 不附带 SRV/A)，浏览器必须单独查询 SRV 与 A 才能发现主机；
+//      PTR 与 SRV 使用不同的大小写，只应产生一个 FOUND 事件
+//   2. SRV/A 的 TTL 只有 2 秒，浏览器按 TTL 的 80% 刷新，数倍 TTL 之后主机仍然在线
+//   3. 响应器停止回答后主机在 TTL 过期后丢失
+//   4. 响应器改为只回答 PTR 查询 (在 PTR 响应中附带 SRV/A)，此时 PTR 仍在浏览器的缓存中，
+//      浏览器不能把它作为已知答案，否则响应器会抑制回答，主机无法重新发现
+
+#include "host/mdns_browser.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+static const uint16_t TEST_PORT = 25353;
+static const char SERVICE[] = "_nvstream._tcp.local";
+static const char PTR_INSTANCE[] = "Test-PC._nvstream._tcp.local";
+static const char SRV_INSTANCE[] = "test-pc._NVSTREAM._tcp.local";
+static const char HOST_NAME[] = "Test-PC.local";
+static const uint32_t PTR_TTL = 4500;
+static const uint32_t SHORT_TTL = 2;
+
+static int failures = 0;
+
+#define CHECK(cond)                                                     \
+    do {                                                                \
+        if (!(cond)) {                                                  \
+            fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+            failures++;                                                 \
+        }                                                               \
+    } while (0)
+
+static bool same_name(const std::string &a, const std::string &b) {
+    return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+        return std::tolower((unsigned char)x) == std::tolower((unsigned char)y);
+    });
+}
+
+// --- 最小的 DNS 编解码 (只覆盖测试需要的部分，不处理压缩指针) ---
+
+static void put_u16(std::vector<uint8_t> &out, uint16_t value) {
+    out.push_back((uint8_t)(value >> 8));
+    out.push_back((uint8_t)value);
+}
+
+static void put_u32(std::vector<uint8_t> &out, uint32_t value) {
+    put_u16(out, (uint16_t)(value >> 16));
+    put_u16(out, (uint16_t)value);
+}
+
+static void put_name(std::vector<uint8_t> &out, const std::string &name) {
+    size_t begin = 0;
+    while (begin < name.size()) {
+        size_t end = name.find('.', begin);
+        if (end == std::string::npos) {
+            end = name.size();
+        }
+        out.push_back((uint8_t)(end - begin));
+        out.insert(out.end(), name.begin() + begin, name.begin() + end);
+        begin = end + 1;
+    }
+    out.push_back(0);
+}
+
+static bool get_name(const uint8_t *data, size_t length, size_t *offset, std::string *r_name) {
+    r_name->clear();
+    while (*offset < length) {
+        uint8_t len = data[(*offset)++];
+        if (len == 0) {
+            return true;
+        }
+        if ((len & 0xC0) != 0 || *offset + len > length) {
+            return false;
+        }
+        if (!r_name->empty()) {
+            *r_name += '.';
+        }
+        r_name->append((const char *)data + *offset, len);
+        *offset += len;
+    }
+    return false;
+}
+
+static uint16_t get_u16(const uint8_t *data, size_t offset) {
+    return (uint16_t)((data[offset] << 8) | data[offset + 1]);
+}
+
+struct Record {
+    std::string name;
+    uint16_t type;
+    uint32_t ttl;
+    std::vector<uint8_t> rdata;
+};
+
+static Record ptr_record() {
+    Record record{ SERVICE, 12, PTR_TTL, {} };
+    put_name(record.rdata, PTR_INSTANCE);
+    return record;
+}
+
+static Record srv_record() {
+    Record record{ SRV_INSTANCE, 33, SHORT_TTL, {} };
+    put_u16(record.rdata, 0);
+    put_u16(record.rdata, 0);
+    put_u16(record.rdata, 47989);
+    put_name(record.rdata, HOST_NAME);
+    return record;
+}
+
+static Record txt_record() {
+    return Record{ SRV_INSTANCE, 16, SHORT_TTL, { 0 } };
+}
+
+static Record a_record() {
+    return Record{ HOST_NAME, 1, SHORT_TTL, { 127, 0, 0, 1 } };
+}
+
+// --- 测试响应器 ---
+
+class Responder {
+public:
+    enum Mode {
+        PER_QUESTION, // 每个问题只回答对应的记录
+        SILENT,       // 不回答
+        PTR_BUNDLE,   // 只回答 PTR 问题，并在同一响应中附带 SRV/TXT/A
+    };
+
+    std::atomic<int> mode{ PER_QUESTION };
+    std::atomic<int> srv_queries{ 0 };
+    std::atomic<int> address_queries{ 0 };
+    std::atomic<int> suppressed_ptr{ 0 };
+
+    bool start() {
+        sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+        if (sock == NET_INVALID_SOCKET) {
+            return false;
+        }
+        int one = 1;
+        setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, (const char *)&one, sizeof(one));
+#ifdef SO_REUSEPORT
+        setsockopt(sock, SOL_SOCKET, SO_REUSEPORT, (const char *)&one, sizeof(one));
+#endif
+        sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_ANY);
+        addr.sin_port = htons(TEST_PORT);
+        if (bind(sock, (const sockaddr *)&addr, sizeof(addr)) != 0) {
+            return false;
+        }
+        struct ip_mreq mreq;
+        inet_pton(AF_INET, "224.0.0.251", &mreq.imr_multiaddr);
+        mreq.imr_interface.s_addr = htonl(INADDR_ANY);
+        if (setsockopt(sock, IPPROTO_IP, IP_ADD_MEMBERSHIP, (const char *)&mreq, sizeof(mreq)) != 0) {
+            return false;
+        }
+        unsigned char loop = 1;
+        setsockopt(sock, IPPROTO_IP, IP_MULTICAST_LOOP, (const char *)&loop, sizeof(loop));
+        net::set_nonblocking(sock, true);
+        running = true;
+        thread = std::thread(&Responder::_run, this);
+        return true;
+    }
+
+    void stop() {
+        running = false;
+        if (thread.joinable()) {
+            thread.join();
+        }
+        net::close_socket(sock);
+    }
+
+private:
+    socket_t sock = NET_INVALID_SOCKET;
+    std::atomic<bool> running{ false };
+    std::thread thread;
+
+    void _run() {
+        uint8_t buffer[9000];
+        while (running.load()) {
+            struct pollfd pfd;
+            pfd.fd = sock;
+            pfd.events = POLLIN;
+            pfd.revents = 0;
+            if (net::poll_sockets(&pfd, 1, 50) <= 0) {
+                continue;
+            }
+            int n;
+            while ((n = (int)recv(sock, (char *)buffer, sizeof(buffer), 0)) > 0) {
+                _handle_query(buffer, (size_t)n);
+            }
+        }
+    }
+
+    void _handle_query(const uint8_t *data, size_t length) {
+        // 忽略响应 (包括自己发出的)
+        if (length < 12 || (get_u16(data, 2) & 0x8000) != 0 || mode.load() == SILENT) {
+            return;
+        }
+        uint16_t qdcount = get_u16(data, 4);
+        uint16_t ancount = get_u16(data, 6);
+        size_t offset = 12;
+        std::vector<std::pair<std::string, uint16_t>> questions;
+        for (int i = 0; i < qdcount; i++) {
+            std::string name;
+            if (!get_name(data, length, &offset, &name) || offset + 4 > length) {
+                return;
+            }
+            questions.push_back({ name, get_u16(data, offset) });
+            offset += 4;
+        }
+        // 已知答案中 TTL 不少于一半的 PTR 抑制 PTR 回答 (RFC 6762 7.1)
+        bool ptr_known = false;
+        for (int i = 0; i < ancount; i++) {
+            std::string name;
+            if (!get_name(data, length, &offset, &name) || offset + 10 > length) {
+                return;
+            }
+            uint16_t type = get_u16(data, offset);
+            uint32_t ttl = ((uint32_t)get_u16(data, offset + 4) << 16) | get_u16(data, offset + 6);
+            uint16_t rdlength = get_u16(data, offset + 8);
+            offset += 10;
+            size_t rdata_offset = offset;
+            std::string target;
+            if (type == 12 && get_name(data, length, &rdata_offset, &target) && same_name(target, PTR_INSTANCE) && ttl >= PTR_TTL / 2) {
+                ptr_known = true;
+            }
+            offset += rdlength;
+        }
+
+        std::vector<Record> answers;
+        for (auto &question : questions) {
+            if (question.second == 12 && same_name(question.first, SERVICE)) {
+                if (ptr_known) {
+                    suppressed_ptr++;
+                    continue;
+                }
+                answers.push_back(ptr_record());
+                if (mode.load() == PTR_BUNDLE) {
+                    answers.push_back(srv_record());
+                    answers.push_back(txt_record());
+                    answers.push_back(a_record());
+                }
+            } else if (mode.load() == PER_QUESTION) {
+                if (question.second == 33 && same_name(question.first, PTR_INSTANCE)) {
+                    srv_queries++;
+                    answers.push_back(srv_record());
+                } else if (question.second == 16 && same_name(question.first, PTR_INSTANCE)) {
+                    answers.push_back(txt_record());
+                } else if (question.second == 1 && same_name(question.first, HOST_NAME)) {
+                    address_queries++;
+                    answers.push_back(a_record());
+                }
+            }
+        }
+        if (answers.empty()) {
+            return;
+        }
+
+        std::vector<uint8_t> packet;
+        put_u16(packet, 0);
+        put_u16(packet, 0x8400); // 权威响应
+        put_u16(packet, 0);
+        put_u16(packet, (uint16_t)answers.size());
+        put_u16(packet, 0);
+        put_u16(packet, 0);
+        for (const Record &record : answers) {
+            put_name(packet, record.name);
+            put_u16(packet, record.type);
+            put_u16(packet, record.type == 12 ? 1 : 0x8001); // 唯一记录带 cache-flush 位
+            put_u32(packet, record.ttl);
+            put_u16(packet, (uint16_t)record.rdata.size());
+            packet.insert(packet.end(), record.rdata.begin(), record.rdata.end());
+        }
+        sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(TEST_PORT);
+        inet_pton(AF_INET, "224.0.0.251", &addr.sin_addr);
+        sendto(sock, (const char *)packet.data(), (int)packet.size(), 0, (const sockaddr *)&addr, sizeof(addr));
+    }
+};
+
+// 在 timeout_ms 内收集事件，直到出现指定类型的事件
+static bool wait_for_event(MdnsBrowser &browser, MdnsBrowser::Event::Type type, uint64_t timeout_ms, std::vector<MdnsBrowser::Event> *r_events) {
+    uint64_t deadline = net::now_ms() + timeout_ms;
+    while (net::now_ms() < deadline) {
+        for (const MdnsBrowser::Event &event : browser.take_events()) {
+            r_events->push_back(event);
+            if (event.type == type) {
+                return true;
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    return false;
+}
+
+static int count_events(const std::vector<MdnsBrowser::Event> &events, MdnsBrowser::Event::Type type) {
+    return (int)std::count_if(events.begin(), events.end(), [type](const MdnsBrowser::Event &event) { return event.type == type; });
+}
+
+int main() {
+    net::startup();
+
+    Responder responder;
+    if (!responder.start()) {
+        // 没有可用的组播接口 (例如没有网络的容器)
+        printf("SKIP: unable to join 224.0.0.251 on port %d\n", TEST_PORT);
+        return 0;
+    }
+
+    MdnsBrowser browser;
+    MdnsBrowser::Config config;
+    config.port = TEST_PORT;
+    config.use_ipv6 = false;
+    config.max_query_interval_ms = 2000;
+    CHECK(browser.start(config));
+
+    // 1. 逐条回答：单独查询 SRV 与 A 后发现主机，大小写不同的 PTR/SRV 视为同一个实例
+    std::vector<MdnsBrowser::Event> events;
+    CHECK(wait_for_event(browser, MdnsBrowser::Event::FOUND, 5000, &events));
+    CHECK(responder.srv_queries.load() > 0);
+    CHECK(responder.address_queries.load() > 0);
+    if (!events.empty()) {
+        CHECK(events.back().instance == "Test-PC");
+        CHECK(events.back().address == "127.0.0.1");
+        CHECK(events.back().port == 47989);
+        CHECK(events.back().hostname == "test-pc.local");
+    }
+
+    // 2. 四倍 TTL 之后仍然在线，且没有重复的 FOUND
+    int srv_queries = responder.srv_queries.load();
+    int address_queries = responder.address_queries.load();
+    events.clear();
+    wait_for_event(browser, MdnsBrowser::Event::LOST, SHORT_TTL * 4000, &events);
+    CHECK(count_events(events, MdnsBrowser::Event::LOST) == 0);
+    CHECK(count_events(events, MdnsBrowser::Event::FOUND) == 0);
+    CHECK(responder.srv_queries.load() > srv_queries);
+    CHECK(responder.address_queries.load() > address_queries);
+    // 已解析的实例作为已知答案，PTR 回答被抑制
+    CHECK(responder.suppressed_ptr.load() > 0);
+
+    // 3. 响应器停止回答，SRV/A 过期后主机丢失
+    responder.mode = Responder::SILENT;
+    events.clear();
+    CHECK(wait_for_event(browser, MdnsBrowser::Event::LOST, SHORT_TTL * 1000 + 3000, &events));
+    if (!events.empty()) {
+        CHECK(events.back().instance == "Test-PC");
+    }
+
+    // 4. 只回答 PTR 的响应器：缺少 SRV 的实例不能作为已知答案，否则无法重新发现
+    responder.mode = Responder::PTR_BUNDLE;
+    events.clear();
+    CHECK(wait_for_event(browser, MdnsBrowser::Event::FOUND, config.max_query_interval_ms + 3000, &events));
+
+    // 5. stop() 丢弃未取走的事件，重新 start() 后不会报告上一次浏览的结果
+    responder.mode = Responder::SILENT;
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    browser.stop();
+    CHECK(!browser.has_events() && browser.take_events().empty());
+    CHECK(browser.start(config));
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    CHECK(browser.take_events().empty());
+
+    browser.stop();
+    responder.stop();
+
+    if (failures > 0) {
+        printf("FAIL: %d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("PASS\n");
+    return 0;
+}